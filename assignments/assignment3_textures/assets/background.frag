@@ -7,16 +7,18 @@ uniform sampler2D noiseTexture;
 uniform float noiseRate;
 uniform float time;
 uniform float scrollSpeed;
+uniform vec4 backgroundRegion = vec4(0.0, 0.0, 1.0, 1.0);
+uniform vec4 noiseRegion = vec4(0.0, 0.0, 1.0, 1.0);
+
+#include "sampleRegion.glsl"
 
 void main()
 {
     vec2 scrolledUV = UV + vec2(time * scrollSpeed, 0.0);
 
-    scrolledUV = fract(scrolledUV);
-
-    vec4 backgroundSample = texture(background, scrolledUV);
+    vec4 backgroundSample = sampleRegion(background, backgroundRegion, scrolledUV);
     vec2 noiseOffset = vec2(UV.y * noiseRate + time, UV.x * noiseRate + time);
-    vec4 noise = texture(noiseTexture, noiseOffset);
+    vec4 noise = sampleRegion(noiseTexture, noiseRegion, noiseOffset);
 
     vec4 finalColor = backgroundSample + noise;
 
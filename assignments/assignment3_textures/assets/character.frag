@@ -5,10 +5,13 @@ in vec2 UV;
 uniform sampler2D characterTexture;
 uniform float time;
 uniform float alphaRate;
+uniform vec4 characterRegion = vec4(0.0, 0.0, 1.0, 1.0);
+
+#include "sampleRegion.glsl"
 
 void main() 
 {
-    vec4 characterColor = texture(characterTexture, UV);
+    vec4 characterColor = sampleRegion(characterTexture, characterRegion, UV);
     
     float alpha = abs(sin(time * alphaRate));
     
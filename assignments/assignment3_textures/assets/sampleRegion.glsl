@@ -0,0 +1,7 @@
+//Shared atlas sampling, pulled in with #include "sampleRegion.glsl"
+//Region of an atlas a texture was packed into, xy offset and zw size. (0,0,1,1) for a texture of its own.
+//Wrapping happens inside the region, with gradients from the unwrapped UV so mips don't jump at the seam.
+vec4 sampleRegion(sampler2D tex, vec4 region, vec2 uv)
+{
+    return textureGrad(tex, region.xy + fract(uv) * region.zw, dFdx(uv) * region.zw, dFdy(uv) * region.zw);
+}
@@ -13,6 +13,8 @@
 #include <ew/shader.h>
 #include <dj/shader.h>
 #include <dj/texture.cpp>
+#include <ew/atlas.h>
+#include <ew/textureTable.h>
 
 
 struct Vertex {
@@ -23,6 +25,14 @@ struct Vertex {
 unsigned int createVAO(Vertex* vertexData, int numVertices, unsigned short* indicesData, int numIndices);
 void framebufferSizeCallback(GLFWwindow* window, int width, int height);
 
+// Every sprite packed into as few textures as possible, one per atlas page
+struct SpriteAtlas {
+	ew::Atlas atlas;
+	std::vector<unsigned int> textures;
+	bool complete = false; // Every sprite loaded and fit on a page
+};
+void buildSpriteAtlas(const char* files[], int numFiles, const ew::AtlasSettings& settings, SpriteAtlas* spriteAtlas);
+
 const int SCREEN_WIDTH = 1080;
 const int SCREEN_HEIGHT = 720;
 
@@ -70,10 +80,80 @@ int main() {
 	ew::Shader backgroundShader("assets/background.vert", "assets/background.frag");
 	ew::Shader characterShader("assets/character.vert", "assets/character.frag");
 
-	// Load Textures
-	unsigned int brickTexture = loadTexture("assets/brickwall.png", 2, 2);
-	unsigned int noiseTexture = loadTexture("assets/noise.png", 1, 1);
-	unsigned int characterTexture = loadTexture("assets/The_Kid.png", 1, 0);
+	// Load Textures from cached containers, only decoding them if the cache is missing or stale
+	double textureStart = glfwGetTime();
+	ew::TextureCacheStats brickStats;
+	unsigned int brickTexture = loadCachedTexture("assets/brickwall.png", 2, 2, &brickStats);
+	unsigned int noiseTexture = loadCachedTexture("assets/noise.png", 1, 1);
+	unsigned int characterTexture = loadCachedTexture("assets/The_Kid.png", 1, 0);
+	float startupTextureMs = (float)((glfwGetTime() - textureStart) * 1000.0);
+	bool startupFromCache = brickStats.fromCache;
+
+	// The same three images packed into one atlas, so a frame binds one texture instead of three
+	const char* spriteFiles[3] = { "assets/brickwall.png", "assets/noise.png", "assets/The_Kid.png" };
+	const int BRICK_SPRITE = 0, NOISE_SPRITE = 1, CHARACTER_SPRITE = 2;
+	const char* packerNames[2] = { "Skyline", "MaxRects" };
+	ew::AtlasSettings atlasSettings;
+	SpriteAtlas spriteAtlas;
+	buildSpriteAtlas(spriteFiles, 3, atlasSettings, &spriteAtlas);
+	bool useAtlas = true;
+
+	// Sampler objects hold the wrap and filter modes, so changing them below never touches a texture.
+	// Each sprite's state comes from the same codes its texture was loaded with.
+	ew::SamplerCache samplerCache;
+	const ew::SamplerState spriteSamplerStates[3] = { getSamplerState(2, 2), getSamplerState(1, 1), getSamplerState(1, 0) };
+	const ew::SamplerState atlasSamplerState = ew::MakeSamplerState(GL_CLAMP_TO_EDGE, GL_LINEAR);
+	const char* filterOverrideNames[3] = { "Per texture", "Nearest", "Trilinear" };
+	int filterOverride = 0;
+	int anisotropy = 1;
+	unsigned int spriteSamplers[3] = {};
+	unsigned int atlasSampler = 0;
+	auto updateSamplers = [&]() {
+		auto applyOverride = [&](ew::SamplerState state) {
+			if (filterOverride == 1)
+			{
+				state.minFilter = GL_NEAREST_MIPMAP_NEAREST;
+				state.magFilter = GL_NEAREST;
+			}
+			else if (filterOverride == 2)
+			{
+				state.minFilter = GL_LINEAR_MIPMAP_LINEAR;
+				state.magFilter = GL_LINEAR;
+			}
+			state.maxAnisotropy = (float)anisotropy;
+			return state;
+		};
+		for (int i = 0; i < 3; i++)
+			spriteSamplers[i] = samplerCache.get(applyOverride(spriteSamplerStates[i]));
+		atlasSampler = samplerCache.get(applyOverride(atlasSamplerState));
+	};
+	updateSamplers();
+
+	// Every texture gets a fixed slot in a texture table, with slot i on unit i. The whole table is bound in one call per frame,
+	// and sampler uniforms only change when the shaders switch between the atlas and the separate textures.
+	ew::TextureTable textureTable;
+	textureTable.create(ew::TextureTableBackend::MULTI_BIND, 8);
+	const unsigned int spriteTextures[3] = { brickTexture, noiseTexture, characterTexture };
+	int spriteSlots[3];
+	for (int i = 0; i < 3; i++)
+		spriteSlots[i] = textureTable.add(spriteTextures[i], spriteSamplers[i]);
+	std::vector<int> atlasSlots;
+	auto assignAtlasSlots = [&]() {
+		for (int slot : atlasSlots)
+			textureTable.remove(slot);
+		atlasSlots.clear();
+		for (unsigned int texture : spriteAtlas.textures)
+			atlasSlots.push_back(textureTable.add(texture, atlasSampler));
+	};
+	assignAtlasSlots();
+	auto refreshSamplers = [&]() {
+		updateSamplers();
+		for (int i = 0; i < 3; i++)
+			textureTable.set(spriteSlots[i], spriteTextures[i], spriteSamplers[i]);
+		for (size_t i = 0; i < atlasSlots.size(); i++)
+			textureTable.set(atlasSlots[i], spriteAtlas.textures[i], atlasSampler);
+	};
+	int textureCallsPerFrame = 0;
 
 	// Parameters for textures used in .frag and vert
 	int imageSizeWidth = 128;
@@ -87,15 +167,26 @@ int main() {
 	
 
 
-	// Put background textures into shader
-	backgroundShader.use();
-	backgroundShader.setInt("_BrickTexture", 0);
-	backgroundShader.setInt("_NoiseTexture", 1);
-
-	// Same with character shader
-	characterShader.use();
-	characterShader.setInt("characterTexture", 2);
-
+	// Point each shader's samplers at the table slots, and their regions at the sprites
+	auto assignTextureUnits = [&]() {
+		const ew::Vec4 wholeTexture(0, 0, 1, 1);
+		bool atlas = useAtlas && spriteAtlas.complete && (int)atlasSlots.size() == spriteAtlas.atlas.stats.numPages;
+		for (int slot : atlasSlots)
+			atlas = atlas && slot >= 0;
+		const ew::AtlasEntry* entries = spriteAtlas.atlas.entries.data();
+		auto unitOf = [&](int sprite) {
+			return textureTable.getUnit(atlas ? atlasSlots[entries[sprite].page] : spriteSlots[sprite]);
+		};
+		backgroundShader.use();
+		backgroundShader.setInt("background", unitOf(BRICK_SPRITE));
+		backgroundShader.setInt("noiseTexture", unitOf(NOISE_SPRITE));
+		backgroundShader.setVec4("backgroundRegion", atlas ? entries[BRICK_SPRITE].uvRect : wholeTexture);
+		backgroundShader.setVec4("noiseRegion", atlas ? entries[NOISE_SPRITE].uvRect : wholeTexture);
+		characterShader.use();
+		characterShader.setInt("characterTexture", unitOf(CHARACTER_SPRITE));
+		characterShader.setVec4("characterRegion", atlas ? entries[CHARACTER_SPRITE].uvRect : wholeTexture);
+	};
+	assignTextureUnits();
 
 	unsigned int quadVAO = createVAO(vertices, 4, indices, 6);
 	glBindVertexArray(quadVAO);
@@ -108,17 +199,13 @@ int main() {
 
 		float setTime = (float)glfwGetTime();
 
+		// Forced, since ImGui binds its font texture in between frames
+		int textureCallsBefore = textureTable.getStats().glCalls;
+		textureTable.commit(true);
+		textureCallsPerFrame = textureTable.getStats().glCalls - textureCallsBefore;
+
 		// Draw the background 
 		backgroundShader.use();
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, brickTexture);
-		backgroundShader.setInt("_BrickTexture", 0);
-
-
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, noiseTexture);
-		backgroundShader.setInt("noiseTexture", 1);
-
 		backgroundShader.setFloat("noiseRate", noiseRate);
 		backgroundShader.setFloat("time", glfwGetTime());
 		backgroundShader.setFloat("scrollSpeed", scrollSpeed);
@@ -127,9 +214,6 @@ int main() {
 
 		// Draw the Character
 		characterShader.use();
-		glActiveTexture(GL_TEXTURE5);
-		glBindTexture(GL_TEXTURE_2D, characterTexture);
-		characterShader.setInt("characterTexture", 5);
 		characterShader.setFloat("time", glfwGetTime());
 		characterShader.setVec2("imgSize", imageSizeWidth, imageSizeHeight);
 		characterShader.setVec2("aspectRatio", SCREEN_WIDTH, SCREEN_HEIGHT);
@@ -146,6 +230,36 @@ int main() {
 			ImGui::NewFrame();
 
 			ImGui::Begin("Settings");
+			ImGui::Text("Textures loaded in %.2f ms (%s cache)", startupTextureMs, startupFromCache ? "warm" : "cold");
+			if (ImGui::CollapsingHeader("Sampling"))
+			{
+				bool changed = ImGui::Combo("Filter", &filterOverride, filterOverrideNames, IM_ARRAYSIZE(filterOverrideNames));
+				changed |= ImGui::SliderInt("Anisotropy", &anisotropy, 1, 16);
+				if (changed)
+					refreshSamplers();
+				ImGui::Text("Samplers: %d (%d lookups)", samplerCache.getNumSamplers(), samplerCache.getLookups());
+			}
+			if (ImGui::CollapsingHeader("Atlas"))
+			{
+				if (ImGui::Checkbox("Use atlas", &useAtlas))
+					assignTextureUnits();
+				int packer = (int)atlasSettings.packer;
+				if (ImGui::Combo("Packer", &packer, packerNames, IM_ARRAYSIZE(packerNames)))
+					atlasSettings.packer = (ew::AtlasPacker)packer;
+				ImGui::SliderInt("Padding", &atlasSettings.padding, 0, 16);
+				if (ImGui::Button("Rebuild atlas"))
+				{
+					buildSpriteAtlas(spriteFiles, 3, atlasSettings, &spriteAtlas);
+					assignAtlasSlots();
+					assignTextureUnits();
+				}
+				const ew::AtlasStats& atlasStats = spriteAtlas.atlas.stats;
+				ImGui::Text("Texture table calls per frame: %d", textureCallsPerFrame);
+				if (atlasStats.numPages > 0)
+					ImGui::Text("Pages: %d (%dx%d)", atlasStats.numPages, spriteAtlas.atlas.pages[0].width, spriteAtlas.atlas.pages[0].height);
+				ImGui::Text("Efficiency: %.1f%%", atlasStats.efficiency * 100.0f);
+				ImGui::Text("Pack: %.3f ms, Copy: %.2f ms", atlasStats.packMs, atlasStats.copyMs);
+			}
 			ImGui::End();
 
 			ImGui::Render();
@@ -190,3 +304,30 @@ void framebufferSizeCallback(GLFWwindow* window, int width, int height)
 	glViewport(0, 0, width, height);
 }
 
+// Decodes the sprites and packs them, replacing any textures from a previous build
+void buildSpriteAtlas(const char* files[], int numFiles, const ew::AtlasSettings& settings, SpriteAtlas* spriteAtlas)
+{
+	std::vector<ew::Image> images(numFiles);
+	for (int i = 0; i < numFiles; i++)
+	{
+		images[i] = ew::loadImage(files[i], true);
+	}
+	std::vector<const ew::Image*> sprites;
+	for (const ew::Image& image : images)
+	{
+		sprites.push_back(&image);
+	}
+	glDeleteTextures((int)spriteAtlas->textures.size(), spriteAtlas->textures.data());
+	spriteAtlas->textures.clear();
+	spriteAtlas->atlas = ew::BuildAtlas(sprites, settings);
+	for (const ew::Image& page : spriteAtlas->atlas.pages)
+	{
+		spriteAtlas->textures.push_back(ew::uploadTexture(page, GL_CLAMP_TO_EDGE, GL_LINEAR));
+	}
+	spriteAtlas->complete = true;
+	for (const ew::AtlasEntry& entry : spriteAtlas->atlas.entries)
+	{
+		if (entry.page < 0)
+			spriteAtlas->complete = false;
+	}
+}
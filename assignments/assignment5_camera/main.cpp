@@ -12,6 +12,7 @@
 #include <ew/shader.h>
 #include <ew/procGen.h>
 #include <ew/transform.h>
+#include <ew/frustum.h>
 #include <dj/camera.h>
 
 void framebufferSizeCallback(GLFWwindow* window, int width, int height);
@@ -62,7 +63,11 @@ int main() {
 	ew::Shader shader("assets/vertexShader.vert", "assets/fragmentShader.frag");
 	
 	//Cube mesh
-	ew::Mesh cubeMesh(ew::createCube(0.5f));
+	ew::MeshData cubeMeshData = ew::createCube(0.5f);
+	ew::Mesh cubeMesh(cubeMeshData);
+	ew::AABB cubeBounds = ew::ComputeAABB(cubeMeshData);
+	bool frustumCulling = true;
+	int cubesDrawn = 0;
 
 	//Cube positions
 	for (size_t i = 0; i < NUM_CUBES; i++)
@@ -95,12 +100,20 @@ int main() {
 		shader.setMat4("_View", camera.ViewMatrix());
 		shader.setMat4("_Projection", camera.ProjectionMatrix());
 
+		//Skip cubes outside of the camera's view
+		ew::Frustum frustum = ew::CreateFrustum(camera.ProjectionMatrix() * camera.ViewMatrix());
+		cubesDrawn = 0;
+
 		//TODO: Set model matrix uniform
 		for (size_t i = 0; i < NUM_CUBES; i++)
 		{
 			//Construct model matrix
-			shader.setMat4("_Model", cubeTransforms[i].getModelMatrix());
+			ew::Mat4 model = cubeTransforms[i].getModelMatrix();
+			if (frustumCulling && !ew::IsVisible(frustum, ew::TransformAABB(cubeBounds, model)))
+				continue;
+			shader.setMat4("_Model", model);
 			cubeMesh.draw();
+			cubesDrawn++;
 		}
 
 		float currentFrame = (float)glfwGetTime(); 
@@ -153,6 +166,8 @@ int main() {
 
 			ImGui::DragFloat("Near Plane:", &camera.nearPlane, 0.05f, 0.001);
 			ImGui::DragFloat("Far Plane:", &camera.farPlane, 0.05f, 0.001);
+			ImGui::Checkbox("Frustum Culling", &frustumCulling);
+			ImGui::Text("Cubes drawn: %d / %d", cubesDrawn, NUM_CUBES);
 
 			
 			
@@ -15,6 +15,8 @@
 #include <ew/transform.h>
 #include <ew/camera.h>
 #include <ew/cameraController.h>
+#include <ew/mipmap.h>
+#include <ew/textureManager.h>
 #include <dj/procGen.h>
 
 void framebufferSizeCallback(GLFWwindow* window, int width, int height);
@@ -78,7 +80,15 @@ int main() {
 	glPolygonMode(GL_FRONT_AND_BACK, appSettings.wireframe ? GL_LINE : GL_FILL);
 
 	ew::Shader shader("assets/vertexShader.vert", "assets/fragmentShader.frag");
-	unsigned int brickTexture = ew::loadTexture("assets/brick_color.jpg", GL_REPEAT, GL_LINEAR);
+	ew::TextureManager textureManager;
+	ew::TextureHandle brickTexture = textureManager.load("assets/brick_color.jpg", GL_REPEAT, GL_LINEAR);
+
+	//Mipmaps built on the CPU and cached in texturecache/, instead of glGenerateMipmap
+	const char* mipSourceNames[3] = { "glGenerateMipmap", "CPU Box", "CPU Kaiser" };
+	int mipSource = 0;
+	bool mipGammaCorrect = true;
+	ew::MipStats mipStats;
+	ew::JobSystem jobSystem;
 
 	float cubeSize = 0.5f;
 	float pWidth = 1, pHeight = 1, pSegments = 5;
@@ -101,6 +111,15 @@ int main() {
 
 	resetCamera(camera, cameraController);
 
+	//Shapes are edited live, so their buffers are updated in place rather than recreated
+	ew::Mesh cubeMesh(ew::MeshData(), ew::MeshUsage::DYNAMIC);
+	ew::Mesh planeMesh(ew::MeshData(), ew::MeshUsage::DYNAMIC);
+	ew::Mesh cylinderMesh(ew::MeshData(), ew::MeshUsage::DYNAMIC);
+	ew::Mesh sphereMesh(ew::MeshData(), ew::MeshUsage::DYNAMIC);
+	ew::Mesh torusMesh(ew::MeshData(), ew::MeshUsage::DYNAMIC);
+	bool shapesChanged = true;
+	ew::MeshUploadStats meshUploads;
+
 	while (!glfwWindowShouldClose(window)) 
 	{
 		glfwPollEvents();
@@ -119,7 +138,7 @@ int main() {
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 		shader.use();
-		glBindTexture(GL_TEXTURE_2D, brickTexture);
+		glBindTexture(GL_TEXTURE_2D, brickTexture.get());
 		shader.setInt("_Texture", 0);
 		shader.setInt("_Mode", appSettings.shadingModeIndex);
 		shader.setVec3("_Color", appSettings.shapeColor);
@@ -130,18 +149,18 @@ int main() {
 		ew::Vec3 lightF = ew::Vec3(sinf(lightRot.y) * cosf(lightRot.x), sinf(lightRot.x), -cosf(lightRot.y) * cosf(lightRot.x));
 		shader.setVec3("_LightDir", lightF);
 
-		//Create cubes
-		ew::MeshData cubeMeshData = ew::createCube(cubeSize);
-		ew::MeshData planeMeshData = dj::createPlane(pWidth, pHeight, pSegments);
-		ew::MeshData cylinderMeshData = dj::createCylinder(cHeight, cRad, cSegments);
-		ew::MeshData sphereMeshData = dj::createSphere(sRad, sSegments);
-		ew::MeshData torusMeshData = dj::createTorus(tRad, tThickness, tSegmentsOut, tSegmentsIn);
-
-		ew::Mesh cubeMesh(cubeMeshData);
-		ew::Mesh planeMesh(planeMeshData);
-		ew::Mesh cylinderMesh(cylinderMeshData);
-		ew::Mesh sphereMesh(sphereMeshData);
-		ew::Mesh torusMesh(torusMeshData);
+		//Rebuild shapes after they're edited
+		ew::resetMeshUploadStats();
+		if (shapesChanged)
+		{
+			cubeMesh.load(ew::createCube(cubeSize));
+			planeMesh.load(dj::createPlane(pWidth, pHeight, pSegments));
+			cylinderMesh.load(dj::createCylinder(cHeight, cRad, cSegments));
+			sphereMesh.load(dj::createSphere(sRad, sSegments));
+			torusMesh.load(dj::createTorus(tRad, tThickness, tSegmentsOut, tSegmentsIn));
+			shapesChanged = false;
+		}
+		meshUploads = ew::getMeshUploadStats();
 
 		//Draw cube
 		shader.setMat4("_Model", cubeTransform.getModelMatrix());
@@ -188,35 +207,35 @@ int main() {
 			{
 				if (ImGui::CollapsingHeader("Cube"))
 				{
-					ImGui::DragFloat("Size", &cubeSize, .1, .5, 100000);
+					shapesChanged |= ImGui::DragFloat("Size", &cubeSize, .1, .5, 100000);
 				}
 
 				if (ImGui::CollapsingHeader("Plane")) 
 				{
-					ImGui::DragFloat("Width", &pWidth, .1, 1, 100000);
-					ImGui::DragFloat("Height", &pHeight, .1, 1, 100000);
-					ImGui::DragFloat("Segments", &pSegments, 1, 1, 100000);
+					shapesChanged |= ImGui::DragFloat("Width", &pWidth, .1, 1, 100000);
+					shapesChanged |= ImGui::DragFloat("Height", &pHeight, .1, 1, 100000);
+					shapesChanged |= ImGui::DragFloat("Segments", &pSegments, 1, 1, 100000);
 				}
 
 				if (ImGui::CollapsingHeader("Cylinder"))
 				{
-					ImGui::DragFloat("Height", &cHeight, .1, .5, 100);
-					ImGui::DragFloat("Cylinder Radius", &cRad, .1, .5, 100);
-					ImGui::DragFloat("Segments", &cSegments, 1, 3, 100000);
+					shapesChanged |= ImGui::DragFloat("Height", &cHeight, .1, .5, 100);
+					shapesChanged |= ImGui::DragFloat("Cylinder Radius", &cRad, .1, .5, 100);
+					shapesChanged |= ImGui::DragFloat("Segments", &cSegments, 1, 3, 100000);
 				}
 
 				if (ImGui::CollapsingHeader("Sphere")) 
 				{
-					ImGui::DragFloat("Sphere Radius", &sRad, .1, .5, 100);
-					ImGui::DragFloat("Segments", &sSegments, 1, 3, 100000);
+					shapesChanged |= ImGui::DragFloat("Sphere Radius", &sRad, .1, .5, 100);
+					shapesChanged |= ImGui::DragFloat("Segments", &sSegments, 1, 3, 100000);
 				}
 
 				if (ImGui::CollapsingHeader("Torus")) 
 				{
-					ImGui::DragFloat("Torus Radius", &tRad, .1, .5, 100);
-					ImGui::DragFloat("Thickness", &tThickness, .1, .3, 100);
-					ImGui::DragFloat("Outer Segments", &tSegmentsOut, 1, 3, 1000);
-					ImGui::DragFloat("Inner Segments", &tSegmentsIn, 1, 3, 1000);
+					shapesChanged |= ImGui::DragFloat("Torus Radius", &tRad, .1, .5, 100);
+					shapesChanged |= ImGui::DragFloat("Thickness", &tThickness, .1, .3, 100);
+					shapesChanged |= ImGui::DragFloat("Outer Segments", &tSegmentsOut, 1, 3, 1000);
+					shapesChanged |= ImGui::DragFloat("Inner Segments", &tSegmentsIn, 1, 3, 1000);
 				}
 
 				if (ImGui::Button("Reset"))
@@ -226,6 +245,53 @@ int main() {
 					cHeight = 1, cRad = .5, cSegments = 8;
 					sRad = 1, sSegments = 16;
 					tRad = .5, tThickness = .3, tSegmentsOut = 10, tSegmentsIn = 8;
+					shapesChanged = true;
+				}
+				ImGui::Text("Uploaded: %.1f KB in %d uploads, %d reallocations, %d orphaned", meshUploads.bytes / 1024.0f,
+					meshUploads.uploads, meshUploads.reallocations, meshUploads.orphans);
+			}
+
+			if (ImGui::CollapsingHeader("Mipmaps"))
+			{
+				ImGui::Combo("Mip source", &mipSource, mipSourceNames, IM_ARRAYSIZE(mipSourceNames));
+				ImGui::Checkbox("Gamma correct", &mipGammaCorrect);
+				if (ImGui::Button("Rebuild texture"))
+				{
+					mipStats = ew::MipStats();
+					if (mipSource == 0)
+					{
+						brickTexture = textureManager.load("assets/brick_color.jpg", GL_REPEAT, GL_LINEAR);
+					}
+					else
+					{
+						//Only build a variant that isn't loaded already. Replacing the handle frees the previous texture.
+						ew::TextureKey key;
+						key.filePath = "assets/brick_color.jpg";
+						key.wrapMode = GL_REPEAT;
+						key.filterMode = GL_LINEAR;
+						key.variant = std::string(mipSource == 1 ? "box" : "kaiser") + (mipGammaCorrect ? ".srgb" : "");
+						ew::TextureHandle texture = textureManager.find(key);
+						if (!texture.isValid())
+						{
+							ew::MipFilter filter = mipSource == 1 ? ew::MipFilter::BOX : ew::MipFilter::KAISER;
+							ew::MipChain chain = ew::loadMipChainCached("assets/brick_color.jpg", filter, mipGammaCorrect, false, &jobSystem, &mipStats);
+							texture = textureManager.insert(key, ew::uploadMipChain(chain, GL_REPEAT, GL_LINEAR));
+						}
+						brickTexture = texture;
+					}
+				}
+				ImGui::Text("Loaded from cache: %s", mipStats.fromCache ? "Yes" : "No");
+				ImGui::Text("Load: %.2f ms, Build: %.2f ms", mipStats.loadMs, mipStats.buildMs);
+				ImGui::Text("Throughput: %.1f MP/s (%d threads)", mipStats.megapixelsPerSecond, jobSystem.getNumThreads());
+			}
+
+			if (ImGui::CollapsingHeader("Textures"))
+			{
+				ImGui::Text("%d textures, %.2f MB", textureManager.getNumTextures(), textureManager.getTotalBytes() / 1048576.0f);
+				for (const ew::TextureInfo& info : textureManager.getTextures())
+				{
+					ImGui::BulletText("%s %s: %.2f MB, %d refs", info.key.filePath.c_str(), info.key.variant.c_str(),
+						info.bytes / 1048576.0f, info.refCount);
 				}
 			}
 
@@ -9,21 +9,17 @@ in Surface{
 
 uniform sampler2D _Texture;
 
-struct Light
-{
-	vec3 position;
-	vec3 color;
+#include "lighting.glsl"
+//Written once per frame into a ring buffer, rather than uniform by uniform. std140, so it has to match FrameUniforms in main.cpp.
+layout(std140, binding = 0) uniform FrameData{
+	Light _Lights[MAX_LIGHTS];
+	vec3 cameraPos;
+	int numLights;
+	float vAmbient;
+	float vDiffuse;
+	float vSpecular;
+	float vShine;
 };
-#define MAX_LIGHTS 4
-uniform Light _Lights[MAX_LIGHTS];
-
-uniform vec3 cameraPos;
-uniform int numLights;
-uniform float vAmbient;
-uniform float vDiffuse;
-uniform float vSpecular;
-uniform float vShine;
-uniform int phong;
 
 void main(){
 	vec3 normal = normalize(fs_in.WNormal);
@@ -38,19 +34,7 @@ void main(){
 		float diffAngle = max(dot(normal, lightDir),0);
 		vec3 diffuse = _Lights[i].color * vDiffuse* diffAngle;
 
-		vec3 specular = {0,0,0};
-
-		if(phong == 0){
-			//Blinn-Phong specular calculations
-			vec3 halfVec = normalize(lightDir + cameraDir);
-			float specAngle = max(dot(halfVec, normal), 0);
-			specular = _Lights[i].color * vSpecular * pow(specAngle, vShine);
-		}
-		else{
-			//Phong specular calculations
-			vec3 r = reflect(-lightDir, normal);
-			specular = _Lights[i].color * vSpecular * pow(max(dot(r, cameraDir), 0), vShine);
-		}
+		vec3 specular = specularLight(_Lights[i], lightDir, cameraDir, normal, vSpecular, vShine);
 
 		lightColor += (diffuse + specular) * 0.5;
 	}
@@ -0,0 +1,24 @@
+//Shared lighting declarations, pulled in with #include "lighting.glsl"
+struct Light
+{
+	vec3 position;
+	vec3 color;
+};
+//Can be overridden by defining it when the shader is built
+#ifndef MAX_LIGHTS
+#define MAX_LIGHTS 4
+#endif
+
+//Specular term for one light. Built as Phong with PHONG_SPECULAR defined, Blinn-Phong otherwise.
+vec3 specularLight(Light light, vec3 lightDir, vec3 cameraDir, vec3 normal, float strength, float shininess){
+#ifdef PHONG_SPECULAR
+	//Phong specular calculations
+	vec3 r = reflect(-lightDir, normal);
+	return light.color * strength * pow(max(dot(r, cameraDir), 0), shininess);
+#else
+	//Blinn-Phong specular calculations
+	vec3 halfVec = normalize(lightDir + cameraDir);
+	float specAngle = max(dot(halfVec, normal), 0);
+	return light.color * strength * pow(specAngle, shininess);
+#endif
+}
@@ -14,10 +14,29 @@
 #include <ew/transform.h>
 #include <ew/camera.h>
 #include <ew/cameraController.h>
+#include <ew/frustum.h>
+#include <ew/bvh.h>
+#include <ew/raycast.h>
+#include <ew/rasterizer.h>
+#include <ew/occlusion.h>
+#include <ew/textureCompression.h>
+#include <ew/textureManager.h>
+#include <ew/sampler.h>
+#include <ew/programCache.h>
+#include <ew/shaderCompiler.h>
+#include <ew/shaderPreprocessor.h>
+#include <ew/fileWatcher.h>
+#include <ew/renderQueue.h>
+#include <ew/ringBuffer.h>
+#include <ew/geometryHeap.h>
+#include <chrono>
 
 void framebufferSizeCallback(GLFWwindow* window, int width, int height);
 void resetCamera(ew::Camera& camera, ew::CameraController& cameraController);
 
+void renderSoftwareFrame(ew::Rasterizer& rasterizer, ew::Framebuffer& framebuffer, const ew::Camera& camera,
+	const ew::MeshData* meshes[], ew::Transform* transforms[], int numShapes, const ew::LitSettings& lit);
+
 int SCREEN_WIDTH = 1080;
 int SCREEN_HEIGHT = 720;
 
@@ -39,6 +58,23 @@ struct Material {
 	float shine; //Shininess
 };
 
+//Passed to defaultLit.frag as MAX_LIGHTS, so the FrameData block always matches FrameUniforms
+const int MAX_LIGHTS = 4;
+
+//The FrameData block in defaultLit.frag, laid out by std140 rules
+struct FrameUniforms {
+	struct {
+		ew::Vec3 position;
+		float pad0;
+		ew::Vec3 color;
+		float pad1;
+	} lights[MAX_LIGHTS];
+	ew::Vec3 cameraPos;
+	int numLights;
+	Material material;
+};
+static_assert(sizeof(FrameUniforms) == 32 * MAX_LIGHTS + 32, "FrameUniforms must match the std140 FrameData block");
+
 int main() {
 	printf("Initializing...");
 	if (!glfwInit()) {
@@ -70,44 +106,115 @@ int main() {
 	glCullFace(GL_BACK);
 	glEnable(GL_DEPTH_TEST);
 
-	ew::Shader shader("assets/defaultLit.vert", "assets/defaultLit.frag");
-	unsigned int brickTexture = ew::loadTexture("assets/brick_color.jpg", GL_REPEAT, GL_LINEAR);
-
-	ew::Shader unlit("assets/unlit.vert", "assets/unlit.frag");
-
-	//Create cube
-	ew::Mesh cubeMesh(ew::createCube(1.0f));
-	ew::Mesh planeMesh(ew::createPlane(5.0f, 5.0f, 10));
-	ew::Mesh sphereMesh(ew::createSphere(0.5f, 64));
-	ew::Mesh cylinderMesh(ew::createCylinder(0.5f, 1.0f, 32));
-	ew::Mesh lightMesh[4];
-	for (int i = 0; i < 4; i++)
+	//Linked programs are cached as driver binaries, so later launches skip compiling.
+	//Misses are compiled in the background while the rest of the scene loads.
+	ew::ProgramCache programCache;
+	ew::ShaderCompiler shaderCompiler(glfwGetProcAddress, &programCache);
+	//Phong and Blinn-Phong specular are compiled as separate variants rather than branched on per fragment
+	ew::ShaderVariantCache litShaders("assets/defaultLit.vert", "assets/defaultLit.frag", &shaderCompiler);
+	std::vector<ew::ShaderDefines> litVariants = ew::MakeShaderPermutations({ "PHONG_SPECULAR" }, { { "MAX_LIGHTS", std::to_string(MAX_LIGHTS) } });
+	for (const ew::ShaderDefines& defines : litVariants)
 	{
-		lightMesh[i] = (ew::createSphere(0.4f, 20));
+		litShaders.prepare(defines);
 	}
+	ew::ShaderVariantCache unlitShaders("assets/unlit.vert", "assets/unlit.frag", &shaderCompiler);
+	unlitShaders.prepare({});
+	ew::TextureManager textureManager;
+	ew::TextureHandle brickTexture = textureManager.load("assets/brick_color.jpg", GL_REPEAT, GL_LINEAR);
+	//Filtering lives in a sampler object, so it can change without touching the texture
+	ew::SamplerCache samplerCache;
+	ew::SamplerState brickSamplerState = ew::MakeSamplerState(GL_REPEAT, GL_LINEAR);
+	int brickAnisotropy = 1;
+	bool brickNearest = false;
+
+	//Create cube
+	ew::MeshData cubeMeshData = ew::createCube(1.0f);
+	ew::MeshData planeMeshData = ew::createPlane(5.0f, 5.0f, 10);
+	ew::MeshData sphereMeshData = ew::createSphere(0.5f, 64);
+	ew::MeshData cylinderMeshData = ew::createCylinder(0.5f, 1.0f, 32);
+	//Every mesh shares one vertex buffer, index buffer and vertex array, so the scene draws with a single mesh bind.
+	//The light spheres are identical, so they share one mesh.
+	ew::GeometryHeap sceneGeometry;
+	ew::GeometryHandle cubeGeometry = sceneGeometry.add(cubeMeshData);
+	ew::GeometryHandle planeGeometry = sceneGeometry.add(planeMeshData);
+	ew::GeometryHandle sphereGeometry = sceneGeometry.add(sphereMeshData);
+	ew::GeometryHandle cylinderGeometry = sceneGeometry.add(cylinderMeshData);
+	ew::GeometryHandle lightGeometry = sceneGeometry.add(ew::createSphere(0.4f, 20));
+	const float lightRadius = 0.4f;
 
 	//Initialize transforms
 	ew::Transform cubeTransform;
 	ew::Transform planeTransform;
 	ew::Transform sphereTransform;
 	ew::Transform cylinderTransform;
-	ew::Transform lightTransform[4];
+	ew::Transform lightTransform[MAX_LIGHTS];
 	planeTransform.position = ew::Vec3(0, -1.0, 0);
 	sphereTransform.position = ew::Vec3(-1.5f, 0.0f, 0.0f);
 	cylinderTransform.position = ew::Vec3(1.5f, 0.0f, 0.0f);
 
-	Light light[4];
-	for (int i = 0; i < 4; i++)
+	Light light[MAX_LIGHTS];
+	for (int i = 0; i < MAX_LIGHTS; i++)
 	{
-		lightTransform[i].position.x = cos(((ew::PI * 2) / 4) * i) * 2;
+		lightTransform[i].position.x = cos(((ew::PI * 2) / MAX_LIGHTS) * i) * 2;
 		lightTransform[i].position.y = 2;
-		lightTransform[i].position.z = sin(((ew::PI * 2) / 4) * i) * 2;
+		lightTransform[i].position.z = sin(((ew::PI * 2) / MAX_LIGHTS) * i) * 2;
 		light[i].position = lightTransform[i].position;
+		light[i].color = ew::Vec3(1.0);
+	}
+
+	//Shapes that get frustum culled, with their local space bounds
+	const int NUM_SHAPES = 4;
+	ew::GeometryHandle shapeGeometry[NUM_SHAPES] = { cubeGeometry, planeGeometry, sphereGeometry, cylinderGeometry };
+	ew::Transform* shapeTransforms[NUM_SHAPES] = { &cubeTransform, &planeTransform, &sphereTransform, &cylinderTransform };
+	ew::AABB shapeBounds[NUM_SHAPES] = {
+		ew::ComputeAABB(cubeMeshData),
+		ew::ComputeAABB(planeMeshData),
+		ew::ComputeAABB(sphereMeshData),
+		ew::ComputeAABB(cylinderMeshData)
+	};
+	const char* shapeNames[NUM_SHAPES] = { "Cube", "Plane", "Sphere", "Cylinder" };
+	ew::AABBBatch shapeWorldBounds;
+	std::vector<ew::AABB> shapeWorldBoxes(NUM_SHAPES);
+	for (int i = 0; i < NUM_SHAPES; i++)
+	{
+		shapeWorldBoxes[i] = ew::WorldBounds(shapeBounds[i], *shapeTransforms[i]);
 	}
-	light[0].color = ew::Vec3(1.0);
-	light[1].color = ew::Vec3(1.0);
-	light[2].color = ew::Vec3(1.0);
-	light[3].color = ew::Vec3(1.0);
+	ew::BVH sceneBVH;
+	sceneBVH.build(shapeWorldBoxes);
+
+	//Triangle level picking
+	ew::MeshBVH shapeMeshBVHs[NUM_SHAPES] = {
+		ew::MeshBVH(cubeMeshData),
+		ew::MeshBVH(planeMeshData),
+		ew::MeshBVH(sphereMeshData),
+		ew::MeshBVH(cylinderMeshData)
+	};
+	//Software rasterizer, for reference images
+	const ew::MeshData* shapeMeshData[NUM_SHAPES] = { &cubeMeshData, &planeMeshData, &sphereMeshData, &cylinderMeshData };
+	ew::Image brickImage = ew::loadImage("assets/brick_color.jpg");
+	ew::JobSystem jobSystem;
+	ew::Rasterizer rasterizer(&jobSystem);
+	ew::Framebuffer softwareFramebuffer;
+	bool softwareMultithreaded = true;
+
+	//Occlusion culling against a low resolution CPU depth buffer
+	ew::OcclusionBuffer occlusionBuffer(256, 128, &jobSystem);
+	bool occlusionCulling = true;
+	int occludedShapes = 0;
+
+	//Block compressed brick texture
+	const char* bcFormatNames[] = { "BC1", "BC3", "BC5", "BC7" };
+	const char* bcQualityNames[] = { "Fast", "Normal", "High" };
+	int bcFormat = (int)ew::BCFormat::BC1;
+	int bcQuality = (int)ew::BCQuality::NORMAL;
+	ew::CompressionStats compressionStats;
+	bool brickCompressed = false;
+
+	int selectedShape = -1;
+	bool wasMouseDown = false;
+	std::vector<unsigned int> visibleShapes;
+	bool frustumCulling = true;
+	int visibleLights = 0;
 
 	resetCamera(camera, cameraController);
 
@@ -120,22 +227,55 @@ int main() {
 	float orbitRad = 2;
 	bool orbit = false;
 	bool phong = false;
-	int phongSpecular = 0;
+
+	for (const ew::ShaderDefines& defines : litVariants)
+	{
+		litShaders.get(defines);
+	}
+	unlitShaders.get({});
+	const ew::ShaderCompilerStats& compilerStats = shaderCompiler.getStats();
+	printf("Shaders ready: %.2f ms submitting, %.2f ms waiting (%d from cache, %d compiled, %d rejected, %s compile)\n",
+		compilerStats.submitMs, compilerStats.waitMs, compilerStats.cached, compilerStats.submitted - compilerStats.cached,
+		programCache.getStats().rejected, compilerStats.parallel ? "parallel" : "driver default");
+
+	//Draws are sorted by program, texture and mesh each frame so binds aren't repeated
+	ew::RenderQueue renderQueue;
+	//Per frame uniforms are streamed through a persistently mapped buffer, three frames deep
+	ew::RingBuffer frameRing;
+	frameRing.create(16 * 1024);
+	int uniformAlignment = 256;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformAlignment);
+
+	//Editing a shader or anything it includes rebuilds it in the background and swaps it in between frames
+	ew::FileWatcher shaderWatcher;
+	auto watchShaderFiles = [&]() {
+		for (ew::ShaderVariantCache* shaders : { &litShaders, &unlitShaders })
+		{
+			for (const std::string& file : shaders->getFiles())
+			{
+				shaderWatcher.watch(file);
+			}
+		}
+	};
+	watchShaderFiles();
 
 	while (!glfwWindowShouldClose(window)) {
 		glfwPollEvents();
 
+		std::vector<std::string> changedShaderFiles = shaderWatcher.takeChanges();
+		int reloadedShaders = litShaders.update(changedShaderFiles) + unlitShaders.update(changedShaderFiles);
+		if (reloadedShaders > 0)
+		{
+			//Edits may have added includes
+			watchShaderFiles();
+			renderQueue.invalidatePrograms();
+			printf("Reloaded %d shader program(s)\n", reloadedShaders);
+		}
+
 		float time = (float)glfwGetTime();
 		float deltaTime = time - prevTime;
 		prevTime = time;
 
-		if (phong == true) {
-			phongSpecular = 1;
-		}
-		else {
-			phongSpecular = 0;
-		}
-
 		if (orbit == true)
 		{
 			for (int i = 0; i < 4; i++)
@@ -148,53 +288,117 @@ int main() {
 		camera.aspectRatio = (float)SCREEN_WIDTH / SCREEN_HEIGHT;
 		cameraController.Move(window, &camera, deltaTime);
 
+		//Left click selects the shape under the cursor
+		bool mouseDown = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_1);
+		if (mouseDown && !wasMouseDown && !ImGui::GetIO().WantCaptureMouse)
+		{
+			ew::Ray mouseRay = cameraController.GetMouseRay(window, &camera);
+			ew::RayHit hit;
+			auto meshTest = [&](unsigned int shape, const ew::Ray& ray, float maxDistance, float* distance) {
+				ew::MeshHit meshHit;
+				if (!ew::RaycastMesh(shapeMeshBVHs[shape], shapeTransforms[shape]->getModelMatrix(), ray, maxDistance, &meshHit))
+					return false;
+				*distance = meshHit.distance;
+				return true;
+			};
+			selectedShape = sceneBVH.raycast(mouseRay, camera.farPlane, &hit, meshTest) ? (int)hit.object : -1;
+		}
+		wasMouseDown = mouseDown;
+
 		//RENDER
 		glClearColor(bgColor.x, bgColor.y, bgColor.z, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-		shader.use();
-		glBindTexture(GL_TEXTURE_2D, brickTexture);
-		shader.setInt("_Texture", 0);
-		shader.setMat4("_ViewProjection", camera.ProjectionMatrix() * camera.ViewMatrix());
-		shader.setVec3("cameraPos", camera.position);
-		shader.setInt("numLights", numLights);
-		shader.setFloat("vAmbient", material.ambientK);
-		shader.setFloat("vDiffuse", material.diffuseK);
-		shader.setFloat("vSpecular", material.specular);
-		shader.setFloat("vShine", material.shine);
-		shader.setInt("phong", phongSpecular);
+		ew::Shader shader = litShaders.get(litVariants[phong ? 1 : 0]);
+		ew::Shader unlit = unlitShaders.get({});
+		ew::Mat4 viewProjection = camera.ProjectionMatrix() * camera.ViewMatrix();
+		renderQueue.clear();
 
-		for (int i = 0; i < numLights; i++)
+		frameRing.beginFrame();
+		size_t frameOffset = 0;
+		FrameUniforms* frameUniforms = (FrameUniforms*)frameRing.allocate(sizeof(FrameUniforms), uniformAlignment, &frameOffset);
+		if (frameUniforms)
 		{
-			shader.setVec3("_Lights[" + std::to_string(i) + "].position", light[i].position);
-			shader.setVec3("_Lights[" + std::to_string(i) + "].color", light[i].color);
+			for (int i = 0; i < numLights; i++)
+			{
+				frameUniforms->lights[i].position = light[i].position;
+				frameUniforms->lights[i].color = light[i].color;
+			}
+			frameUniforms->cameraPos = camera.position;
+			frameUniforms->numLights = numLights;
+			frameUniforms->material = material;
+			frameRing.bindRange(GL_UNIFORM_BUFFER, 0, frameOffset, sizeof(FrameUniforms));
 		}
 
-		//Draw shapes
-		shader.setMat4("_Model", cubeTransform.getModelMatrix());
-		cubeMesh.draw();
-
-		shader.setMat4("_Model", planeTransform.getModelMatrix());
-		planeMesh.draw();
+		//Frustum cull shapes
+		ew::Frustum frustum = ew::CreateFrustum(camera);
+		shapeWorldBounds.clear();
+		for (int i = 0; i < NUM_SHAPES; i++)
+		{
+			ew::AABB worldBox = ew::WorldBounds(shapeBounds[i], *shapeTransforms[i]);
+			shapeWorldBounds.add(worldBox);
+			sceneBVH.setBounds(i, worldBox);
+		}
+		sceneBVH.refit();
+		visibleShapes.clear();
+		if (frustumCulling) {
+			ew::CullAABBs(frustum, shapeWorldBounds, &visibleShapes);
+		}
+		else {
+			for (int i = 0; i < NUM_SHAPES; i++)
+				visibleShapes.push_back(i);
+		}
 
-		shader.setMat4("_Model", sphereTransform.getModelMatrix());
-		sphereMesh.draw();
+		//Shapes that survived frustum culling occlude each other
+		occludedShapes = 0;
+		if (occlusionCulling) {
+			occlusionBuffer.begin(camera.ProjectionMatrix() * camera.ViewMatrix());
+			for (unsigned int i : visibleShapes)
+			{
+				occlusionBuffer.addOccluder(*shapeMeshData[i], shapeTransforms[i]->getModelMatrix());
+			}
+			occlusionBuffer.end();
+			size_t numUnoccluded = 0;
+			for (unsigned int i : visibleShapes)
+			{
+				if (occlusionBuffer.isVisible(ew::WorldBounds(shapeBounds[i], *shapeTransforms[i])))
+					visibleShapes[numUnoccluded++] = i;
+			}
+			occludedShapes = (int)(visibleShapes.size() - numUnoccluded);
+			visibleShapes.resize(numUnoccluded);
+		}
 
-		shader.setMat4("_Model", cylinderTransform.getModelMatrix());
-		cylinderMesh.draw();
+		//Queue shapes
+		unsigned int brickSampler = samplerCache.get(brickSamplerState);
+		for (unsigned int i : visibleShapes)
+		{
+			float depth = ew::Magnitude(shapeTransforms[i]->position - camera.position);
+			renderQueue.submit(shader, brickTexture.get(), brickSampler, sceneGeometry, shapeGeometry[i], shapeTransforms[i]->getModelMatrix(), depth);
+		}
 
-		//TODO: Render point lights
+		//Queue point lights
+		visibleLights = 0;
 		for (int i = 0; i < numLights; i++)
 		{
-			shader.setVec3("_Light.position", light[i].position);
-			shader.setVec3("_Light.color", light[i].color);
-			unlit.use();
-			unlit.setMat4("_Model", lightTransform[i].getModelMatrix());
-			unlit.setMat4("_ViewProjection", camera.ProjectionMatrix() * camera.ViewMatrix());
-			unlit.setVec3("_Color", light[i].color);
-			lightMesh[i].draw();
+			ew::BoundingSphere lightBounds;
+			lightBounds.center = lightTransform[i].position;
+			lightBounds.radius = lightRadius;
+			if (frustumCulling && !ew::IsVisible(frustum, lightBounds))
+				continue;
+			visibleLights++;
+			float depth = ew::Magnitude(lightTransform[i].position - camera.position);
+			renderQueue.submit(unlit, 0, 0, sceneGeometry, lightGeometry, lightTransform[i].getModelMatrix(), depth, light[i].color);
 		}
 
+		//Draw everything sorted by state, setting each program's per frame uniforms once
+		renderQueue.execute([&](const ew::Shader& program) {
+			program.setMat4("_ViewProjection", viewProjection);
+			if (program.getID() != shader.getID())
+				return;
+			program.setInt("_Texture", 0);
+		});
+		frameRing.endFrame();
+
 		//Render UI
 		{
 			ImGui_ImplGlfw_NewFrame();
@@ -229,10 +433,12 @@ int main() {
 				}
 				if (ImGui::CollapsingHeader("Shading")) {
 					ImGui::ColorEdit3("BG color", &bgColor.x);
-					ImGui::SliderInt("Num Lights", &numLights, 1, 4);
+					ImGui::SliderInt("Num Lights", &numLights, 1, MAX_LIGHTS);
 					ImGui::Checkbox("Orbit Lights", &orbit);
 					ImGui::SliderFloat("Orbit Radius", &orbitRad, 2, 10);
 					ImGui::Checkbox("Phong", &phong);
+					ImGui::Text("Shader reloads: %d, failed: %d (%s)", litShaders.getStats().reloads + unlitShaders.getStats().reloads,
+						litShaders.getStats().reloadFailures + unlitShaders.getStats().reloadFailures, shaderWatcher.isNotifying() ? "inotify" : "polling");
 				}
 			}
 
@@ -244,6 +450,137 @@ int main() {
 				}
 			}
 
+			if (ImGui::CollapsingHeader("Culling"))
+			{
+				ImGui::Checkbox("Frustum Culling", &frustumCulling);
+				ImGui::Text("Shapes drawn: %d / %d", (int)visibleShapes.size(), NUM_SHAPES);
+				ImGui::Text("Lights drawn: %d / %d", visibleLights, numLights);
+				const ew::RenderQueueStats& queueStats = renderQueue.getStats();
+				ImGui::Text("Render queue: %d state changes (%d unsorted), %.3f ms sort", queueStats.getStateChanges(),
+					queueStats.unsortedStateChanges, queueStats.sortMs);
+				ew::GeometryHeapStats geometryStats = sceneGeometry.getStats();
+				ImGui::Text("Geometry heap: %d meshes, %d / %d vertices, %.0f%% fragmented, %d vertex array binds", geometryStats.meshes,
+					(int)geometryStats.usedVertices, (int)sceneGeometry.getVertexCapacity(), geometryStats.vertexFragmentation * 100.0f,
+					queueStats.meshChanges);
+				const ew::RingBufferStats& ringStats = frameRing.getStats();
+				ImGui::Text("Frame uniforms: %d bytes, %d frames in flight, %d stalls (%.2f ms)", (int)ringStats.frameBytes,
+					frameRing.getFramesInFlight(), ringStats.stalls, ringStats.stallMs);
+			}
+
+			if (ImGui::CollapsingHeader("Occlusion"))
+			{
+				ImGui::Checkbox("Occlusion Culling", &occlusionCulling);
+				const ew::OcclusionStats& stats = occlusionBuffer.getStats();
+				ImGui::Text("Shapes occluded: %d", occludedShapes);
+				ImGui::Text("Occluder triangles: %d (%d rasterized)", stats.occluderTriangles, stats.trianglesRasterized);
+				ImGui::Text("Setup: %.3f ms, Raster: %.3f ms", stats.setupMs, stats.rasterMs);
+			}
+
+			if (ImGui::CollapsingHeader("BVH"))
+			{
+				unsigned int nearestShape;
+				float nearestDistance;
+				if (sceneBVH.nearest(camera.position, &nearestShape, &nearestDistance))
+				{
+					ImGui::Text("Nearest shape: %s (%.2f)", shapeNames[nearestShape], nearestDistance);
+				}
+			}
+
+			if (ImGui::CollapsingHeader("Picking"))
+			{
+				ImGui::Text("Selected: %s", selectedShape >= 0 ? shapeNames[selectedShape] : "None");
+			}
+
+			if (ImGui::CollapsingHeader("Software Rasterizer"))
+			{
+				ImGui::Checkbox("Multithreaded", &softwareMultithreaded);
+				if (ImGui::Button("Render Reference Image"))
+				{
+					ew::PointLight softwareLights[MAX_LIGHTS];
+					for (int i = 0; i < numLights; i++)
+					{
+						softwareLights[i].position = light[i].position;
+						softwareLights[i].color = light[i].color;
+					}
+					ew::LitSettings lit;
+					lit.cameraPosition = camera.position;
+					lit.lights = softwareLights;
+					lit.numLights = numLights;
+					lit.ambientK = material.ambientK;
+					lit.diffuseK = material.diffuseK;
+					lit.specularK = material.specular;
+					lit.shininess = material.shine;
+					lit.phong = phong;
+					lit.texture = &brickImage;
+					softwareFramebuffer.resize(SCREEN_WIDTH, SCREEN_HEIGHT);
+					rasterizer.setJobSystem(softwareMultithreaded ? &jobSystem : nullptr);
+					renderSoftwareFrame(rasterizer, softwareFramebuffer, camera, shapeMeshData, shapeTransforms, NUM_SHAPES, lit);
+					softwareFramebuffer.save("reference.ppm");
+				}
+				const ew::RasterStats& stats = rasterizer.getStats();
+				ImGui::Text("Threads: %d", softwareMultithreaded ? jobSystem.getNumThreads() : 1);
+				ImGui::Text("Triangles: %d rasterized, %d culled", stats.trianglesRasterized, stats.trianglesCulled);
+				ImGui::Text("Fragments: %d", stats.fragmentsShaded);
+				ImGui::Text("Setup: %.2f ms, Raster: %.2f ms", stats.setupMs, stats.rasterMs);
+			}
+
+			if (ImGui::CollapsingHeader("Texture Compression"))
+			{
+				ImGui::Combo("Format", &bcFormat, bcFormatNames, IM_ARRAYSIZE(bcFormatNames));
+				ImGui::Combo("Quality", &bcQuality, bcQualityNames, IM_ARRAYSIZE(bcQualityNames));
+				ImGui::Text("Driver support: %s", ew::isCompressedFormatSupported((ew::BCFormat)bcFormat) ? "yes" : "no");
+				if (ImGui::Button("Compress Brick Texture"))
+				{
+					ew::TextureKey key;
+					key.filePath = "assets/brick_color.jpg";
+					key.wrapMode = GL_REPEAT;
+					key.filterMode = GL_LINEAR;
+					key.variant = std::string(bcFormatNames[bcFormat]) + "." + bcQualityNames[bcQuality];
+					ew::TextureHandle texture = textureManager.find(key);
+					if (!texture.isValid())
+					{
+						ew::CompressedTexture compressed = ew::loadCompressedTextureCached("assets/brick_color.jpg",
+							(ew::BCFormat)bcFormat, (ew::BCQuality)bcQuality, false, &jobSystem, &compressionStats);
+						texture = textureManager.insert(key, ew::uploadCompressedTexture(compressed, GL_REPEAT, GL_LINEAR));
+					}
+					if (texture.isValid())
+					{
+						//The previous texture is freed if nothing else uses it
+						brickTexture = texture;
+						brickCompressed = true;
+					}
+				}
+				ImGui::SameLine();
+				if (ImGui::Button("Uncompressed"))
+				{
+					brickTexture = textureManager.load("assets/brick_color.jpg", GL_REPEAT, GL_LINEAR);
+					brickCompressed = false;
+				}
+				ImGui::Text("Brick texture: %s", brickCompressed ? "compressed" : "uncompressed");
+				ImGui::Text("%s: %.2f ms (encode %.2f ms)", compressionStats.fromCache ? "Cached" : "Encoded",
+					compressionStats.loadMs, compressionStats.encodeMs);
+				ImGui::Text("PSNR: %.2f dB", compressionStats.psnr);
+				ImGui::Text("Size: %.2f MB -> %.2f MB", compressionStats.uncompressedBytes / 1048576.0f, compressionStats.compressedBytes / 1048576.0f);
+			}
+
+			if (ImGui::CollapsingHeader("Textures"))
+			{
+				ImGui::Text("%d textures, %.2f MB", textureManager.getNumTextures(), textureManager.getTotalBytes() / 1048576.0f);
+				bool samplerChanged = ImGui::Checkbox("Nearest filtering", &brickNearest);
+				samplerChanged |= ImGui::SliderInt("Anisotropy", &brickAnisotropy, 1, 16);
+				if (samplerChanged)
+				{
+					brickSamplerState = ew::MakeSamplerState(GL_REPEAT, brickNearest ? GL_NEAREST : GL_LINEAR);
+					brickSamplerState.maxAnisotropy = (float)brickAnisotropy;
+				}
+				ImGui::Text("Samplers: %d", samplerCache.getNumSamplers());
+				for (const ew::TextureInfo& info : textureManager.getTextures())
+				{
+					ImGui::BulletText("%s %s: %.2f MB, %d refs", info.key.filePath.c_str(), info.key.variant.c_str(),
+						info.bytes / 1048576.0f, info.refCount);
+				}
+			}
+
 			if (ImGui::CollapsingHeader("Material"))
 			{
 				ImGui::SliderFloat("AmbientK", &material.ambientK, 0, 1);
@@ -270,6 +607,24 @@ void framebufferSizeCallback(GLFWwindow* window, int width, int height)
 	SCREEN_HEIGHT = height;
 }
 
+/// <summary>
+/// Draws the lit shapes with the CPU rasterizer, the same way the GL path draws them
+/// </summary>
+void renderSoftwareFrame(ew::Rasterizer& rasterizer, ew::Framebuffer& framebuffer, const ew::Camera& camera,
+	const ew::MeshData* meshes[], ew::Transform* transforms[], int numShapes, const ew::LitSettings& lit)
+{
+	auto shader = [&lit](const ew::Fragment& fragment) {
+		return ew::ShadeLit(fragment, lit);
+	};
+	framebuffer.clear(bgColor);
+	rasterizer.begin(&framebuffer, camera.ProjectionMatrix() * camera.ViewMatrix());
+	for (int i = 0; i < numShapes; i++)
+	{
+		rasterizer.draw(*meshes[i], transforms[i]->getModelMatrix(), shader);
+	}
+	rasterizer.end();
+}
+
 void resetCamera(ew::Camera& camera, ew::CameraController& cameraController)
 {
 	camera.position = ew::Vec3(0, 0, 5);
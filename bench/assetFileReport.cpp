@@ -0,0 +1,95 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <chrono>
+
+#include <ew/assetFile.h>
+#include <ew/shader.h>
+#include <ew/image.h>
+#include <ew/external/stb_image.h>
+
+//How the loaders read files before: through a stringstream, then copied out of it
+static std::string readThroughStream(const char* filePath)
+{
+	std::ifstream fstream(filePath);
+	std::stringstream buffer;
+	buffer << fstream.rdbuf();
+	return buffer.str();
+}
+
+/// <summary>
+/// Reads every shader in assets many times through a stringstream and through AssetFile, printing the time for each,
+/// then builds shaders on the stub GL backend. Checks mapped files hold the whole file, missing and empty files give
+/// an empty buffer rather than null, shaders without includes reach glShaderSource with their lengths instead of a
+/// copy, shaders with includes still get them expanded, and images decode the same from the mapped file.
+/// </summary>
+/// <param name="iterations">Times to read each shader</param>
+/// <returns>0, with failed checks counted by check()</returns>
+int reportAssetFile(int iterations)
+{
+	const char* shaderPaths[4] = { "assets/unlit.vert", "assets/unlit.frag", "assets/defaultLit.vert", "assets/defaultLit.frag" };
+	size_t totalBytes = 0;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < iterations; i++)
+	{
+		for (const char* shaderPath : shaderPaths)
+			totalBytes += readThroughStream(shaderPath).size();
+	}
+	float streamMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	size_t mappedBytes = 0;
+	start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < iterations; i++)
+	{
+		for (const char* shaderPath : shaderPaths)
+		{
+			ew::AssetFile file(shaderPath);
+			mappedBytes += file.getSize();
+		}
+	}
+	float mappedMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	printf("%d reads of 4 shaders: %.2f ms through a stringstream, %.2f ms mapped\n", iterations, streamMs, mappedMs);
+
+	bool whole = mappedBytes == totalBytes;
+	for (const char* shaderPath : shaderPaths)
+	{
+		ew::AssetFile file(shaderPath);
+		std::string expected = readThroughStream(shaderPath);
+		whole = whole && file.isOpen() && file.getSize() == expected.size() && memcmp(file.getText(), expected.data(), expected.size()) == 0
+			&& ew::loadShaderSourceFromFile(shaderPath) == expected;
+	}
+	check("Mapped files hold the whole file", whole);
+
+	const char* emptyPath = "bench_empty.glsl";
+	fclose(fopen(emptyPath, "wb"));
+	ew::AssetFile empty(emptyPath);
+	ew::AssetFile missing("assets/missing.glsl");
+	std::string source = "stale";
+	bool missingSource = !ew::loadShaderSourceFromFile("assets/missing.glsl", source) && source.empty();
+	check("Missing and empty files give an empty buffer", empty.isOpen() && empty.getSize() == 0 && empty.getText() != NULL
+		&& !missing.isOpen() && missing.getSize() == 0 && missing.getText() != NULL && missingSource);
+	remove(emptyPath);
+
+	ew::Shader unlit("assets/unlit.vert", "assets/unlit.frag");
+	check("Shaders without includes are passed with their lengths", unlit.getID() != 0 && glStats.compiles == 2 && glStats.sizedSources == 2
+		&& glStats.sourceBytes == ew::AssetFile(shaderPaths[0]).getSize() + ew::AssetFile(shaderPaths[1]).getSize());
+	ew::GLStubStats before = glStats;
+	ew::Shader lit("assets/defaultLit.vert", "assets/defaultLit.frag");
+	check("Shaders with includes get them expanded", lit.getID() != 0 && glStats.compiles == before.compiles + 2
+		&& glStats.sizedSources == before.sizedSources && glStats.sourceBytes - before.sourceBytes > ew::AssetFile(shaderPaths[2]).getSize()
+		+ ew::AssetFile(shaderPaths[3]).getSize());
+
+	const char* imagePath = "assets/brick_color.jpg";
+	ew::Image image = ew::loadImage(imagePath);
+	int width, height, numComponents;
+	stbi_set_flip_vertically_on_load_thread(false);
+	unsigned char* pixels = stbi_load(imagePath, &width, &height, &numComponents, 0);
+	check("Images decode the same from the mapped file", pixels != NULL && image.width == width && image.height == height
+		&& image.numComponents == numComponents && image.pixels.size() == (size_t)width * height * numComponents
+		&& memcmp(image.pixels.data(), pixels, image.pixels.size()) == 0);
+	stbi_image_free(pixels);
+	return 0;
+}
@@ -0,0 +1,151 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+#include <vector>
+
+#include <ew/image.h>
+#include <ew/atlas.h>
+
+//Lowest share of page pixels each packer should fill with random small sprites, packed without padding
+static const float MIN_EFFICIENCY[2] = { 0.75f, 0.8f };
+
+//Padded rects of every placed entry stay inside their page and don't overlap each other
+static bool placedWithoutOverlap(const ew::Atlas& atlas, int padding)
+{
+	for (size_t i = 0; i < atlas.entries.size(); i++)
+	{
+		const ew::AtlasEntry& a = atlas.entries[i];
+		if (a.page < 0)
+			continue;
+		const ew::Image& page = atlas.pages[a.page];
+		if (a.x - padding < 0 || a.y - padding < 0 || a.x + a.width + padding > page.width || a.y + a.height + padding > page.height)
+			return false;
+		for (size_t j = i + 1; j < atlas.entries.size(); j++)
+		{
+			const ew::AtlasEntry& b = atlas.entries[j];
+			if (b.page != a.page)
+				continue;
+			if (a.x - padding < b.x + b.width + padding && b.x - padding < a.x + a.width + padding
+				&& a.y - padding < b.y + b.height + padding && b.y - padding < a.y + a.height + padding)
+				return false;
+		}
+	}
+	return true;
+}
+
+//UV rects map 0-1 onto the entry's pixels in its page
+static bool uvRectsMatch(const ew::Atlas& atlas)
+{
+	for (const ew::AtlasEntry& entry : atlas.entries)
+	{
+		if (entry.page < 0)
+			continue;
+		const ew::Image& page = atlas.pages[entry.page];
+		if (fabsf(entry.uvRect.x * page.width - entry.x) > 0.01f || fabsf(entry.uvRect.y * page.height - entry.y) > 0.01f
+			|| fabsf(entry.uvRect.z * page.width - entry.width) > 0.01f || fabsf(entry.uvRect.w * page.height - entry.height) > 0.01f)
+			return false;
+	}
+	return true;
+}
+
+//Every page pixel in an entry and its padding is the nearest image pixel, expanded to RGBA
+static bool copiedWithBleed(const ew::Atlas& atlas, const std::vector<ew::Image>& images, int padding)
+{
+	for (size_t i = 0; i < images.size(); i++)
+	{
+		const ew::AtlasEntry& entry = atlas.entries[i];
+		const ew::Image& image = images[i];
+		if (entry.page < 0 || atlas.pages[entry.page].pixels.empty())
+			return false;
+		const ew::Image& page = atlas.pages[entry.page];
+		for (int y = -padding; y < entry.height + padding; y++)
+		{
+			for (int x = -padding; x < entry.width + padding; x++)
+			{
+				int sourceX = std::min(std::max(x, 0), image.width - 1);
+				int sourceY = std::min(std::max(y, 0), image.height - 1);
+				const unsigned char* src = &image.pixels[((size_t)sourceY * image.width + sourceX) * image.numComponents];
+				const unsigned char* dst = &page.pixels[((size_t)(entry.y + y) * page.width + entry.x + x) * 4];
+				bool grey = image.numComponents <= 2;
+				unsigned char expected[4] = { src[0], grey ? src[0] : src[1], grey ? src[0] : src[2], 255 };
+				if (image.numComponents == 2 || image.numComponents == 4)
+					expected[3] = src[image.numComponents - 1];
+				if (dst[0] != expected[0] || dst[1] != expected[1] || dst[2] != expected[2] || dst[3] != expected[3])
+					return false;
+			}
+		}
+	}
+	return true;
+}
+
+/// <summary>
+/// Packs random 8-64 pixel sprites with both packers and prints efficiency, pages and pack time. Checks every sprite is
+/// placed inside its page without its padding overlapping another's, UV rects match, efficiency is high enough, and
+/// sprites too big for a page are rejected. Then builds an atlas from assignment3's images and checks the copied pixels
+/// and edge bleeding.
+/// </summary>
+/// <param name="numSprites">Random sprites to pack</param>
+/// <returns>0, or 1 if an image couldn't be loaded</returns>
+int reportAtlas(int numSprites)
+{
+	std::vector<ew::AtlasSize> sizes(numSprites);
+	for (ew::AtlasSize& size : sizes)
+	{
+		size.width = 8 + rand() % 57;
+		size.height = 8 + rand() % 57;
+	}
+	ew::AtlasSettings settings;
+	settings.maxSize = 1024;
+	const char* packerNames[2] = { "Skyline", "MaxRects" };
+	bool placed = true;
+	bool efficient = true;
+	for (int i = 0; i < 2; i++)
+	{
+		settings.packer = (ew::AtlasPacker)i;
+		ew::Atlas atlas = ew::PackAtlas(sizes, settings);
+		//Without padding, efficiency only measures the packer's own waste
+		ew::AtlasSettings tightSettings = settings;
+		tightSettings.padding = 0;
+		tightSettings.alignment = 1;
+		ew::Atlas tight = ew::PackAtlas(sizes, tightSettings);
+		printf("%s: %d sprites, %.1f%% in %d pages, %.2f ms (%.1f%% in %d pages without padding)\n", packerNames[i], numSprites,
+			atlas.stats.efficiency * 100.0f, atlas.stats.numPages, atlas.stats.packMs, tight.stats.efficiency * 100.0f, tight.stats.numPages);
+		placed = placed && atlas.stats.numRejected == 0 && placedWithoutOverlap(atlas, settings.padding) && uvRectsMatch(atlas)
+			&& tight.stats.numRejected == 0 && placedWithoutOverlap(tight, 0) && uvRectsMatch(tight);
+		efficient = efficient && tight.stats.efficiency >= MIN_EFFICIENCY[i];
+	}
+	check("Sprites are placed inside their page without overlapping", placed);
+	check("Packing efficiency is high enough", efficient);
+
+	std::vector<ew::AtlasSize> tooBig = { { 16, 16 }, { settings.maxSize, 8 }, { 0, 16 } };
+	ew::Atlas rejected = ew::PackAtlas(tooBig, settings);
+	check("Sprites too big for a page are rejected", rejected.stats.numRejected == 2 && rejected.entries[0].page == 0
+		&& rejected.entries[1].page < 0 && rejected.entries[2].page < 0 && rejected.stats.numPages == 1);
+
+	const char* filePaths[3] = { "assets/brickwall.png", "assets/noise.png", "assets/The_Kid.png" };
+	std::vector<ew::Image> images;
+	std::vector<const ew::Image*> sprites;
+	for (const char* filePath : filePaths)
+	{
+		images.push_back(ew::loadImage(filePath, true));
+		if (!images.back().isValid())
+		{
+			printf("Failed to load %s\n", filePath);
+			return 1;
+		}
+	}
+	for (const ew::Image& image : images)
+	{
+		sprites.push_back(&image);
+	}
+	settings = ew::AtlasSettings();
+	ew::Atlas atlas = ew::BuildAtlas(sprites, settings);
+	printf("assignment3 atlas: %d page(s), %.1f%%, pack %.3f ms, copy %.2f ms\n", atlas.stats.numPages,
+		atlas.stats.efficiency * 100.0f, atlas.stats.packMs, atlas.stats.copyMs);
+	check("Images fit on one page", atlas.stats.numPages == 1 && placedWithoutOverlap(atlas, settings.padding));
+	check("Image pixels are copied and their edges bled into the padding", copiedWithBleed(atlas, images, settings.padding));
+	return 0;
+}
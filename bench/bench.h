@@ -0,0 +1,35 @@
+#pragma once
+#include <ew/glStub.h>
+
+//Counters of the stub GL backend, which main() installs and clears before each mode
+extern ew::GLStubStats glStats;
+
+//Prints whether a check passed. Any failed check makes the bench exit with 1.
+bool check(const char* name, bool passed);
+
+//Each mode prints its report and returns 0, or nonzero if it couldn't run
+int reportFrustumCulling(int numObjects);
+int reportBVH(int numObjects);
+int reportPicking(int gridSize);
+int reportRasterizer(const char* outputPath);
+int reportOcclusion(int numOccluders);
+int reportTextureLoad(const char* directory);
+int reportMipmap(const char* imagePath);
+int reportCompression(const char* imagePath);
+int reportContainer(const char* imagePath);
+int reportTextureManager(int numLoads);
+int reportAtlas(int numSprites);
+int reportVirtualTexture(const char* imagePath);
+int reportSampler(int numTextures);
+int reportTextureBinding(int frames);
+int reportHDR(const char* imagePath);
+int checkProgramCache();
+int reportShaderCompiler(int numPrograms);
+int reportShaderPreprocessor();
+int reportShaderReload();
+int reportAssetFile(int iterations);
+int reportRenderQueue(int numDraws);
+int reportCommandBuffers(int numObjects);
+int checkRingBuffer();
+int reportMeshUpdates(int frames);
+int reportGeometryHeap(int numMeshes);
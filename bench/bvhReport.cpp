@@ -0,0 +1,144 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+
+#include <ew/ewMath/ewMath.h>
+#include <ew/camera.h>
+#include <ew/bvh.h>
+
+static float millisecondsSince(std::chrono::high_resolution_clock::time_point start)
+{
+	return std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static ew::Vec3 randomPoint(float range)
+{
+	return ew::Vec3(ew::RandomRange(-range, range), ew::RandomRange(-range, range), ew::RandomRange(-range, range));
+}
+
+//Whether the query found the same objects as testing every box, in any order
+static bool matchesBruteForce(const ew::Frustum& frustum, const std::vector<ew::AABB>& boxes, std::vector<unsigned int> found)
+{
+	std::vector<unsigned int> expected;
+	for (unsigned int i = 0; i < boxes.size(); i++)
+	{
+		if (ew::IsVisible(frustum, boxes[i]))
+			expected.push_back(i);
+	}
+	std::sort(found.begin(), found.end());
+	return found == expected;
+}
+
+/// <summary>
+/// Builds a BVH over numObjects random boxes, moves them and refits, then times frustum, ray and nearest queries.
+/// Every query is checked against testing each box in turn.
+/// </summary>
+/// <returns>0, with failed checks counted by check()</returns>
+int reportBVH(int numObjects)
+{
+	const int NUM_QUERIES = 1000;
+	std::vector<ew::AABB> boxes(numObjects);
+	for (ew::AABB& box : boxes)
+	{
+		ew::Vec3 center = randomPoint(100);
+		ew::Vec3 extents = ew::Vec3(ew::RandomRange(0.1f, 1.0f), ew::RandomRange(0.1f, 1.0f), ew::RandomRange(0.1f, 1.0f));
+		box.min = center - extents;
+		box.max = center + extents;
+	}
+
+	ew::BVH bvh;
+	auto start = std::chrono::high_resolution_clock::now();
+	bvh.build(boxes);
+	float buildMs = millisecondsSince(start);
+
+	ew::Camera camera;
+	camera.farPlane = 200.0f;
+	ew::Frustum frustum = ew::CreateFrustum(camera);
+	std::vector<unsigned int> visible;
+	bvh.queryFrustum(frustum, &visible);
+	check("Frustum query after build matches every box", matchesBruteForce(frustum, boxes, visible));
+
+	//Move every object, as if their transforms changed
+	for (int i = 0; i < numObjects; i++)
+	{
+		boxes[i].min.y += 1.0f;
+		boxes[i].max.y += 1.0f;
+		bvh.setBounds(i, boxes[i]);
+	}
+	start = std::chrono::high_resolution_clock::now();
+	bvh.refit();
+	float refitMs = millisecondsSince(start);
+
+	visible.clear();
+	start = std::chrono::high_resolution_clock::now();
+	bvh.queryFrustum(frustum, &visible);
+	float frustumMs = millisecondsSince(start);
+	check("Frustum query after refit matches every box", matchesBruteForce(frustum, boxes, visible));
+
+	std::vector<ew::Ray> rays(NUM_QUERIES);
+	std::vector<ew::RayHit> hits(NUM_QUERIES);
+	std::vector<bool> didHit(NUM_QUERIES);
+	for (ew::Ray& ray : rays)
+	{
+		ray.origin = randomPoint(100);
+		ray.direction = ew::Normalize(randomPoint(1));
+	}
+	start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < NUM_QUERIES; i++)
+		didHit[i] = bvh.raycast(rays[i], camera.farPlane, &hits[i]);
+	float raycastMs = millisecondsSince(start);
+
+	//Hits can tie when boxes overlap, so compare distances rather than objects
+	int rayHits = 0;
+	bool raysMatch = true;
+	for (int i = 0; i < NUM_QUERIES; i++)
+	{
+		ew::Vec3 invDirection = ew::InverseDirection(rays[i].direction);
+		float closest = INFINITY;
+		for (const ew::AABB& box : boxes)
+		{
+			float t;
+			if (ew::IntersectRayAABB(rays[i].origin, invDirection, box, camera.farPlane, &t))
+				closest = fminf(closest, t);
+		}
+		rayHits += didHit[i];
+		if (didHit[i] != (closest != INFINITY) || (didHit[i] && fabsf(hits[i].distance - closest) > 1e-4f))
+			raysMatch = false;
+	}
+	check("Closest ray hits match every box", raysMatch);
+
+	std::vector<ew::Vec3> points(NUM_QUERIES);
+	std::vector<float> distances(NUM_QUERIES);
+	for (ew::Vec3& point : points)
+		point = randomPoint(120);
+	start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < NUM_QUERIES; i++)
+	{
+		unsigned int object;
+		bvh.nearest(points[i], &object, &distances[i]);
+	}
+	float nearestMs = millisecondsSince(start);
+
+	bool nearestMatches = true;
+	for (int i = 0; i < NUM_QUERIES; i++)
+	{
+		float closestSq = INFINITY;
+		for (const ew::AABB& box : boxes)
+			closestSq = fminf(closestSq, ew::DistanceSquared(box, points[i]));
+		if (fabsf(distances[i] - sqrtf(closestSq)) > 1e-4f)
+			nearestMatches = false;
+	}
+	check("Nearest objects match every box", nearestMatches);
+
+	printf("%d objects, %d nodes\n", numObjects, (int)bvh.getNumNodes());
+	printf("Build: %.2f ms\n", buildMs);
+	printf("Refit: %.2f ms\n", refitMs);
+	printf("Frustum query: %.3f ms (%d visible)\n", frustumMs, (int)visible.size());
+	printf("%d ray casts: %.3f ms (%d hits)\n", NUM_QUERIES, raycastMs, rayHits);
+	printf("%d nearest queries: %.3f ms\n", NUM_QUERIES, nearestMs);
+	return 0;
+}
@@ -0,0 +1,190 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+
+#include <ew/external/glad.h>
+#include <ew/ewMath/ewMath.h>
+#include <ew/glStub.h>
+#include <ew/shader.h>
+#include <ew/mesh.h>
+#include <ew/procGen.h>
+#include <ew/transform.h>
+#include <ew/camera.h>
+#include <ew/frustum.h>
+#include <ew/jobSystem.h>
+#include <ew/commandBuffer.h>
+
+/// <summary>
+/// Culls numObjects random objects against a camera and records the visible ones into command buffers,
+/// first on the calling thread alone and then across the job system, replaying each on the stub GL backend.
+/// Checks both replays and drawing inline issue the same uniforms and draws in the same order with fewer binds, the
+/// first sampler bind after an untextured draw isn't skipped, uniform locations are shared by name rather than by
+/// pointer, and allocators stop growing once recording is steady.
+/// </summary>
+/// <param name="numObjects">Random objects to cull and record</param>
+/// <returns>0, with failed checks counted by check()</returns>
+int reportCommandBuffers(int numObjects)
+{
+	const int NUM_MESHES = 4;
+	const int OBJECTS_PER_BUFFER = 1024;
+	ew::MeshData meshData[NUM_MESHES] = { ew::createCube(1.0f), ew::createSphere(0.5f, 16), ew::createCylinder(0.5f, 1.0f, 16), ew::createPlane(1.0f, 1.0f, 2) };
+	ew::Mesh meshes[NUM_MESHES];
+	for (int i = 0; i < NUM_MESHES; i++)
+		meshes[i].load(meshData[i]);
+	ew::Shader lit(glCreateProgram());
+	ew::Shader unlit(glCreateProgram());
+	unsigned int texture = 0, sampler = 0;
+	glGenTextures(1, &texture);
+	glGenSamplers(1, &sampler);
+
+	struct Object {
+		ew::Transform transform;
+		ew::Vec3 color;
+		int mesh;
+		bool isLit;
+	};
+	std::vector<Object> objects(numObjects);
+	for (Object& object : objects)
+	{
+		object.transform.position = ew::Vec3(ew::RandomRange(-100, 100), ew::RandomRange(-100, 100), ew::RandomRange(-100, 100));
+		object.transform.scale = ew::Vec3(ew::RandomRange(0.5f, 2.0f));
+		object.color = ew::Vec3(ew::RandomRange(0, 1), ew::RandomRange(0, 1), ew::RandomRange(0, 1));
+		object.mesh = rand() % NUM_MESHES;
+		object.isLit = rand() % 4 != 0;
+	}
+	ew::Camera camera;
+	camera.position = ew::Vec3(0, 0, 120);
+	camera.farPlane = 300.0f;
+	ew::Frustum frustum = ew::CreateFrustum(camera);
+
+	//Scene traversal for one chunk: cull, build the model matrix and record
+	int numBuffers = (numObjects + OBJECTS_PER_BUFFER - 1) / OBJECTS_PER_BUFFER;
+	auto recordChunk = [&](ew::CommandBuffer& buffer, int chunk) {
+		int end = std::min(numObjects, (chunk + 1) * OBJECTS_PER_BUFFER);
+		for (int i = chunk * OBJECTS_PER_BUFFER; i < end; i++)
+		{
+			const Object& object = objects[i];
+			ew::BoundingSphere bounds;
+			bounds.center = object.transform.position;
+			bounds.radius = object.transform.scale.x;
+			if (!ew::IsVisible(frustum, bounds))
+				continue;
+			buffer.draw(object.isLit ? lit : unlit, object.isLit ? texture : 0, sampler, meshes[object.mesh]);
+			buffer.setMat4("_Model", object.transform.getModelMatrix());
+			buffer.setVec3("_Color", object.color);
+		}
+	};
+
+	//Inline, the way the assignments draw
+	glStats = ew::GLStubStats();
+	auto start = std::chrono::high_resolution_clock::now();
+	int inlineDraws = 0;
+	for (const Object& object : objects)
+	{
+		ew::BoundingSphere bounds;
+		bounds.center = object.transform.position;
+		bounds.radius = object.transform.scale.x;
+		if (!ew::IsVisible(frustum, bounds))
+			continue;
+		const ew::Shader& shader = object.isLit ? lit : unlit;
+		shader.use();
+		if (object.isLit)
+		{
+			glBindTexture(GL_TEXTURE_2D, texture);
+			glBindSampler(0, sampler);
+		}
+		shader.setMat4("_Model", object.transform.getModelMatrix());
+		shader.setVec3("_Color", object.color);
+		meshes[object.mesh].draw();
+		inlineDraws++;
+	}
+	float inlineMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	uint64_t inlineHash = glStats.callHash;
+	int inlineChanges = glStats.getStateChanges() - glStats.uniforms;
+	printf("Inline: %d of %d objects drawn in %.2f ms, %d binds\n", inlineDraws, numObjects, inlineMs, inlineChanges);
+
+	ew::JobSystem jobSystem;
+	ew::CommandQueue commandQueue;
+	uint64_t hashes[2];
+	int replayChanges[2];
+	size_t reserved[2];
+	for (int pass = 0; pass < 2; pass++)
+	{
+		bool threaded = pass == 1;
+		commandQueue.begin(numBuffers);
+		start = std::chrono::high_resolution_clock::now();
+		if (threaded)
+		{
+			jobSystem.parallelFor(numBuffers, [&](int chunk) { recordChunk(commandQueue.getBuffer(chunk), chunk); });
+		}
+		else
+		{
+			for (int chunk = 0; chunk < numBuffers; chunk++)
+				recordChunk(commandQueue.getBuffer(chunk), chunk);
+		}
+		float recordMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		glStats = ew::GLStubStats();
+		commandQueue.replay();
+		hashes[pass] = glStats.callHash;
+		replayChanges[pass] = glStats.getStateChanges() - glStats.uniforms;
+		const ew::CommandQueueStats& stats = commandQueue.getStats();
+		reserved[pass] = 0;
+		for (int chunk = 0; chunk < numBuffers; chunk++)
+			reserved[pass] += commandQueue.getBuffer(chunk).getMemory().getReservedBytes();
+		printf("%s: recorded in %.2f ms on %d thread(s) into %d buffers (%.1f KB), replayed %d draws in %.2f ms, %d binds\n",
+			threaded ? "Threaded" : "Single thread", recordMs, threaded ? jobSystem.getNumThreads() : 1, numBuffers,
+			stats.recordedBytes / 1024.0f, stats.draws, stats.replayMs, glStats.getStateChanges() - glStats.uniforms);
+	}
+	check("Replays match inline drawing", hashes[0] == hashes[1] && hashes[0] == inlineHash
+		&& commandQueue.getStats().draws == inlineDraws);
+	check("Replays skip unchanged binds", replayChanges[0] == replayChanges[1] && replayChanges[1] < inlineChanges);
+	check("Recording the same frame again doesn't allocate", reserved[1] == reserved[0]);
+
+	//An untextured draw first, then a textured one with sampler 0, which still has to be bound
+	commandQueue.begin(1);
+	commandQueue.getBuffer(0).draw(unlit, 0, 0, meshes[0]);
+	commandQueue.getBuffer(0).draw(unlit, texture, 0, meshes[0]);
+	glStats = ew::GLStubStats();
+	commandQueue.replay();
+	check("The first texture and sampler binds are never skipped", glStats.bindTexture == 1 && glStats.bindSampler == 1);
+
+	//Names built at run time, equal but in different memory, then different but in the same memory
+	commandQueue.invalidatePrograms();
+	std::string names[2] = { std::string("_Mo") + "del", std::string("_Mod") + "el" };
+	char reusedName[16];
+	strcpy(reusedName, "_Color");
+	commandQueue.begin(1);
+	for (int i = 0; i < 2; i++)
+	{
+		commandQueue.getBuffer(0).draw(lit, texture, sampler, meshes[0]);
+		commandQueue.getBuffer(0).setMat4(names[i].c_str(), ew::Mat4(1));
+	}
+	commandQueue.getBuffer(0).setVec3(reusedName, ew::Vec3(1));
+	glStats = ew::GLStubStats();
+	commandQueue.replay();
+	int equalLookups = glStats.uniformLookups;
+	strcpy(reusedName, "_Tint");
+	commandQueue.begin(1);
+	commandQueue.getBuffer(0).draw(lit, texture, sampler, meshes[0]);
+	commandQueue.getBuffer(0).setVec3(reusedName, ew::Vec3(1));
+	glStats = ew::GLStubStats();
+	commandQueue.replay();
+	check("Uniform locations are looked up by name, not pointer", equalLookups == 2 && glStats.uniformLookups == 1);
+
+	ew::LinearAllocator allocator(256);
+	void* small = allocator.allocate(3, 1);
+	void* aligned = allocator.allocate(16, 64);
+	void* large = allocator.allocate(1000);
+	size_t reservedBefore = allocator.getReservedBytes();
+	allocator.reset();
+	bool reused = allocator.allocate(3, 1) == small && allocator.allocate(16, 64) == aligned;
+	check("Allocations are aligned, oversized ones get their own block, and blocks are reused", small && ((uintptr_t)aligned & 63) == 0
+		&& large && reservedBefore >= 256 + 1000 && reused && allocator.getReservedBytes() == reservedBefore);
+	return 0;
+}
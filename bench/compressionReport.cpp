@@ -0,0 +1,137 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <string>
+#include <filesystem>
+
+#include <ew/image.h>
+#include <ew/jobSystem.h>
+#include <ew/mipmap.h>
+#include <ew/textureCompression.h>
+#include <ew/textureContainer.h>
+
+//Lowest PSNR each format should reach on a photo at normal quality
+static const float MIN_PSNR[4] = { 32.0f, 32.0f, 40.0f, 37.0f };
+
+static bool sameTexture(const ew::CompressedTexture& a, const ew::CompressedTexture& b)
+{
+	if (a.format != b.format || a.levels.size() != b.levels.size())
+		return false;
+	for (size_t i = 0; i < a.levels.size(); i++)
+	{
+		if (a.levels[i].width != b.levels[i].width || a.levels[i].height != b.levels[i].height || a.levels[i].blocks != b.levels[i].blocks)
+			return false;
+	}
+	return true;
+}
+
+//Every decoded pixel is within tolerance of the solid color, for the channels the format keeps
+static bool decodesSolid(const ew::Image& decoded, const unsigned char* color, int tolerance)
+{
+	for (size_t i = 0; i < decoded.pixels.size(); i++)
+	{
+		if (abs(decoded.pixels[i] - color[i % decoded.numComponents]) > tolerance)
+			return false;
+	}
+	return true;
+}
+
+/// <summary>
+/// Encodes imagePath in every format and quality, printing PSNR, size and encode time for each. Checks block
+/// counts, minimum PSNR per format, that higher quality never loses to fast, that threads don't change the blocks,
+/// that solid partial blocks decode to their color, and that cached mip chains match.
+/// </summary>
+/// <returns>0, or 1 if the image couldn't be loaded</returns>
+int reportCompression(const char* imagePath)
+{
+	ew::Image image = ew::loadImage(imagePath);
+	if (!image.isValid())
+	{
+		printf("Failed to load %s\n", imagePath);
+		return 1;
+	}
+	const char* formatNames[] = { "BC1", "BC3", "BC5", "BC7" };
+	const char* qualityNames[] = { "fast", "normal", "high" };
+	//At least 4 threads, so block rows are split across workers even on a single core
+	ew::JobSystem jobSystem(std::max(3, (int)std::thread::hardware_concurrency() - 1));
+	size_t uncompressedBytes = (size_t)image.width * image.height * image.numComponents;
+	size_t numBlocks = (size_t)((image.width + 3) / 4) * ((image.height + 3) / 4);
+	printf("%s: %dx%d, %d channels, %.2f MB, %d thread(s)\n", imagePath, image.width, image.height, image.numComponents,
+		uncompressedBytes / 1048576.0f, jobSystem.getNumThreads());
+	bool sizesCorrect = true;
+	bool psnrHighEnough = true;
+	bool qualityOrdered = true;
+	bool threadsMatch = true;
+	for (int format = 0; format < 4; format++)
+	{
+		float psnr[3];
+		for (int quality = 0; quality < 3; quality++)
+		{
+			auto start = std::chrono::high_resolution_clock::now();
+			ew::CompressedImage compressed = ew::CompressImage(image, (ew::BCFormat)format, (ew::BCQuality)quality, &jobSystem);
+			float encodeMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			psnr[quality] = ew::ComputePSNR(image, ew::DecompressImage(compressed, (ew::BCFormat)format));
+			printf("%s %-6s: %6.2f dB, %.2f MB, %8.2f ms (%.1f MP/s)\n", formatNames[format], qualityNames[quality], psnr[quality],
+				compressed.blocks.size() / 1048576.0f, encodeMs, image.width * image.height / (encodeMs * 1000.0f));
+			sizesCorrect = sizesCorrect && compressed.blocks.size() == numBlocks * ew::BCBlockSize((ew::BCFormat)format);
+			if (quality == (int)ew::BCQuality::NORMAL)
+			{
+				ew::CompressedImage serial = ew::CompressImage(image, (ew::BCFormat)format, ew::BCQuality::NORMAL);
+				threadsMatch = threadsMatch && serial.blocks == compressed.blocks;
+			}
+		}
+		psnrHighEnough = psnrHighEnough && psnr[(int)ew::BCQuality::NORMAL] >= MIN_PSNR[format];
+		qualityOrdered = qualityOrdered && psnr[(int)ew::BCQuality::HIGH] >= psnr[(int)ew::BCQuality::FAST] - 0.01f;
+	}
+	check("Compressed sizes are blocks times block size", sizesCorrect);
+	check("Normal quality reaches each format's minimum PSNR", psnrHighEnough);
+	check("High quality is at least as good as fast", qualityOrdered);
+	check("Threaded encodes match single threaded", threadsMatch);
+
+	//6x5 leaves partial blocks on the right and bottom
+	const unsigned char color[4] = { 180, 90, 30, 128 };
+	ew::Image solid;
+	solid.width = 6;
+	solid.height = 5;
+	solid.numComponents = 4;
+	solid.pixels.resize(solid.width * solid.height * 4);
+	for (size_t i = 0; i < solid.pixels.size(); i++)
+		solid.pixels[i] = color[i % 4];
+	bool solidDecodes = true;
+	for (int format = 0; format < 4; format++)
+	{
+		ew::CompressedImage compressed = ew::CompressImage(solid, (ew::BCFormat)format, ew::BCQuality::NORMAL);
+		ew::Image decoded = ew::DecompressImage(compressed, (ew::BCFormat)format);
+		solidDecodes = solidDecodes && decoded.width == solid.width && decoded.height == solid.height
+			&& decoded.numComponents == ew::BCNumComponents((ew::BCFormat)format) && decodesSolid(decoded, color, 4);
+	}
+	check("Solid partial blocks decode to their color", solidDecodes);
+
+	//A copy of the image, so its cache starts cold
+	const char* copyPath = "bench_compression.jpg";
+	std::error_code error;
+	std::filesystem::copy_file(imagePath, copyPath, std::filesystem::copy_options::overwrite_existing, error);
+	ew::TextureCacheSettings settings;
+	settings.gammaCorrect = true;
+	settings.compress = true;
+	settings.bcFormat = (int)ew::BCFormat::BC1;
+	settings.quality = ew::BCQuality::FAST;
+	std::string cachePath = ew::TextureCachePath(copyPath, settings);
+	remove(cachePath.c_str());
+	ew::CompressionStats coldStats;
+	ew::CompressionStats warmStats;
+	ew::CompressedTexture cold = ew::loadCompressedTextureCached(copyPath, ew::BCFormat::BC1, ew::BCQuality::FAST, false, &jobSystem, &coldStats);
+	ew::CompressedTexture warm = ew::loadCompressedTextureCached(copyPath, ew::BCFormat::BC1, ew::BCQuality::FAST, false, &jobSystem, &warmStats);
+	ew::CompressedTexture expected = ew::CompressMipChain(ew::BuildMipChain(image, ew::MipFilter::BOX, true, &jobSystem),
+		ew::BCFormat::BC1, ew::BCQuality::FAST, &jobSystem);
+	printf("Cached BC1 mip chain: %.2f ms cold, %.2f ms warm\n", coldStats.loadMs, warmStats.loadMs);
+	check("Cached mip chain is encoded once, then read back unchanged", !error && !coldStats.fromCache && warmStats.fromCache
+		&& sameTexture(expected, cold) && sameTexture(expected, warm));
+	remove(cachePath.c_str());
+	remove(copyPath);
+	return 0;
+}
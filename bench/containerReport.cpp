@@ -0,0 +1,174 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <filesystem>
+
+#include <ew/image.h>
+#include <ew/mipmap.h>
+#include <ew/textureCompression.h>
+#include <ew/textureContainer.h>
+
+static std::vector<unsigned char> readFile(const char* filePath)
+{
+	std::vector<unsigned char> bytes;
+	FILE* file = fopen(filePath, "rb");
+	if (file == NULL)
+		return bytes;
+	fseek(file, 0, SEEK_END);
+	bytes.resize(ftell(file));
+	fseek(file, 0, SEEK_SET);
+	bytes.resize(fread(bytes.data(), 1, bytes.size(), file));
+	fclose(file);
+	return bytes;
+}
+
+static bool writeFile(const char* filePath, const std::vector<unsigned char>& bytes)
+{
+	FILE* file = fopen(filePath, "wb");
+	if (file == NULL)
+		return false;
+	bool written = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+	fclose(file);
+	return written;
+}
+
+//Whether every level in an open container holds the same bytes as the chain
+static bool matchesChain(const ew::TextureContainer& container, const ew::MipChain& chain)
+{
+	if (!container.isOpen() || container.isCompressed() || container.getNumLevels() != (int)chain.levels.size()
+		|| container.getHeader().numComponents != (uint32_t)chain.levels[0].numComponents)
+		return false;
+	for (int i = 0; i < container.getNumLevels(); i++)
+	{
+		const ew::TextureContainerLevel& level = container.getLevel(i);
+		const ew::Image& image = chain.levels[i];
+		if (level.width != (uint32_t)image.width || level.height != (uint32_t)image.height || level.size != image.pixels.size()
+			|| memcmp(container.getLevelData(i), image.pixels.data(), image.pixels.size()) != 0)
+			return false;
+	}
+	return true;
+}
+
+static bool matchesTexture(const ew::TextureContainer& container, const ew::CompressedTexture& texture)
+{
+	if (!container.isOpen() || !container.isCompressed() || container.getBCFormat() != texture.format
+		|| container.getNumLevels() != (int)texture.levels.size())
+		return false;
+	for (int i = 0; i < container.getNumLevels(); i++)
+	{
+		const ew::CompressedImage& image = texture.levels[i];
+		if (container.getLevel(i).size != image.blocks.size() || memcmp(container.getLevelData(i), image.blocks.data(), image.blocks.size()) != 0)
+			return false;
+	}
+	return true;
+}
+
+//Writes a damaged copy of a container and checks open() refuses it
+static bool rejectsDamaged(const std::vector<unsigned char>& bytes, void (*damage)(std::vector<unsigned char>& bytes))
+{
+	const char* damagedPath = "bench_damaged.ewtx";
+	std::vector<unsigned char> damaged = bytes;
+	damage(damaged);
+	ew::TextureContainer container;
+	bool rejected = writeFile(damagedPath, damaged) && !container.open(damagedPath);
+	container.close();
+	remove(damagedPath);
+	return rejected;
+}
+
+static ew::TextureContainerHeader* headerOf(std::vector<unsigned char>& bytes)
+{
+	return (ew::TextureContainerHeader*)bytes.data();
+}
+
+static ew::TextureContainerLevel* levelsOf(std::vector<unsigned char>& bytes)
+{
+	return (ew::TextureContainerLevel*)(bytes.data() + sizeof(ew::TextureContainerHeader));
+}
+
+/// <summary>
+/// Round trips raw and BC compressed mip chains through containers, and checks damaged containers are refused:
+/// truncated files, levels with the wrong byte size or dimensions, and bad formats. Then loads an image through the
+/// cache cold, warm, after touching it and after changing it, printing the load times.
+/// </summary>
+/// <param name="imagePath">Image to cache</param>
+/// <returns>0, or 1 if the image couldn't be loaded</returns>
+int reportContainer(const char* imagePath)
+{
+	ew::Image image = ew::loadImage(imagePath);
+	if (!image.isValid())
+	{
+		printf("Failed to load %s\n", imagePath);
+		return 1;
+	}
+	ew::MipChain chain = ew::BuildMipChain(image, ew::MipFilter::BOX, true);
+	ew::CompressedTexture texture = ew::CompressMipChain(chain, ew::ChooseBCFormat(image.numComponents), ew::BCQuality::FAST);
+	ew::TextureCacheSettings settings;
+	ew::TextureSource source;
+	ew::getTextureSource(imagePath, true, &source);
+
+	const char* rawPath = "bench_raw.ewtx";
+	const char* compressedPath = "bench_compressed.ewtx";
+	ew::TextureContainer container;
+	check("Raw mip chain round trips", ew::saveTextureContainer(rawPath, chain, settings, source) && container.open(rawPath)
+		&& matchesChain(container, chain) && container.getHeader().sourceHash == source.hash);
+	container.close();
+	check("Compressed mip chain round trips", ew::saveTextureContainer(compressedPath, texture, settings, source)
+		&& container.open(compressedPath) && matchesTexture(container, texture));
+	container.close();
+
+	std::vector<unsigned char> raw = readFile(rawPath);
+	std::vector<unsigned char> compressed = readFile(compressedPath);
+	remove(rawPath);
+	remove(compressedPath);
+	check("Truncated container is refused", rejectsDamaged(raw, [](std::vector<unsigned char>& bytes) { bytes.pop_back(); })
+		&& rejectsDamaged(compressed, [](std::vector<unsigned char>& bytes) { bytes.resize(bytes.size() / 2); }));
+	check("Level with the wrong byte size is refused",
+		rejectsDamaged(raw, [](std::vector<unsigned char>& bytes) { levelsOf(bytes)[0].size--; })
+		&& rejectsDamaged(compressed, [](std::vector<unsigned char>& bytes) { levelsOf(bytes)[1].size -= 8; }));
+	check("Level with the wrong dimensions is refused",
+		rejectsDamaged(raw, [](std::vector<unsigned char>& bytes) { levelsOf(bytes)[1].width++; })
+		&& rejectsDamaged(compressed, [](std::vector<unsigned char>& bytes) { levelsOf(bytes)[0].height *= 2; }));
+	check("Unknown format or channel count is refused",
+		rejectsDamaged(compressed, [](std::vector<unsigned char>& bytes) { headerOf(bytes)->bcFormat = 7; })
+		&& rejectsDamaged(raw, [](std::vector<unsigned char>& bytes) { headerOf(bytes)->numComponents = 0; })
+		&& rejectsDamaged(raw, [](std::vector<unsigned char>& bytes) { headerOf(bytes)->magic[0] = 'X'; }));
+
+	//A copy of the image, so its cache starts cold and it can be touched and edited
+	std::string copyPath = "bench_container" + std::filesystem::path(imagePath).extension().string();
+	std::error_code error;
+	std::filesystem::copy_file(imagePath, copyPath, std::filesystem::copy_options::overwrite_existing, error);
+	std::string cachePath = ew::TextureCachePath(copyPath.c_str(), settings);
+	remove(cachePath.c_str());
+	ew::TextureCacheStats stats[4];
+	bool opened = ew::openTextureCached(copyPath.c_str(), settings, &container, nullptr, &stats[0]);
+	opened = opened && ew::openTextureCached(copyPath.c_str(), settings, &container, nullptr, &stats[1]);
+	container.close();
+	std::filesystem::last_write_time(copyPath, std::filesystem::last_write_time(copyPath) + std::chrono::hours(1), error);
+	opened = opened && ew::openTextureCached(copyPath.c_str(), settings, &container, nullptr, &stats[2]);
+	container.close();
+	//Bytes after the end of the image change its hash without stopping it decoding
+	std::vector<unsigned char> edited = readFile(copyPath.c_str());
+	edited.push_back(0);
+	writeFile(copyPath.c_str(), edited);
+	opened = opened && ew::openTextureCached(copyPath.c_str(), settings, &container, nullptr, &stats[3]);
+	opened = opened && matchesChain(container, chain);
+	container.close();
+	remove(cachePath.c_str());
+	remove(copyPath.c_str());
+
+	const char* passNames[4] = { "cold", "warm", "touched", "edited" };
+	for (int i = 0; i < 4; i++)
+	{
+		printf("%s, %s: %.2f ms (build %.2f ms)%s\n", imagePath, passNames[i], stats[i].loadMs, stats[i].buildMs,
+			stats[i].hashed ? ", hashed" : "");
+	}
+	check("Cache is built cold and reused warm", !error && opened && !stats[0].fromCache && stats[1].fromCache && !stats[1].hashed);
+	check("Touched source is hashed and reused", stats[2].fromCache && stats[2].hashed);
+	check("Edited source is rebuilt", !stats[3].fromCache);
+	return 0;
+}
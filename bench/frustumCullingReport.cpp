@@ -0,0 +1,147 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <chrono>
+
+#include <ew/ewMath/ewMath.h>
+#include <ew/camera.h>
+#include <ew/frustum.h>
+
+//Distance a sphere is inside every plane by, negative when it's outside one
+static float sphereMargin(const ew::Frustum& frustum, const ew::BoundingSphere& sphere)
+{
+	float margin = INFINITY;
+	for (const ew::Plane& plane : frustum.planes)
+		margin = fminf(margin, ew::Dot(plane.normal, sphere.center) + plane.distance + sphere.radius);
+	return margin;
+}
+
+static float boxMargin(const ew::Frustum& frustum, const ew::AABB& box)
+{
+	ew::Vec3 c = box.center();
+	ew::Vec3 e = box.extents();
+	float margin = INFINITY;
+	for (const ew::Plane& plane : frustum.planes)
+	{
+		float r = fabsf(plane.normal.x) * e.x + fabsf(plane.normal.y) * e.y + fabsf(plane.normal.z) * e.z;
+		margin = fminf(margin, ew::Dot(plane.normal, c) + plane.distance + r);
+	}
+	return margin;
+}
+
+//Whether the visible list holds exactly the objects the scalar test passes, except ones touching a plane
+//closely enough for the SIMD rounding to differ
+template<typename Bounds>
+static bool matchesScalar(const ew::Frustum& frustum, const std::vector<Bounds>& objects, const std::vector<unsigned int>& visible,
+	float (*margin)(const ew::Frustum&, const Bounds&))
+{
+	std::vector<bool> isVisible(objects.size(), false);
+	for (unsigned int i : visible)
+	{
+		if (i >= objects.size() || isVisible[i])
+			return false;
+		isVisible[i] = true;
+	}
+	for (size_t i = 0; i < objects.size(); i++)
+	{
+		if (isVisible[i] != ew::IsVisible(frustum, objects[i]) && fabsf(margin(frustum, objects[i])) > 1e-4f)
+			return false;
+	}
+	return true;
+}
+
+/// <summary>
+/// Culls numObjects random spheres and boxes around a camera four at a time, and times it against testing each one
+/// with IsVisible. Checks both agree, including batches that aren't a multiple of four, and a few hand placed objects.
+/// </summary>
+/// <returns>0, with failed checks counted by check()</returns>
+int reportFrustumCulling(int numObjects)
+{
+	ew::Camera camera;
+	ew::Frustum frustum = ew::CreateFrustum(camera);
+
+	std::vector<ew::BoundingSphere> spheres(numObjects);
+	std::vector<ew::AABB> boxes(numObjects);
+	ew::SphereBatch sphereBatch;
+	ew::AABBBatch boxBatch;
+	sphereBatch.reserve(numObjects);
+	boxBatch.reserve(numObjects);
+	for (int i = 0; i < numObjects; i++)
+	{
+		spheres[i].center = ew::Vec3(ew::RandomRange(-50, 50), ew::RandomRange(-50, 50), ew::RandomRange(-50, 50));
+		spheres[i].radius = ew::RandomRange(0.1f, 1.0f);
+		sphereBatch.add(spheres[i]);
+		ew::Vec3 extents = ew::Vec3(ew::RandomRange(0.1f, 1.0f), ew::RandomRange(0.1f, 1.0f), ew::RandomRange(0.1f, 1.0f));
+		boxes[i].min = spheres[i].center - extents;
+		boxes[i].max = spheres[i].center + extents;
+		boxBatch.add(boxes[i]);
+	}
+
+	std::vector<unsigned int> visibleSpheres;
+	std::vector<unsigned int> visibleBoxes;
+	visibleSpheres.reserve(numObjects);
+	visibleBoxes.reserve(numObjects);
+	auto start = std::chrono::high_resolution_clock::now();
+	ew::CullSpheres(frustum, sphereBatch, &visibleSpheres);
+	float sphereMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	start = std::chrono::high_resolution_clock::now();
+	ew::CullAABBs(frustum, boxBatch, &visibleBoxes);
+	float boxMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	int scalarSpheres = 0;
+	int scalarBoxes = 0;
+	start = std::chrono::high_resolution_clock::now();
+	for (const ew::BoundingSphere& sphere : spheres)
+		scalarSpheres += ew::IsVisible(frustum, sphere);
+	float scalarSphereMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	start = std::chrono::high_resolution_clock::now();
+	for (const ew::AABB& box : boxes)
+		scalarBoxes += ew::IsVisible(frustum, box);
+	float scalarBoxMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	printf("%d spheres: %d visible in %.3f ms batched, %d in %.3f ms one at a time\n", numObjects, (int)visibleSpheres.size(), sphereMs,
+		scalarSpheres, scalarSphereMs);
+	printf("%d boxes: %d visible in %.3f ms batched, %d in %.3f ms one at a time\n", numObjects, (int)visibleBoxes.size(), boxMs,
+		scalarBoxes, scalarBoxMs);
+	check("Batched spheres match IsVisible", matchesScalar(frustum, spheres, visibleSpheres, sphereMargin));
+	check("Batched boxes match IsVisible", matchesScalar(frustum, boxes, visibleBoxes, boxMargin));
+
+	//In view, behind the camera, past the far plane, and straddling the left edge, plus a remainder lane
+	ew::Vec3 forward = ew::Normalize(camera.target - camera.position);
+	ew::Vec3 edge = camera.position + forward * 10.0f - ew::Vec3(10.0f * tanf(ew::Radians(camera.fov) * 0.5f) * camera.aspectRatio, 0, 0);
+	ew::BoundingSphere placed[5] = {
+		{ camera.target, 0.5f },
+		{ camera.position - forward * 5.0f, 1.0f },
+		{ camera.position + forward * (camera.farPlane + 5.0f), 1.0f },
+		{ edge, 0.5f },
+		{ edge - ew::Vec3(2.0f, 0, 0), 0.5f }
+	};
+	const bool expected[5] = { true, false, false, true, false };
+	std::vector<ew::BoundingSphere> placedSpheres(placed, placed + 5);
+	std::vector<ew::AABB> placedBoxes;
+	sphereBatch.clear();
+	boxBatch.clear();
+	for (const ew::BoundingSphere& sphere : placed)
+	{
+		sphereBatch.add(sphere);
+		ew::AABB box;
+		box.min = sphere.center - ew::Vec3(sphere.radius);
+		box.max = sphere.center + ew::Vec3(sphere.radius);
+		placedBoxes.push_back(box);
+		boxBatch.add(box);
+	}
+	visibleSpheres.clear();
+	visibleBoxes.clear();
+	ew::CullSpheres(frustum, sphereBatch, &visibleSpheres);
+	ew::CullAABBs(frustum, boxBatch, &visibleBoxes);
+	bool placedCorrectly = true;
+	for (int i = 0; i < 5; i++)
+		placedCorrectly &= ew::IsVisible(frustum, placed[i]) == expected[i] && ew::IsVisible(frustum, placedBoxes[i]) == expected[i];
+	check("Objects in view, behind, past the far plane and on the edge", placedCorrectly);
+	check("Remainder lanes match IsVisible", matchesScalar(frustum, placedSpheres, visibleSpheres, sphereMargin)
+		&& matchesScalar(frustum, placedBoxes, visibleBoxes, boxMargin));
+	return 0;
+}
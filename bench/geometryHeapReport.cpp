@@ -0,0 +1,166 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include <ew/external/glad.h>
+#include <ew/ewMath/ewMath.h>
+#include <ew/glStub.h>
+#include <ew/shader.h>
+#include <ew/mesh.h>
+#include <ew/procGen.h>
+#include <ew/transform.h>
+#include <ew/renderQueue.h>
+#include <ew/geometryHeap.h>
+
+/// <summary>
+/// Draws numMeshes small random primitives on the stub GL backend through a RenderQueue, once as separate meshes and once
+/// from a GeometryHeap, and prints the vertex array binds of each. Then removes and adds meshes until the heap is fragmented,
+/// defragments it, and checks that every mesh still reads back as it was uploaded. Also checks the free list takes the
+/// smallest block that fits and merges freed neighbours, only a full buffer grows, the bound vertex array is left alone,
+/// and removed handles are reused.
+/// </summary>
+/// <param name="numMeshes">Random meshes to draw and churn</param>
+/// <returns>0, with failed checks counted by check()</returns>
+int reportGeometryHeap(int numMeshes)
+{
+	auto randomMesh = [&]() {
+		switch (rand() % 3)
+		{
+		case 0:
+			return ew::createCube(ew::RandomRange(0.5f, 2.0f));
+		case 1:
+			return ew::createSphere(ew::RandomRange(0.5f, 2.0f), 4 + rand() % 12);
+		default:
+			return ew::createCylinder(ew::RandomRange(0.5f, 2.0f), 1.0f, 4 + rand() % 12);
+		}
+	};
+
+	std::vector<ew::MeshData> meshData(numMeshes);
+	std::vector<ew::Mat4> models(numMeshes);
+	for (int i = 0; i < numMeshes; i++)
+	{
+		meshData[i] = randomMesh();
+		ew::Transform transform;
+		transform.position = ew::Vec3(ew::RandomRange(-50, 50), ew::RandomRange(-50, 50), ew::RandomRange(-50, 50));
+		models[i] = transform.getModelMatrix();
+	}
+	ew::Shader program(glCreateProgram());
+	ew::RenderQueue renderQueue;
+
+	std::vector<ew::Mesh> meshes(numMeshes);
+	for (int i = 0; i < numMeshes; i++)
+		meshes[i].load(meshData[i]);
+	renderQueue.clear();
+	for (int i = 0; i < numMeshes; i++)
+		renderQueue.submit(program, 0, 0, meshes[i], models[i], (float)i);
+	renderQueue.execute([](const ew::Shader&) {});
+	printf("Separate meshes: %d draws, %d vertex array binds, %d buffers\n", renderQueue.getStats().draws,
+		renderQueue.getStats().meshChanges, numMeshes * 2);
+
+	//Starts small, so adding everything grows it
+	ew::GeometryHeap heap(4096, 8192);
+	std::vector<ew::GeometryHandle> handles(numMeshes);
+	for (int i = 0; i < numMeshes; i++)
+		handles[i] = heap.add(meshData[i]);
+	renderQueue.clear();
+	for (int i = 0; i < numMeshes; i++)
+		renderQueue.submit(program, 0, 0, heap, handles[i], models[i], (float)i);
+	renderQueue.execute([](const ew::Shader&) {});
+	ew::GeometryHeapStats stats = heap.getStats();
+	printf("Geometry heap: %d draws, %d vertex array binds, 2 buffers, grew %d times to %d vertices and %d indices\n",
+		renderQueue.getStats().draws, renderQueue.getStats().meshChanges, stats.grows, (int)heap.getVertexCapacity(),
+		(int)heap.getIndexCapacity());
+	check("Heap draws take one vertex array bind", renderQueue.getStats().meshChanges == 1 && renderQueue.getStats().draws == numMeshes);
+
+	auto contentsMatch = [&]() {
+		bool match = true;
+		std::vector<ew::Vertex> vertices;
+		std::vector<unsigned int> indices;
+		for (int i = 0; i < numMeshes; i++)
+		{
+			if (handles[i] == ew::INVALID_GEOMETRY)
+				continue;
+			const ew::GeometryRange& range = heap.getRange(handles[i]);
+			vertices.resize(range.numVertices);
+			indices.resize(range.numIndices);
+			glBindBuffer(GL_COPY_READ_BUFFER, heap.getVertexBuffer());
+			glGetBufferSubData(GL_COPY_READ_BUFFER, sizeof(ew::Vertex) * range.baseVertex, sizeof(ew::Vertex) * range.numVertices, vertices.data());
+			glBindBuffer(GL_COPY_READ_BUFFER, heap.getIndexBuffer());
+			glGetBufferSubData(GL_COPY_READ_BUFFER, sizeof(unsigned int) * range.firstIndex, sizeof(unsigned int) * range.numIndices, indices.data());
+			match = match && range.numVertices == (int)meshData[i].vertices.size() && range.numIndices == (int)meshData[i].indices.size()
+				&& memcmp(vertices.data(), meshData[i].vertices.data(), sizeof(ew::Vertex) * range.numVertices) == 0
+				&& memcmp(indices.data(), meshData[i].indices.data(), sizeof(unsigned int) * range.numIndices) == 0;
+		}
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		return match;
+	};
+	check("Meshes survive growing", contentsMatch());
+
+	//Churn: remove half, then replace some with new meshes of other sizes
+	for (int i = 0; i < numMeshes; i++)
+	{
+		if (rand() % 2 == 0)
+		{
+			heap.remove(handles[i]);
+			handles[i] = ew::INVALID_GEOMETRY;
+		}
+	}
+	for (int i = 0; i < numMeshes; i++)
+	{
+		if (handles[i] == ew::INVALID_GEOMETRY && rand() % 4 == 0)
+		{
+			meshData[i] = randomMesh();
+			handles[i] = heap.add(meshData[i]);
+		}
+	}
+	stats = heap.getStats();
+	float fragmented = stats.vertexFragmentation;
+	printf("After churn: %d meshes, %.1f%% of vertex and %.1f%% of index free space fragmented\n", stats.meshes,
+		stats.vertexFragmentation * 100.0f, stats.indexFragmentation * 100.0f);
+	check("Meshes survive churn", contentsMatch());
+
+	glStats = ew::GLStubStats();
+	heap.defragment();
+	stats = heap.getStats();
+	printf("Defragmented: %.2f MB copied on the GPU, %d bytes through the CPU\n", glStats.bufferCopyBytes / 1048576.0f, (int)glStats.bufferBytes);
+	check("Defragmenting leaves one free block", fragmented > 0 && stats.vertexFragmentation == 0 && stats.indexFragmentation == 0);
+	check("Meshes survive defragmenting", contentsMatch());
+
+	ew::FreeListAllocator allocator(100);
+	size_t offsets[4];
+	bool allocated = allocator.allocate(10, &offsets[0]) && allocator.allocate(30, &offsets[1]) && allocator.allocate(20, &offsets[2])
+		&& allocator.allocate(40, &offsets[3]);
+	allocator.free(offsets[1], 30);
+	allocator.free(offsets[3], 40);
+	//A 30 block at 10 and a 40 block at 60: 25 fits both, and goes in the smaller
+	size_t bestFit = 0;
+	bool fitted = allocator.allocate(25, &bestFit) && bestFit == offsets[1];
+	size_t tooBig = 0;
+	bool refused = !allocator.allocate(41, &tooBig);
+	allocator.free(bestFit, 25);
+	allocator.free(offsets[0], 10);
+	allocator.free(offsets[2], 20);
+	check("Free lists take the smallest fit and merge neighbours", allocated && fitted && refused && allocator.getNumFreeBlocks() == 1
+		&& allocator.getLargestFree() == 100 && allocator.getFragmentation() == 0);
+
+	//Plenty of index space but too little vertex space, with another vertex array bound
+	ew::GeometryHeap smallHeap(8, 1024);
+	unsigned int otherVertexArray = 0;
+	glGenVertexArrays(1, &otherVertexArray);
+	glBindVertexArray(otherVertexArray);
+	ew::MeshData cube = ew::createCube(1.0f);
+	GLint boundVertexArray = 0;
+	ew::GeometryHandle cubeHandle = smallHeap.add(cube);
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &boundVertexArray);
+	check("Only the full buffer grows", smallHeap.getVertexCapacity() >= cube.vertices.size() && smallHeap.getIndexCapacity() == 1024
+		&& smallHeap.getStats().grows == 1);
+	check("Growing leaves the bound vertex array alone", (unsigned int)boundVertexArray == otherVertexArray);
+	glBindVertexArray(0);
+
+	smallHeap.remove(cubeHandle);
+	check("Removed handles are reused", smallHeap.add(cube) == cubeHandle && smallHeap.getStats().meshes == 1);
+	return 0;
+}
@@ -0,0 +1,158 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+
+#include <ew/external/glad.h>
+#include <ew/ewMath/ewMath.h>
+#include <ew/image.h>
+#include <ew/texture.h>
+#include <ew/halfFloat.h>
+#include <ew/jobSystem.h>
+
+static float bitsToFloat(uint32_t bits)
+{
+	float f;
+	memcpy(&f, &bits, sizeof(f));
+	return f;
+}
+
+//Writes a flat (not run length encoded) Radiance file where pixel i is 2^i in red, halving in each later channel
+static bool writeRadiance(const char* filePath, int width, int height)
+{
+	FILE* file = fopen(filePath, "wb");
+	if (file == NULL)
+		return false;
+	fprintf(file, "#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y %d +X %d\n", height, width);
+	for (int i = 0; i < width * height; i++)
+	{
+		//Channels are scaled by 2^(exponent - 136), so 128 with exponent 129 + i is 2^i
+		unsigned char rgbe[4] = { 128, 64, 32, (unsigned char)(129 + i) };
+		fwrite(rgbe, 1, 4, file);
+	}
+	fclose(file);
+	return true;
+}
+
+/// <summary>
+/// Loads imagePath as floats and uploads it in every HDR format through the stub GL backend, printing conversion time
+/// and size for each, then compares scalar and SIMD half conversion and measures the R11G11B10F error. Checks half
+/// conversion rounds to nearest even with overflow, denormals and NaN handled, the SIMD path gives the same bits as the
+/// scalar one, R11G11B10F stays within its precision, and Radiance files keep values above 1.
+/// </summary>
+/// <param name="imagePath">Image to convert</param>
+/// <returns>0, or 1 if the image couldn't be loaded</returns>
+int reportHDR(const char* imagePath)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	ew::FloatImage image = ew::loadImageFloat(imagePath);
+	float loadMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	if (!image.isValid())
+	{
+		printf("Failed to load %s\n", imagePath);
+		return 1;
+	}
+	ew::JobSystem jobSystem;
+	printf("%s: %dx%d, %d channels at %d bits, loaded in %.2f ms\n", imagePath, image.width, image.height, image.numComponents,
+		image.bitsPerChannel, loadMs);
+
+	ew::Image bytes = ew::loadImage(imagePath);
+	bool scaled = image.bitsPerChannel == 8 && bytes.pixels.size() == image.pixels.size();
+	for (size_t i = 0; scaled && i < bytes.pixels.size(); i++)
+	{
+		scaled = image.pixels[i] == bytes.pixels[i] / 255.0f;
+	}
+	check("8 bit images are scaled to 0-1 without gamma", scaled);
+
+	const char* formatNames[] = { "Half", "R11G11B10F", "Float" };
+	const size_t numPixels = (size_t)image.width * image.height;
+	const size_t expectedBytes[3] = { image.pixels.size() * 2, numPixels * 4, image.pixels.size() * 4 };
+	bool uploaded = true;
+	for (int format = 0; format < 3; format++)
+	{
+		ew::HDRTextureStats stats;
+		int uploadsBefore = glStats.textureUploads;
+		unsigned int texture = ew::uploadTextureHDR(image, (ew::HDRFormat)format, GL_REPEAT, GL_LINEAR, &jobSystem, &stats);
+		printf("%-10s: %6.2f MB, converted in %.2f ms on %d thread(s)\n", formatNames[format], stats.gpuBytes / 1048576.0f,
+			stats.convertMs, jobSystem.getNumThreads());
+		uploaded = uploaded && texture != 0 && glStats.textureUploads == uploadsBefore + 1 && stats.gpuBytes == expectedBytes[format]
+			&& stats.sourceBytes == image.pixels.size() * sizeof(float);
+	}
+	check("Every format is uploaded at its packed size", uploaded);
+
+	std::vector<uint16_t> halves(image.pixels.size());
+	for (int simd = 0; simd < 2; simd++)
+	{
+		start = std::chrono::high_resolution_clock::now();
+		ew::FloatToHalfArray(image.pixels.data(), halves.data(), image.pixels.size(), simd == 1);
+		float convertMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		printf("Half, %s, one thread: %.2f ms\n", simd ? "SIMD" : "scalar", convertMs);
+	}
+
+	uint16_t nan = ew::FloatToHalf(NAN);
+	check("Half conversion rounds to nearest even", ew::FloatToHalf(1.0f) == 0x3C00 && ew::FloatToHalf(-2.0f) == 0xC000
+		&& ew::FloatToHalf(65504.0f) == 0x7BFF && ew::FloatToHalf(65520.0f) == 0x7C00 && ew::FloatToHalf(-1e10f) == 0xFC00
+		&& ew::FloatToHalf(bitsToFloat(0x3F801000)) == 0x3C00 && ew::FloatToHalf(bitsToFloat(0x3F803000)) == 0x3C02
+		&& ew::FloatToHalf(ldexpf(1.0f, -24)) == 0x0001 && ew::FloatToHalf(ldexpf(1.0f, -26)) == 0x0000
+		&& (nan & 0x7C00) == 0x7C00 && (nan & 0x03FF) != 0 && ew::HalfToFloat(0x3555) == bitsToFloat(0x3EAAA000));
+
+	//A spread of bit patterns covering every exponent, both signs, infinities and NaN
+	const size_t NUM_PATTERNS = 1 << 22;
+	std::vector<float> patterns(NUM_PATTERNS);
+	for (size_t i = 0; i < NUM_PATTERNS; i++)
+		patterns[i] = bitsToFloat((uint32_t)(i * 1021u + (i >> 11)));
+	std::vector<uint16_t> scalarHalves(NUM_PATTERNS);
+	std::vector<uint16_t> simdHalves(NUM_PATTERNS);
+	ew::FloatToHalfArray(patterns.data(), scalarHalves.data(), NUM_PATTERNS, false);
+	ew::FloatToHalfArray(patterns.data(), simdHalves.data(), NUM_PATTERNS, true);
+	bool matched = true;
+	for (size_t i = 0; i < NUM_PATTERNS && matched; i++)
+	{
+		bool isNaN = (scalarHalves[i] & 0x7FFF) > 0x7C00;
+		matched = isNaN ? (simdHalves[i] & 0x7FFF) > 0x7C00 : simdHalves[i] == scalarHalves[i];
+	}
+	check("SIMD half conversion gives the same bits as scalar", matched);
+
+	//Relative error of the packed format against the source, ignoring near black pixels where it is meaningless
+	std::vector<uint32_t> packed(numPixels);
+	ew::PackR11G11B10FArray(image.pixels.data(), image.numComponents, packed.data(), numPixels);
+	double totalError = 0;
+	float maxError = 0;
+	size_t counted = 0;
+	for (size_t i = 0; i < numPixels; i++)
+	{
+		ew::Vec3 unpacked = ew::UnpackR11G11B10F(packed[i]);
+		const float* pixel = &image.pixels[i * image.numComponents];
+		for (int c = 0; c < std::min(image.numComponents, 3); c++)
+		{
+			if (pixel[c] < 1.0f / 1024.0f)
+				continue;
+			float error = fabsf((&unpacked.x)[c] - pixel[c]) / pixel[c];
+			totalError += error;
+			maxError = std::max(maxError, error);
+			counted++;
+		}
+	}
+	printf("R11G11B10F relative error: mean %.3f%%, max %.3f%%\n", counted ? totalError / counted * 100.0 : 0.0, maxError * 100.0f);
+	//Half a step of blue's 5 bit mantissa
+	check("R11G11B10F error is within its precision", counted > 0 && maxError <= 1.0f / 64.0f);
+	ew::Vec3 clamped = ew::UnpackR11G11B10F(ew::PackR11G11B10F(-1.0f, 1e10f, NAN));
+	check("R11G11B10F drops negatives and NaN and clamps overflow", clamped.x == 0.0f && clamped.y == 65024.0f && clamped.z == 0.0f);
+
+	const char* radiancePath = "bench_radiance.hdr";
+	bool radiance = writeRadiance(radiancePath, 4, 2);
+	ew::FloatImage hdr = ew::loadImageFloat(radiancePath);
+	radiance = radiance && hdr.isValid() && hdr.width == 4 && hdr.height == 2 && hdr.bitsPerChannel == 32 && hdr.numComponents == 3;
+	for (int i = 0; radiance && i < 8; i++)
+	{
+		float value = ldexpf(1.0f, i);
+		radiance = hdr.pixels[i * 3] == value && hdr.pixels[i * 3 + 1] == value / 2 && hdr.pixels[i * 3 + 2] == value / 4;
+	}
+	remove(radiancePath);
+	check("Radiance files keep their linear values", radiance);
+	return 0;
+}
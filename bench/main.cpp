@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "bench.h"
+
+ew::GLStubStats glStats;
+static int failures = 0;
+
+bool check(const char* name, bool passed)
+{
+	printf("%s: %s\n", passed ? "PASS" : "FAIL", name);
+	failures += passed ? 0 : 1;
+	return passed;
+}
+
+//Runs a mode with its optional argument, which is NULL when not given
+struct Mode {
+	const char* name;
+	const char* description;
+	int (*run)(const char* argument);
+};
+
+static const Mode MODES[] = {
+	{ "frustum-culling", "[objects] SIMD sphere and box culling against the scalar tests",
+		[](const char* argument) { return reportFrustumCulling(argument ? atoi(argument) : 1000000); } },
+	{ "bvh", "[objects] SAH build, refit and queries against testing every box",
+		[](const char* argument) { return reportBVH(argument ? atoi(argument) : 100000); } },
+	{ "picking", "[grid size] MeshBVH ray casts against testing every triangle",
+		[](const char* argument) { return reportPicking(argument ? atoi(argument) : 500); } },
+	{ "rasterizer", "[output.ppm] Software render timings, single threaded against the job system",
+		[](const char* argument) { return reportRasterizer(argument); } },
+	{ "occlusion", "[occluders] Occlusion buffer thread scaling and depth tests",
+		[](const char* argument) { return reportOcclusion(argument ? atoi(argument) : 200); } },
+	{ "texture-load", "[directory] Serial against parallel image decoding",
+		[](const char* argument) { return reportTextureLoad(argument ? argument : "assets"); } },
+	{ "mipmap", "[image] CPU mip chain build times and filter checks",
+		[](const char* argument) { return reportMipmap(argument ? argument : "assets/brick_color.jpg"); } },
+	{ "compression", "[image] PSNR, size and encode time for every BC format and quality",
+		[](const char* argument) { return reportCompression(argument ? argument : "assets/brick_color.jpg"); } },
+	{ "container", "[image] Texture container round trips, damaged files and cache reuse",
+		[](const char* argument) { return reportContainer(argument ? argument : "assets/brickwall.png"); } },
+	{ "texture-manager", "[loads] Texture sharing, reference counts and memory on the stub backend",
+		[](const char* argument) { return reportTextureManager(argument ? atoi(argument) : 100); } },
+	{ "atlas", "[sprites] Skyline and MaxRects packing efficiency, overlap and edge bleeding",
+		[](const char* argument) { return reportAtlas(argument ? atoi(argument) : 2000); } },
+	{ "virtual-texture", "[image] Virtual texture streaming under a simulated camera, LRU and page checks",
+		[](const char* argument) { return reportVirtualTexture(argument ? argument : "assets/brick_color.jpg"); } },
+	{ "sampler", "[textures] Sampler sharing by state, stored parameters and cleanup on the stub backend",
+		[](const char* argument) { return reportSampler(argument ? atoi(argument) : 10000); } },
+	{ "texture-binding", "[frames] State changes per frame with per draw binds and each texture table backend",
+		[](const char* argument) { return reportTextureBinding(argument ? atoi(argument) : 1000); } },
+	{ "hdr", "[image] Float loading, half and R11G11B10F conversion speed and error",
+		[](const char* argument) { return reportHDR(argument ? argument : "assets/brick_color.jpg"); } },
+	{ "program-cache", "Program binary cache through cold, warm, edited and rejected launches on the stub backend",
+		[](const char* argument) { return checkProgramCache(); } },
+	{ "shader-compiler", "[programs] Asynchronous program builds, cold and through the program cache, on the stub backend",
+		[](const char* argument) { return reportShaderCompiler(argument ? atoi(argument) : 100); } },
+	{ "shader-preprocessor", "Shader includes, defines and variants, and the assignments' shared shader code",
+		[](const char* argument) { return reportShaderPreprocessor(); } },
+	{ "shader-reload", "Hot reloads shader files through a file watcher",
+		[](const char* argument) { return reportShaderReload(); } },
+	{ "asset-file", "Reads shaders and images through mapped asset files",
+		[](const char* argument) { return reportAssetFile(argument ? atoi(argument) : 1000); } },
+	{ "render-queue", "Sorts random draws through a render queue",
+		[](const char* argument) { return reportRenderQueue(argument ? atoi(argument) : 10000); } },
+	{ "command-buffer", "Records culled draws on worker threads and replays them",
+		[](const char* argument) { return reportCommandBuffers(argument ? atoi(argument) : 100000); } },
+	{ "ring-buffer", "Ring buffer wraparound and fenced reuse",
+		[](const char* argument) { return checkRingBuffer(); } },
+	{ "mesh-update", "Dynamic mesh updates against a new mesh per frame, [frames]",
+		[](const char* argument) { return reportMeshUpdates(argument ? atoi(argument) : 1000); } },
+	{ "geometry-heap", "Draws random meshes separately and from a geometry heap, then churns and defragments it, [meshes]",
+		[](const char* argument) { return reportGeometryHeap(argument ? atoi(argument) : 1000); } },
+};
+static const int NUM_MODES = sizeof(MODES) / sizeof(MODES[0]);
+
+static int runMode(const Mode& mode, const char* argument)
+{
+	printf("== %s\n", mode.name);
+	glStats = ew::GLStubStats();
+	ew::installGLStub(&glStats);
+	int result = mode.run(argument);
+	if (result != 0) {
+		printf("FAIL: %s exited with %d\n", mode.name, result);
+	}
+	return result;
+}
+
+//Reports and checks run on the stub GL backend, so no window or GPU is needed.
+//Run from the bin directory, where the assets are copied. Exits with 1 if any check fails.
+int main(int argc, char** argv) {
+	const char* modeName = argc > 1 ? argv[1] : "all";
+	const char* argument = argc > 2 ? argv[2] : NULL;
+	int result = 0;
+	bool found = false;
+	bool all = strcmp(modeName, "all") == 0;
+	for (int i = 0; i < NUM_MODES; i++) {
+		if (all || strcmp(modeName, MODES[i].name) == 0) {
+			found = true;
+			result |= runMode(MODES[i], all ? NULL : argument);
+		}
+	}
+	if (!found) {
+		printf("Usage: bench [mode [argument]]\nModes, or all to run every one with its defaults:\n");
+		for (int i = 0; i < NUM_MODES; i++) {
+			printf("  %-16s %s\n", MODES[i].name, MODES[i].description);
+		}
+		return 1;
+	}
+	if (failures > 0) {
+		printf("%d check(s) failed\n", failures);
+	}
+	return result != 0 || failures > 0 ? 1 : 0;
+}
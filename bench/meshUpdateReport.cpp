@@ -0,0 +1,105 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <vector>
+
+#include <ew/glStub.h>
+#include <ew/mesh.h>
+#include <dj/procGen.h>
+
+//A strip of count vertices and the indices of its triangles
+static ew::MeshData makeStrip(int count)
+{
+	ew::MeshData meshData;
+	meshData.vertices.resize(count);
+	for (int i = 0; i + 2 < count; i++)
+	{
+		meshData.indices.push_back(i);
+		meshData.indices.push_back(i + 1);
+		meshData.indices.push_back(i + 2);
+	}
+	return meshData;
+}
+
+/// <summary>
+/// Replays a sphere having its segments dragged up and back down in assignment6 through the stub GL backend, once creating
+/// a new mesh every frame as the scene used to and once loading into one dynamic mesh, printing the buffer traffic of each.
+/// Checks the dynamic mesh only reallocates when it outgrows its storage, reloads that fit keep their storage, dynamic and stream reloads orphan it,
+/// storage grows geometrically, partial updates stay inside the mesh, and the upload stats match what reached GL.
+/// </summary>
+/// <param name="frames">Frames to replay</param>
+/// <returns>0, with failed checks counted by check()</returns>
+int reportMeshUpdates(int frames)
+{
+	auto segmentsAt = [&](int frame) {
+		//Up to 64 segments and back, a few frames per step
+		int step = (frame / 4) % 96;
+		return 16 + (step < 48 ? step : 96 - step);
+	};
+
+	glStats = ew::GLStubStats();
+	for (int frame = 0; frame < frames; frame++)
+	{
+		ew::Mesh sphereMesh(dj::createSphere(1.0f, segmentsAt(frame)));
+	}
+	int perFrameAllocations = glStats.bufferAllocations;
+	printf("New mesh per frame: %d buffer allocations, %d vertex arrays, %.2f MB uploaded\n", perFrameAllocations,
+		frames, glStats.bufferBytes / 1048576.0f);
+
+	glStats = ew::GLStubStats();
+	ew::resetMeshUploadStats();
+	ew::Mesh sphereMesh(ew::MeshData(), ew::MeshUsage::DYNAMIC);
+	int lastSegments = -1;
+	int edits = 0;
+	for (int frame = 0; frame < frames; frame++)
+	{
+		if (segmentsAt(frame) != lastSegments)
+		{
+			lastSegments = segmentsAt(frame);
+			edits++;
+			sphereMesh.load(dj::createSphere(1.0f, lastSegments));
+		}
+	}
+	const ew::MeshUploadStats& stats = ew::getMeshUploadStats();
+	printf("Dynamic mesh updated on edits: %d buffer allocations (%d reallocations, %d orphaned), 1 vertex array, %.2f MB uploaded, %.1f KB capacity\n",
+		glStats.bufferAllocations, stats.reallocations, stats.orphans, glStats.bufferBytes / 1048576.0f,
+		(sphereMesh.getVertexCapacity() + sphereMesh.getIndexCapacity()) / 1024.0f);
+	//Only edits reach GL, and most of them fit in the storage already there
+	check("A dynamic mesh only reallocates when it outgrows its storage", glStats.bufferAllocations <= 2 * edits
+		&& glStats.bufferAllocations == stats.reallocations + stats.orphans && stats.reallocations <= 2 * 8);
+	check("Upload stats match the bytes that reached GL", stats.bytes == glStats.bufferBytes && stats.uploads == glStats.bufferUploads);
+
+	//Partial updates only reach vertices already in the mesh
+	std::vector<ew::Vertex> ring(lastSegments + 1);
+	bool inside = sphereMesh.updateVertices(ring.data(), 0, (int)ring.size());
+	bool outside = sphereMesh.updateVertices(ring.data(), sphereMesh.getNumVertices() - 1, (int)ring.size());
+	std::vector<unsigned int> indices(3);
+	bool indicesInside = sphereMesh.updateIndices(indices.data(), sphereMesh.getNumIndices() - 3, 3);
+	bool indicesOutside = sphereMesh.updateIndices(indices.data(), -1, 3);
+	check("Partial updates stay inside the mesh", inside && !outside && indicesInside && !indicesOutside);
+
+	//Reloading data of the same size
+	ew::MeshData strip = makeStrip(100);
+	ew::Mesh staticMesh(strip);
+	ew::Mesh streamMesh(strip, ew::MeshUsage::STREAM);
+	ew::resetMeshUploadStats();
+	int allocationsBefore = glStats.bufferAllocations;
+	staticMesh.load(strip);
+	bool staticKept = glStats.bufferAllocations == allocationsBefore && ew::getMeshUploadStats().orphans == 0;
+	streamMesh.load(strip);
+	check("Reloads that fit keep their storage", staticKept && ew::getMeshUploadStats().reallocations == 0
+		&& staticMesh.getVertexCapacity() == sizeof(ew::Vertex) * 100 && streamMesh.getVertexCapacity() == sizeof(ew::Vertex) * 100);
+	check("Dynamic and stream reloads orphan their storage", ew::getMeshUploadStats().orphans == 2
+		&& glStats.bufferAllocations == allocationsBefore + 2);
+
+	//Growing one vertex at a time
+	ew::Mesh growingMesh(makeStrip(3), ew::MeshUsage::DYNAMIC);
+	ew::resetMeshUploadStats();
+	for (int count = 4; count <= 1024; count++)
+		growingMesh.load(makeStrip(count));
+	int reallocations = ew::getMeshUploadStats().reallocations;
+	printf("Growing from 3 to 1024 vertices: %d reallocations\n", reallocations);
+	check("Storage grows geometrically", reallocations <= 2 * 10 && growingMesh.getVertexCapacity() >= sizeof(ew::Vertex) * 1024
+		&& growingMesh.getVertexCapacity() < sizeof(ew::Vertex) * 2048);
+	return 0;
+}
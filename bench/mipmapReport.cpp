@@ -0,0 +1,146 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <string>
+#include <filesystem>
+
+#include <ew/image.h>
+#include <ew/jobSystem.h>
+#include <ew/mipmap.h>
+#include <ew/textureContainer.h>
+
+static bool sameChain(const ew::MipChain& a, const ew::MipChain& b)
+{
+	if (a.levels.size() != b.levels.size())
+		return false;
+	for (size_t i = 0; i < a.levels.size(); i++)
+	{
+		if (a.levels[i].width != b.levels[i].width || a.levels[i].height != b.levels[i].height || a.levels[i].pixels != b.levels[i].pixels)
+			return false;
+	}
+	return true;
+}
+
+//Levels halve with GL's floor(size / 2) rule down to 1x1
+static bool followsFloorRule(const ew::MipChain& chain)
+{
+	for (size_t i = 1; i < chain.levels.size(); i++)
+	{
+		const ew::Image& previous = chain.levels[i - 1];
+		const ew::Image& level = chain.levels[i];
+		if (level.width != std::max(1, previous.width / 2) || level.height != std::max(1, previous.height / 2)
+			|| level.numComponents != previous.numComponents || level.pixels.size() != (size_t)level.width * level.height * level.numComponents)
+			return false;
+	}
+	const ew::Image& last = chain.levels.back();
+	return last.width == 1 && last.height == 1;
+}
+
+static ew::Image solidImage(int width, int height, int numComponents, const unsigned char* color)
+{
+	ew::Image image;
+	image.width = width;
+	image.height = height;
+	image.numComponents = numComponents;
+	image.pixels.resize(width * height * numComponents);
+	for (size_t i = 0; i < image.pixels.size(); i++)
+		image.pixels[i] = color[i % numComponents];
+	return image;
+}
+
+/// <summary>
+/// Builds mip chains for an image with both filters, with and without gamma correction, on one thread and on the
+/// job system, and prints build times. Checks level sizes, that threads don't change the result, that flat images stay
+/// flat, that gamma correct filtering averages in linear space, and that cached chains match.
+/// </summary>
+/// <param name="imagePath">Image to build chains for</param>
+/// <returns>0, or 1 if the image couldn't be loaded</returns>
+int reportMipmap(const char* imagePath)
+{
+	ew::Image image = ew::loadImage(imagePath);
+	if (!image.isValid())
+	{
+		printf("Failed to load %s\n", imagePath);
+		return 1;
+	}
+	printf("%s: %dx%d, %d channels\n", imagePath, image.width, image.height, image.numComponents);
+
+	//At least 4 threads, so rows are split across workers even on a single core
+	ew::JobSystem jobSystem(std::max(3, (int)std::thread::hardware_concurrency() - 1));
+	const ew::MipFilter filters[2] = { ew::MipFilter::BOX, ew::MipFilter::KAISER };
+	const char* filterNames[2] = { "Box", "Kaiser" };
+	bool sizesCorrect = true;
+	bool threadsMatch = true;
+	ew::MipChain kaiserChain;
+	for (int f = 0; f < 2; f++)
+	{
+		for (int gamma = 0; gamma < 2; gamma++)
+		{
+			auto start = std::chrono::high_resolution_clock::now();
+			ew::MipChain serial = ew::BuildMipChain(image, filters[f], gamma);
+			float serialMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			start = std::chrono::high_resolution_clock::now();
+			ew::MipChain parallel = ew::BuildMipChain(image, filters[f], gamma, &jobSystem);
+			float parallelMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			float megapixels = image.width * image.height / 1000000.0f;
+			printf("%s%s: %d levels, %.2f ms (%.1f MP/s) on 1 thread, %.2f ms (%.1f MP/s) on %d\n", filterNames[f],
+				gamma ? " gamma correct" : "", (int)serial.levels.size(), serialMs, megapixels / (serialMs / 1000.0f),
+				parallelMs, megapixels / (parallelMs / 1000.0f), jobSystem.getNumThreads());
+			sizesCorrect = sizesCorrect && serial.isValid() && followsFloorRule(serial);
+			threadsMatch = threadsMatch && sameChain(serial, parallel);
+			if (filters[f] == ew::MipFilter::KAISER && gamma)
+				kaiserChain = serial;
+		}
+	}
+	check("Levels halve down to 1x1", sizesCorrect);
+	check("Threaded chains match single threaded", threadsMatch);
+
+	//Odd sizes make the filters straddle the edge of the image
+	const unsigned char color[4] = { 200, 100, 50, 255 };
+	ew::Image solid = solidImage(37, 23, 4, color);
+	bool staysSolid = true;
+	for (ew::MipFilter filter : filters)
+	{
+		ew::MipChain chain = ew::BuildMipChain(solid, filter, true, &jobSystem);
+		staysSolid = staysSolid && followsFloorRule(chain);
+		for (const ew::Image& level : chain.levels)
+		{
+			for (size_t i = 0; i < level.pixels.size(); i++)
+				staysSolid = staysSolid && abs(level.pixels[i] - color[i % 4]) <= 1;
+		}
+	}
+	check("Solid color odd sized image stays solid", staysSolid);
+
+	//Black and white average to half the light, which is 188 in sRGB rather than 128
+	const unsigned char black[1] = { 0 };
+	ew::Image checker = solidImage(2, 2, 1, black);
+	checker.pixels[0] = checker.pixels[3] = 255;
+	unsigned char linearAverage = ew::BuildMipChain(checker, ew::MipFilter::BOX, false).levels[1].pixels[0];
+	unsigned char gammaAverage = ew::BuildMipChain(checker, ew::MipFilter::BOX, true).levels[1].pixels[0];
+	printf("Black and white checker averages to %d, or %d gamma correct\n", linearAverage, gammaAverage);
+	check("Gamma correct average is done in linear space", abs(linearAverage - 128) <= 1 && abs(gammaAverage - 188) <= 1);
+
+	//A copy of the image, so its cache starts cold
+	const char* copyPath = "bench_mipmap.jpg";
+	std::error_code error;
+	std::filesystem::copy_file(imagePath, copyPath, std::filesystem::copy_options::overwrite_existing, error);
+	ew::TextureCacheSettings settings;
+	settings.mipFilter = ew::MipFilter::KAISER;
+	settings.gammaCorrect = true;
+	std::string cachePath = ew::TextureCachePath(copyPath, settings);
+	remove(cachePath.c_str());
+	ew::MipStats coldStats;
+	ew::MipStats warmStats;
+	ew::MipChain cold = ew::loadMipChainCached(copyPath, ew::MipFilter::KAISER, true, false, &jobSystem, &coldStats);
+	ew::MipChain warm = ew::loadMipChainCached(copyPath, ew::MipFilter::KAISER, true, false, &jobSystem, &warmStats);
+	printf("Cached Kaiser chain: %.2f ms cold, %.2f ms warm\n", coldStats.loadMs, warmStats.loadMs);
+	check("Cached chain is built once, then read back unchanged", !error && !coldStats.fromCache && warmStats.fromCache
+		&& sameChain(kaiserChain, cold) && sameChain(kaiserChain, warm));
+	remove(cachePath.c_str());
+	remove(copyPath);
+	return 0;
+}
@@ -0,0 +1,125 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include <chrono>
+
+#include <ew/ewMath/ewMath.h>
+#include <ew/camera.h>
+#include <ew/procGen.h>
+#include <ew/transform.h>
+#include <ew/occlusion.h>
+
+static ew::AABB boxAt(const ew::Vec3& center, float halfSize)
+{
+	ew::AABB box;
+	box.min = center - ew::Vec3(halfSize);
+	box.max = center + ew::Vec3(halfSize);
+	return box;
+}
+
+//Every texel inside the sphere's silhouette (shrunk a little for the tessellation) has depth
+static bool coversSilhouette(const ew::OcclusionBuffer& buffer, const ew::Camera& camera, float sphereRadius)
+{
+	float distance = ew::Magnitude(camera.position);
+	float ndcRadius = sphereRadius / sqrtf(distance * distance - sphereRadius * sphereRadius) / tanf(ew::Radians(camera.fov) * 0.5f);
+	float pixelRadius = ndcRadius * buffer.getHeight() * 0.5f * 0.8f;
+	float centerX = buffer.getWidth() * 0.5f;
+	float centerY = buffer.getHeight() * 0.5f;
+	for (int y = 0; y < buffer.getHeight(); y++)
+	{
+		for (int x = 0; x < buffer.getWidth(); x++)
+		{
+			float dx = x + 0.5f - centerX;
+			float dy = y + 0.5f - centerY;
+			if (dx * dx + dy * dy < pixelRadius * pixelRadius && buffer.getDepth()[y * buffer.getWidth() + x] >= 1.0f)
+				return false;
+		}
+	}
+	return true;
+}
+
+/// <summary>
+/// Rasterizes random sphere occluders in front of the camera with 1, 2 and 4 threads and tests boxes against the result.
+/// Checks every thread count gives the same depth, a sphere has no cracks between its triangles, and boxes behind it
+/// are hidden while boxes in front of it, beside it or crossing the near plane are not.
+/// </summary>
+/// <param name="numOccluders">Spheres in the scaling scene</param>
+/// <returns>0, with failed checks counted by check()</returns>
+int reportOcclusion(int numOccluders)
+{
+	const int NUM_FRAMES = 10;
+	const int NUM_BOXES = 10000;
+	const int MAX_THREADS = 4;
+	ew::Camera camera;
+	camera.aspectRatio = 2.0f;
+	ew::Mat4 viewProjection = camera.ProjectionMatrix() * camera.ViewMatrix();
+	ew::Vec3 forward = ew::Normalize(camera.target - camera.position);
+	ew::MeshData sphereMeshData = ew::createSphere(0.5f, 64);
+
+	std::vector<ew::Mat4> occluderModels(numOccluders);
+	for (ew::Mat4& model : occluderModels)
+	{
+		ew::Transform transform;
+		transform.position = camera.position + forward * ew::RandomRange(3, 20) + ew::Vec3(ew::RandomRange(-6, 6), ew::RandomRange(-3, 3), ew::RandomRange(-6, 6));
+		transform.scale = ew::Vec3(ew::RandomRange(0.5f, 2.0f));
+		model = transform.getModelMatrix();
+	}
+
+	//Thread counts include the calling thread
+	ew::OcclusionBuffer occlusionBuffer(256, 128);
+	std::vector<float> singleThreadedDepth;
+	bool depthMatches = true;
+	for (int numThreads = 1; numThreads <= MAX_THREADS; numThreads *= 2)
+	{
+		ew::JobSystem jobSystem(numThreads - 1);
+		occlusionBuffer.setJobSystem(numThreads > 1 ? &jobSystem : nullptr);
+		float setupMs = 0;
+		float rasterMs = 0;
+		for (int frame = 0; frame < NUM_FRAMES; frame++)
+		{
+			occlusionBuffer.begin(viewProjection);
+			for (const ew::Mat4& model : occluderModels)
+			{
+				occlusionBuffer.addOccluder(sphereMeshData, model);
+			}
+			occlusionBuffer.end();
+			setupMs += occlusionBuffer.getStats().setupMs;
+			rasterMs += occlusionBuffer.getStats().rasterMs;
+		}
+		printf("%d thread(s): %.2f ms setup, %.2f ms raster (%d occluders, %d triangles rasterized)\n", numThreads,
+			setupMs / NUM_FRAMES, rasterMs / NUM_FRAMES, numOccluders, occlusionBuffer.getStats().trianglesRasterized);
+		if (numThreads == 1)
+			singleThreadedDepth = occlusionBuffer.getDepth();
+		else if (occlusionBuffer.getDepth() != singleThreadedDepth)
+			depthMatches = false;
+	}
+	occlusionBuffer.setJobSystem(nullptr);
+	check("Threaded depth matches single threaded", depthMatches);
+
+	int occluded = 0;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < NUM_BOXES; i++)
+	{
+		ew::AABB box;
+		box.min = camera.position + forward * ew::RandomRange(5, 40) + ew::Vec3(ew::RandomRange(-10, 10), ew::RandomRange(-5, 5), ew::RandomRange(-10, 10));
+		box.max = box.min + ew::Vec3(0.5f);
+		occluded += !occlusionBuffer.isVisible(box);
+	}
+	float testMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	printf("%d box tests: %.3f ms (%d occluded)\n", NUM_BOXES, testMs, occluded);
+
+	//One sphere of radius 1 at the origin, 5 units in front of the camera
+	ew::Transform sphereTransform;
+	sphereTransform.scale = ew::Vec3(2.0f);
+	occlusionBuffer.begin(viewProjection);
+	occlusionBuffer.addOccluder(sphereMeshData, sphereTransform.getModelMatrix());
+	occlusionBuffer.end();
+	check("Sphere silhouette has no cracks", coversSilhouette(occlusionBuffer, camera, 1.0f));
+	check("Box behind the sphere is hidden", !occlusionBuffer.isVisible(boxAt(ew::Vec3(0, 0, -3), 0.25f)));
+	check("Box in front of the sphere is visible", occlusionBuffer.isVisible(boxAt(ew::Vec3(0, 0, 2), 0.25f)));
+	check("Box beside the sphere is visible", occlusionBuffer.isVisible(boxAt(ew::Vec3(3, 0, -3), 0.25f)));
+	check("Box crossing the near plane is visible", occlusionBuffer.isVisible(boxAt(camera.position, 0.5f)));
+	return 0;
+}
@@ -0,0 +1,113 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include <chrono>
+
+#include <ew/ewMath/ewMath.h>
+#include <ew/camera.h>
+#include <ew/procGen.h>
+#include <ew/transform.h>
+#include <ew/raycast.h>
+
+//Closest hit found by testing every triangle one at a time, INFINITY if none
+static float raycastEveryTriangle(const ew::MeshData& meshData, const ew::Ray& ray, float maxDistance)
+{
+	float closest = INFINITY;
+	for (size_t i = 0; i + 2 < meshData.indices.size(); i += 3)
+	{
+		ew::Vec3 v0 = meshData.vertices[meshData.indices[i]].pos;
+		ew::Vec3 e1 = meshData.vertices[meshData.indices[i + 1]].pos - v0;
+		ew::Vec3 e2 = meshData.vertices[meshData.indices[i + 2]].pos - v0;
+		ew::Vec3 p = ew::Cross(ray.direction, e2);
+		float det = ew::Dot(e1, p);
+		if (fabsf(det) < 1e-8f)
+			continue;
+		ew::Vec3 s = ray.origin - v0;
+		float u = ew::Dot(s, p) / det;
+		ew::Vec3 q = ew::Cross(s, e1);
+		float v = ew::Dot(ray.direction, q) / det;
+		float t = ew::Dot(e2, q) / det;
+		if (u >= 0 && v >= 0 && u + v <= 1 && t >= 0 && t <= maxDistance)
+			closest = fminf(closest, t);
+	}
+	return closest;
+}
+
+/// <summary>
+/// Casts a grid of rays from the camera at a moved and scaled sphere mesh through its MeshBVH, and checks the hits
+/// against testing each triangle. Also checks the ray through the middle of the screen points at the target.
+/// </summary>
+/// <param name="gridSize">Rays per side of the grid</param>
+/// <returns>0, with failed checks counted by check()</returns>
+int reportPicking(int gridSize)
+{
+	ew::MeshData sphereMeshData = ew::createSphere(0.5f, 64);
+	ew::MeshBVH mesh(sphereMeshData);
+	ew::Transform transform;
+	transform.position = ew::Vec3(0.5f, -0.25f, 0.0f);
+	transform.scale = ew::Vec3(2.0f, 1.0f, 1.5f);
+	ew::Mat4 model = transform.getModelMatrix();
+	ew::Mat4 invModel = ew::Inverse(model);
+
+	ew::Camera camera;
+	ew::Ray centerRay = ew::ScreenPointToRay(camera, 400.0f, 300.0f, 800.0f, 600.0f);
+	ew::Vec3 forward = ew::Normalize(camera.target - camera.position);
+	check("Ray through the middle of the screen points at the target",
+		ew::Magnitude(centerRay.origin - camera.position) < 0.2f && ew::Dot(ew::Normalize(centerRay.direction), forward) > 0.9999f);
+
+	//Grid over a little more than the mesh, so some rays miss
+	ew::AABB bounds = ew::TransformAABB(mesh.getBounds(), model);
+	ew::Vec3 center = bounds.center();
+	ew::Vec3 extents = bounds.extents() * 1.5f;
+	std::vector<ew::Ray> rays;
+	rays.reserve(gridSize * gridSize);
+	for (int y = 0; y < gridSize; y++)
+	{
+		for (int x = 0; x < gridSize; x++)
+		{
+			ew::Vec3 target = center + ew::Vec3(extents.x * (2.0f * x / gridSize - 1.0f), extents.y * (2.0f * y / gridSize - 1.0f), 0);
+			ew::Ray ray;
+			ray.origin = camera.position;
+			ray.direction = ew::Normalize(target - camera.position);
+			rays.push_back(ray);
+		}
+	}
+
+	std::vector<ew::MeshHit> hits(rays.size());
+	std::vector<bool> didHit(rays.size());
+	int numHits = 0;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < rays.size(); i++)
+	{
+		didHit[i] = mesh.raycast(ew::TransformRay(rays[i], invModel), camera.farPlane, &hits[i]);
+		numHits += didHit[i];
+	}
+	float seconds = std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - start).count();
+
+	//Every 7th ray is checked, which covers the whole grid. Rays grazing an edge can land on either
+	//triangle, or slip between them in one test only
+	int mismatches = 0;
+	int numChecked = 0;
+	bool distancesMatch = true;
+	for (size_t i = 0; i < rays.size(); i += 7)
+	{
+		numChecked++;
+		float closest = raycastEveryTriangle(sphereMeshData, ew::TransformRay(rays[i], invModel), camera.farPlane);
+		if (didHit[i] != (closest != INFINITY))
+			mismatches++;
+		else if (didHit[i] && fabsf(hits[i].distance - closest) > 1e-3f)
+			distancesMatch = false;
+	}
+	check("Closest hits match testing every triangle", distancesMatch && mismatches <= numChecked / 1000);
+
+	ew::MeshHit hit;
+	check("World space hit matches local space hit", numHits > 0 && ew::RaycastMesh(mesh, model, rays[rays.size() / 2 + gridSize / 2], camera.farPlane, &hit)
+		&& fabsf(hit.distance - hits[rays.size() / 2 + gridSize / 2].distance) < 1e-3f);
+
+	printf("Sphere, %d triangles: %d rays, %d hits, %d of %d checked rays on an edge\n", (int)mesh.getNumTriangles(), (int)rays.size(), numHits,
+		mismatches, numChecked);
+	printf("%.3f s, %.2f million rays/s\n", seconds, rays.size() / fmaxf(seconds, 1e-9f) / 1000000.0f);
+	return 0;
+}
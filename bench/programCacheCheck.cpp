@@ -0,0 +1,60 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <string>
+#include <filesystem>
+
+#include <ew/external/glad.h>
+#include <ew/glStub.h>
+#include <ew/shader.h>
+#include <ew/programCache.h>
+#include <ew/shaderPreprocessor.h>
+
+/// <summary>
+/// Loads assignment7's lit shader through a fresh ProgramCache on the stub GL backend, as separate launches would:
+/// cold, warm, with an edited source, and with a binary the driver rejects. Prints cold and warm times.
+/// </summary>
+/// <returns>0, with failed checks counted by check()</returns>
+int checkProgramCache()
+{
+	const std::string directory = "shadercache_check";
+	std::error_code error;
+	std::filesystem::remove_all(directory, error);
+
+	auto launch = [&](const char* fragmentShader) {
+		glStats = ew::GLStubStats();
+		ew::ProgramCache cache(directory);
+		ew::Shader shader("assets/defaultLit.vert", fragmentShader, &cache);
+		return cache.getStats();
+	};
+
+	ew::ProgramCacheStats stats = launch("assets/defaultLit.frag");
+	float coldMs = stats.compileMs;
+	check("Cold launch compiles and saves", stats.misses == 1 && glStats.compiles == 2 && glStats.links == 1);
+	stats = launch("assets/defaultLit.frag");
+	check("Warm launch loads the binary", stats.hits == 1 && glStats.compiles == 0 && glStats.programBinaries == 1);
+	printf("Lit shader: %.3f ms compiling cold, %.3f ms loading warm\n", coldMs, stats.loadMs);
+	stats = launch("assets/unlit.frag");
+	check("Other sources miss", stats.misses == 1 && glStats.compiles == 2);
+
+	//Overwrite the binary after the header, as if the driver had changed underneath it
+	ew::ProgramCache pathCache(directory);
+	std::string vertexSource, fragmentSource;
+	ew::PreprocessShader("assets/defaultLit.vert", {}, vertexSource);
+	ew::PreprocessShader("assets/defaultLit.frag", {}, fragmentSource);
+	std::string path = pathCache.getProgramPath(vertexSource.c_str(), fragmentSource.c_str());
+	FILE* file = fopen(path.c_str(), "r+b");
+	if (file)
+	{
+		fseek(file, -4, SEEK_END);
+		fwrite("XXXX", 1, 4, file);
+		fclose(file);
+	}
+	stats = launch("assets/defaultLit.frag");
+	check("Rejected binary is recompiled", file && stats.rejected == 1 && glStats.compiles == 2);
+	stats = launch("assets/defaultLit.frag");
+	check("Recompiled binary replaces it", stats.hits == 1 && glStats.compiles == 0);
+
+	std::filesystem::remove_all(directory, error);
+	return 0;
+}
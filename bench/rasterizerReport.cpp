@@ -0,0 +1,139 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <thread>
+
+#include <ew/ewMath/ewMath.h>
+#include <ew/camera.h>
+#include <ew/procGen.h>
+#include <ew/transform.h>
+#include <ew/rasterizer.h>
+
+static void renderScene(ew::Rasterizer& rasterizer, ew::Framebuffer& framebuffer, const ew::Camera& camera,
+	const ew::MeshData* meshes[], ew::Transform* transforms[], int numShapes, const ew::LitSettings& lit)
+{
+	auto shader = [&lit](const ew::Fragment& fragment) {
+		return ew::ShadeLit(fragment, lit);
+	};
+	framebuffer.clear(ew::Vec3(0.1f));
+	rasterizer.begin(&framebuffer, camera.ProjectionMatrix() * camera.ViewMatrix());
+	for (int i = 0; i < numShapes; i++)
+	{
+		rasterizer.draw(*meshes[i], transforms[i]->getModelMatrix(), shader);
+	}
+	rasterizer.end();
+}
+
+//Draws two triangles covering the whole framebuffer, and checks every pixel was shaded exactly once
+static bool fillsEveryPixelOnce(int width, int height)
+{
+	ew::MeshData quad;
+	quad.vertices.resize(4);
+	quad.vertices[0].pos = ew::Vec3(-1, -1, 0);
+	quad.vertices[1].pos = ew::Vec3(1, -1, 0);
+	quad.vertices[2].pos = ew::Vec3(1, 1, 0);
+	quad.vertices[3].pos = ew::Vec3(-1, 1, 0);
+	quad.indices = { 0, 1, 2, 0, 2, 3 };
+
+	ew::Framebuffer framebuffer(width, height);
+	framebuffer.clear(ew::Vec3(0));
+	std::vector<int> timesShaded(width * height, 0);
+	ew::Rasterizer rasterizer;
+	rasterizer.begin(&framebuffer, ew::Identity());
+	rasterizer.draw(quad, ew::Identity(), [&](const ew::Fragment& fragment) {
+		timesShaded[fragment.y * width + fragment.x]++;
+		return ew::Vec4(1.0f);
+	});
+	rasterizer.end();
+	return std::all_of(timesShaded.begin(), timesShaded.end(), [](int n) { return n == 1; });
+}
+
+/// <summary>
+/// Renders assignment7's default scene on the CPU, single threaded and then on the job system, and prints frame
+/// timings. Checks both give the same image, that back faces are culled, and that the fill rule leaves no gaps or
+/// overlaps along a shared edge.
+/// </summary>
+/// <param name="outputPath">Writes the image as a PPM here, if not NULL</param>
+/// <returns>0, or 1 if the texture or the output image couldn't be opened</returns>
+int reportRasterizer(const char* outputPath)
+{
+	const int WIDTH = 1080;
+	const int HEIGHT = 720;
+	const int NUM_SHAPES = 4;
+	const int NUM_FRAMES = 10;
+	ew::MeshData cubeMeshData = ew::createCube(1.0f);
+	ew::MeshData planeMeshData = ew::createPlane(5.0f, 5.0f, 10);
+	ew::MeshData sphereMeshData = ew::createSphere(0.5f, 64);
+	ew::MeshData cylinderMeshData = ew::createCylinder(0.5f, 1.0f, 32);
+	const ew::MeshData* shapeMeshData[NUM_SHAPES] = { &cubeMeshData, &planeMeshData, &sphereMeshData, &cylinderMeshData };
+
+	ew::Transform cubeTransform;
+	ew::Transform planeTransform;
+	ew::Transform sphereTransform;
+	ew::Transform cylinderTransform;
+	planeTransform.position = ew::Vec3(0, -1.0, 0);
+	sphereTransform.position = ew::Vec3(-1.5f, 0.0f, 0.0f);
+	cylinderTransform.position = ew::Vec3(1.5f, 0.0f, 0.0f);
+	ew::Transform* shapeTransforms[NUM_SHAPES] = { &cubeTransform, &planeTransform, &sphereTransform, &cylinderTransform };
+
+	ew::Camera camera;
+	camera.aspectRatio = (float)WIDTH / HEIGHT;
+
+	ew::Image brickImage = ew::loadImage("assets/brick_color.jpg");
+	if (!brickImage.isValid())
+	{
+		printf("Failed to load assets/brick_color.jpg\n");
+		return 1;
+	}
+	ew::PointLight light;
+	light.position = ew::Vec3(2.0f, 2.0f, 0.0f);
+	light.color = ew::Vec3(1.0f);
+	ew::LitSettings lit;
+	lit.cameraPosition = camera.position;
+	lit.lights = &light;
+	lit.numLights = 1;
+	lit.texture = &brickImage;
+
+	//At least 4 threads, so tiles are split across workers even on a single core
+	ew::JobSystem jobSystem(std::max(3, (int)std::thread::hardware_concurrency() - 1));
+	ew::Rasterizer rasterizer;
+	ew::Framebuffer framebuffers[2];
+	ew::RasterStats stats[2];
+	for (int pass = 0; pass < 2; pass++)
+	{
+		framebuffers[pass].resize(WIDTH, HEIGHT);
+		rasterizer.setJobSystem(pass == 0 ? nullptr : &jobSystem);
+		float setupMs = 0;
+		float rasterMs = 0;
+		for (int i = 0; i < NUM_FRAMES; i++)
+		{
+			renderScene(rasterizer, framebuffers[pass], camera, shapeMeshData, shapeTransforms, NUM_SHAPES, lit);
+			setupMs += rasterizer.getStats().setupMs;
+			rasterMs += rasterizer.getStats().rasterMs;
+		}
+		stats[pass] = rasterizer.getStats();
+		printf("%d thread(s): %.2f ms setup, %.2f ms raster per frame (%d triangles, %d fragments)\n",
+			pass == 0 ? 1 : jobSystem.getNumThreads(), setupMs / NUM_FRAMES, rasterMs / NUM_FRAMES,
+			stats[pass].trianglesRasterized, stats[pass].fragmentsShaded);
+	}
+
+	check("Threaded image matches single threaded", framebuffers[0].color == framebuffers[1].color && framebuffers[0].depth == framebuffers[1].depth);
+	check("Threaded stats match single threaded", stats[0].trianglesRasterized == stats[1].trianglesRasterized
+		&& stats[0].fragmentsShaded == stats[1].fragmentsShaded);
+	check("Back faces are culled", stats[0].trianglesCulled > 0 && stats[0].trianglesRasterized < stats[0].trianglesSubmitted);
+	//The cube sits in the middle of the screen, and nothing covers the top corner
+	const ew::Framebuffer& image = framebuffers[0];
+	check("Cube covers the middle, the corner is cleared", image.depth[(HEIGHT / 2) * WIDTH + WIDTH / 2] < 1.0f && image.depth[0] == 1.0f);
+	check("Shared edge is filled once", fillsEveryPixelOnce(256, 192));
+
+	if (outputPath)
+	{
+		if (!image.save(outputPath))
+		{
+			return 1;
+		}
+		printf("Wrote %s\n", outputPath);
+	}
+	return 0;
+}
@@ -0,0 +1,137 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+
+#include <ew/external/glad.h>
+#include <ew/ewMath/ewMath.h>
+#include <ew/glStub.h>
+#include <ew/shader.h>
+#include <ew/mesh.h>
+#include <ew/procGen.h>
+#include <ew/transform.h>
+#include <ew/renderQueue.h>
+
+/// <summary>
+/// Draws numDraws objects with random programs, textures and meshes on the stub GL backend, once per object
+/// in submission order the way the scene used to, and once through a RenderQueue. Prints the GL state changes
+/// for each, then times the radix sort against std::stable_sort on the same keys. Checks the queue binds each
+/// program once and makes fewer state changes than either order, its counts match the GL calls made, the first
+/// bind of a sampler after an untextured draw isn't skipped, uniform locations are only looked up again after
+/// invalidatePrograms(), and the radix sort agrees with std::stable_sort.
+/// </summary>
+/// <param name="numDraws">Random draws to submit</param>
+/// <returns>0, with failed checks counted by check()</returns>
+int reportRenderQueue(int numDraws)
+{
+	const int NUM_PROGRAMS = 8;
+	const int NUM_TEXTURES = 32;
+	const int NUM_MESHES = 16;
+	ew::MeshData meshData = ew::createCube(1.0f);
+	std::vector<ew::Mesh> meshes(NUM_MESHES);
+	std::vector<ew::Shader> programs;
+	std::vector<unsigned int> textures(NUM_TEXTURES);
+	for (int i = 0; i < NUM_MESHES; i++)
+		meshes[i].load(meshData);
+	for (int i = 0; i < NUM_PROGRAMS; i++)
+		programs.push_back(ew::Shader(glCreateProgram()));
+	glGenTextures(NUM_TEXTURES, textures.data());
+	unsigned int sampler = 0;
+	glGenSamplers(1, &sampler);
+
+	struct Draw {
+		int program, texture, mesh;
+		ew::Mat4 model;
+		float depth;
+	};
+	std::vector<Draw> draws(numDraws);
+	for (Draw& draw : draws)
+	{
+		draw.program = rand() % NUM_PROGRAMS;
+		draw.texture = rand() % NUM_TEXTURES;
+		draw.mesh = rand() % NUM_MESHES;
+		ew::Transform transform;
+		transform.position = ew::Vec3(ew::RandomRange(-50, 50), ew::RandomRange(-50, 50), ew::RandomRange(-50, 50));
+		draw.model = transform.getModelMatrix();
+		draw.depth = ew::Magnitude(transform.position);
+	}
+
+	glStats = ew::GLStubStats();
+	for (const Draw& draw : draws)
+	{
+		programs[draw.program].use();
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, textures[draw.texture]);
+		glBindSampler(0, sampler);
+		programs[draw.program].setMat4("_Model", draw.model);
+		meshes[draw.mesh].draw();
+	}
+	int perDrawChanges = glStats.getStateChanges();
+	printf("Per draw binds: %d draws, %d state changes\n", glStats.draws, perDrawChanges);
+
+	ew::RenderQueue renderQueue;
+	glStats = ew::GLStubStats();
+	renderQueue.clear();
+	for (const Draw& draw : draws)
+		renderQueue.submit(programs[draw.program], textures[draw.texture], sampler, meshes[draw.mesh], draw.model, draw.depth);
+	renderQueue.execute([](const ew::Shader& program) { program.setInt("_Texture", 0); });
+	const ew::RenderQueueStats& stats = renderQueue.getStats();
+	printf("Render queue: %d draws, %d state changes (%d programs, %d textures, %d samplers, %d meshes, %d in submission order), "
+		"%d GL state calls, %.3f ms sort\n", glStats.draws, stats.getStateChanges(), stats.programChanges, stats.textureChanges,
+		stats.samplerChanges, stats.meshChanges, stats.unsortedStateChanges, glStats.getStateChanges(), stats.sortMs);
+	check("Every draw is issued, with each program bound once", stats.draws == numDraws && glStats.draws == numDraws
+		&& stats.programChanges == NUM_PROGRAMS);
+	check("Sorting makes fewer state changes than per draw or submission order", glStats.getStateChanges() < perDrawChanges
+		&& stats.getStateChanges() < stats.unsortedStateChanges);
+	check("Counted changes match the GL calls made", glStats.useProgram == stats.programChanges && glStats.bindTexture == stats.textureChanges
+		&& glStats.bindSampler == stats.samplerChanges && glStats.bindVertexArray == stats.meshChanges);
+
+	//An untextured draw sorts first, then a textured one with sampler 0, which still has to be bound
+	glStats = ew::GLStubStats();
+	renderQueue.clear();
+	renderQueue.submit(programs[0], 0, 0, meshes[0], ew::Mat4(1), 1.0f, ew::Vec3(1));
+	renderQueue.submit(programs[0], textures[0], 0, meshes[0], ew::Mat4(1), 2.0f);
+	renderQueue.execute([](const ew::Shader& program) {});
+	check("The first texture and sampler binds are never skipped", glStats.bindTexture == 1 && glStats.bindSampler == 1
+		&& renderQueue.getStats().unsortedStateChanges == 4);
+
+	//Each frame only looks up _Model and _Color for programs it hasn't seen
+	int lookups[3];
+	for (int frame = 0; frame < 3; frame++)
+	{
+		if (frame == 2)
+			renderQueue.invalidatePrograms();
+		glStats = ew::GLStubStats();
+		renderQueue.clear();
+		for (const Draw& draw : draws)
+			renderQueue.submit(programs[draw.program], textures[draw.texture], sampler, meshes[draw.mesh], draw.model, draw.depth);
+		renderQueue.execute([](const ew::Shader& program) {});
+		lookups[frame] = glStats.uniformLookups;
+	}
+	check("Uniform locations are kept until programs are invalidated", lookups[0] == 0 && lookups[1] == 0
+		&& lookups[2] == 2 * NUM_PROGRAMS);
+
+	//The same keys sorted both ways
+	std::vector<ew::RenderKey> keys(numDraws), scratch;
+	for (int i = 0; i < numDraws; i++)
+	{
+		keys[i].key = ((uint64_t)rand() << 48) ^ ((uint64_t)rand() << 32) ^ ((uint64_t)rand() << 16) ^ (uint64_t)rand();
+		keys[i].item = i;
+	}
+	std::vector<ew::RenderKey> sorted = keys;
+	auto start = std::chrono::high_resolution_clock::now();
+	ew::RadixSortKeys(sorted, scratch);
+	float radixMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	start = std::chrono::high_resolution_clock::now();
+	std::stable_sort(keys.begin(), keys.end(), [](const ew::RenderKey& a, const ew::RenderKey& b) { return a.key < b.key; });
+	float stdMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	bool same = true;
+	for (int i = 0; i < numDraws; i++)
+		same = same && sorted[i].item == keys[i].item;
+	printf("Sorting %d keys: radix %.3f ms, std::stable_sort %.3f ms\n", numDraws, radixMs, stdMs);
+	check("Radix sort orders keys like std::stable_sort", same);
+	return 0;
+}
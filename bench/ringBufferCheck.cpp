@@ -0,0 +1,95 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+
+#include <ew/glStub.h>
+#include <ew/ringBuffer.h>
+
+/// <summary>
+/// Streams frames of random allocations through a RingBuffer on the stub GL backend, whose fences only signal when
+/// waited on or when the GPU is said to have caught up. Checks the triple buffering, the wraparound, and that no
+/// allocation overlaps anything from a frame the GPU hasn't finished. Prints a line per check.
+/// </summary>
+/// <returns>0, with failed checks counted by check()</returns>
+int checkRingBuffer()
+{
+	ew::RingBuffer ring;
+	check("Creates and maps", ring.create(1024, 3) && ring.getSize() == 3072);
+	size_t offsets[4];
+	bool aligned = true;
+	for (int frame = 0; frame < 3; frame++)
+	{
+		ring.beginFrame();
+		unsigned char* data = (unsigned char*)ring.allocate(1000, 16, &offsets[frame]);
+		aligned = aligned && data && offsets[frame] % 16 == 0;
+		ring.endFrame();
+	}
+	check("Allocations are aligned and in order", aligned && offsets[0] == 0 && offsets[1] == 1008 && offsets[2] == 2016);
+	check("Three frames in flight without waiting", ring.getStats().stalls == 0 && ring.getFramesInFlight() == 3);
+	ring.beginFrame();
+	check("A fourth frame waits for the first", ring.getStats().stalls == 1 && glStats.fencesSignaled == 1);
+	ring.allocate(900, 16, &offsets[3]);
+	check("Wraps into the first frame's space", offsets[3] == 0 && ring.getStats().wraps == 1 && ring.getStats().stalls == 1);
+	ring.endFrame();
+	ew::signalGLStubFences();
+	ring.beginFrame();
+	check("Frames the GPU finished retire without waiting", ring.getStats().stalls == 1 && ring.getFramesInFlight() == 0);
+	size_t offset;
+	check("Oversized allocations fail", ring.allocate(4096, 16, &offset) == nullptr);
+	ring.endFrame();
+
+	//Random frames, with the GPU catching up now and then. Fences signal in order, so every frame before
+	//fencesSignaled is finished and anything from a later one must be left alone.
+	struct Range {
+		size_t begin, end;
+		int frame;
+		const unsigned char* data;
+	};
+	std::vector<Range> live;
+	int firstFrame = glStats.fences;
+	bool overlapped = false;
+	bool contentsKept = true;
+	for (int frame = 0; frame < 2000; frame++)
+	{
+		if (rand() % 4 == 0)
+			ew::signalGLStubFences();
+		ring.beginFrame();
+		int numAllocations = 1 + rand() % 8;
+		for (int i = 0; i < numAllocations; i++)
+		{
+			size_t size = 1 + rand() % 300;
+			unsigned char* data = (unsigned char*)ring.allocate(size, (size_t)1 << (rand() % 9), &offset);
+			if (!data)
+			{
+				overlapped = true;
+				continue;
+			}
+			int finished = glStats.fencesSignaled - firstFrame;
+			for (const Range& range : live)
+			{
+				if (range.frame >= finished && offset < range.end && range.begin < offset + size)
+					overlapped = true;
+			}
+			live.erase(std::remove_if(live.begin(), live.end(), [&](const Range& range) { return range.frame < finished; }), live.end());
+			//Stamp each allocation with its frame, and check the stamps of everything still live
+			memset(data, frame & 0xFF, size);
+			live.push_back({ offset, offset + size, frame, data });
+		}
+		for (const Range& range : live)
+		{
+			for (size_t i = 0; i < range.end - range.begin; i++)
+				contentsKept = contentsKept && range.data[i] == (range.frame & 0xFF);
+		}
+		ring.endFrame();
+	}
+	check("Never overwrites a frame the GPU hasn't finished", !overlapped);
+	check("Live allocations keep their contents", contentsKept);
+	const ew::RingBufferStats& stats = ring.getStats();
+	printf("2000 random frames: %d wraps, %d stalls, %d fences\n", stats.wraps, stats.stalls, glStats.fences);
+	ring.destroy();
+	return 0;
+}
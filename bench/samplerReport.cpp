@@ -0,0 +1,107 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <vector>
+#include <chrono>
+
+#include <ew/external/glad.h>
+#include <ew/sampler.h>
+
+static float getSamplerParameter(unsigned int sampler, int name)
+{
+	float value = 0;
+	glGetSamplerParameterfv(sampler, name, &value);
+	return value;
+}
+
+//The sampler holds every field of the state, with anisotropy clamped to the stub's limit of 16
+static bool matchesState(unsigned int sampler, const ew::SamplerState& state)
+{
+	float anisotropy = state.maxAnisotropy < 1.0f ? 1.0f : (state.maxAnisotropy > 16.0f ? 16.0f : state.maxAnisotropy);
+	return getSamplerParameter(sampler, GL_TEXTURE_MIN_FILTER) == state.minFilter
+		&& getSamplerParameter(sampler, GL_TEXTURE_MAG_FILTER) == state.magFilter
+		&& getSamplerParameter(sampler, GL_TEXTURE_WRAP_S) == state.wrapS
+		&& getSamplerParameter(sampler, GL_TEXTURE_WRAP_T) == state.wrapT
+		&& getSamplerParameter(sampler, GL_TEXTURE_MAX_ANISOTROPY) == anisotropy
+		&& getSamplerParameter(sampler, GL_TEXTURE_LOD_BIAS) == state.lodBias
+		&& getSamplerParameter(sampler, GL_TEXTURE_BORDER_COLOR) == state.borderColor.x;
+}
+
+/// <summary>
+/// Looks up a sampler for many textures that share a few wrap and filter settings, on the stub backend, and prints how
+/// many GL samplers were made. Checks equal states share a sampler, any changed field gets a new one, created samplers
+/// hold their state with anisotropy clamped to the driver's limit, binds set texture and sampler together, and clearing
+/// or destroying the cache deletes every sampler.
+/// </summary>
+/// <param name="numTextures">Textures looking up a sampler</param>
+/// <returns>0, with failed checks counted by check()</returns>
+int reportSampler(int numTextures)
+{
+	const int WRAP_MODES[3] = { GL_REPEAT, GL_CLAMP_TO_EDGE, GL_MIRRORED_REPEAT };
+	const int FILTER_MODES[2] = { GL_LINEAR, GL_NEAREST };
+	{
+		ew::SamplerCache samplerCache;
+		std::vector<unsigned int> samplers(numTextures);
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < numTextures; i++)
+		{
+			samplers[i] = samplerCache.get(ew::MakeSamplerState(WRAP_MODES[i % 3], FILTER_MODES[i / 3 % 2]));
+		}
+		float lookupMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		printf("%d textures: %d samplers created, %.3f ms for every lookup\n", numTextures, glStats.samplersCreated, lookupMs);
+		bool shared = samplerCache.getNumSamplers() == 6 && glStats.samplersCreated == 6 && samplerCache.getLookups() == numTextures;
+		for (int i = 6; i < numTextures; i++)
+		{
+			shared = shared && samplers[i] == samplers[i % 6];
+		}
+		check("Textures with the same settings share a sampler", shared);
+
+		ew::SamplerState base = ew::MakeSamplerState(GL_CLAMP_TO_BORDER, GL_LINEAR);
+		std::vector<ew::SamplerState> variants(8, base);
+		variants[1].minFilter = GL_LINEAR_MIPMAP_NEAREST;
+		variants[2].magFilter = GL_NEAREST;
+		variants[3].wrapS = GL_REPEAT;
+		variants[4].wrapT = GL_REPEAT;
+		variants[5].maxAnisotropy = 8.0f;
+		variants[6].lodBias = -0.5f;
+		variants[7].borderColor = ew::Vec4(1, 0, 0, 1);
+		int createdBefore = samplerCache.getCreated();
+		bool distinct = true;
+		bool stored = true;
+		std::vector<unsigned int> variantSamplers;
+		for (const ew::SamplerState& state : variants)
+		{
+			unsigned int sampler = samplerCache.get(state);
+			for (unsigned int other : variantSamplers)
+				distinct = distinct && sampler != other;
+			variantSamplers.push_back(sampler);
+			stored = stored && matchesState(sampler, state);
+		}
+		check("Changing any field gets another sampler", distinct && samplerCache.getCreated() == createdBefore + 8
+			&& ew::SamplerStateHash()(base) == ew::SamplerStateHash()(variants[0]));
+		check("Samplers hold their state", stored);
+
+		ew::SamplerState sharp = base;
+		sharp.maxAnisotropy = 64.0f;
+		ew::SamplerState flat = base;
+		flat.maxAnisotropy = 0.0f;
+		check("Anisotropy is clamped to the driver's limit", matchesState(samplerCache.get(sharp), sharp) && matchesState(samplerCache.get(flat), flat));
+
+		ew::SamplerState nearest = ew::MakeSamplerState(GL_REPEAT, GL_NEAREST);
+		ew::SamplerState linear = ew::MakeSamplerState(GL_REPEAT, GL_LINEAR, false);
+		check("Filter modes get matching minification filters", nearest.minFilter == GL_NEAREST_MIPMAP_NEAREST && nearest.magFilter == GL_NEAREST
+			&& linear.minFilter == GL_LINEAR && ew::MakeSamplerState(GL_REPEAT, GL_NEAREST, false).minFilter == GL_NEAREST);
+
+		ew::GLStubStats before = glStats;
+		samplerCache.bind(3, 7, samplers[0]);
+		check("Bind sets the texture and sampler together", glStats.activeTexture == before.activeTexture + 1
+			&& glStats.bindTexture == before.bindTexture + 1 && glStats.bindSampler == before.bindSampler + 1);
+
+		samplerCache.clear();
+		bool cleared = samplerCache.getNumSamplers() == 0 && glStats.getLiveSamplers() == 0;
+		samplerCache.get(base);
+		check("Clearing deletes every sampler and later lookups make new ones", cleared && glStats.getLiveSamplers() == 1);
+	}
+	check("Destroying the cache deletes every sampler", glStats.getLiveSamplers() == 0);
+	return 0;
+}
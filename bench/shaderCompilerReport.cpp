@@ -0,0 +1,75 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <filesystem>
+
+#include <ew/external/glad.h>
+#include <ew/glStub.h>
+#include <ew/programCache.h>
+#include <ew/shaderCompiler.h>
+
+/// <summary>
+/// Submits many programs to a ShaderCompiler on the stub GL backend, which compiles in parallel, then again through a
+/// warm ProgramCache, printing submit and wait times. Checks the parallel extension is used when the loader has it,
+/// submits issue compiles and links without blocking, every program is handed out once, and cached programs skip compiling.
+/// </summary>
+/// <param name="numPrograms">Programs to build</param>
+/// <returns>0, with failed checks counted by check()</returns>
+int reportShaderCompiler(int numPrograms)
+{
+	const std::string directory = "shadercache_compiler";
+	std::error_code error;
+	std::filesystem::remove_all(directory, error);
+	//Every program has its own sources, so each one is its own cache entry
+	std::vector<std::string> vertexSources, fragmentSources;
+	for (int i = 0; i < numPrograms; i++)
+	{
+		vertexSources.push_back("#version 450\n//Program " + std::to_string(i) + "\nvoid main() { gl_Position = vec4(0.0); }\n");
+		fragmentSources.push_back("#version 450\n//Program " + std::to_string(i) + "\nout vec4 FragColor;\nvoid main() { FragColor = vec4(1.0); }\n");
+	}
+
+	for (int warm = 0; warm < 2; warm++)
+	{
+		glStats = ew::GLStubStats();
+		ew::ProgramCache programCache(directory);
+		ew::ShaderCompiler compiler(ew::getGLStubProc, &programCache);
+		std::vector<int> ids;
+		for (int i = 0; i < numPrograms; i++)
+			ids.push_back(compiler.submit(vertexSources[i].c_str(), fragmentSources[i].c_str()));
+		int pending = compiler.getNumPending();
+		bool ready = true;
+		for (int id : ids)
+			ready = ready && compiler.isReady(id);
+		std::vector<unsigned int> programs;
+		for (int id : ids)
+			programs.push_back(compiler.get(id));
+		const ew::ShaderCompilerStats& stats = compiler.getStats();
+		printf("%s: %d programs, %.3f ms submitting, %.3f ms waiting, %d from cache, %d compiles, %d links\n", warm ? "Warm" : "Cold",
+			numPrograms, stats.submitMs, stats.waitMs, stats.cached, glStats.compiles, glStats.links);
+		bool handedOut = stats.finished == numPrograms && stats.failed == 0 && compiler.getNumPending() == 0;
+		for (unsigned int program : programs)
+			handedOut = handedOut && program != 0;
+		if (!warm)
+		{
+			check("Parallel compile is used when the driver has it", stats.parallel);
+			//The stub reports programs complete as soon as they are linked
+			check("Submits compile and link every program before any is taken", glStats.compiles == 2 * numPrograms
+				&& glStats.links == numPrograms && pending == 0 && ready);
+			check("Every program is handed out once", handedOut);
+		}
+		else
+		{
+			check("Cached programs skip compiling", stats.cached == numPrograms && glStats.compiles == 0 && glStats.links == 0
+				&& glStats.programBinaries == numPrograms && handedOut);
+		}
+	}
+
+	//Without a loader the compiler can't raise the thread count, and can't ask whether a program is done
+	ew::ShaderCompiler serial;
+	int id = serial.submit(vertexSources[0].c_str(), fragmentSources[0].c_str());
+	check("Without the extension programs still build", !serial.getStats().parallel && serial.isReady(id) && serial.get(id) != 0);
+	std::filesystem::remove_all(directory, error);
+	return 0;
+}
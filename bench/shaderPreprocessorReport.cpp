@@ -0,0 +1,107 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <filesystem>
+
+#include <ew/glStub.h>
+#include <ew/shaderCompiler.h>
+#include <ew/shaderPreprocessor.h>
+
+static bool writeText(const std::string& filePath, const char* text)
+{
+	FILE* file = fopen(filePath.c_str(), "wb");
+	if (file == NULL)
+		return false;
+	fputs(text, file);
+	fclose(file);
+	return true;
+}
+
+static int countOf(const std::string& text, const char* part)
+{
+	int count = 0;
+	for (size_t i = text.find(part); i != std::string::npos; i = text.find(part, i + 1))
+		count++;
+	return count;
+}
+
+/// <summary>
+/// Expands a small tree of shader files with nested and repeated includes, and checks the output line for line:
+/// defines after #version, every file once, and #line directives pointing back at each file. Checks broken includes
+/// fail, define hashes ignore order, and variants are built once per define set. Then preprocesses the assignments'
+/// shaders that share code through includes, printing the time taken.
+/// </summary>
+/// <returns>0, with failed checks counted by check()</returns>
+int reportShaderPreprocessor()
+{
+	const std::string directory = "bench_shaders";
+	std::error_code error;
+	std::filesystem::remove_all(directory, error);
+	std::filesystem::create_directories(directory + "/common", error);
+	writeText(directory + "/main.vert", "#version 450\nvoid main() { gl_Position = vec4(0.0); }\n");
+	writeText(directory + "/main.frag", "#version 450\n#include \"common/a.glsl\"\n  #include \"b.glsl\"\nvoid main() {}\n");
+	writeText(directory + "/common/a.glsl", "//A\n#include \"../b.glsl\"\nfloat a() { return 1.0; }\n");
+	writeText(directory + "/b.glsl", "//B\nfloat b() { return 2.0; }\n");
+	writeText(directory + "/missing.frag", "#version 450\n#include \"missing.glsl\"\n");
+	writeText(directory + "/malformed.frag", "#version 450\n#include \"b.glsl\n");
+
+	std::string source;
+	std::vector<std::string> files;
+	bool expanded = ew::PreprocessShader(directory + "/main.frag", { { "X" }, { "Y", "2" } }, source, &files);
+	const char* EXPECTED = "#version 450\n#define X 1\n#define Y 2\n#line 2 0\n"
+		"#line 1 1\n//A\n#line 1 2\n//B\nfloat b() { return 2.0; }\n#line 3 1\nfloat a() { return 1.0; }\n#line 3 0\n"
+		"#line 4 0\nvoid main() {}\n";
+	check("Includes are expanded once each after the defines, with #line directives", expanded && source == EXPECTED
+		&& files.size() == 3 && files[1] == directory + "/common/a.glsl" && files[2] == directory + "/b.glsl");
+	check("Missing or malformed includes fail", !ew::PreprocessShader(directory + "/missing.frag", {}, source)
+		&& !ew::PreprocessShader(directory + "/malformed.frag", {}, source) && !ew::PreprocessShader(directory + "/none.frag", {}, source));
+
+	check("Define hashes ignore order but not values", ew::HashShaderDefines({ { "A" }, { "B", "2" } }) == ew::HashShaderDefines({ { "B", "2" }, { "A" } })
+		&& ew::HashShaderDefines({ { "A" } }) != ew::HashShaderDefines({ { "A", "2" } })
+		&& ew::HashShaderDefines({ { "AB", "C" } }) != ew::HashShaderDefines({ { "A", "BC" } }));
+	std::vector<ew::ShaderDefines> permutations = ew::MakeShaderPermutations({ "A", "B", "C" }, { { "BASE" } });
+	bool permuted = permutations.size() == 8;
+	for (size_t i = 0; i < permutations.size() && permuted; i++)
+	{
+		size_t toggled = (i & 1) + ((i >> 1) & 1) + ((i >> 2) & 1);
+		permuted = permutations[i].size() == 1 + toggled && permutations[i][0].name == "BASE";
+		for (size_t j = i + 1; j < permutations.size() && permuted; j++)
+			permuted = ew::HashShaderDefines(permutations[i]) != ew::HashShaderDefines(permutations[j]);
+	}
+	check("Permutations cover every combination once", permuted);
+
+	{
+		ew::ShaderCompiler compiler(ew::getGLStubProc);
+		ew::ShaderVariantCache variants(directory + "/main.vert", directory + "/main.frag", &compiler);
+		for (const ew::ShaderDefines& defines : permutations)
+			variants.prepare(defines);
+		int compilesBefore = glStats.compiles;
+		for (int pass = 0; pass < 2; pass++)
+		{
+			for (const ew::ShaderDefines& defines : permutations)
+				variants.get(ew::ShaderDefines(defines.rbegin(), defines.rend()));
+		}
+		check("Each define set is built once", variants.getNumVariants() == 8 && variants.getStats().variants == 8
+			&& variants.getStats().failed == 0 && compiler.getStats().finished == 8 && compiler.getStats().failed == 0
+			&& compilesBefore == 16 && glStats.compiles == compilesBefore && variants.getStats().lookups == 16);
+	}
+	std::filesystem::remove_all(directory, error);
+
+	//The assignments' shaders that pull shared code in through includes
+	const char* shaderPaths[3] = { "assets/background.frag", "assets/character.frag", "assets/defaultLit.frag" };
+	const char* sharedCode[3] = { "vec4 sampleRegion(", "vec4 sampleRegion(", "struct Light" };
+	bool shared = true;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < 3; i++)
+	{
+		shared = shared && ew::PreprocessShader(shaderPaths[i], { { "PHONG_SPECULAR" } }, source) && countOf(source, sharedCode[i]) == 1
+			&& countOf(source, "\n#include") == 0;
+	}
+	float preprocessMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	printf("Assignment shaders: %.3f ms to preprocess 3 files\n", preprocessMs);
+	check("Assignment shaders get their shared code from includes", shared);
+	return 0;
+}
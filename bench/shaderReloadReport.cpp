@@ -0,0 +1,125 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <filesystem>
+
+#include <ew/fileWatcher.h>
+#include <ew/shaderCompiler.h>
+#include <ew/shaderPreprocessor.h>
+
+static bool writeText(const std::string& filePath, const char* text)
+{
+	FILE* file = fopen(filePath.c_str(), "wb");
+	if (file == NULL)
+		return false;
+	fputs(text, file);
+	fclose(file);
+	return true;
+}
+
+//Waits up to a second for the watcher to report something, returning how long it took
+static float waitForChanges(ew::FileWatcher& watcher, std::vector<std::string>& changes)
+{
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < 200; i++)
+	{
+		changes = watcher.takeChanges();
+		if (!changes.empty())
+			break;
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+	return std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static bool contains(const std::vector<std::string>& files, const std::string& file)
+{
+	return std::find(files.begin(), files.end(), file) != files.end();
+}
+
+/// <summary>
+/// Edits shader files under a FileWatcher, both polling and with notifications where the platform has them, printing
+/// how long each change took to be seen. Checks only watched files are reported, once each, files replaced by a rename
+/// are still seen, edits to an include rebuild only the variants that read it, and a rebuild that fails keeps the old
+/// program until the file is fixed.
+/// </summary>
+/// <returns>0, with failed checks counted by check()</returns>
+int reportShaderReload()
+{
+	const std::string directory = "bench_reload";
+	std::error_code error;
+	std::filesystem::remove_all(directory, error);
+	std::filesystem::create_directories(directory, error);
+	writeText(directory + "/lit.vert", "#version 450\nvoid main() { gl_Position = vec4(0.0); }\n");
+	writeText(directory + "/lit.frag", "#version 450\n#include \"light.glsl\"\nvoid main() {}\n");
+	writeText(directory + "/light.glsl", "float light() { return 1.0; }\n");
+	writeText(directory + "/unlit.frag", "#version 450\nvoid main() {}\n");
+	writeText(directory + "/other.glsl", "//Not watched\n");
+
+	const char* modeNames[2] = { "Polling", "Notifications" };
+	for (int notify = 0; notify < 2; notify++)
+	{
+		ew::FileWatcher watcher(notify == 1, 10);
+		if (notify && !watcher.isNotifying())
+		{
+			printf("%s: unavailable\n", modeNames[notify]);
+			continue;
+		}
+		watcher.watch(directory + "/light.glsl");
+		watcher.watch(directory + "/./light.glsl");
+		watcher.watch(directory + "/lit.frag");
+		//Polling compares modification times, so let the clock move on, and drop anything seen while the files settled
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		watcher.takeChanges();
+		writeText(directory + "/other.glsl", "//Still not watched\n");
+		writeText(directory + "/light.glsl", "float light() { return 2.0; }\n");
+		writeText(directory + "/light.glsl", "float light() { return 3.0; }\n");
+		std::vector<std::string> changes;
+		float detectMs = waitForChanges(watcher, changes);
+		printf("%s: change seen after %.1f ms\n", modeNames[notify], detectMs);
+		check(notify ? "Notifications report watched files once each" : "Polling reports watched files once each",
+			changes.size() == 1 && changes[0] == directory + "/light.glsl");
+
+		//Editors that save to a temporary file and rename it over the original
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		watcher.takeChanges();
+		writeText(directory + "/lit.frag.tmp", "#version 450\n#include \"light.glsl\"\nvoid main() { }\n");
+		std::filesystem::rename(directory + "/lit.frag.tmp", directory + "/lit.frag", error);
+		waitForChanges(watcher, changes);
+		check(notify ? "Notifications see files replaced by a rename" : "Polling sees files replaced by a rename",
+			changes.size() == 1 && changes[0] == directory + "/lit.frag");
+	}
+
+	ew::ShaderCompiler compiler(ew::getGLStubProc);
+	ew::ShaderVariantCache litShaders(directory + "/lit.vert", directory + "/lit.frag", &compiler);
+	ew::ShaderVariantCache unlitShaders(directory + "/lit.vert", directory + "/unlit.frag", &compiler);
+	unsigned int litPrograms[2] = { litShaders.get({}).getID(), litShaders.get({ { "PHONG" } }).getID() };
+	unsigned int unlitProgram = unlitShaders.get({}).getID();
+	std::vector<std::string> files = litShaders.getFiles();
+	check("Variants list every file they read", files.size() == 3 && contains(files, directory + "/light.glsl")
+		&& unlitShaders.getFiles().size() == 2);
+
+	int compilesBefore = glStats.compiles;
+	std::vector<std::string> changed = { directory + "/light.glsl" };
+	int litReloads = litShaders.update(changed);
+	int unlitReloads = unlitShaders.update(changed);
+	unsigned int reloaded = litShaders.get({}).getID();
+	check("An include edit rebuilds only the variants that read it", litReloads == 2 && unlitReloads == 0
+		&& glStats.compiles == compilesBefore + 4 && reloaded != litPrograms[0] && reloaded != litPrograms[1]
+		&& unlitShaders.get({}).getID() == unlitProgram && litShaders.update() == 0);
+
+	//Deleting the include makes the rebuild fail to preprocess
+	std::filesystem::remove(directory + "/light.glsl", error);
+	int failedReloads = litShaders.update(changed);
+	bool kept = failedReloads == 0 && litShaders.getStats().reloadFailures == 2 && litShaders.get({}).getID() == reloaded;
+	writeText(directory + "/light.glsl", "float light() { return 4.0; }\n");
+	int fixedReloads = litShaders.update(changed);
+	check("A failed rebuild keeps the old program until the file is fixed", kept && fixedReloads == 2
+		&& litShaders.getStats().reloads == 4 && litShaders.get({}).getID() != reloaded);
+	std::filesystem::remove_all(directory, error);
+	return 0;
+}
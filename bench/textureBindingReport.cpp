@@ -0,0 +1,116 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <string>
+
+#include <ew/external/glad.h>
+#include <ew/glStub.h>
+#include <ew/textureTable.h>
+
+/// <summary>
+/// Replays assignment3's texture setup through the stub GL backend: first binding each texture to its own unit and
+/// setting its sampler uniform per draw, then with a texture table for every backend. Prints state changes per frame.
+/// Checks every table makes fewer changes than per draw binding, commits only when something changed or forced,
+/// reuses removed slots, and declares its lookup function for shaders.
+/// </summary>
+/// <param name="frames">Frames to replay</param>
+/// <returns>0, with failed checks counted by check()</returns>
+int reportTextureBinding(int frames)
+{
+	unsigned int textures[3];
+	unsigned int samplers[3];
+	glGenTextures(3, textures);
+	glGenSamplers(3, samplers);
+	//Background samples textures 0 and 1 on units 0 and 1, the character texture 2 on unit 5
+	const int drawTextures[2][2] = { { 0, 1 }, { 2, -1 } };
+	const int drawUnits[2][2] = { { 0, 1 }, { 5, -1 } };
+
+	for (int frame = 0; frame < frames; frame++)
+	{
+		for (int draw = 0; draw < 2; draw++)
+		{
+			glUseProgram(draw + 1);
+			for (int i = 0; i < 2 && drawTextures[draw][i] >= 0; i++)
+			{
+				glActiveTexture(GL_TEXTURE0 + drawUnits[draw][i]);
+				glBindTexture(GL_TEXTURE_2D, textures[drawTextures[draw][i]]);
+				glBindSampler(drawUnits[draw][i], samplers[drawTextures[draw][i]]);
+				glUniform1i(i, drawUnits[draw][i]);
+			}
+			glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, NULL);
+		}
+	}
+	float perDrawChanges = (float)glStats.getStateChanges() / frames;
+	printf("Per draw binds: %.1f state changes per frame\n", perDrawChanges);
+
+	const char* backendNames[3] = { "Multi-bind", "Texture array", "Bindless" };
+	bool fewerChanges = true;
+	bool created = true;
+	bool declared = true;
+	int makeResident = 0;
+	for (int backend = 0; backend < 3; backend++)
+	{
+		glStats = ew::GLStubStats();
+		ew::TextureTable table;
+		if (!table.create((ew::TextureTableBackend)backend, 8, 0, ew::getGLStubProc))
+		{
+			created = false;
+			continue;
+		}
+		int slots[3];
+		for (int i = 0; i < 3; i++)
+			slots[i] = table.add(textures[i], samplers[i]);
+		created = created && slots[0] == 0 && slots[1] == 1 && slots[2] == 2;
+		//Sampler uniforms are only set once
+		for (int draw = 0; draw < 2; draw++)
+		{
+			glUseProgram(draw + 1);
+			for (int i = 0; i < 2 && drawTextures[draw][i] >= 0; i++)
+				glUniform1i(i, slots[drawTextures[draw][i]]);
+		}
+		int setupChanges = glStats.getStateChanges();
+		for (int frame = 0; frame < frames; frame++)
+		{
+			table.commit(true);
+			for (int draw = 0; draw < 2; draw++)
+			{
+				glUseProgram(draw + 1);
+				glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, NULL);
+			}
+		}
+		float tableChanges = (float)(glStats.getStateChanges() - setupChanges) / frames;
+		printf("%s table: %.1f state changes per frame, %d at setup, %d handles made resident\n", backendNames[backend],
+			tableChanges, setupChanges, glStats.makeResident);
+		fewerChanges = fewerChanges && tableChanges < perDrawChanges;
+		if (backend == (int)ew::TextureTableBackend::BINDLESS)
+			makeResident = glStats.makeResident;
+		std::string source = table.getShaderSource();
+		declared = declared && source.find("vec4 sampleTextureTable(int index, vec2 uv)") != std::string::npos
+			&& (backend != (int)ew::TextureTableBackend::BINDLESS || source.find("GL_ARB_bindless_texture") != std::string::npos);
+	}
+	check("Every backend is created and hands out slots from 0", created);
+	check("Tables make fewer state changes than per draw binds", fewerChanges);
+	check("Bindless handles are made resident once per texture", makeResident == 3);
+	check("Every backend declares sampleTextureTable", declared);
+
+	ew::TextureTable table;
+	table.create(ew::TextureTableBackend::MULTI_BIND, 2, 4);
+	int first = table.add(textures[0]);
+	int second = table.add(textures[1], samplers[1]);
+	bool full = table.add(textures[2]) < 0;
+	table.remove(first);
+	int reused = table.add(textures[2]);
+	check("Removed slots are reused and a full table refuses more", full && reused == first && second == 1
+		&& table.getUnit(second) == 5 && table.getTexture(reused) == textures[2] && table.getStats().slotsUsed == 2);
+	table.commit();
+	int commits = table.getStats().commits;
+	table.commit();
+	bool skipped = table.getStats().commits == commits;
+	table.commit(true);
+	bool forced = table.getStats().commits == commits + 1;
+	table.set(second, textures[0]);
+	table.commit();
+	check("Commits only happen after a change or when forced", skipped && forced && table.getStats().commits == commits + 2
+		&& !table.set(7, textures[0]));
+	return 0;
+}
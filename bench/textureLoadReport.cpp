@@ -0,0 +1,122 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <algorithm>
+#include <thread>
+
+#include <ew/image.h>
+#include <ew/jobSystem.h>
+#include <ew/textureLoader.h>
+
+static bool sameImage(const ew::Image& a, const ew::Image& b)
+{
+	return a.width == b.width && a.height == b.height && a.numComponents == b.numComponents && a.pixels == b.pixels;
+}
+
+//Whether b is image a upside down
+static bool isFlipped(const ew::Image& a, const ew::Image& b)
+{
+	if (a.width != b.width || a.height != b.height || a.numComponents != b.numComponents)
+		return false;
+	size_t rowSize = (size_t)a.width * a.numComponents;
+	for (int y = 0; y < a.height; y++)
+	{
+		if (memcmp(&a.pixels[y * rowSize], &b.pixels[(a.height - 1 - y) * rowSize], rowSize) != 0)
+			return false;
+	}
+	return true;
+}
+
+/// <summary>
+/// Decodes every image in a directory one after another, then all at once on the job system, and prints both times.
+/// Checks the parallel decodes match the serial ones, and that flipped and unflipped decodes of the same files running
+/// at the same time each get their own flip setting.
+/// </summary>
+/// <param name="directory">Folder of images, relative to the working directory</param>
+/// <returns>0, or 1 if the directory has no images</returns>
+int reportTextureLoad(const char* directory)
+{
+	std::vector<std::string> files = ew::listImageFiles(directory);
+	if (files.empty())
+	{
+		printf("No images in %s\n", directory);
+		return 1;
+	}
+
+	std::map<std::string, ew::Image> serial;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (const std::string& file : files)
+	{
+		serial[file] = ew::loadImage(file.c_str());
+	}
+	float serialMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	//At least 4 threads, so decodes overlap even on a single core
+	ew::JobSystem jobSystem(std::max(3, (int)std::thread::hardware_concurrency() - 1));
+	std::map<std::string, ew::Image> parallel;
+	float decodeMs = 0;
+	start = std::chrono::high_resolution_clock::now();
+	{
+		ew::TextureLoader textureLoader(&jobSystem);
+		for (const std::string& file : files)
+		{
+			textureLoader.request(file);
+		}
+		while (textureLoader.getNumPending() > 0)
+		{
+			ew::DecodedImage decoded;
+			if (!textureLoader.poll(&decoded))
+			{
+				std::this_thread::yield();
+				continue;
+			}
+			decodeMs += decoded.decodeMs;
+			parallel[decoded.filePath] = std::move(decoded.image);
+		}
+	}
+	float parallelMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	printf("%d images: %.2f ms serial, %.2f ms on %d threads (%.2f ms decoding across workers)\n", (int)files.size(),
+		serialMs, parallelMs, jobSystem.getNumThreads(), decodeMs);
+
+	bool matches = parallel.size() == serial.size();
+	for (const std::string& file : files)
+	{
+		matches = matches && serial[file].isValid() && sameImage(serial[file], parallel[file]);
+	}
+	check("Parallel decodes match serial decodes", matches);
+
+	//Requests alternate flip settings, so workers decode both kinds at once
+	std::map<std::string, ew::Image> flipped;
+	std::map<std::string, ew::Image> unflipped;
+	{
+		ew::TextureLoader textureLoader(&jobSystem);
+		for (const std::string& file : files)
+		{
+			textureLoader.request(file, true);
+			textureLoader.request(file, false);
+		}
+		textureLoader.waitAll();
+		//Each file finishes twice in either order, so tell them apart by comparing with the serial decode
+		ew::DecodedImage decoded;
+		while (textureLoader.poll(&decoded))
+		{
+			const ew::Image& reference = serial[decoded.filePath];
+			if (sameImage(reference, decoded.image) && unflipped.count(decoded.filePath) == 0)
+				unflipped[decoded.filePath] = std::move(decoded.image);
+			else
+				flipped[decoded.filePath] = std::move(decoded.image);
+		}
+	}
+	bool flipsMatch = flipped.size() == files.size() && unflipped.size() == files.size();
+	for (const std::string& file : files)
+	{
+		flipsMatch = flipsMatch && isFlipped(serial[file], flipped[file]);
+	}
+	check("Concurrent flipped and unflipped decodes don't interfere", flipsMatch);
+	return 0;
+}
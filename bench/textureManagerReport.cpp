@@ -0,0 +1,92 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <vector>
+#include <chrono>
+
+#include <ew/external/glad.h>
+#include <ew/texture.h>
+#include <ew/textureManager.h>
+
+/// <summary>
+/// Loads each image many times through a TextureManager on the stub backend and prints how many GL textures were made.
+/// Checks repeated loads share one texture, other sampler settings and variants get their own, references are counted
+/// through copies and moves, the last release frees the texture and its memory, and the manager frees what's left.
+/// </summary>
+/// <param name="numLoads">Loads of each image</param>
+/// <returns>0, with failed checks counted by check()</returns>
+int reportTextureManager(int numLoads)
+{
+	const char* filePaths[3] = { "assets/brickwall.png", "assets/noise.png", "assets/brick_color.jpg" };
+	//The stub reports every texture as 256x256 RGBA8 with a full mip chain
+	const size_t STUB_TEXTURE_BYTES = ew::getTextureMemory(0);
+	{
+		ew::TextureManager textureManager;
+		std::vector<ew::TextureHandle> handles;
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < numLoads; i++)
+		{
+			for (const char* filePath : filePaths)
+			{
+				handles.push_back(textureManager.load(filePath, GL_REPEAT, GL_LINEAR));
+			}
+		}
+		float loadMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		printf("%d loads of %d images: %.2f ms, %d GL textures created, %.2f MB\n", numLoads * 3, 3, loadMs,
+			glStats.texturesCreated, textureManager.getTotalBytes() / 1048576.0f);
+		bool shared = glStats.texturesCreated == 3 && textureManager.getNumTextures() == 3;
+		for (size_t i = 0; i < handles.size(); i++)
+		{
+			shared = shared && handles[i].isValid() && handles[i].get() == handles[i % 3].get();
+		}
+		check("Repeated loads share one texture", shared);
+		check("Total memory is the sum of each texture", textureManager.getTotalBytes() == 3 * STUB_TEXTURE_BYTES);
+		bool counted = true;
+		for (const ew::TextureInfo& info : textureManager.getTextures())
+		{
+			counted = counted && info.refCount == numLoads && info.bytes == STUB_TEXTURE_BYTES;
+		}
+		check("Every handle holds a reference", counted);
+
+		ew::TextureHandle clamped = textureManager.load(filePaths[0], GL_CLAMP_TO_EDGE, GL_LINEAR);
+		ew::TextureHandle nearest = textureManager.load(filePaths[0], GL_REPEAT, GL_NEAREST);
+		ew::TextureKey key;
+		key.filePath = filePaths[0];
+		key.wrapMode = GL_REPEAT;
+		key.filterMode = GL_LINEAR;
+		key.variant = "bc1";
+		bool variantMissing = !textureManager.find(key).isValid();
+		ew::TextureHandle variant = textureManager.insert(key, ew::loadTexture(filePaths[0], GL_REPEAT, GL_LINEAR));
+		check("Other sampler settings and variants get their own texture", variantMissing && clamped.get() != handles[0].get()
+			&& nearest.get() != handles[0].get() && nearest.get() != clamped.get() && variant.get() != handles[0].get()
+			&& textureManager.getNumTextures() == 6 && glStats.texturesCreated == 6);
+
+		//A second texture for a key in use is deleted in favor of the existing one
+		int deletedBefore = glStats.texturesDeleted;
+		ew::TextureHandle duplicate = textureManager.insert(key, ew::loadTexture(filePaths[0], GL_REPEAT, GL_LINEAR));
+		check("Inserting a duplicate key keeps the existing texture", duplicate.get() == variant.get()
+			&& glStats.texturesDeleted == deletedBefore + 1 && textureManager.getNumTextures() == 6);
+
+		ew::TextureHandle copy = variant;
+		ew::TextureHandle moved = std::move(duplicate);
+		bool movedFrom = !duplicate.isValid() && duplicate.get() == 0;
+		variant.reset();
+		moved.reset();
+		bool stillAlive = copy.isValid() && glStats.texturesDeleted == deletedBefore + 1 && textureManager.find(key).isValid();
+		copy.reset();
+		check("Copies and moves count references", movedFrom && stillAlive);
+		check("Last release frees the texture and its memory", glStats.texturesDeleted == deletedBefore + 2
+			&& !textureManager.find(key).isValid() && textureManager.getNumTextures() == 5
+			&& textureManager.getTotalBytes() == 5 * STUB_TEXTURE_BYTES);
+
+		//Reassigning a handle releases what it held
+		clamped = nearest;
+		check("Reassigning a handle releases the old texture", glStats.texturesDeleted == deletedBefore + 3
+			&& clamped.get() == nearest.get() && textureManager.getNumTextures() == 4);
+
+		check("Missing file gives an empty handle", !textureManager.load("assets/missing.png", GL_REPEAT, GL_LINEAR).isValid()
+			&& textureManager.getNumTextures() == 4);
+	}
+	check("Manager frees every texture it made", glStats.getLiveTextures() == 0);
+	return 0;
+}
@@ -0,0 +1,221 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <filesystem>
+
+#include <ew/image.h>
+#include <ew/jobSystem.h>
+#include <ew/virtualTexture.h>
+
+//Reports the same pages every frame until they are all resident, or the frames run out
+static bool streamUntilResident(ew::VirtualTexture& virtualTexture, const std::vector<ew::PageId>& pages, int maxFrames)
+{
+	for (int frame = 0; frame < maxFrames; frame++)
+	{
+		for (const ew::PageId& page : pages)
+			virtualTexture.addFeedback(page);
+		virtualTexture.update();
+		bool resident = true;
+		for (const ew::PageId& page : pages)
+			resident = resident && virtualTexture.getSlot(page) >= 0;
+		if (resident)
+			return true;
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return false;
+}
+
+//A resident level 0 page holds the image's pixels, with its border clamped at the image's edges
+static bool pageMatchesImage(const ew::VirtualTexture& virtualTexture, ew::PageId page, const ew::Image& image)
+{
+	int slot = virtualTexture.getSlot(page);
+	if (slot < 0 || page.mip != 0)
+		return false;
+	int pageSize = virtualTexture.getPageSize();
+	int border = virtualTexture.getBorder();
+	int slotSize = pageSize + border * 2;
+	const ew::Image& physical = virtualTexture.getPhysicalImage();
+	int originX = slot % virtualTexture.getSlotsPerRow() * slotSize;
+	int originY = slot / virtualTexture.getSlotsPerRow() * slotSize;
+	for (int y = 0; y < slotSize; y++)
+	{
+		int sourceY = std::min(std::max(page.y * pageSize + y - border, 0), image.height - 1);
+		for (int x = 0; x < slotSize; x++)
+		{
+			int sourceX = std::min(std::max(page.x * pageSize + x - border, 0), image.width - 1);
+			const unsigned char* src = &image.pixels[((size_t)sourceY * image.width + sourceX) * image.numComponents];
+			const unsigned char* dst = &physical.pixels[((size_t)(originY + y) * physical.width + originX + x) * 4];
+			for (int c = 0; c < 4; c++)
+			{
+				unsigned char expected = c < image.numComponents ? src[c] : (c == 3 ? 255 : 0);
+				if (dst[c] != expected)
+					return false;
+			}
+		}
+	}
+	return true;
+}
+
+static ew::PageId pageId(int mip, int x, int y)
+{
+	ew::PageId page;
+	page.mip = mip;
+	page.x = x;
+	page.y = y;
+	return page;
+}
+
+/// <summary>
+/// Builds a cached page file for an image, then pans and zooms a 256x256 view over it, feeding back the page each pixel
+/// of a 32x32 feedback buffer would sample, with a simulated disk latency. Prints hit rate, loads, evictions and how many
+/// levels coarser than wanted the view center shows. Checks the cache is reused, resident pages hold the image's pixels,
+/// the budget is kept, pages used this frame are never evicted, and parents of edge pages on odd sized levels stay in range.
+/// </summary>
+/// <param name="imagePath">Image to stream</param>
+/// <returns>0, or 1 if the page file couldn't be built</returns>
+int reportVirtualTexture(const char* imagePath)
+{
+	const int PAGE_SIZE = 128;
+	const int BORDER = 4;
+	const int NUM_FRAMES = 300;
+	const int VIEW_SIZE = 256;
+	const int FEEDBACK_SIZE = 32;
+	//At least 4 threads, so loads overlap even on a single core
+	ew::JobSystem jobSystem(std::max(3, (int)std::thread::hardware_concurrency() - 1));
+
+	//A copy of the image, so its page file starts cold
+	std::string copyPath = "bench_virtual" + std::filesystem::path(imagePath).extension().string();
+	std::error_code error;
+	std::filesystem::copy_file(imagePath, copyPath, std::filesystem::copy_options::overwrite_existing, error);
+	auto start = std::chrono::high_resolution_clock::now();
+	std::string pagePath = ew::buildVirtualTextureCached(copyPath.c_str(), PAGE_SIZE, BORDER, &jobSystem);
+	float coldMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	if (pagePath.empty())
+	{
+		printf("Failed to build pages for %s\n", imagePath);
+		remove(copyPath.c_str());
+		return 1;
+	}
+	std::filesystem::file_time_type builtTime = std::filesystem::last_write_time(pagePath, error);
+	start = std::chrono::high_resolution_clock::now();
+	std::string warmPath = ew::buildVirtualTextureCached(copyPath.c_str(), PAGE_SIZE, BORDER, &jobSystem);
+	float warmMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	printf("Page file: %.2f ms cold, %.3f ms warm\n", coldMs, warmMs);
+	check("Page file is built in the texture cache and reused", !error && warmPath == pagePath
+		&& pagePath.rfind(ew::TEXTURE_CACHE_DIRECTORY, 0) == 0 && std::filesystem::last_write_time(pagePath, error) == builtTime);
+
+	ew::VirtualTextureSettings settings;
+	settings.budgetBytes = 4 * 1024 * 1024;
+	settings.simulatedLatencyMs = 2.0f;
+	bool keptBudget = true;
+	{
+		ew::VirtualTexture virtualTexture(&jobSystem);
+		if (!virtualTexture.open(pagePath.c_str(), settings))
+			return 1;
+		int textureSize = virtualTexture.getLevel(0).width;
+		int hits = 0, requested = 0, loads = 0, evictions = 0, dropped = 0;
+		float updateMs = 0, fallback = 0;
+		for (int frame = 0; frame < NUM_FRAMES; frame++)
+		{
+			//Wander in a loop while zooming in and out
+			float t = frame * 0.01f;
+			ew::Vec2 center(0.5f + 0.4f * cosf(t * 3.0f), 0.5f + 0.4f * sinf(t * 2.0f));
+			float viewUV = 0.1f + 0.08f * sinf(t * 5.0f); //Fraction of the texture across the view
+			float mip = std::max(log2f(viewUV * textureSize / VIEW_SIZE), 0.0f);
+			for (int y = 0; y < FEEDBACK_SIZE; y++)
+			{
+				for (int x = 0; x < FEEDBACK_SIZE; x++)
+				{
+					ew::Vec2 offset((x + 0.5f) / FEEDBACK_SIZE - 0.5f, (y + 0.5f) / FEEDBACK_SIZE - 0.5f);
+					virtualTexture.addFeedback(ew::Vec2(center.x + offset.x * viewUV, center.y + offset.y * viewUV), mip);
+				}
+			}
+			auto updateStart = std::chrono::high_resolution_clock::now();
+			virtualTexture.update();
+			updateMs += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - updateStart).count();
+			virtualTexture.takeDirtySlots();
+
+			const ew::VirtualTextureStats& stats = virtualTexture.getStats();
+			hits += stats.hits;
+			requested += stats.requested;
+			loads += stats.loadsCompleted;
+			evictions += stats.evictions;
+			dropped += stats.dropped;
+			fallback += virtualTexture.getResidentMip(center, (int)mip) - (int)mip;
+			keptBudget = keptBudget && stats.residentPages <= stats.capacityPages
+				&& virtualTexture.getResidentMip(center, virtualTexture.getNumLevels() - 1) >= 0;
+			//Time for a real frame to render
+			std::this_thread::sleep_for(std::chrono::milliseconds(4));
+		}
+		const ew::VirtualTextureStats& stats = virtualTexture.getStats();
+		float hitRate = requested > 0 ? (float)hits / requested : 0.0f;
+		printf("%d frames, %d of %d pages resident: %.1f%% hits, %d loads (%.2f ms each), %d evictions, %d dropped, "
+			"%.3f ms update, %.2f mips fallback\n", NUM_FRAMES, stats.residentPages, stats.capacityPages, hitRate * 100.0f, loads,
+			stats.averageLoadMs, evictions, dropped, updateMs / NUM_FRAMES, fallback / NUM_FRAMES);
+		keptBudget = keptBudget && (size_t)stats.capacityPages * (PAGE_SIZE + BORDER * 2) * (PAGE_SIZE + BORDER * 2) * 4 <= settings.budgetBytes;
+		check("Resident pages stay in budget with the coarsest level pinned", keptBudget);
+		check("Most sampled pages are already resident", hitRate >= 0.8f && fallback / NUM_FRAMES < 1.0f);
+
+		ew::Image image = ew::loadImage(copyPath.c_str());
+		ew::PageId page = pageId(0, 1, 1);
+		check("Resident pages hold the image's pixels", streamUntilResident(virtualTexture, { page, pageId(0, 0, 0) }, 1000)
+			&& pageMatchesImage(virtualTexture, page, image) && pageMatchesImage(virtualTexture, pageId(0, 0, 0), image));
+	}
+	remove(pagePath.c_str());
+	remove(copyPath.c_str());
+
+	//257x257 with 64 pixel pages has 5 pages per side on level 0, but only 2 on level 1
+	ew::Image odd;
+	odd.width = odd.height = 257;
+	odd.numComponents = 4;
+	odd.pixels.resize((size_t)odd.width * odd.height * 4);
+	for (size_t i = 0; i < odd.pixels.size(); i++)
+		odd.pixels[i] = (unsigned char)(i * 7);
+	const char* oddPath = "bench_odd.vtex";
+	const size_t ODD_PAGE_BYTES = (size_t)(64 + BORDER * 2) * (64 + BORDER * 2) * 4;
+	ew::VirtualTextureSettings oddSettings;
+	bool oddLoaded = ew::saveVirtualTexture(oddPath, odd, 64, BORDER);
+	{
+		ew::VirtualTexture virtualTexture(&jobSystem);
+		oddLoaded = oddLoaded && virtualTexture.open(oddPath, oddSettings) && virtualTexture.getLevel(1).pagesX == 2;
+		ew::PageId corner = pageId(0, 4, 4);
+		oddLoaded = oddLoaded && streamUntilResident(virtualTexture, { corner }, 1000) && virtualTexture.getSlot(pageId(1, 1, 1)) >= 0
+			&& virtualTexture.getStats().bytesLoaded == 2 * ODD_PAGE_BYTES
+			&& pageMatchesImage(virtualTexture, corner, odd);
+	}
+	check("Edge page of an odd sized level loads with its clamped parent", oddLoaded);
+
+	//Room for the pinned page and 3 more, while 5 are wanted every frame
+	ew::VirtualTextureSettings smallSettings;
+	smallSettings.budgetBytes = 4 * ODD_PAGE_BYTES;
+	bool keptUsedPages = true;
+	{
+		ew::VirtualTexture virtualTexture(&jobSystem);
+		keptUsedPages = virtualTexture.open(oddPath, smallSettings);
+		std::vector<ew::PageId> wanted = { pageId(1, 0, 0), pageId(1, 1, 0), pageId(1, 0, 1), pageId(0, 0, 0), pageId(0, 1, 0) };
+		int evictions = 0, dropped = 0;
+		for (int frame = 0; frame < 200; frame++)
+		{
+			for (const ew::PageId& page : wanted)
+				virtualTexture.addFeedback(page);
+			virtualTexture.update();
+			evictions += virtualTexture.getStats().evictions;
+			dropped += virtualTexture.getStats().dropped;
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		keptUsedPages = keptUsedPages && evictions == 0 && dropped > 0 && virtualTexture.getStats().residentPages == 4;
+		//Once the view moves on, the old pages make room
+		std::vector<ew::PageId> next = { pageId(0, 4, 4) };
+		keptUsedPages = keptUsedPages && streamUntilResident(virtualTexture, next, 1000) && virtualTexture.getStats().evictions > 0;
+	}
+	check("Pages used this frame are never evicted", keptUsedPages);
+	remove(oddPath);
+	return 0;
+}
@@ -1,31 +1,27 @@
 #include "shader.h"
 #include <stdio.h>
-#include <sstream>
-#include <fstream>
+#include "../ew/assetFile.h"
 #include "../ew/external/glad.h"
 namespace dj
 {
 	std::string loadShaderSourceFromFile(const std::string& filePath)
 	{
-		std::ifstream fstream(filePath);
-		if (!fstream.is_open())
+		// One copy, straight out of the mapped file
+		ew::AssetFile file;
+		if (!file.open(filePath.c_str()))
 		{
-			printf("Failed to load file %s", filePath);
 			return {};
 		}
-		std::stringstream buffer;
-		buffer << fstream.rdbuf();
-
-		return buffer.str();
+		return std::string(file.getText(), file.getSize());
 	}
 
-	unsigned int createShader(GLenum shaderType, const char* sourceCode)
+	unsigned int createShader(GLenum shaderType, const char* sourceCode, int sourceLength)
 	{
 		//Create a new vertex shader object
 		unsigned int shader = glCreateShader(shaderType);
 
-		//Supply the shader object with source code
-		glShaderSource(shader, 1, &sourceCode, NULL);
+		//Supply the shader object with source code, -1 meaning it is null terminated
+		glShaderSource(shader, 1, &sourceCode, &sourceLength);
 
 		//Compile the shader object
 		glCompileShader(shader);
@@ -45,8 +41,13 @@ namespace dj
 
 	unsigned int createShaderProgram(const char* vertexShaderSource, const char* fragmentShaderSource)
 	{
-		unsigned int vertexShader = createShader(GL_VERTEX_SHADER, vertexShaderSource);
-		unsigned int fragmentShader = createShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
+		return createShaderProgram(vertexShaderSource, -1, fragmentShaderSource, -1);
+	}
+
+	unsigned int createShaderProgram(const char* vertexShaderSource, int vertexShaderLength, const char* fragmentShaderSource, int fragmentShaderLength)
+	{
+		unsigned int vertexShader = createShader(GL_VERTEX_SHADER, vertexShaderSource, vertexShaderLength);
+		unsigned int fragmentShader = createShader(GL_FRAGMENT_SHADER, fragmentShaderSource, fragmentShaderLength);
 
 		unsigned int shaderProgram = glCreateProgram();
 
@@ -105,9 +106,10 @@ namespace dj
 	
 	Shader::Shader(const std::string& vertextShader, const std::string& fragmentShader)
 	{
-		std::string vertexShaderSource = loadShaderSourceFromFile(vertextShader.c_str());
-		std::string fragmentShaderSource = loadShaderSourceFromFile(fragmentShader.c_str());
-		m_id = createShaderProgram(vertexShaderSource.c_str(), fragmentShaderSource.c_str());
+		// The mapped files are handed to the driver as they are, with their lengths
+		ew::AssetFile vertexFile(vertextShader.c_str());
+		ew::AssetFile fragmentFile(fragmentShader.c_str());
+		m_id = createShaderProgram(vertexFile.getText(), (int)vertexFile.getSize(), fragmentFile.getText(), (int)fragmentFile.getSize());
 	}
 
 	void Shader::use()
@@ -3,8 +3,6 @@
 
 #include "../ew/external/glad.h"
 #include <string>
-#include <sstream>
-#include <fstream>
 #include "../ew/external/glad.h"
 #include "../ew/ewMath/mat4.h"
 namespace dj
@@ -34,8 +32,11 @@ namespace dj
 	};
 
 	std::string loadShaderSourceFromFile(const std::string& filePath);
-	unsigned int createShader(GLenum shaderType, const char* sourceCode);
+	// sourceLength of -1 means sourceCode is null terminated
+	unsigned int createShader(GLenum shaderType, const char* sourceCode, int sourceLength = -1);
 	unsigned int createShaderProgram(const char* vertexShaderSource, const char* fragmentShaderSource);
+	// Sources with known lengths, e.g. straight from a mapped file
+	unsigned int createShaderProgram(const char* vertexShaderSource, int vertexShaderLength, const char* fragmentShaderSource, int fragmentShaderLength);
 	unsigned int createVAO(Vertex* vertexData, int numVertices, unsigned int* indicesData, int numIndices);
 }
 
@@ -4,20 +4,22 @@
 
 unsigned int loadTexture(const char* filePath, int wrapMode, int filterMode) 
 {
-	stbi_set_flip_vertically_on_load(true);
-	int width, height, numComponents;
-	unsigned char* data = stbi_load(filePath, &width, &height, &numComponents, 0);
-	if (data == NULL) {
-		printf("Failed to load image %s", filePath);
-		stbi_image_free(data);
+	ew::Image image = ew::loadImage(filePath, true);
+	if (!image.isValid()) {
 		return 0;
 	}
+	return createTexture(image, wrapMode, filterMode);
+}
+
+// Upload half of loadTexture, so images can be decoded on other threads first
+unsigned int createTexture(const ew::Image& image, int wrapMode, int filterMode)
+{
 	unsigned int texture;
 
 	glGenTextures(1, &texture);
 	glBindTexture(GL_TEXTURE_2D, texture);
 
-	glTexImage2D(GL_TEXTURE_2D, 0, getFormat(numComponents), width, height, 0, getFormat(numComponents), GL_UNSIGNED_BYTE, data);
+	glTexImage2D(GL_TEXTURE_2D, 0, getFormat(image.numComponents), image.width, image.height, 0, getFormat(image.numComponents), GL_UNSIGNED_BYTE, image.pixels.data());
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, getTextWrapS(wrapMode));
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, getTextWrapT(wrapMode));
@@ -27,10 +29,18 @@ unsigned int loadTexture(const char* filePath, int wrapMode, int filterMode)
 	glGenerateMipmap(GL_TEXTURE_2D);
 
 	glBindTexture(GL_TEXTURE_2D, 0);
-	stbi_image_free(data);
 	return texture;
 }
 
+// loadTexture through a cached container, so only the first run decodes the image
+unsigned int loadCachedTexture(const char* filePath, int wrapMode, int filterMode, ew::TextureCacheStats* stats)
+{
+	ew::TextureCacheSettings settings;
+	settings.flipVertically = true;
+	settings.minFilter = getMinFilter(filterMode);
+	return ew::loadTextureCached(filePath, getTextWrapS(wrapMode), getMagFilter(filterMode), settings, nullptr, stats);
+}
+
 // Better way of doing the formatting
 GLenum getFormat(int numComponents) 
 {
@@ -138,4 +148,15 @@ GLenum getMagFilter(int filterMode)
 	}
 
 	return magFilter;
-}
\ No newline at end of file
+}
+
+// All four modes at once for a sampler object, so the codes are translated once instead of on every texture
+ew::SamplerState getSamplerState(int wrapMode, int filterMode)
+{
+	ew::SamplerState state;
+	state.wrapS = getTextWrapS(wrapMode);
+	state.wrapT = getTextWrapT(wrapMode);
+	state.minFilter = getMinFilter(filterMode);
+	state.magFilter = getMagFilter(filterMode);
+	return state;
+}
@@ -2,10 +2,16 @@
 
 #include "../ew/external/stb_image.h"
 #include "../ew/external/glad.h"
+#include "../ew/image.h"
+#include "../ew/texture.h"
+#include "../ew/sampler.h"
 
 unsigned int loadTexture(const char* filePath, int wrapMode, int filterMode);
+unsigned int createTexture(const ew::Image& image, int wrapMode, int filterMode);
+unsigned int loadCachedTexture(const char* filePath, int wrapMode, int filterMode, ew::TextureCacheStats* stats = nullptr);
 GLenum getFormat(int numComponents);
 GLenum getTextWrapS(int wrapMode);
 GLenum getTextWrapT(int wrapMode);
 GLenum getMinFilter(int filterMode);
-GLenum getMagFilter(int filterMode);
\ No newline at end of file
+GLenum getMagFilter(int filterMode);
+ew::SamplerState getSamplerState(int wrapMode, int filterMode);
\ No newline at end of file
@@ -0,0 +1,35 @@
+#include "assetFile.h"
+#include <stdio.h>
+
+namespace ew {
+	bool AssetFile::open(const char* filePath)
+	{
+		close();
+		if (m_mapped.open(filePath)) {
+			return true;
+		}
+		FILE* file = fopen(filePath, "rb");
+		if (file == NULL) {
+			printf("Failed to load file %s\n", filePath);
+			return false;
+		}
+		fseek(file, 0, SEEK_END);
+		long size = ftell(file);
+		fseek(file, 0, SEEK_SET);
+		m_buffer.resize(size > 0 ? (size_t)size : 0);
+		m_read = fread(m_buffer.data(), 1, m_buffer.size(), file) == m_buffer.size();
+		fclose(file);
+		if (!m_read) {
+			printf("Failed to read file %s\n", filePath);
+			m_buffer.clear();
+		}
+		return m_read;
+	}
+
+	void AssetFile::close()
+	{
+		m_mapped.close();
+		m_buffer.clear();
+		m_read = false;
+	}
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <stddef.h>
+#include <vector>
+#include "mappedFile.h"
+
+namespace ew {
+	/// <summary>
+	/// A whole asset file in one buffer, for loaders that parse or upload it in place without copying it again.
+	/// The file is memory mapped, or read into memory if it can't be mapped (e.g. on some network drives).
+	/// Text is not null terminated, so always pass getSize() along with it.
+	/// </summary>
+	class AssetFile {
+	public:
+		AssetFile() = default;
+		explicit AssetFile(const char* filePath) { open(filePath); }
+
+		//Prints a message and returns false if the file can't be read. Closes any previous file first.
+		bool open(const char* filePath);
+		void close();
+
+		inline bool isOpen()const { return m_mapped.isOpen() || m_read; }
+		inline const unsigned char* getData()const { return m_mapped.isOpen() ? m_mapped.getData() : m_buffer.data(); }
+		//Never null, even for an empty or missing file
+		inline const char* getText()const { return getSize() > 0 ? (const char*)getData() : ""; }
+		inline size_t getSize()const { return m_mapped.isOpen() ? m_mapped.getSize() : m_buffer.size(); }
+	private:
+		MappedFile m_mapped;
+		std::vector<unsigned char> m_buffer; //Only used when mapping fails
+		bool m_read = false;
+	};
+}
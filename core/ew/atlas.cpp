@@ -0,0 +1,327 @@
+#include "atlas.h"
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+
+namespace ew {
+	struct PackRect {
+		int x, y, width, height;
+	};
+
+	/// <summary>
+	/// Bottom left skyline. Keeps only the top edge of everything placed so far,
+	/// so space under an overhang is lost, but each insert is a single pass.
+	/// </summary>
+	class SkylinePacker {
+	public:
+		SkylinePacker(int width, int height) : m_width(width), m_height(height) {
+			m_skyline.push_back({ 0, 0, width });
+		}
+
+		bool insert(int width, int height, int* x, int* y) {
+			int bestIndex = -1, bestTop = m_height + 1, bestWidth = 0, bestY = 0;
+			for (int i = 0; i < (int)m_skyline.size(); i++) {
+				int fitY;
+				if (!fit(i, width, height, &fitY)) {
+					continue;
+				}
+				int top = fitY + height;
+				if (top < bestTop || (top == bestTop && m_skyline[i].width < bestWidth)) {
+					bestIndex = i;
+					bestTop = top;
+					bestWidth = m_skyline[i].width;
+					bestY = fitY;
+				}
+			}
+			if (bestIndex < 0) {
+				return false;
+			}
+			*x = m_skyline[bestIndex].x;
+			*y = bestY;
+			place(bestIndex, *x, bestY + height, width);
+			return true;
+		}
+	private:
+		struct Segment {
+			int x, y, width;
+		};
+
+		//Lowest y a rect starting at segment i can sit at
+		bool fit(int i, int width, int height, int* y)const {
+			int x = m_skyline[i].x;
+			if (x + width > m_width) {
+				return false;
+			}
+			int top = 0;
+			for (int remaining = width; remaining > 0; i++) {
+				top = std::max(top, m_skyline[i].y);
+				if (top + height > m_height) {
+					return false;
+				}
+				remaining -= m_skyline[i].width;
+			}
+			*y = top;
+			return true;
+		}
+
+		void place(int index, int x, int top, int width) {
+			m_skyline.insert(m_skyline.begin() + index, { x, top, width });
+			//Trim the segments the new one covers
+			int end = x + width;
+			for (size_t i = index + 1; i < m_skyline.size();) {
+				Segment& segment = m_skyline[i];
+				if (segment.x >= end) {
+					break;
+				}
+				int segmentEnd = segment.x + segment.width;
+				if (segmentEnd <= end) {
+					m_skyline.erase(m_skyline.begin() + i);
+					continue;
+				}
+				segment.width = segmentEnd - end;
+				segment.x = end;
+				break;
+			}
+			//Merge neighbours at the same height
+			for (size_t i = 0; i + 1 < m_skyline.size();) {
+				if (m_skyline[i].y == m_skyline[i + 1].y) {
+					m_skyline[i].width += m_skyline[i + 1].width;
+					m_skyline.erase(m_skyline.begin() + i + 1);
+				}
+				else {
+					i++;
+				}
+			}
+		}
+
+		int m_width, m_height;
+		std::vector<Segment> m_skyline;
+	};
+
+	/// <summary>
+	/// MaxRects with best short side fit. Keeps every maximal free rectangle, which may overlap,
+	/// and splits all the ones a placed rect touches.
+	/// </summary>
+	class MaxRectsPacker {
+	public:
+		MaxRectsPacker(int width, int height) {
+			m_free.push_back({ 0, 0, width, height });
+		}
+
+		bool insert(int width, int height, int* x, int* y) {
+			int bestShort = INT32_MAX, bestLong = INT32_MAX;
+			PackRect best = {};
+			for (const PackRect& free : m_free) {
+				if (free.width < width || free.height < height) {
+					continue;
+				}
+				int leftoverX = free.width - width;
+				int leftoverY = free.height - height;
+				int shortSide = std::min(leftoverX, leftoverY);
+				int longSide = std::max(leftoverX, leftoverY);
+				if (shortSide < bestShort || (shortSide == bestShort && longSide < bestLong)) {
+					bestShort = shortSide;
+					bestLong = longSide;
+					best = { free.x, free.y, width, height };
+				}
+			}
+			if (bestShort == INT32_MAX) {
+				return false;
+			}
+			split(best);
+			prune();
+			*x = best.x;
+			*y = best.y;
+			return true;
+		}
+	private:
+		void split(const PackRect& used) {
+			std::vector<PackRect> next;
+			for (const PackRect& free : m_free) {
+				if (used.x >= free.x + free.width || used.x + used.width <= free.x
+					|| used.y >= free.y + free.height || used.y + used.height <= free.y) {
+					next.push_back(free);
+					continue;
+				}
+				//Up to four maximal rects around the used one
+				if (used.x > free.x) {
+					next.push_back({ free.x, free.y, used.x - free.x, free.height });
+				}
+				if (used.x + used.width < free.x + free.width) {
+					next.push_back({ used.x + used.width, free.y, free.x + free.width - used.x - used.width, free.height });
+				}
+				if (used.y > free.y) {
+					next.push_back({ free.x, free.y, free.width, used.y - free.y });
+				}
+				if (used.y + used.height < free.y + free.height) {
+					next.push_back({ free.x, used.y + used.height, free.width, free.y + free.height - used.y - used.height });
+				}
+			}
+			m_free.swap(next);
+		}
+
+		//Removes rects contained in others
+		void prune() {
+			for (size_t i = 0; i < m_free.size(); i++) {
+				for (size_t j = i + 1; j < m_free.size();) {
+					if (contains(m_free[i], m_free[j])) {
+						m_free.erase(m_free.begin() + j);
+					}
+					else if (contains(m_free[j], m_free[i])) {
+						m_free.erase(m_free.begin() + i);
+						i--;
+						break;
+					}
+					else {
+						j++;
+					}
+				}
+			}
+		}
+
+		static bool contains(const PackRect& outer, const PackRect& inner) {
+			return inner.x >= outer.x && inner.y >= outer.y
+				&& inner.x + inner.width <= outer.x + outer.width && inner.y + inner.height <= outer.y + outer.height;
+		}
+
+		std::vector<PackRect> m_free;
+	};
+
+	static int alignUp(int value, int alignment) {
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	template<typename Packer>
+	static void packPages(const std::vector<AtlasSize>& sizes, const AtlasSettings& settings, Atlas* atlas) {
+		int alignment = std::max(settings.alignment, 1);
+		int pageSize = settings.maxSize / alignment * alignment;
+		//Largest side first, then largest area. Packing big rects early leaves small ones to fill gaps.
+		std::vector<int> order(sizes.size());
+		for (int i = 0; i < (int)order.size(); i++) {
+			order[i] = i;
+		}
+		std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+			int sideA = std::max(sizes[a].width, sizes[a].height);
+			int sideB = std::max(sizes[b].width, sizes[b].height);
+			if (sideA != sideB) {
+				return sideA > sideB;
+			}
+			return sizes[a].width * sizes[a].height > sizes[b].width * sizes[b].height;
+		});
+
+		std::vector<Packer> packers;
+		std::vector<PackRect> extents; //Used area of each page
+		for (int index : order) {
+			AtlasEntry& entry = atlas->entries[index];
+			int width = alignUp(sizes[index].width + settings.padding * 2, alignment);
+			int height = alignUp(sizes[index].height + settings.padding * 2, alignment);
+			if (sizes[index].width <= 0 || sizes[index].height <= 0 || width > pageSize || height > pageSize) {
+				atlas->stats.numRejected++;
+				continue;
+			}
+			int x = 0, y = 0;
+			int page = 0;
+			for (; page < (int)packers.size(); page++) {
+				if (packers[page].insert(width, height, &x, &y)) {
+					break;
+				}
+			}
+			if (page == (int)packers.size()) {
+				packers.emplace_back(pageSize, pageSize);
+				extents.push_back({ 0, 0, 0, 0 });
+				packers.back().insert(width, height, &x, &y);
+			}
+			entry.page = page;
+			entry.x = x + settings.padding;
+			entry.y = y + settings.padding;
+			entry.width = sizes[index].width;
+			entry.height = sizes[index].height;
+			extents[page].width = std::max(extents[page].width, x + width);
+			extents[page].height = std::max(extents[page].height, y + height);
+		}
+
+		//Shrink pages to what they use
+		atlas->pages.resize(packers.size());
+		for (size_t i = 0; i < packers.size(); i++) {
+			atlas->pages[i].width = extents[i].width;
+			atlas->pages[i].height = extents[i].height;
+			atlas->pages[i].numComponents = 4;
+		}
+	}
+
+	Atlas PackAtlas(const std::vector<AtlasSize>& sizes, const AtlasSettings& settings)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		Atlas atlas;
+		atlas.entries.resize(sizes.size());
+		atlas.stats.numImages = (int)sizes.size();
+		if (settings.packer == AtlasPacker::SKYLINE) {
+			packPages<SkylinePacker>(sizes, settings, &atlas);
+		}
+		else {
+			packPages<MaxRectsPacker>(sizes, settings, &atlas);
+		}
+
+		double imagePixels = 0, pagePixels = 0;
+		for (AtlasEntry& entry : atlas.entries) {
+			if (entry.page < 0) {
+				continue;
+			}
+			const Image& page = atlas.pages[entry.page];
+			entry.uvRect = ew::Vec4((float)entry.x / page.width, (float)entry.y / page.height,
+				(float)entry.width / page.width, (float)entry.height / page.height);
+			imagePixels += (double)entry.width * entry.height;
+		}
+		for (const Image& page : atlas.pages) {
+			pagePixels += (double)page.width * page.height;
+		}
+		atlas.stats.numPages = (int)atlas.pages.size();
+		atlas.stats.efficiency = pagePixels > 0 ? (float)(imagePixels / pagePixels) : 0.0f;
+		atlas.stats.packMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		return atlas;
+	}
+
+	Atlas BuildAtlas(const std::vector<const Image*>& images, const AtlasSettings& settings)
+	{
+		std::vector<AtlasSize> sizes;
+		for (const Image* image : images) {
+			sizes.push_back({ image->width, image->height });
+		}
+		Atlas atlas = PackAtlas(sizes, settings);
+		auto start = std::chrono::high_resolution_clock::now();
+		for (Image& page : atlas.pages) {
+			page.pixels.assign((size_t)page.width * page.height * 4, 0);
+		}
+		for (size_t i = 0; i < images.size(); i++) {
+			const AtlasEntry& entry = atlas.entries[i];
+			if (entry.page < 0) {
+				printf("%dx%d image does not fit in a %d atlas page\n", images[i]->width, images[i]->height, settings.maxSize);
+				continue;
+			}
+			const Image& image = *images[i];
+			Image& page = atlas.pages[entry.page];
+			//Padding repeats the nearest edge pixel
+			int pad = settings.padding;
+			for (int y = -pad; y < entry.height + pad; y++) {
+				int sourceY = std::min(std::max(y, 0), image.height - 1);
+				unsigned char* dst = &page.pixels[((size_t)(entry.y + y) * page.width + entry.x - pad) * 4];
+				for (int x = -pad; x < entry.width + pad; x++, dst += 4) {
+					int sourceX = std::min(std::max(x, 0), image.width - 1);
+					const unsigned char* src = &image.pixels[((size_t)sourceY * image.width + sourceX) * image.numComponents];
+					dst[0] = dst[1] = dst[2] = 0;
+					dst[3] = 255;
+					for (int c = 0; c < image.numComponents && c < 4; c++) {
+						dst[c] = src[c];
+					}
+					//Grey images spread to all three color channels
+					if (image.numComponents <= 2) {
+						dst[1] = dst[2] = src[0];
+						dst[3] = image.numComponents == 2 ? src[1] : 255;
+					}
+				}
+			}
+		}
+		atlas.stats.copyMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		return atlas;
+	}
+}
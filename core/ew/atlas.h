@@ -0,0 +1,57 @@
+#pragma once
+#include <vector>
+#include "image.h"
+
+namespace ew {
+	enum class AtlasPacker {
+		SKYLINE = 0, //Fast, wastes space under tall neighbours
+		MAX_RECTS = 1 //Tracks every free rectangle, tighter but slower
+	};
+
+	struct AtlasSettings {
+		AtlasPacker packer = AtlasPacker::MAX_RECTS;
+		int maxSize = 2048; //Of each page
+		//Edge pixels repeated around each image, so filtering and mips don't blend in neighbours.
+		//Padding p keeps roughly log2(p) + 1 mip levels clean.
+		int padding = 4;
+		int alignment = 4; //Each padded rect starts and ends on a multiple of this
+	};
+
+	struct AtlasEntry {
+		int page = -1; //-1 if the image was too big for a page
+		//Pixels of the image itself, without padding
+		int x = 0;
+		int y = 0;
+		int width = 0;
+		int height = 0;
+		//Remaps a 0-1 UV into the page: uvRect.xy + uv * uvRect.zw
+		ew::Vec4 uvRect = ew::Vec4(0, 0, 1, 1);
+	};
+
+	struct AtlasStats {
+		int numImages = 0;
+		int numPages = 0;
+		int numRejected = 0; //Larger than a page
+		float efficiency = 0; //Image pixels over page pixels, 0-1
+		float packMs = 0;
+		float copyMs = 0;
+	};
+
+	//Pages are RGBA, with grey images spread to all three color channels.
+	//Entries are in the same order as the images they were built from.
+	struct Atlas {
+		std::vector<Image> pages;
+		std::vector<AtlasEntry> entries;
+		AtlasStats stats;
+	};
+
+	struct AtlasSize {
+		int width;
+		int height;
+	};
+
+	//Places rectangles on as few pages as possible. The pages have sizes but no pixels.
+	Atlas PackAtlas(const std::vector<AtlasSize>& sizes, const AtlasSettings& settings = AtlasSettings());
+	//Packs the images and copies them onto RGBA pages, bleeding their edges into the padding
+	Atlas BuildAtlas(const std::vector<const Image*>& images, const AtlasSettings& settings = AtlasSettings());
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+namespace ew {
+	/// <summary>
+	/// The program, texture, sampler and vertex array a draw loop last bound, so binds that wouldn't change anything can
+	/// be skipped. Everything starts unknown rather than 0, so the first bind of each always happens, even of 0.
+	/// Only tracks names; the caller makes the GL calls when a change returns true.
+	/// </summary>
+	class BindTracker {
+	public:
+		//Not a name GL hands out
+		static const unsigned int UNKNOWN = ~0u;
+
+		//Each records the name as bound, returning whether it differs from the last one
+		inline bool changeProgram(unsigned int program) { return change(m_program, program); }
+		inline bool changeTexture(unsigned int texture) { return change(m_texture, texture); }
+		inline bool changeSampler(unsigned int sampler) { return change(m_sampler, sampler); }
+		inline bool changeVertexArray(unsigned int vertexArray) { return change(m_vertexArray, vertexArray); }
+		//Forgets everything, e.g. when something else may have bound in between
+		inline void reset() { m_program = m_texture = m_sampler = m_vertexArray = UNKNOWN; }
+	private:
+		static inline bool change(unsigned int& bound, unsigned int name) {
+			if (bound == name) {
+				return false;
+			}
+			bound = name;
+			return true;
+		}
+
+		unsigned int m_program = UNKNOWN;
+		unsigned int m_texture = UNKNOWN;
+		unsigned int m_sampler = UNKNOWN;
+		unsigned int m_vertexArray = UNKNOWN;
+	};
+}
@@ -0,0 +1,128 @@
+#pragma once
+#include <float.h>
+#include "ewMath/ewMath.h"
+#include "mesh.h"
+
+namespace ew {
+	//Axis aligned bounding box
+	struct AABB {
+		ew::Vec3 min = ew::Vec3(FLT_MAX);
+		ew::Vec3 max = ew::Vec3(-FLT_MAX);
+
+		inline ew::Vec3 center()const { return (min + max) * 0.5f; }
+		inline ew::Vec3 extents()const { return (max - min) * 0.5f; }
+		inline bool isValid()const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+		//Grow to contain a point
+		inline void expand(const ew::Vec3& p) {
+			//Plain compares instead of fminf/fmaxf, which are not inlined without fast math
+			min.x = p.x < min.x ? p.x : min.x; max.x = p.x > max.x ? p.x : max.x;
+			min.y = p.y < min.y ? p.y : min.y; max.y = p.y > max.y ? p.y : max.y;
+			min.z = p.z < min.z ? p.z : min.z; max.z = p.z > max.z ? p.z : max.z;
+		}
+		//Grow to contain another box
+		inline void expand(const AABB& b) {
+			min.x = b.min.x < min.x ? b.min.x : min.x; max.x = b.max.x > max.x ? b.max.x : max.x;
+			min.y = b.min.y < min.y ? b.min.y : min.y; max.y = b.max.y > max.y ? b.max.y : max.y;
+			min.z = b.min.z < min.z ? b.min.z : min.z; max.z = b.max.z > max.z ? b.max.z : max.z;
+		}
+	};
+
+	struct BoundingSphere {
+		ew::Vec3 center = ew::Vec3(0);
+		float radius = 0;
+	};
+
+	struct Ray {
+		ew::Vec3 origin = ew::Vec3(0);
+		ew::Vec3 direction = ew::Vec3(0, 0, -1); //Normalized
+	};
+
+	//Union of two boxes
+	inline AABB Merge(const AABB& a, const AABB& b) {
+		AABB out = a;
+		out.expand(b);
+		return out;
+	}
+
+	//Used by the surface area heuristic
+	inline float SurfaceArea(const AABB& box) {
+		ew::Vec3 d = box.max - box.min;
+		return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+	}
+
+	//Squared distance from a point to the closest point on a box. 0 when inside.
+	inline float DistanceSquared(const AABB& box, const ew::Vec3& p) {
+		float dx = fmaxf(fmaxf(box.min.x - p.x, 0.0f), p.x - box.max.x);
+		float dy = fmaxf(fmaxf(box.min.y - p.y, 0.0f), p.y - box.max.y);
+		float dz = fmaxf(fmaxf(box.min.z - p.z, 0.0f), p.z - box.max.z);
+		return dx * dx + dy * dy + dz * dz;
+	}
+
+	/// <summary>
+	/// Slab test between a ray and a box
+	/// </summary>
+	/// <param name="origin">Ray origin</param>
+	/// <param name="invDirection">1 / ray direction, per component</param>
+	/// <param name="box">Box to test</param>
+	/// <param name="maxDistance">Hits further than this are ignored</param>
+	/// <param name="tEnter">Distance along the ray where it enters the box (0 if starting inside)</param>
+	/// <returns>True if the ray touches the box within maxDistance</returns>
+	inline bool IntersectRayAABB(const ew::Vec3& origin, const ew::Vec3& invDirection, const AABB& box, float maxDistance, float* tEnter) {
+		float tx1 = (box.min.x - origin.x) * invDirection.x;
+		float tx2 = (box.max.x - origin.x) * invDirection.x;
+		float tmin = fminf(tx1, tx2), tmax = fmaxf(tx1, tx2);
+		float ty1 = (box.min.y - origin.y) * invDirection.y;
+		float ty2 = (box.max.y - origin.y) * invDirection.y;
+		tmin = fmaxf(tmin, fminf(ty1, ty2)); tmax = fminf(tmax, fmaxf(ty1, ty2));
+		float tz1 = (box.min.z - origin.z) * invDirection.z;
+		float tz2 = (box.max.z - origin.z) * invDirection.z;
+		tmin = fmaxf(tmin, fminf(tz1, tz2)); tmax = fminf(tmax, fmaxf(tz1, tz2));
+		tmin = fmaxf(tmin, 0.0f);
+		*tEnter = tmin;
+		return tmin <= tmax && tmin <= maxDistance;
+	}
+
+	inline ew::Vec3 InverseDirection(const ew::Vec3& d) {
+		//Division by zero gives +-inf, which the slab test handles
+		return ew::Vec3(1.0f / d.x, 1.0f / d.y, 1.0f / d.z);
+	}
+
+	/// <summary>
+	/// Local space bounds of all vertices in a mesh
+	/// </summary>
+	inline AABB ComputeAABB(const MeshData& meshData) {
+		AABB box;
+		for (const Vertex& v : meshData.vertices) {
+			box.expand(v.pos);
+		}
+		return box;
+	}
+
+	/// <summary>
+	/// Transforms a box by an affine matrix and returns the box that encloses the result
+	/// </summary>
+	/// <param name="box">Local space box</param>
+	/// <param name="m">Model matrix</param>
+	inline AABB TransformAABB(const AABB& box, const ew::Mat4& m) {
+		//Transform the center, then project the extents onto each world axis (Arvo)
+		ew::Vec3 c = box.center();
+		ew::Vec3 e = box.extents();
+		ew::Vec3 wc = (m * ew::Vec4(c, 1.0f)).toVec3();
+		ew::Vec3 we;
+		we.x = fabsf(m[0][0]) * e.x + fabsf(m[1][0]) * e.y + fabsf(m[2][0]) * e.z;
+		we.y = fabsf(m[0][1]) * e.x + fabsf(m[1][1]) * e.y + fabsf(m[2][1]) * e.z;
+		we.z = fabsf(m[0][2]) * e.x + fabsf(m[1][2]) * e.y + fabsf(m[2][2]) * e.z;
+		AABB out;
+		out.min = wc - we;
+		out.max = wc + we;
+		return out;
+	}
+
+	//Sphere enclosing a box
+	inline BoundingSphere ToBoundingSphere(const AABB& box) {
+		BoundingSphere s;
+		s.center = box.center();
+		s.radius = ew::Magnitude(box.extents());
+		return s;
+	}
+}
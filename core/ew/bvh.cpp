@@ -0,0 +1,281 @@
+#include "bvh.h"
+#include <algorithm>
+
+namespace ew {
+	static const int SAH_BINS = 12;
+	static const unsigned int MAX_LEAF_OBJECTS = 4;
+	//Cost of visiting a node relative to testing one object
+	static const float TRAVERSAL_COST = 1.0f;
+
+	void BVH::build(const std::vector<AABB>& bounds) {
+		m_objectBounds = bounds;
+		m_nodes.clear();
+		m_objectIndices.resize(bounds.size());
+		if (bounds.empty()) {
+			return;
+		}
+		std::vector<ew::Vec3> centroids(bounds.size());
+		for (unsigned int i = 0; i < bounds.size(); i++) {
+			m_objectIndices[i] = i;
+			centroids[i] = bounds[i].center();
+		}
+		//A binary tree with n leaves never has more than 2n - 1 nodes
+		m_nodes.reserve(bounds.size() * 2);
+		m_nodes.push_back(Node());
+		buildNode(0, 0, (unsigned int)bounds.size(), 0, centroids);
+	}
+
+	static inline int centroidBin(const ew::Vec3& centroid, int axis, float axisMin, float scale) {
+		return std::min(SAH_BINS - 1, (int)(((&centroid.x)[axis] - axisMin) * scale));
+	}
+
+	/// <summary>
+	/// Computes bounds for a node and recursively splits it where the SAH cost is lowest
+	/// </summary>
+	/// <param name="nodeIndex">Node to fill in</param>
+	/// <param name="first">First object in m_objectIndices</param>
+	/// <param name="count">Number of objects in this node</param>
+	/// <param name="depth">Distance from the root</param>
+	/// <param name="centroids">Center of each object's bounds</param>
+	void BVH::buildNode(unsigned int nodeIndex, unsigned int first, unsigned int count, int depth, const std::vector<ew::Vec3>& centroids) {
+		AABB bounds;
+		AABB centroidBounds;
+		for (unsigned int i = first; i < first + count; i++) {
+			bounds.expand(m_objectBounds[m_objectIndices[i]]);
+			centroidBounds.expand(centroids[m_objectIndices[i]]);
+		}
+		m_nodes[nodeIndex].bounds = bounds;
+
+		//Find the cheapest split plane by binning centroids along each axis
+		float bestCost = FLT_MAX;
+		int bestAxis = -1;
+		int bestSplit = 0;
+		float parentArea = fmaxf(SurfaceArea(bounds), FLT_MIN);
+		for (int axis = 0; axis < 3; axis++) {
+			float axisMin = (&centroidBounds.min.x)[axis];
+			float axisMax = (&centroidBounds.max.x)[axis];
+			if (axisMax - axisMin <= 0.0f) {
+				continue;
+			}
+			AABB binBounds[SAH_BINS];
+			unsigned int binCounts[SAH_BINS] = {};
+			float scale = SAH_BINS / (axisMax - axisMin);
+			for (unsigned int i = first; i < first + count; i++) {
+				unsigned int object = m_objectIndices[i];
+				int bin = centroidBin(centroids[object], axis, axisMin, scale);
+				binCounts[bin]++;
+				binBounds[bin].expand(m_objectBounds[object]);
+			}
+			//Sweep from the right to get the area and count past each plane
+			float rightArea[SAH_BINS];
+			unsigned int rightCount[SAH_BINS];
+			AABB sweep;
+			unsigned int sweepCount = 0;
+			for (int b = SAH_BINS - 1; b > 0; b--) {
+				sweep.expand(binBounds[b]);
+				sweepCount += binCounts[b];
+				rightArea[b] = sweepCount > 0 ? SurfaceArea(sweep) : 0.0f;
+				rightCount[b] = sweepCount;
+			}
+			sweep = AABB();
+			sweepCount = 0;
+			for (int b = 0; b < SAH_BINS - 1; b++) {
+				sweep.expand(binBounds[b]);
+				sweepCount += binCounts[b];
+				if (sweepCount == 0 || rightCount[b + 1] == 0) {
+					continue;
+				}
+				float cost = TRAVERSAL_COST + (SurfaceArea(sweep) * sweepCount + rightArea[b + 1] * rightCount[b + 1]) / parentArea;
+				if (cost < bestCost) {
+					bestCost = cost;
+					bestAxis = axis;
+					bestSplit = b;
+				}
+			}
+		}
+
+		//Stop splitting when testing every object is cheaper than splitting
+		if ((count <= MAX_LEAF_OBJECTS && bestCost >= (float)count) || count == 1 || depth >= MAX_DEPTH - 2) {
+			m_nodes[nodeIndex].first = first;
+			m_nodes[nodeIndex].count = count;
+			return;
+		}
+
+		unsigned int mid = first + count / 2;
+		if (bestAxis >= 0) {
+			float axisMin = (&centroidBounds.min.x)[bestAxis];
+			float scale = SAH_BINS / ((&centroidBounds.max.x)[bestAxis] - axisMin);
+			unsigned int* begin = m_objectIndices.data() + first;
+			unsigned int* split = std::partition(begin, begin + count, [&](unsigned int object) {
+				return centroidBin(centroids[object], bestAxis, axisMin, scale) <= bestSplit;
+			});
+			mid = first + (unsigned int)(split - begin);
+		}
+		//Otherwise every centroid is in the same place, so split the list in half
+
+		//Children are stored next to each other, always after their parent
+		unsigned int left = (unsigned int)m_nodes.size();
+		m_nodes[nodeIndex].first = left;
+		m_nodes[nodeIndex].count = 0;
+		m_nodes.push_back(Node());
+		m_nodes.push_back(Node());
+		buildNode(left, first, mid - first, depth + 1, centroids);
+		buildNode(left + 1, mid, first + count - mid, depth + 1, centroids);
+	}
+
+	void BVH::setBounds(unsigned int object, const AABB& bounds) {
+		m_objectBounds[object] = bounds;
+	}
+
+	void BVH::refit() {
+		//Children always have a higher index than their parent, so walking backwards visits children first
+		for (size_t i = m_nodes.size(); i-- > 0;) {
+			Node& node = m_nodes[i];
+			if (node.count > 0) {
+				AABB bounds;
+				for (unsigned int j = node.first; j < node.first + node.count; j++) {
+					bounds.expand(m_objectBounds[m_objectIndices[j]]);
+				}
+				node.bounds = bounds;
+			}
+			else {
+				node.bounds = Merge(m_nodes[node.first].bounds, m_nodes[node.first + 1].bounds);
+			}
+		}
+	}
+
+	void BVH::appendSubtree(unsigned int node, std::vector<unsigned int>* objects)const {
+		const Node& n = m_nodes[node];
+		if (n.count > 0) {
+			objects->insert(objects->end(), m_objectIndices.begin() + n.first, m_objectIndices.begin() + n.first + n.count);
+			return;
+		}
+		appendSubtree(n.first, objects);
+		appendSubtree(n.first + 1, objects);
+	}
+
+	void BVH::queryFrustum(const Frustum& frustum, std::vector<unsigned int>* objects)const {
+		if (m_nodes.empty()) {
+			return;
+		}
+		unsigned int stack[MAX_DEPTH];
+		int stackSize = 0;
+		stack[stackSize++] = 0;
+		while (stackSize > 0) {
+			unsigned int nodeIndex = stack[--stackSize];
+			const Node& node = m_nodes[nodeIndex];
+			Containment containment = Classify(frustum, node.bounds);
+			if (containment == Containment::OUTSIDE) {
+				continue;
+			}
+			if (containment == Containment::INSIDE) {
+				//Everything below is visible without further tests
+				appendSubtree(nodeIndex, objects);
+				continue;
+			}
+			if (node.count > 0) {
+				for (unsigned int i = node.first; i < node.first + node.count; i++) {
+					unsigned int object = m_objectIndices[i];
+					if (IsVisible(frustum, m_objectBounds[object])) {
+						objects->push_back(object);
+					}
+				}
+				continue;
+			}
+			stack[stackSize++] = node.first;
+			stack[stackSize++] = node.first + 1;
+		}
+	}
+
+	bool BVH::raycast(const Ray& ray, float maxDistance, RayHit* hit, const RayObjectTest& objectTest)const {
+		if (m_nodes.empty()) {
+			return false;
+		}
+		ew::Vec3 invDir = InverseDirection(ray.direction);
+		float closest = maxDistance;
+		bool found = false;
+		float tEnter;
+		if (!IntersectRayAABB(ray.origin, invDir, m_nodes[0].bounds, closest, &tEnter)) {
+			return false;
+		}
+		unsigned int stack[MAX_DEPTH];
+		int stackSize = 0;
+		stack[stackSize++] = 0;
+		while (stackSize > 0) {
+			const Node& node = m_nodes[stack[--stackSize]];
+			if (node.count > 0) {
+				for (unsigned int i = node.first; i < node.first + node.count; i++) {
+					unsigned int object = m_objectIndices[i];
+					float t;
+					if (!IntersectRayAABB(ray.origin, invDir, m_objectBounds[object], closest, &t)) {
+						continue;
+					}
+					if (objectTest && !objectTest(object, ray, closest, &t)) {
+						continue;
+					}
+					if (t <= closest) {
+						closest = t;
+						hit->object = object;
+						hit->distance = t;
+						found = true;
+					}
+				}
+				continue;
+			}
+			//Visit the nearer child first so the far one is more likely to be culled by closest
+			float tLeft, tRight;
+			bool hitLeft = IntersectRayAABB(ray.origin, invDir, m_nodes[node.first].bounds, closest, &tLeft);
+			bool hitRight = IntersectRayAABB(ray.origin, invDir, m_nodes[node.first + 1].bounds, closest, &tRight);
+			if (hitLeft && hitRight) {
+				bool leftFirst = tLeft <= tRight;
+				stack[stackSize++] = leftFirst ? node.first + 1 : node.first;
+				stack[stackSize++] = leftFirst ? node.first : node.first + 1;
+			}
+			else if (hitLeft) {
+				stack[stackSize++] = node.first;
+			}
+			else if (hitRight) {
+				stack[stackSize++] = node.first + 1;
+			}
+		}
+		return found;
+	}
+
+	bool BVH::nearest(const ew::Vec3& point, unsigned int* object, float* distance)const {
+		if (m_nodes.empty()) {
+			return false;
+		}
+		float bestDistSq = FLT_MAX;
+		bool found = false;
+		unsigned int stack[MAX_DEPTH];
+		int stackSize = 0;
+		stack[stackSize++] = 0;
+		while (stackSize > 0) {
+			const Node& node = m_nodes[stack[--stackSize]];
+			if (DistanceSquared(node.bounds, point) >= bestDistSq) {
+				continue;
+			}
+			if (node.count > 0) {
+				for (unsigned int i = node.first; i < node.first + node.count; i++) {
+					float d = DistanceSquared(m_objectBounds[m_objectIndices[i]], point);
+					if (d < bestDistSq) {
+						bestDistSq = d;
+						*object = m_objectIndices[i];
+						found = true;
+					}
+				}
+				continue;
+			}
+			float dLeft = DistanceSquared(m_nodes[node.first].bounds, point);
+			float dRight = DistanceSquared(m_nodes[node.first + 1].bounds, point);
+			//Push the far child first so the near one is popped next
+			bool leftFirst = dLeft <= dRight;
+			stack[stackSize++] = leftFirst ? node.first + 1 : node.first;
+			stack[stackSize++] = leftFirst ? node.first : node.first + 1;
+		}
+		if (found) {
+			*distance = sqrtf(bestDistSq);
+		}
+		return found;
+	}
+}
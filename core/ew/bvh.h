@@ -0,0 +1,67 @@
+#pragma once
+#include <vector>
+#include <functional>
+#include "bounds.h"
+#include "frustum.h"
+#include "transform.h"
+
+namespace ew {
+	struct RayHit {
+		unsigned int object = 0; //Index of the object that was hit
+		float distance = 0; //Distance along the ray
+	};
+
+	//Optional exact test run on objects whose box the ray touches.
+	//Return true and write the distance to accept the hit.
+	typedef std::function<bool(unsigned int object, const Ray& ray, float maxDistance, float* distance)> RayObjectTest;
+
+	/// <summary>
+	/// Bounding volume hierarchy over world space object bounds.
+	/// Built top down with the surface area heuristic. When objects move,
+	/// update their bounds and refit instead of rebuilding.
+	/// </summary>
+	class BVH {
+	public:
+		struct Node {
+			AABB bounds;
+			unsigned int first = 0; //Leaf: first entry in getObjectIndices(). Internal: left child (right is first + 1)
+			unsigned int count = 0; //Number of objects, 0 for internal nodes
+		};
+		//Trees are never built deeper than this, so traversal can use a fixed size stack
+		static const int MAX_DEPTH = 64;
+
+		//Builds the tree. Object i uses bounds[i].
+		void build(const std::vector<AABB>& bounds);
+		//Changes one object's bounds. Takes effect after refit()
+		void setBounds(unsigned int object, const AABB& bounds);
+		//Recomputes node bounds bottom up, keeping the tree topology
+		void refit();
+
+		//Appends every object whose bounds touch the frustum
+		void queryFrustum(const Frustum& frustum, std::vector<unsigned int>* objects)const;
+		//Closest hit along the ray. Tests object boxes unless an exact test is given
+		bool raycast(const Ray& ray, float maxDistance, RayHit* hit, const RayObjectTest& objectTest = nullptr)const;
+		//Object whose bounds are closest to a point
+		bool nearest(const ew::Vec3& point, unsigned int* object, float* distance)const;
+
+		inline size_t getNumObjects()const { return m_objectBounds.size(); }
+		inline size_t getNumNodes()const { return m_nodes.size(); }
+		inline const AABB& getObjectBounds(unsigned int object)const { return m_objectBounds[object]; }
+		//For walking the tree directly. Node 0 is the root.
+		inline const std::vector<Node>& getNodes()const { return m_nodes; }
+		//Objects in leaf order
+		inline const std::vector<unsigned int>& getObjectIndices()const { return m_objectIndices; }
+	private:
+		void buildNode(unsigned int nodeIndex, unsigned int first, unsigned int count, int depth, const std::vector<ew::Vec3>& centroids);
+		void appendSubtree(unsigned int node, std::vector<unsigned int>* objects)const;
+
+		std::vector<Node> m_nodes;
+		std::vector<unsigned int> m_objectIndices;
+		std::vector<AABB> m_objectBounds;
+	};
+
+	//World space bounds of a mesh placed by a transform
+	inline AABB WorldBounds(const AABB& localBounds, const ew::Transform& transform) {
+		return TransformAABB(localBounds, transform.getModelMatrix());
+	}
+}
@@ -1,4 +1,5 @@
 #include "cameraController.h"
+#include "raycast.h"
 namespace ew {
 	void CameraController::Move(GLFWwindow* window, ew::Camera* camera, float deltaTime) {
 		//Only allow movement if right mouse is held
@@ -75,4 +76,12 @@ namespace ew {
 			camera->target = camera->position + forward;
 		}
 	}
+	ew::Ray CameraController::GetMouseRay(GLFWwindow* window, const ew::Camera* camera) const {
+		double mouseX, mouseY;
+		glfwGetCursorPos(window, &mouseX, &mouseY);
+		//Cursor position is in screen coordinates, which match window size rather than framebuffer size
+		int width, height;
+		glfwGetWindowSize(window, &width, &height);
+		return ew::ScreenPointToRay(*camera, (float)mouseX, (float)mouseY, (float)width, (float)height);
+	}
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 #include <GLFW/glfw3.h>
 #include "camera.h"
+#include "bounds.h"
 
 namespace ew {
 	struct CameraController {
@@ -15,5 +16,7 @@ namespace ew {
 
 		//Using input from window, aim and rotate camera
 		void Move(GLFWwindow* window, ew::Camera* camera, float deltaTime);
+		//World space ray from the camera through the mouse cursor, for selecting objects
+		ew::Ray GetMouseRay(GLFWwindow* window, const ew::Camera* camera)const;
 	};
 }
\ No newline at end of file
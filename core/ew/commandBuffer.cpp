@@ -0,0 +1,227 @@
+#include "commandBuffer.h"
+#include "bindTracker.h"
+#include "hash.h"
+#include "external/glad.h"
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+namespace ew {
+	LinearAllocator::LinearAllocator(size_t blockSize)
+		: m_blockSize(blockSize)
+	{
+	}
+
+	LinearAllocator::~LinearAllocator()
+	{
+		for (Block& block : m_blocks) {
+			free(block.data);
+		}
+	}
+
+	void* LinearAllocator::allocate(size_t size, size_t alignment)
+	{
+		while (true) {
+			if (m_block < m_blocks.size()) {
+				Block& block = m_blocks[m_block];
+				//Aligned by address, since malloc only guarantees max_align_t
+				uintptr_t start = (uintptr_t)block.data;
+				size_t offset = (size_t)(((start + m_offset + alignment - 1) & ~(uintptr_t)(alignment - 1)) - start);
+				if (offset + size <= block.size) {
+					m_used += offset + size - m_offset;
+					m_offset = offset + size;
+					return block.data + offset;
+				}
+				//Try the next kept block, or make a new one
+				m_block++;
+				m_offset = 0;
+				if (m_block < m_blocks.size()) {
+					continue;
+				}
+			}
+			Block block;
+			block.size = size + alignment > m_blockSize ? size + alignment : m_blockSize;
+			block.data = (unsigned char*)malloc(block.size);
+			m_reserved += block.size;
+			m_blocks.push_back(block);
+			m_block = m_blocks.size() - 1;
+			m_offset = 0;
+		}
+	}
+
+	void LinearAllocator::reset()
+	{
+		m_block = 0;
+		m_offset = 0;
+		m_used = 0;
+	}
+
+	CommandBuffer::CommandBuffer(size_t blockSize)
+		: m_memory(blockSize)
+	{
+	}
+
+	void CommandBuffer::reset()
+	{
+		m_memory.reset();
+		m_first = m_last = nullptr;
+		m_numDraws = 0;
+	}
+
+	void CommandBuffer::draw(const Shader& shader, unsigned int texture, unsigned int sampler, const Mesh& mesh)
+	{
+		DrawCommand* command = (DrawCommand*)m_memory.allocate(sizeof(DrawCommand), alignof(DrawCommand));
+		command->program = shader.getID();
+		command->texture = texture;
+		command->sampler = sampler;
+		command->vertexArray = mesh.getVAO();
+		command->numIndices = mesh.getNumIndices();
+		command->uniforms = command->lastUniform = nullptr;
+		command->next = nullptr;
+		if (m_last) {
+			m_last->next = command;
+		}
+		else {
+			m_first = command;
+		}
+		m_last = command;
+		m_numDraws++;
+	}
+
+	void CommandBuffer::addUniform(const char* name, UniformType type, const void* value, size_t size)
+	{
+		if (!m_last) {
+			return;
+		}
+		//The value goes straight after its header, which is already aligned for floats and ints
+		UniformCommand* uniform = (UniformCommand*)m_memory.allocate(sizeof(UniformCommand) + size, alignof(UniformCommand));
+		uniform->name = name;
+		uniform->type = type;
+		uniform->next = nullptr;
+		memcpy(uniform + 1, value, size);
+		if (m_last->lastUniform) {
+			m_last->lastUniform->next = uniform;
+		}
+		else {
+			m_last->uniforms = uniform;
+		}
+		m_last->lastUniform = uniform;
+	}
+
+	void CommandBuffer::setInt(const char* name, int v)
+	{
+		addUniform(name, UniformType::INT, &v, sizeof(v));
+	}
+
+	void CommandBuffer::setFloat(const char* name, float v)
+	{
+		addUniform(name, UniformType::FLOAT, &v, sizeof(v));
+	}
+
+	void CommandBuffer::setVec3(const char* name, const ew::Vec3& v)
+	{
+		float values[3] = { v.x, v.y, v.z };
+		addUniform(name, UniformType::VEC3, values, sizeof(values));
+	}
+
+	void CommandBuffer::setVec4(const char* name, const ew::Vec4& v)
+	{
+		float values[4] = { v.x, v.y, v.z, v.w };
+		addUniform(name, UniformType::VEC4, values, sizeof(values));
+	}
+
+	void CommandBuffer::setMat4(const char* name, const ew::Mat4& m)
+	{
+		addUniform(name, UniformType::MAT4, &m[0][0], sizeof(float) * 16);
+	}
+
+	size_t CommandQueue::UniformKeyHash::operator()(const UniformKey& key)const
+	{
+		return (size_t)HashBytes(key.name.data(), key.name.size(), HashBytes(&key.program, sizeof(key.program)));
+	}
+
+	CommandQueue::CommandQueue(int numBuffers)
+	{
+		begin(numBuffers);
+	}
+
+	void CommandQueue::begin(int numBuffers)
+	{
+		while ((int)m_buffers.size() < numBuffers) {
+			m_buffers.push_back(std::make_unique<CommandBuffer>());
+		}
+		m_numBuffers = numBuffers;
+		for (int i = 0; i < numBuffers; i++) {
+			m_buffers[i]->reset();
+		}
+	}
+
+	void CommandQueue::invalidatePrograms()
+	{
+		m_locations.clear();
+	}
+
+	int CommandQueue::getLocation(unsigned int program, const char* name)
+	{
+		m_lookupKey.program = program;
+		m_lookupKey.name = name;
+		auto it = m_locations.find(m_lookupKey);
+		if (it == m_locations.end()) {
+			it = m_locations.emplace(m_lookupKey, glGetUniformLocation(program, name)).first;
+		}
+		return it->second;
+	}
+
+	void CommandQueue::replay()
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		m_stats = CommandQueueStats();
+		BindTracker bound;
+		glActiveTexture(GL_TEXTURE0);
+		for (int i = 0; i < m_numBuffers; i++) {
+			m_stats.recordedBytes += m_buffers[i]->getMemory().getUsedBytes();
+			for (const DrawCommand* command = m_buffers[i]->getFirst(); command; command = command->next) {
+				if (bound.changeProgram(command->program)) {
+					glUseProgram(command->program);
+					m_stats.programChanges++;
+				}
+				if (command->texture && bound.changeTexture(command->texture)) {
+					glBindTexture(GL_TEXTURE_2D, command->texture);
+					m_stats.textureChanges++;
+				}
+				if (command->texture && bound.changeSampler(command->sampler)) {
+					glBindSampler(0, command->sampler);
+				}
+				if (bound.changeVertexArray(command->vertexArray)) {
+					glBindVertexArray(command->vertexArray);
+					m_stats.meshChanges++;
+				}
+				for (const UniformCommand* uniform = command->uniforms; uniform; uniform = uniform->next) {
+					int location = getLocation(command->program, uniform->name);
+					const float* values = (const float*)(uniform + 1);
+					switch (uniform->type) {
+					case UniformType::INT:
+						glUniform1i(location, *(const int*)(uniform + 1));
+						break;
+					case UniformType::FLOAT:
+						glUniform1f(location, values[0]);
+						break;
+					case UniformType::VEC3:
+						glUniform3f(location, values[0], values[1], values[2]);
+						break;
+					case UniformType::VEC4:
+						glUniform4f(location, values[0], values[1], values[2], values[3]);
+						break;
+					case UniformType::MAT4:
+						glUniformMatrix4fv(location, 1, GL_FALSE, values);
+						break;
+					}
+					m_stats.uniforms++;
+				}
+				glDrawElements(GL_TRIANGLES, command->numIndices, GL_UNSIGNED_INT, NULL);
+				m_stats.draws++;
+			}
+		}
+		m_stats.replayMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+}
@@ -0,0 +1,150 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <string>
+#include "ewMath/ewMath.h"
+#include "shader.h"
+#include "mesh.h"
+
+namespace ew {
+	/// <summary>
+	/// Hands out memory by bumping a pointer through fixed size blocks, and frees it all at once with reset().
+	/// Blocks are kept between resets, so a steady workload stops allocating after the first frame. Not thread safe;
+	/// give each thread its own.
+	/// </summary>
+	class LinearAllocator {
+	public:
+		LinearAllocator(size_t blockSize = 64 * 1024);
+		~LinearAllocator();
+		LinearAllocator(const LinearAllocator&) = delete;
+		LinearAllocator& operator=(const LinearAllocator&) = delete;
+
+		//alignment must be a power of two. Sizes over the block size get a block of their own.
+		void* allocate(size_t size, size_t alignment = alignof(max_align_t));
+		void reset();
+
+		inline size_t getUsedBytes()const { return m_used; }
+		inline size_t getReservedBytes()const { return m_reserved; }
+	private:
+		struct Block {
+			unsigned char* data;
+			size_t size;
+		};
+		std::vector<Block> m_blocks;
+		size_t m_blockSize;
+		size_t m_block = 0; //Block currently being filled
+		size_t m_offset = 0; //Into that block
+		size_t m_used = 0;
+		size_t m_reserved = 0;
+	};
+
+	enum class UniformType : uint8_t {
+		INT,
+		FLOAT,
+		VEC3,
+		VEC4,
+		MAT4
+	};
+
+	//A uniform value copied into a command buffer, followed in memory by the value itself
+	struct UniformCommand {
+		const char* name; //Must outlive the replay, e.g. a string literal
+		UniformType type;
+		UniformCommand* next;
+	};
+
+	//Everything one draw needs, recorded without touching GL
+	struct DrawCommand {
+		unsigned int program;
+		unsigned int texture; //0 leaves whatever is bound
+		unsigned int sampler;
+		unsigned int vertexArray;
+		int numIndices;
+		UniformCommand* uniforms;
+		UniformCommand* lastUniform;
+		DrawCommand* next;
+	};
+
+	/// <summary>
+	/// Draws recorded on any thread into its own LinearAllocator, for CommandQueue to issue on the GL thread later.
+	/// Uniforms set after draw() belong to that draw. Nothing here calls GL, and one buffer must only be
+	/// recorded by one thread at a time.
+	/// </summary>
+	class CommandBuffer {
+	public:
+		CommandBuffer(size_t blockSize = 64 * 1024);
+
+		//Drops every recorded command and reuses the memory
+		void reset();
+		void draw(const Shader& shader, unsigned int texture, unsigned int sampler, const Mesh& mesh);
+		void setInt(const char* name, int v);
+		void setFloat(const char* name, float v);
+		void setVec3(const char* name, const ew::Vec3& v);
+		void setVec4(const char* name, const ew::Vec4& v);
+		void setMat4(const char* name, const ew::Mat4& m);
+
+		inline const DrawCommand* getFirst()const { return m_first; }
+		inline int getNumDraws()const { return m_numDraws; }
+		inline const LinearAllocator& getMemory()const { return m_memory; }
+	private:
+		void addUniform(const char* name, UniformType type, const void* value, size_t size);
+
+		LinearAllocator m_memory;
+		DrawCommand* m_first = nullptr;
+		DrawCommand* m_last = nullptr;
+		int m_numDraws = 0;
+	};
+
+	struct CommandQueueStats {
+		int draws = 0;
+		int programChanges = 0;
+		int textureChanges = 0;
+		int meshChanges = 0;
+		int uniforms = 0;
+		size_t recordedBytes = 0; //Used in every buffer's allocator
+		float replayMs = 0;
+	};
+
+	/// <summary>
+	/// One CommandBuffer per recording task, replayed in buffer order on the GL thread. Splitting a scene into
+	/// fixed chunks, each recorded into the buffer with its index (e.g. with JobSystem::parallelFor), issues
+	/// the same calls in the same order however many threads recorded it. Program, texture and vertex array
+	/// binds are skipped when unchanged, and uniform locations are looked up once per program and name until invalidatePrograms().
+	/// </summary>
+	class CommandQueue {
+	public:
+		CommandQueue(int numBuffers = 1);
+
+		//Resets every buffer, growing or shrinking to numBuffers
+		void begin(int numBuffers);
+		inline CommandBuffer& getBuffer(int index) { return *m_buffers[index]; }
+		inline int getNumBuffers()const { return m_numBuffers; }
+		//Issues every buffer's draws in order. Must be on the thread with the GL context.
+		void replay();
+		//Forgets uniform locations. Call when programs are deleted or relinked, as with RenderQueue.
+		void invalidatePrograms();
+
+		inline const CommandQueueStats& getStats()const { return m_stats; }
+	private:
+		//Keyed by the name's contents, so equal names recorded from different strings share a location, and a
+		//pointer reused for another name can't find the old one
+		struct UniformKey {
+			unsigned int program;
+			std::string name;
+			bool operator==(const UniformKey& other)const { return program == other.program && name == other.name; }
+		};
+		struct UniformKeyHash {
+			size_t operator()(const UniformKey& key)const;
+		};
+		int getLocation(unsigned int program, const char* name);
+
+		std::vector<std::unique_ptr<CommandBuffer>> m_buffers; //Buffers don't move when more are added
+		int m_numBuffers = 0;
+		std::unordered_map<UniformKey, int, UniformKeyHash> m_locations;
+		UniformKey m_lookupKey; //Reused by getLocation(), so lookups stop allocating once its name has grown
+		CommandQueueStats m_stats;
+	};
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+
+//SSE2 is baseline on every x64 compiler, so use it whenever it is available
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define EW_SIMD_SSE2 1
+#include <emmintrin.h>
+#else
+#define EW_SIMD_SSE2 0
+#endif
+
+namespace ew {
+	//4 floats processed together. Comparisons return masks (all bits set per true lane).
+	//Falls back to plain arrays when SSE2 is not available.
+	struct Float4 {
+#if EW_SIMD_SSE2
+		__m128 v;
+#else
+		float v[4];
+#endif
+	};
+
+#if EW_SIMD_SSE2
+	inline Float4 Float4Set1(float x) { return { _mm_set1_ps(x) }; }
+	inline Float4 Float4Set(float x, float y, float z, float w) { return { _mm_setr_ps(x, y, z, w) }; }
+	inline Float4 Float4Load(const float* p) { return { _mm_loadu_ps(p) }; }
+	inline void Float4Store(float* p, const Float4& a) { _mm_storeu_ps(p, a.v); }
+	inline Float4 operator+(const Float4& a, const Float4& b) { return { _mm_add_ps(a.v, b.v) }; }
+	inline Float4 operator-(const Float4& a, const Float4& b) { return { _mm_sub_ps(a.v, b.v) }; }
+	inline Float4 operator*(const Float4& a, const Float4& b) { return { _mm_mul_ps(a.v, b.v) }; }
+	inline Float4 operator/(const Float4& a, const Float4& b) { return { _mm_div_ps(a.v, b.v) }; }
+	inline Float4 operator&(const Float4& a, const Float4& b) { return { _mm_and_ps(a.v, b.v) }; }
+	inline Float4 operator|(const Float4& a, const Float4& b) { return { _mm_or_ps(a.v, b.v) }; }
+	inline Float4 Min(const Float4& a, const Float4& b) { return { _mm_min_ps(a.v, b.v) }; }
+	inline Float4 Max(const Float4& a, const Float4& b) { return { _mm_max_ps(a.v, b.v) }; }
+	inline Float4 Abs(const Float4& a) { return { _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v) }; }
+	inline Float4 Sqrt(const Float4& a) { return { _mm_sqrt_ps(a.v) }; }
+	inline Float4 CmpLt(const Float4& a, const Float4& b) { return { _mm_cmplt_ps(a.v, b.v) }; }
+	inline Float4 CmpLe(const Float4& a, const Float4& b) { return { _mm_cmple_ps(a.v, b.v) }; }
+	inline Float4 CmpGt(const Float4& a, const Float4& b) { return { _mm_cmpgt_ps(a.v, b.v) }; }
+	inline Float4 CmpGe(const Float4& a, const Float4& b) { return { _mm_cmpge_ps(a.v, b.v) }; }
+	//Lanes of a where mask is not set
+	inline Float4 AndNot(const Float4& mask, const Float4& a) { return { _mm_andnot_ps(mask.v, a.v) }; }
+	//Per lane: mask ? a : b
+	inline Float4 Select(const Float4& mask, const Float4& a, const Float4& b) {
+		return { _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)) };
+	}
+	//One bit per lane, lane 0 in bit 0
+	inline int MoveMask(const Float4& mask) { return _mm_movemask_ps(mask.v); }
+#else
+	inline Float4 Float4Set1(float x) { return { { x, x, x, x } }; }
+	inline Float4 Float4Set(float x, float y, float z, float w) { return { { x, y, z, w } }; }
+	inline Float4 Float4Load(const float* p) { return { { p[0], p[1], p[2], p[3] } }; }
+	inline void Float4Store(float* p, const Float4& a) { for (int i = 0; i < 4; i++) p[i] = a.v[i]; }
+
+	namespace detail {
+		inline uint32_t floatBits(float f) { uint32_t u; memcpy(&u, &f, 4); return u; }
+		inline float bitsFloat(uint32_t u) { float f; memcpy(&f, &u, 4); return f; }
+		inline float maskLane(bool b) { return bitsFloat(b ? 0xFFFFFFFFu : 0u); }
+	}
+#define EW_FLOAT4_LANEWISE(expr) Float4 r; for (int i = 0; i < 4; i++) { r.v[i] = (expr); } return r;
+	inline Float4 operator+(const Float4& a, const Float4& b) { EW_FLOAT4_LANEWISE(a.v[i] + b.v[i]) }
+	inline Float4 operator-(const Float4& a, const Float4& b) { EW_FLOAT4_LANEWISE(a.v[i] - b.v[i]) }
+	inline Float4 operator*(const Float4& a, const Float4& b) { EW_FLOAT4_LANEWISE(a.v[i] * b.v[i]) }
+	inline Float4 operator/(const Float4& a, const Float4& b) { EW_FLOAT4_LANEWISE(a.v[i] / b.v[i]) }
+	inline Float4 operator&(const Float4& a, const Float4& b) { EW_FLOAT4_LANEWISE(detail::bitsFloat(detail::floatBits(a.v[i]) & detail::floatBits(b.v[i]))) }
+	inline Float4 operator|(const Float4& a, const Float4& b) { EW_FLOAT4_LANEWISE(detail::bitsFloat(detail::floatBits(a.v[i]) | detail::floatBits(b.v[i]))) }
+	inline Float4 Min(const Float4& a, const Float4& b) { EW_FLOAT4_LANEWISE(a.v[i] < b.v[i] ? a.v[i] : b.v[i]) }
+	inline Float4 Max(const Float4& a, const Float4& b) { EW_FLOAT4_LANEWISE(a.v[i] > b.v[i] ? a.v[i] : b.v[i]) }
+	inline Float4 Abs(const Float4& a) { EW_FLOAT4_LANEWISE(fabsf(a.v[i])) }
+	inline Float4 Sqrt(const Float4& a) { EW_FLOAT4_LANEWISE(sqrtf(a.v[i])) }
+	inline Float4 CmpLt(const Float4& a, const Float4& b) { EW_FLOAT4_LANEWISE(detail::maskLane(a.v[i] < b.v[i])) }
+	inline Float4 CmpLe(const Float4& a, const Float4& b) { EW_FLOAT4_LANEWISE(detail::maskLane(a.v[i] <= b.v[i])) }
+	inline Float4 CmpGt(const Float4& a, const Float4& b) { EW_FLOAT4_LANEWISE(detail::maskLane(a.v[i] > b.v[i])) }
+	inline Float4 CmpGe(const Float4& a, const Float4& b) { EW_FLOAT4_LANEWISE(detail::maskLane(a.v[i] >= b.v[i])) }
+	inline Float4 AndNot(const Float4& mask, const Float4& a) { EW_FLOAT4_LANEWISE(detail::bitsFloat(~detail::floatBits(mask.v[i]) & detail::floatBits(a.v[i]))) }
+	inline Float4 Select(const Float4& mask, const Float4& a, const Float4& b) { EW_FLOAT4_LANEWISE(detail::floatBits(mask.v[i]) ? a.v[i] : b.v[i]) }
+#undef EW_FLOAT4_LANEWISE
+	inline int MoveMask(const Float4& mask) {
+		int bits = 0;
+		for (int i = 0; i < 4; i++) {
+			bits |= (detail::floatBits(mask.v[i]) >> 31) << i;
+		}
+		return bits;
+	}
+#endif
+	//a * b + c
+	inline Float4 MulAdd(const Float4& a, const Float4& b, const Float4& c) {
+		return a * b + c;
+	}
+}
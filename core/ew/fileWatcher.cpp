@@ -0,0 +1,128 @@
+#include "fileWatcher.h"
+#include <stdio.h>
+#include <chrono>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace {
+	std::string normalizePath(const std::string& path) {
+		return std::filesystem::path(path).lexically_normal().generic_string();
+	}
+
+	std::string getDirectory(const std::string& path) {
+		std::string directory = std::filesystem::path(path).parent_path().generic_string();
+		return directory.empty() ? "." : directory;
+	}
+}
+
+namespace ew {
+	FileWatcher::FileWatcher(bool useNotifications, int pollMs)
+		: m_pollMs(pollMs > 0 ? pollMs : 1)
+	{
+#ifdef __linux__
+		if (useNotifications) {
+			m_notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+			if (m_notifyFd < 0) {
+				printf("inotify unavailable, polling for file changes instead\n");
+			}
+		}
+#endif
+		if (m_notifyFd >= 0) {
+			m_thread = std::thread(&FileWatcher::notifyLoop, this);
+		}
+		else {
+			m_thread = std::thread(&FileWatcher::pollLoop, this);
+		}
+	}
+
+	FileWatcher::~FileWatcher()
+	{
+		m_quit = true;
+		m_thread.join();
+#ifdef __linux__
+		if (m_notifyFd >= 0) {
+			close(m_notifyFd);
+		}
+#endif
+	}
+
+	void FileWatcher::watch(const std::string& filePath)
+	{
+		std::string path = normalizePath(filePath);
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_files.count(path)) {
+			return;
+		}
+		std::error_code error;
+		m_files[path] = std::filesystem::last_write_time(path, error);
+#ifdef __linux__
+		if (m_notifyFd >= 0) {
+			//Adding the same directory again returns its existing descriptor
+			std::string directory = getDirectory(path);
+			int descriptor = inotify_add_watch(m_notifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+			if (descriptor < 0) {
+				printf("Failed to watch %s\n", directory.c_str());
+				return;
+			}
+			m_directories[descriptor] = directory;
+		}
+#endif
+	}
+
+	std::vector<std::string> FileWatcher::takeChanges()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		std::vector<std::string> changes(m_changes.begin(), m_changes.end());
+		m_changes.clear();
+		return changes;
+	}
+
+	void FileWatcher::notifyLoop()
+	{
+#ifdef __linux__
+		//Room for plenty of events, aligned for inotify_event
+		alignas(inotify_event) char buffer[4096];
+		while (!m_quit) {
+			pollfd request = { m_notifyFd, POLLIN, 0 };
+			if (poll(&request, 1, m_pollMs) <= 0) {
+				continue;
+			}
+			ssize_t length;
+			while ((length = read(m_notifyFd, buffer, sizeof(buffer))) > 0) {
+				std::lock_guard<std::mutex> lock(m_mutex);
+				for (char* event = buffer; event < buffer + length; ) {
+					const inotify_event* notification = (const inotify_event*)event;
+					auto directory = m_directories.find(notification->wd);
+					if (notification->len > 0 && directory != m_directories.end()) {
+						std::string path = normalizePath(directory->second + "/" + notification->name);
+						if (m_files.count(path)) {
+							m_changes.insert(path);
+						}
+					}
+					event += sizeof(inotify_event) + notification->len;
+				}
+			}
+		}
+#endif
+	}
+
+	void FileWatcher::pollLoop()
+	{
+		while (!m_quit) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(m_pollMs));
+			std::lock_guard<std::mutex> lock(m_mutex);
+			for (auto& file : m_files) {
+				std::error_code error;
+				std::filesystem::file_time_type time = std::filesystem::last_write_time(file.first, error);
+				//Missing while an editor swaps the file in, so wait until it's back
+				if (!error && time != file.second) {
+					file.second = time;
+					m_changes.insert(file.first);
+				}
+			}
+		}
+	}
+}
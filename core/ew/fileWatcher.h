@@ -0,0 +1,46 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <filesystem>
+
+namespace ew {
+	/// <summary>
+	/// Watches files for changes on a background thread. On Linux the thread sleeps on inotify,
+	/// watching each file's directory so editors that save by replacing the file are still seen.
+	/// Elsewhere, or if inotify is unavailable, it polls modification times instead.
+	/// Paths are normalized, so changes are reported as they were passed to watch() once normalized.
+	/// </summary>
+	class FileWatcher {
+	public:
+		//useNotifications false always polls. pollMs is the polling interval, and how often the thread checks whether to stop.
+		FileWatcher(bool useNotifications = true, int pollMs = 250);
+		~FileWatcher();
+		FileWatcher(const FileWatcher&) = delete;
+		FileWatcher& operator=(const FileWatcher&) = delete;
+
+		//Thread safe. Watching a file twice does nothing.
+		void watch(const std::string& filePath);
+		//Files written since the last call, each listed once. Thread safe.
+		std::vector<std::string> takeChanges();
+
+		//False when polling
+		inline bool isNotifying()const { return m_notifyFd >= 0; }
+	private:
+		void notifyLoop();
+		void pollLoop();
+
+		int m_pollMs;
+		int m_notifyFd = -1;
+		std::unordered_map<std::string, std::filesystem::file_time_type> m_files; //Last write time, for polling
+		std::unordered_map<int, std::string> m_directories; //inotify watch descriptor to directory
+		std::unordered_set<std::string> m_changes;
+		std::mutex m_mutex;
+		std::atomic<bool> m_quit{ false };
+		std::thread m_thread;
+	};
+}
@@ -0,0 +1,211 @@
+#include "frustum.h"
+#include "ewMath/simd.h"
+
+namespace ew {
+	void SphereBatch::add(const BoundingSphere& s) {
+		x.push_back(s.center.x);
+		y.push_back(s.center.y);
+		z.push_back(s.center.z);
+		radius.push_back(s.radius);
+	}
+	void SphereBatch::clear() {
+		x.clear(); y.clear(); z.clear(); radius.clear();
+	}
+	void SphereBatch::reserve(size_t n) {
+		x.reserve(n); y.reserve(n); z.reserve(n); radius.reserve(n);
+	}
+
+	void AABBBatch::add(const AABB& box) {
+		ew::Vec3 c = box.center();
+		ew::Vec3 e = box.extents();
+		centerX.push_back(c.x); centerY.push_back(c.y); centerZ.push_back(c.z);
+		extentX.push_back(e.x); extentY.push_back(e.y); extentZ.push_back(e.z);
+	}
+	void AABBBatch::clear() {
+		centerX.clear(); centerY.clear(); centerZ.clear();
+		extentX.clear(); extentY.clear(); extentZ.clear();
+	}
+	void AABBBatch::reserve(size_t n) {
+		centerX.reserve(n); centerY.reserve(n); centerZ.reserve(n);
+		extentX.reserve(n); extentY.reserve(n); extentZ.reserve(n);
+	}
+
+	static Plane normalizePlane(float a, float b, float c, float d) {
+		float mag = sqrtf(a * a + b * b + c * c);
+		Plane p;
+		p.normal = ew::Vec3(a, b, c) / mag;
+		p.distance = d / mag;
+		return p;
+	}
+
+	/// <summary>
+	/// Extracts the 6 clip planes from a view projection matrix (Gribb/Hartmann).
+	/// Planes are in world space when given projection * view.
+	/// </summary>
+	/// <param name="m">Projection * View matrix, OpenGL clip space (-w..w on all axes)</param>
+	Frustum CreateFrustum(const ew::Mat4& m) {
+		//Matrix is stored by column, so row i is m[0][i], m[1][i], m[2][i], m[3][i]
+		Frustum f;
+		for (int i = 0; i < 3; i++) {
+			f.planes[i * 2] = normalizePlane(
+				m[0][3] + m[0][i], m[1][3] + m[1][i], m[2][3] + m[2][i], m[3][3] + m[3][i]);
+			f.planes[i * 2 + 1] = normalizePlane(
+				m[0][3] - m[0][i], m[1][3] - m[1][i], m[2][3] - m[2][i], m[3][3] - m[3][i]);
+		}
+		return f;
+	}
+
+	Frustum CreateFrustum(const ew::Camera& camera) {
+		return CreateFrustum(camera.ProjectionMatrix() * camera.ViewMatrix());
+	}
+
+	bool IsVisible(const Frustum& frustum, const BoundingSphere& sphere) {
+		for (int i = 0; i < FRUSTUM_PLANE_COUNT; i++) {
+			const Plane& p = frustum.planes[i];
+			if (ew::Dot(p.normal, sphere.center) + p.distance < -sphere.radius) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool IsVisible(const Frustum& frustum, const AABB& box) {
+		ew::Vec3 c = box.center();
+		ew::Vec3 e = box.extents();
+		for (int i = 0; i < FRUSTUM_PLANE_COUNT; i++) {
+			const Plane& p = frustum.planes[i];
+			//Projected radius of the box onto the plane normal
+			float r = fabsf(p.normal.x) * e.x + fabsf(p.normal.y) * e.y + fabsf(p.normal.z) * e.z;
+			if (ew::Dot(p.normal, c) + p.distance < -r) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	Containment Classify(const Frustum& frustum, const AABB& box) {
+		ew::Vec3 c = box.center();
+		ew::Vec3 e = box.extents();
+		Containment result = Containment::INSIDE;
+		for (int i = 0; i < FRUSTUM_PLANE_COUNT; i++) {
+			const Plane& p = frustum.planes[i];
+			float r = fabsf(p.normal.x) * e.x + fabsf(p.normal.y) * e.y + fabsf(p.normal.z) * e.z;
+			float d = ew::Dot(p.normal, c) + p.distance;
+			if (d < -r) {
+				return Containment::OUTSIDE;
+			}
+			if (d < r) {
+				result = Containment::INTERSECTS;
+			}
+		}
+		return result;
+	}
+
+	//Plane components splatted across 4 lanes
+	struct PlaneX4 {
+		Float4 nx, ny, nz, d;
+		Float4 absX, absY, absZ;
+	};
+
+	static void splatPlanes(const Frustum& frustum, PlaneX4* out) {
+		for (int i = 0; i < FRUSTUM_PLANE_COUNT; i++) {
+			const Plane& p = frustum.planes[i];
+			out[i].nx = Float4Set1(p.normal.x);
+			out[i].ny = Float4Set1(p.normal.y);
+			out[i].nz = Float4Set1(p.normal.z);
+			out[i].d = Float4Set1(p.distance);
+			out[i].absX = Float4Set1(fabsf(p.normal.x));
+			out[i].absY = Float4Set1(fabsf(p.normal.y));
+			out[i].absZ = Float4Set1(fabsf(p.normal.z));
+		}
+	}
+
+	static void appendVisible(int laneMask, size_t base, std::vector<unsigned int>* visible) {
+		while (laneMask) {
+			int lane = 0;
+			while (!(laneMask & (1 << lane))) lane++;
+			visible->push_back((unsigned int)(base + lane));
+			laneMask &= laneMask - 1;
+		}
+	}
+
+	/// <summary>
+	/// Tests 4 spheres per iteration against all 6 planes.
+	/// </summary>
+	/// <param name="frustum">Frustum to test against</param>
+	/// <param name="spheres">Bounds in SoA form</param>
+	/// <param name="visible">Receives indices of visible spheres</param>
+	/// <returns>Number of visible spheres</returns>
+	size_t CullSpheres(const Frustum& frustum, const SphereBatch& spheres, std::vector<unsigned int>* visible) {
+		PlaneX4 planes[FRUSTUM_PLANE_COUNT];
+		splatPlanes(frustum, planes);
+
+		size_t count = spheres.size();
+		size_t start = visible->size();
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			Float4 x = Float4Load(&spheres.x[i]);
+			Float4 y = Float4Load(&spheres.y[i]);
+			Float4 z = Float4Load(&spheres.z[i]);
+			Float4 negR = Float4Set1(0.0f) - Float4Load(&spheres.radius[i]);
+			Float4 outside = Float4Set1(0.0f);
+			for (int p = 0; p < FRUSTUM_PLANE_COUNT; p++) {
+				Float4 dist = MulAdd(planes[p].nx, x, MulAdd(planes[p].ny, y, MulAdd(planes[p].nz, z, planes[p].d)));
+				outside = outside | CmpLt(dist, negR);
+			}
+			appendVisible(~MoveMask(outside) & 0xF, i, visible);
+		}
+		//Remainder
+		for (; i < count; i++) {
+			BoundingSphere s;
+			s.center = ew::Vec3(spheres.x[i], spheres.y[i], spheres.z[i]);
+			s.radius = spheres.radius[i];
+			if (IsVisible(frustum, s)) {
+				visible->push_back((unsigned int)i);
+			}
+		}
+		return visible->size() - start;
+	}
+
+	/// <summary>
+	/// Tests 4 boxes per iteration against all 6 planes.
+	/// </summary>
+	/// <param name="frustum">Frustum to test against</param>
+	/// <param name="boxes">Bounds in SoA form</param>
+	/// <param name="visible">Receives indices of visible boxes</param>
+	/// <returns>Number of visible boxes</returns>
+	size_t CullAABBs(const Frustum& frustum, const AABBBatch& boxes, std::vector<unsigned int>* visible) {
+		PlaneX4 planes[FRUSTUM_PLANE_COUNT];
+		splatPlanes(frustum, planes);
+
+		size_t count = boxes.size();
+		size_t start = visible->size();
+		size_t i = 0;
+		for (; i + 4 <= count; i += 4) {
+			Float4 cx = Float4Load(&boxes.centerX[i]);
+			Float4 cy = Float4Load(&boxes.centerY[i]);
+			Float4 cz = Float4Load(&boxes.centerZ[i]);
+			Float4 ex = Float4Load(&boxes.extentX[i]);
+			Float4 ey = Float4Load(&boxes.extentY[i]);
+			Float4 ez = Float4Load(&boxes.extentZ[i]);
+			Float4 outside = Float4Set1(0.0f);
+			for (int p = 0; p < FRUSTUM_PLANE_COUNT; p++) {
+				Float4 dist = MulAdd(planes[p].nx, cx, MulAdd(planes[p].ny, cy, MulAdd(planes[p].nz, cz, planes[p].d)));
+				Float4 radius = MulAdd(planes[p].absX, ex, MulAdd(planes[p].absY, ey, planes[p].absZ * ez));
+				outside = outside | CmpLt(dist + radius, Float4Set1(0.0f));
+			}
+			appendVisible(~MoveMask(outside) & 0xF, i, visible);
+		}
+		for (; i < count; i++) {
+			AABB box;
+			ew::Vec3 c = ew::Vec3(boxes.centerX[i], boxes.centerY[i], boxes.centerZ[i]);
+			ew::Vec3 e = ew::Vec3(boxes.extentX[i], boxes.extentY[i], boxes.extentZ[i]);
+			box.min = c - e;
+			box.max = c + e;
+			if (IsVisible(frustum, box)) {
+				visible->push_back((unsigned int)i);
+			}
+		}
+		return visible->size() - start;
+	}
+}
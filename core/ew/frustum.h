@@ -0,0 +1,66 @@
+#pragma once
+#include <vector>
+#include "ewMath/ewMath.h"
+#include "camera.h"
+#include "bounds.h"
+
+namespace ew {
+	//Points p where Dot(normal, p) + distance >= 0 are on the inside
+	struct Plane {
+		ew::Vec3 normal = ew::Vec3(0, 1, 0);
+		float distance = 0;
+	};
+
+	enum FrustumPlane {
+		FRUSTUM_LEFT = 0,
+		FRUSTUM_RIGHT,
+		FRUSTUM_BOTTOM,
+		FRUSTUM_TOP,
+		FRUSTUM_NEAR,
+		FRUSTUM_FAR,
+		FRUSTUM_PLANE_COUNT
+	};
+
+	struct Frustum {
+		Plane planes[FRUSTUM_PLANE_COUNT];
+	};
+
+	enum class Containment {
+		OUTSIDE = 0,
+		INTERSECTS = 1,
+		INSIDE = 2
+	};
+
+	//Structure of arrays list of spheres, so 4 can be tested against a plane at once
+	struct SphereBatch {
+		std::vector<float> x, y, z, radius;
+
+		void add(const BoundingSphere& s);
+		void clear();
+		void reserve(size_t n);
+		inline size_t size()const { return x.size(); }
+	};
+
+	//Structure of arrays list of boxes stored as center + half extents
+	struct AABBBatch {
+		std::vector<float> centerX, centerY, centerZ;
+		std::vector<float> extentX, extentY, extentZ;
+
+		void add(const AABB& box);
+		void clear();
+		void reserve(size_t n);
+		inline size_t size()const { return centerX.size(); }
+	};
+
+	Frustum CreateFrustum(const ew::Mat4& viewProjection);
+	Frustum CreateFrustum(const ew::Camera& camera);
+
+	bool IsVisible(const Frustum& frustum, const BoundingSphere& sphere);
+	bool IsVisible(const Frustum& frustum, const AABB& box);
+	//Like IsVisible, but also reports when the box is entirely inside so children can skip testing
+	Containment Classify(const Frustum& frustum, const AABB& box);
+
+	//Appends the index of every object that touches the frustum. Returns the number of visible objects.
+	size_t CullSpheres(const Frustum& frustum, const SphereBatch& spheres, std::vector<unsigned int>* visible);
+	size_t CullAABBs(const Frustum& frustum, const AABBBatch& boxes, std::vector<unsigned int>* visible);
+}
@@ -0,0 +1,324 @@
+#include "geometryHeap.h"
+#include "external/glad.h"
+#include <stdio.h>
+#include <algorithm>
+#include <iterator>
+
+namespace ew {
+	FreeListAllocator::FreeListAllocator(size_t capacity)
+	{
+		reset(capacity);
+	}
+
+	void FreeListAllocator::reset(size_t capacity)
+	{
+		m_byOffset.clear();
+		m_bySize.clear();
+		m_capacity = capacity;
+		m_freeSize = 0;
+		if (capacity > 0) {
+			insertFree(0, capacity);
+		}
+	}
+
+	void FreeListAllocator::grow(size_t capacity)
+	{
+		if (capacity <= m_capacity) {
+			return;
+		}
+		size_t end = m_capacity;
+		m_capacity = capacity;
+		free(end, capacity - end);
+	}
+
+	void FreeListAllocator::insertFree(size_t offset, size_t size)
+	{
+		m_byOffset[offset] = size;
+		m_bySize.emplace(size, offset);
+		m_freeSize += size;
+	}
+
+	void FreeListAllocator::eraseFree(std::map<size_t, size_t>::iterator it)
+	{
+		auto sizes = m_bySize.equal_range(it->second);
+		for (auto size = sizes.first; size != sizes.second; ++size) {
+			if (size->second == it->first) {
+				m_bySize.erase(size);
+				break;
+			}
+		}
+		m_freeSize -= it->second;
+		m_byOffset.erase(it);
+	}
+
+	bool FreeListAllocator::allocate(size_t size, size_t* offset)
+	{
+		if (size == 0) {
+			*offset = 0;
+			return true;
+		}
+		auto best = m_bySize.lower_bound(size);
+		if (best == m_bySize.end()) {
+			return false;
+		}
+		size_t blockOffset = best->second;
+		size_t blockSize = best->first;
+		eraseFree(m_byOffset.find(blockOffset));
+		if (blockSize > size) {
+			insertFree(blockOffset + size, blockSize - size);
+		}
+		*offset = blockOffset;
+		return true;
+	}
+
+	void FreeListAllocator::free(size_t offset, size_t size)
+	{
+		if (size == 0) {
+			return;
+		}
+		auto next = m_byOffset.find(offset + size);
+		if (next != m_byOffset.end()) {
+			size += next->second;
+			eraseFree(next);
+		}
+		auto after = m_byOffset.lower_bound(offset);
+		if (after != m_byOffset.begin()) {
+			auto previous = std::prev(after);
+			if (previous->first + previous->second == offset) {
+				offset = previous->first;
+				size += previous->second;
+				eraseFree(previous);
+			}
+		}
+		insertFree(offset, size);
+	}
+
+	size_t FreeListAllocator::getLargestFree()const
+	{
+		return m_bySize.empty() ? 0 : m_bySize.rbegin()->first;
+	}
+
+	float FreeListAllocator::getFragmentation()const
+	{
+		return m_freeSize == 0 ? 0.0f : 1.0f - (float)getLargestFree() / m_freeSize;
+	}
+
+	GeometryHeap::GeometryHeap(size_t vertexCapacity, size_t indexCapacity)
+		: m_vertices(vertexCapacity), m_indices(indexCapacity)
+	{
+		glGenVertexArrays(1, &m_vao);
+		glGenBuffers(1, &m_vbo);
+		glGenBuffers(1, &m_ebo);
+		//Uploads go through the copy target, so they never touch whichever vertex array is bound
+		glBindBuffer(GL_COPY_WRITE_BUFFER, m_vbo);
+		glBufferData(GL_COPY_WRITE_BUFFER, sizeof(Vertex) * vertexCapacity, NULL, GL_STATIC_DRAW);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, m_ebo);
+		glBufferData(GL_COPY_WRITE_BUFFER, sizeof(unsigned int) * indexCapacity, NULL, GL_STATIC_DRAW);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		setVertexBuffers();
+	}
+
+	GeometryHeap::~GeometryHeap()
+	{
+		glDeleteVertexArrays(1, &m_vao);
+		glDeleteBuffers(1, &m_vbo);
+		glDeleteBuffers(1, &m_ebo);
+	}
+
+	//The same layout as Mesh. Leaves whichever vertex array was bound bound.
+	void GeometryHeap::setVertexBuffers()
+	{
+		int previous = 0;
+		glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previous);
+		glBindVertexArray(m_vao);
+		glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, pos));
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, normal));
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, uv));
+		glEnableVertexAttribArray(2);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+		glBindVertexArray(previous);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	/// <summary>
+	/// Suballocates room for the mesh, doubling whichever buffer has no free block big enough, and uploads it.
+	/// Indices are uploaded as they are, relative to the mesh's first vertex.
+	/// </summary>
+	GeometryHandle GeometryHeap::add(const MeshData& meshData)
+	{
+		size_t numVertices = meshData.vertices.size();
+		size_t numIndices = meshData.indices.size();
+		GeometryRange range;
+		if (!m_vertices.allocate(numVertices, &range.baseVertex)) {
+			growVertices(std::max(getVertexCapacity() * 2, getVertexCapacity() + numVertices));
+			m_vertices.allocate(numVertices, &range.baseVertex);
+		}
+		if (!m_indices.allocate(numIndices, &range.firstIndex)) {
+			growIndices(std::max(getIndexCapacity() * 2, getIndexCapacity() + numIndices));
+			m_indices.allocate(numIndices, &range.firstIndex);
+		}
+		range.numVertices = (int)numVertices;
+		range.numIndices = (int)numIndices;
+
+		if (numVertices > 0) {
+			glBindBuffer(GL_COPY_WRITE_BUFFER, m_vbo);
+			glBufferSubData(GL_COPY_WRITE_BUFFER, sizeof(Vertex) * range.baseVertex, sizeof(Vertex) * numVertices, meshData.vertices.data());
+		}
+		if (numIndices > 0) {
+			glBindBuffer(GL_COPY_WRITE_BUFFER, m_ebo);
+			glBufferSubData(GL_COPY_WRITE_BUFFER, sizeof(unsigned int) * range.firstIndex, sizeof(unsigned int) * numIndices, meshData.indices.data());
+		}
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		GeometryHandle handle;
+		if (!m_freeHandles.empty()) {
+			handle = m_freeHandles.back();
+			m_freeHandles.pop_back();
+			m_ranges[handle] = range;
+			m_live[handle] = true;
+		}
+		else {
+			handle = (GeometryHandle)m_ranges.size();
+			m_ranges.push_back(range);
+			m_live.push_back(true);
+		}
+		return handle;
+	}
+
+	void GeometryHeap::remove(GeometryHandle handle)
+	{
+		if (handle >= m_ranges.size() || !m_live[handle]) {
+			printf("Geometry %u isn't in the heap\n", handle);
+			return;
+		}
+		const GeometryRange& range = m_ranges[handle];
+		m_vertices.free(range.baseVertex, range.numVertices);
+		m_indices.free(range.firstIndex, range.numIndices);
+		m_ranges[handle] = GeometryRange();
+		m_live[handle] = false;
+		m_freeHandles.push_back(handle);
+	}
+
+	//Replaces buffer with a new one of newSize bytes, starting with a GPU side copy of the first copySize bytes of the old one
+	static void replaceBuffer(unsigned int& buffer, size_t newSize, size_t copySize) {
+		unsigned int replacement;
+		glGenBuffers(1, &replacement);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, replacement);
+		glBufferData(GL_COPY_WRITE_BUFFER, newSize, NULL, GL_STATIC_DRAW);
+		if (copySize > 0) {
+			glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, copySize);
+			glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		}
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		glDeleteBuffers(1, &buffer);
+		buffer = replacement;
+	}
+
+	//Everything keeps its offset, and the new space is free
+	void GeometryHeap::growVertices(size_t capacity)
+	{
+		size_t bytes = sizeof(Vertex) * getVertexCapacity();
+		replaceBuffer(m_vbo, sizeof(Vertex) * capacity, bytes);
+		m_vertices.grow(capacity);
+		m_stats.movedBytes += bytes;
+		m_stats.grows++;
+		setVertexBuffers();
+	}
+
+	void GeometryHeap::growIndices(size_t capacity)
+	{
+		size_t bytes = sizeof(unsigned int) * getIndexCapacity();
+		replaceBuffer(m_ebo, sizeof(unsigned int) * capacity, bytes);
+		m_indices.grow(capacity);
+		m_stats.movedBytes += bytes;
+		m_stats.grows++;
+		setVertexBuffers();
+	}
+
+	/// <summary>
+	/// Buffers can't be moved within themselves when ranges overlap, so the meshes are copied into new buffers
+	/// with glCopyBufferSubData, without a round trip through the CPU. The vertex array is then pointed at them.
+	/// </summary>
+	void GeometryHeap::defragment()
+	{
+		unsigned int buffers[2];
+		glGenBuffers(2, buffers);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, buffers[0]);
+		glBufferData(GL_COPY_WRITE_BUFFER, sizeof(Vertex) * getVertexCapacity(), NULL, GL_STATIC_DRAW);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, buffers[1]);
+		glBufferData(GL_COPY_WRITE_BUFFER, sizeof(unsigned int) * getIndexCapacity(), NULL, GL_STATIC_DRAW);
+
+		std::vector<GeometryRange> packed(m_ranges.size());
+		m_vertices.reset(getVertexCapacity());
+		m_indices.reset(getIndexCapacity());
+		for (size_t i = 0; i < m_ranges.size(); i++) {
+			if (m_live[i]) {
+				packed[i] = m_ranges[i];
+				m_vertices.allocate(m_ranges[i].numVertices, &packed[i].baseVertex);
+				m_indices.allocate(m_ranges[i].numIndices, &packed[i].firstIndex);
+			}
+		}
+		glBindBuffer(GL_COPY_READ_BUFFER, m_vbo);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, buffers[0]);
+		for (size_t i = 0; i < m_ranges.size(); i++) {
+			if (m_live[i] && m_ranges[i].numVertices > 0) {
+				size_t size = sizeof(Vertex) * m_ranges[i].numVertices;
+				glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, sizeof(Vertex) * m_ranges[i].baseVertex,
+					sizeof(Vertex) * packed[i].baseVertex, size);
+				m_stats.movedBytes += size;
+			}
+		}
+		glBindBuffer(GL_COPY_READ_BUFFER, m_ebo);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, buffers[1]);
+		for (size_t i = 0; i < m_ranges.size(); i++) {
+			if (m_live[i] && m_ranges[i].numIndices > 0) {
+				size_t size = sizeof(unsigned int) * m_ranges[i].numIndices;
+				glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, sizeof(unsigned int) * m_ranges[i].firstIndex,
+					sizeof(unsigned int) * packed[i].firstIndex, size);
+				m_stats.movedBytes += size;
+			}
+		}
+		m_ranges = packed;
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+		glDeleteBuffers(1, &m_vbo);
+		glDeleteBuffers(1, &m_ebo);
+		m_vbo = buffers[0];
+		m_ebo = buffers[1];
+		setVertexBuffers();
+		m_stats.defragmentations++;
+	}
+
+	void GeometryHeap::bind()
+	{
+		glBindVertexArray(m_vao);
+	}
+
+	void GeometryHeap::draw(GeometryHandle handle, DrawMode drawMode)
+	{
+		const GeometryRange& range = m_ranges[handle];
+		if (drawMode == DrawMode::TRIANGLES) {
+			glDrawElementsBaseVertex(GL_TRIANGLES, range.numIndices, GL_UNSIGNED_INT, (const void*)(sizeof(unsigned int) * range.firstIndex),
+				(GLint)range.baseVertex);
+		}
+		else {
+			glDrawArrays(GL_POINTS, (GLint)range.baseVertex, range.numVertices);
+		}
+	}
+
+	GeometryHeapStats GeometryHeap::getStats()const
+	{
+		GeometryHeapStats stats = m_stats;
+		stats.meshes = (int)(m_ranges.size() - m_freeHandles.size());
+		stats.usedVertices = m_vertices.getCapacity() - m_vertices.getFreeSize();
+		stats.usedIndices = m_indices.getCapacity() - m_indices.getFreeSize();
+		stats.vertexFragmentation = m_vertices.getFragmentation();
+		stats.indexFragmentation = m_indices.getFragmentation();
+		return stats;
+	}
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include <map>
+#include "mesh.h"
+
+namespace ew {
+	/// <summary>
+	/// Hands out ranges of a fixed size space, taking the smallest free block that fits. Freed ranges merge with
+	/// free neighbours, so only live allocations ever split the space. Sizes and offsets are in whatever unit the caller uses.
+	/// </summary>
+	class FreeListAllocator {
+	public:
+		FreeListAllocator(size_t capacity = 0);
+
+		//Forgets every allocation
+		void reset(size_t capacity);
+		//Adds free space at the end
+		void grow(size_t capacity);
+		//False if no free block is big enough
+		bool allocate(size_t size, size_t* offset);
+		//A range given by allocate(), with the same size
+		void free(size_t offset, size_t size);
+
+		inline size_t getCapacity()const { return m_capacity; }
+		inline size_t getFreeSize()const { return m_freeSize; }
+		size_t getLargestFree()const;
+		inline int getNumFreeBlocks()const { return (int)m_byOffset.size(); }
+		//0 when the free space is one block, approaching 1 as it splits into many small ones
+		float getFragmentation()const;
+	private:
+		void insertFree(size_t offset, size_t size);
+		void eraseFree(std::map<size_t, size_t>::iterator it);
+
+		size_t m_capacity = 0;
+		size_t m_freeSize = 0;
+		std::map<size_t, size_t> m_byOffset; //Free blocks, offset to size
+		std::multimap<size_t, size_t> m_bySize; //Free blocks, size to offset
+	};
+
+	//Index of a mesh in a GeometryHeap. Stays valid when the heap moves the mesh.
+	typedef uint32_t GeometryHandle;
+	const GeometryHandle INVALID_GEOMETRY = 0xFFFFFFFF;
+
+	//Where a mesh lives in a GeometryHeap's buffers, in vertices and indices
+	struct GeometryRange {
+		size_t baseVertex = 0;
+		int numVertices = 0;
+		size_t firstIndex = 0;
+		int numIndices = 0;
+	};
+
+	struct GeometryHeapStats {
+		int meshes = 0;
+		size_t usedVertices = 0;
+		size_t usedIndices = 0;
+		float vertexFragmentation = 0;
+		float indexFragmentation = 0;
+		int grows = 0;
+		int defragmentations = 0;
+		size_t movedBytes = 0; //Copied on the GPU by grows and defragmentations
+	};
+
+	/// <summary>
+	/// Many meshes in one vertex buffer and one index buffer, sharing one vertex array, so drawing them takes one bind.
+	/// Meshes keep their own indices and are drawn with their first vertex as the base vertex, so moving one never rewrites
+	/// its indices. Space is suballocated with a FreeListAllocator per buffer. A full buffer doubles, and defragment()
+	/// packs every mesh to the front; both copy on the GPU. All calls must be on the thread with the GL context.
+	/// </summary>
+	class GeometryHeap {
+	public:
+		GeometryHeap(size_t vertexCapacity = 65536, size_t indexCapacity = 196608);
+		~GeometryHeap();
+		GeometryHeap(const GeometryHeap&) = delete;
+		GeometryHeap& operator=(const GeometryHeap&) = delete;
+
+		GeometryHandle add(const MeshData& meshData);
+		void remove(GeometryHandle handle);
+		//Packs every mesh to the start of the buffers, leaving all free space in one block
+		void defragment();
+
+		//Binds the shared vertex array, which draw() expects
+		void bind();
+		void draw(GeometryHandle handle, DrawMode drawMode = DrawMode::TRIANGLES);
+
+		inline const GeometryRange& getRange(GeometryHandle handle)const { return m_ranges[handle]; }
+		inline unsigned int getVAO()const { return m_vao; }
+		inline unsigned int getVertexBuffer()const { return m_vbo; }
+		inline unsigned int getIndexBuffer()const { return m_ebo; }
+		inline size_t getVertexCapacity()const { return m_vertices.getCapacity(); }
+		inline size_t getIndexCapacity()const { return m_indices.getCapacity(); }
+		//RenderQueueStats::meshChanges counts the vertex array binds of heap draws going through a RenderQueue
+		GeometryHeapStats getStats()const;
+	private:
+		void growVertices(size_t capacity);
+		void growIndices(size_t capacity);
+		void setVertexBuffers();
+
+		unsigned int m_vao = 0;
+		unsigned int m_vbo = 0;
+		unsigned int m_ebo = 0;
+		FreeListAllocator m_vertices;
+		FreeListAllocator m_indices;
+		std::vector<GeometryRange> m_ranges;
+		std::vector<bool> m_live;
+		std::vector<GeometryHandle> m_freeHandles;
+		GeometryHeapStats m_stats; //Only the counters, the rest is filled in by getStats()
+	};
+}
@@ -0,0 +1,441 @@
+#include "glStub.h"
+#include "hash.h"
+#include "external/glad.h"
+#include <string.h>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+	ew::GLStubStats* s_stats = nullptr;
+	GLuint s_nextName = 1;
+	const int STUB_TEXTURE_SIZE = 256;
+	const int STUB_NUM_EXTENSIONS = 3;
+	const char* const STUB_EXTENSIONS[STUB_NUM_EXTENSIONS] = { "GL_ARB_texture_filter_anisotropic", "GL_ARB_bindless_texture",
+		"GL_KHR_parallel_shader_compile" };
+	std::unordered_map<GLuint, std::unordered_map<GLenum, GLfloat>> s_samplerParameters;
+	const GLenum STUB_BINARY_FORMAT = 0x5354;
+	const GLenum STUB_COMPLETION_STATUS = 0x91B1; //GL_COMPLETION_STATUS_KHR
+	const char STUB_BINARY[16] = "EW STUB PROGRAM";
+	std::unordered_map<GLuint, GLint> s_linkStatus;
+	GLuint s_program = 0;
+	GLuint s_vertexArray = 0;
+	std::unordered_map<GLenum, GLuint> s_boundBuffers;
+	std::unordered_map<GLuint, GLuint> s_elementBuffers; //Element buffer binding is vertex array state
+	std::unordered_map<GLuint, std::vector<unsigned char>> s_bufferStorage;
+	std::unordered_map<uintptr_t, bool> s_fences; //Signaled or not, by name
+
+	GLuint getBoundBuffer(GLenum target) {
+		return target == GL_ELEMENT_ARRAY_BUFFER ? s_elementBuffers[s_vertexArray] : s_boundBuffers[target];
+	}
+	//Null if nothing bound to target has storage, or the range doesn't fit in it
+	unsigned char* getBufferRange(GLenum target, GLintptr offset, GLsizeiptr size) {
+		auto it = s_bufferStorage.find(getBoundBuffer(target));
+		if (it == s_bufferStorage.end() || offset < 0 || (size_t)(offset + size) > it->second.size()) {
+			return nullptr;
+		}
+		return it->second.data() + offset;
+	}
+
+	void hashUniform(GLint location, const void* values, size_t size) {
+		s_stats->uniforms++;
+		s_stats->callHash = ew::HashBytes(&location, sizeof(location), s_stats->callHash);
+		s_stats->callHash = ew::HashBytes(values, size, s_stats->callHash);
+	}
+
+	void GLAD_API_PTR stubGenTextures(GLsizei n, GLuint* textures) {
+		for (GLsizei i = 0; i < n; i++) {
+			textures[i] = s_nextName++;
+		}
+		s_stats->texturesCreated += n;
+	}
+	void GLAD_API_PTR stubDeleteTextures(GLsizei n, const GLuint* textures) {
+		for (GLsizei i = 0; i < n; i++) {
+			//Deleting 0 is ignored, as in GL
+			s_stats->texturesDeleted += textures[i] != 0 ? 1 : 0;
+		}
+	}
+	void GLAD_API_PTR stubGenNames(GLsizei n, GLuint* names) {
+		for (GLsizei i = 0; i < n; i++) {
+			names[i] = s_nextName++;
+		}
+	}
+	void GLAD_API_PTR stubDeleteNames(GLsizei, const GLuint*) {}
+
+	void GLAD_API_PTR stubActiveTexture(GLenum) { s_stats->activeTexture++; }
+	void GLAD_API_PTR stubBindTexture(GLenum, GLuint) { s_stats->bindTexture++; }
+	void GLAD_API_PTR stubBindTextures(GLuint, GLsizei, const GLuint*) { s_stats->bindTextures++; }
+	void GLAD_API_PTR stubBindSamplers(GLuint, GLsizei, const GLuint*) { s_stats->bindSamplers++; }
+	void GLAD_API_PTR stubBindBuffer(GLenum target, GLuint buffer) {
+		s_stats->bindBuffer++;
+		if (target == GL_ELEMENT_ARRAY_BUFFER) {
+			s_elementBuffers[s_vertexArray] = buffer;
+		}
+		else {
+			s_boundBuffers[target] = buffer;
+		}
+	}
+	void GLAD_API_PTR stubBindBufferBase(GLenum, GLuint, GLuint) { s_stats->bindBuffer++; }
+	void GLAD_API_PTR stubBindBufferRange(GLenum, GLuint, GLuint, GLintptr, GLsizeiptr) { s_stats->bindBuffer++; }
+	void GLAD_API_PTR stubBindVertexArray(GLuint vertexArray) {
+		s_stats->bindVertexArray++;
+		s_vertexArray = vertexArray;
+	}
+	void GLAD_API_PTR stubVertexAttribPointer(GLuint, GLint, GLenum, GLboolean, GLsizei, const void*) {}
+	void GLAD_API_PTR stubEnableVertexAttribArray(GLuint) {}
+	void GLAD_API_PTR stubBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum) {
+		s_stats->bufferAllocations++;
+		std::vector<unsigned char>& storage = s_bufferStorage[getBoundBuffer(target)];
+		storage.assign((size_t)size, 0);
+		if (data) {
+			memcpy(storage.data(), data, (size_t)size);
+			s_stats->bufferUploads++;
+			s_stats->bufferBytes += (size_t)size;
+		}
+	}
+	void GLAD_API_PTR stubBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data) {
+		s_stats->bufferUploads++;
+		s_stats->bufferBytes += (size_t)size;
+		unsigned char* range = getBufferRange(target, offset, size);
+		if (range) {
+			memcpy(range, data, (size_t)size);
+		}
+	}
+	void GLAD_API_PTR stubGetBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, void* data) {
+		unsigned char* range = getBufferRange(target, offset, size);
+		if (range) {
+			memcpy(data, range, (size_t)size);
+		}
+	}
+	void GLAD_API_PTR stubCopyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size) {
+		s_stats->bufferCopyBytes += (size_t)size;
+		unsigned char* source = getBufferRange(readTarget, readOffset, size);
+		unsigned char* destination = getBufferRange(writeTarget, writeOffset, size);
+		if (source && destination) {
+			memmove(destination, source, (size_t)size);
+		}
+	}
+	void GLAD_API_PTR stubBufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield) {
+		std::vector<unsigned char>& storage = s_bufferStorage[getBoundBuffer(target)];
+		storage.assign((size_t)size, 0);
+		if (data) {
+			memcpy(storage.data(), data, (size_t)size);
+		}
+	}
+	void* GLAD_API_PTR stubMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield) {
+		return getBufferRange(target, offset, length);
+	}
+	GLboolean GLAD_API_PTR stubUnmapBuffer(GLenum) { return GL_TRUE; }
+	void GLAD_API_PTR stubDeleteBuffers(GLsizei n, const GLuint* buffers) {
+		for (GLsizei i = 0; i < n; i++) {
+			s_bufferStorage.erase(buffers[i]);
+		}
+	}
+	GLsync GLAD_API_PTR stubFenceSync(GLenum, GLbitfield) {
+		s_stats->fences++;
+		uintptr_t name = s_nextName++;
+		s_fences[name] = false;
+		return (GLsync)name;
+	}
+	GLenum GLAD_API_PTR stubClientWaitSync(GLsync sync, GLbitfield, GLuint64 timeout) {
+		auto it = s_fences.find((uintptr_t)sync);
+		if (it == s_fences.end()) {
+			return GL_WAIT_FAILED;
+		}
+		if (it->second) {
+			return GL_ALREADY_SIGNALED;
+		}
+		if (timeout == 0) {
+			return GL_TIMEOUT_EXPIRED;
+		}
+		it->second = true;
+		s_stats->fencesSignaled++;
+		return GL_CONDITION_SATISFIED;
+	}
+	void GLAD_API_PTR stubDeleteSync(GLsync sync) { s_fences.erase((uintptr_t)sync); }
+	void GLAD_API_PTR stubUseProgram(GLuint program) {
+		s_stats->useProgram++;
+		s_program = program;
+	}
+	GLint GLAD_API_PTR stubGetUniformLocation(GLuint, const GLchar*) { s_stats->uniformLookups++; return 0; }
+	void GLAD_API_PTR stubUniform1i(GLint location, GLint v0) { hashUniform(location, &v0, sizeof(v0)); }
+	void GLAD_API_PTR stubUniform1f(GLint location, GLfloat v0) { hashUniform(location, &v0, sizeof(v0)); }
+	void GLAD_API_PTR stubUniform2f(GLint location, GLfloat v0, GLfloat v1) {
+		GLfloat values[2] = { v0, v1 };
+		hashUniform(location, values, sizeof(values));
+	}
+	void GLAD_API_PTR stubUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2) {
+		GLfloat values[3] = { v0, v1, v2 };
+		hashUniform(location, values, sizeof(values));
+	}
+	void GLAD_API_PTR stubUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3) {
+		GLfloat values[4] = { v0, v1, v2, v3 };
+		hashUniform(location, values, sizeof(values));
+	}
+	void GLAD_API_PTR stubUniformMatrix4fv(GLint location, GLsizei count, GLboolean, const GLfloat* value) {
+		hashUniform(location, value, sizeof(GLfloat) * 16 * count);
+	}
+	void GLAD_API_PTR stubDrawElements(GLenum, GLsizei count, GLenum, const void*) {
+		s_stats->draws++;
+		GLuint draw[3] = { s_program, s_vertexArray, (GLuint)count };
+		s_stats->callHash = ew::HashBytes(draw, sizeof(draw), s_stats->callHash);
+	}
+	void GLAD_API_PTR stubDrawElementsBaseVertex(GLenum, GLsizei count, GLenum, const void*, GLint) {
+		s_stats->draws++;
+		GLuint draw[3] = { s_program, s_vertexArray, (GLuint)count };
+		s_stats->callHash = ew::HashBytes(draw, sizeof(draw), s_stats->callHash);
+	}
+	void GLAD_API_PTR stubDrawArrays(GLenum, GLint, GLsizei) { s_stats->draws++; }
+
+	GLuint GLAD_API_PTR stubCreateName() { return s_nextName++; }
+	GLuint GLAD_API_PTR stubCreateShader(GLenum) { return s_nextName++; }
+	void GLAD_API_PTR stubShaderSource(GLuint, GLsizei count, const GLchar* const* string, const GLint* length) {
+		for (GLsizei i = 0; i < count; i++) {
+			bool sized = length && length[i] >= 0;
+			s_stats->sizedSources += sized ? 1 : 0;
+			s_stats->sourceBytes += sized ? (size_t)length[i] : strlen(string[i]);
+		}
+	}
+	void GLAD_API_PTR stubCompileShader(GLuint) { s_stats->compiles++; }
+	void GLAD_API_PTR stubAttachShader(GLuint, GLuint) {}
+	void GLAD_API_PTR stubDeleteName(GLuint) {}
+	void GLAD_API_PTR stubDeleteProgram(GLuint program) { s_linkStatus.erase(program); }
+	void GLAD_API_PTR stubLinkProgram(GLuint program) {
+		s_stats->links++;
+		s_linkStatus[program] = 1;
+	}
+	void GLAD_API_PTR stubMaxShaderCompilerThreads(GLuint) {}
+	void GLAD_API_PTR stubGetShaderiv(GLuint, GLenum name, GLint* params) { *params = name == GL_COMPILE_STATUS ? 1 : 0; }
+	void GLAD_API_PTR stubGetProgramiv(GLuint program, GLenum name, GLint* params) {
+		switch (name) {
+		case GL_LINK_STATUS:
+			*params = s_linkStatus.count(program) ? s_linkStatus[program] : 0;
+			break;
+		case GL_PROGRAM_BINARY_LENGTH:
+			*params = sizeof(STUB_BINARY);
+			break;
+		case STUB_COMPLETION_STATUS:
+			*params = 1;
+			break;
+		default:
+			*params = 0;
+			break;
+		}
+	}
+	void GLAD_API_PTR stubGetInfoLog(GLuint, GLsizei bufSize, GLsizei* length, GLchar* infoLog) {
+		if (length) {
+			*length = 0;
+		}
+		if (bufSize > 0) {
+			infoLog[0] = 0;
+		}
+	}
+	void GLAD_API_PTR stubProgramParameteri(GLuint, GLenum, GLint) {}
+	void GLAD_API_PTR stubGetProgramBinary(GLuint, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary) {
+		GLsizei size = bufSize < (GLsizei)sizeof(STUB_BINARY) ? bufSize : (GLsizei)sizeof(STUB_BINARY);
+		memcpy(binary, STUB_BINARY, size);
+		if (length) {
+			*length = size;
+		}
+		*binaryFormat = STUB_BINARY_FORMAT;
+	}
+	void GLAD_API_PTR stubProgramBinary(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length) {
+		s_stats->programBinaries++;
+		bool valid = binaryFormat == STUB_BINARY_FORMAT && length == (GLsizei)sizeof(STUB_BINARY) && memcmp(binary, STUB_BINARY, length) == 0;
+		s_linkStatus[program] = valid ? 1 : 0;
+	}
+
+	void GLAD_API_PTR stubTexImage2D(GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum, const void*) { s_stats->textureUploads++; }
+	void GLAD_API_PTR stubCompressedTexImage2D(GLenum, GLint, GLenum, GLsizei, GLsizei, GLint, GLsizei, const void*) { s_stats->textureUploads++; }
+	void GLAD_API_PTR stubTexStorage3D(GLenum, GLsizei, GLenum, GLsizei, GLsizei, GLsizei) {}
+	void GLAD_API_PTR stubTexParameteri(GLenum, GLenum, GLint) {}
+	void GLAD_API_PTR stubTexParameterfv(GLenum, GLenum, const GLfloat*) {}
+	void GLAD_API_PTR stubGenerateMipmap(GLenum) {}
+	void GLAD_API_PTR stubPixelStorei(GLenum, GLint) {}
+	void GLAD_API_PTR stubCopyImageSubData(GLuint, GLenum, GLint, GLint, GLint, GLint, GLuint, GLenum, GLint, GLint, GLint, GLint,
+		GLsizei, GLsizei, GLsizei) {}
+
+	void GLAD_API_PTR stubGenSamplers(GLsizei n, GLuint* samplers) {
+		for (GLsizei i = 0; i < n; i++) {
+			samplers[i] = s_nextName++;
+			s_samplerParameters[samplers[i]].clear();
+		}
+		s_stats->samplersCreated += n;
+	}
+	void GLAD_API_PTR stubDeleteSamplers(GLsizei n, const GLuint* samplers) {
+		for (GLsizei i = 0; i < n; i++) {
+			s_stats->samplersDeleted += s_samplerParameters.erase(samplers[i]) ? 1 : 0;
+		}
+	}
+	void GLAD_API_PTR stubBindSampler(GLuint, GLuint) { s_stats->bindSampler++; }
+	void GLAD_API_PTR stubSamplerParameteri(GLuint sampler, GLenum name, GLint param) { s_samplerParameters[sampler][name] = (GLfloat)param; }
+	void GLAD_API_PTR stubSamplerParameterf(GLuint sampler, GLenum name, GLfloat param) { s_samplerParameters[sampler][name] = param; }
+	//Vector parameters keep their first component
+	void GLAD_API_PTR stubSamplerParameterfv(GLuint sampler, GLenum name, const GLfloat* params) { s_samplerParameters[sampler][name] = params[0]; }
+	void GLAD_API_PTR stubGetSamplerParameteriv(GLuint sampler, GLenum name, GLint* params) { *params = (GLint)s_samplerParameters[sampler][name]; }
+	void GLAD_API_PTR stubGetSamplerParameterfv(GLuint sampler, GLenum name, GLfloat* params) { *params = s_samplerParameters[sampler][name]; }
+
+	void GLAD_API_PTR stubGetIntegerv(GLenum name, GLint* data) {
+		switch (name) {
+		case GL_MAJOR_VERSION:
+			*data = 4;
+			break;
+		case GL_MINOR_VERSION:
+			*data = 5;
+			break;
+		case GL_NUM_EXTENSIONS:
+			*data = STUB_NUM_EXTENSIONS;
+			break;
+		case GL_NUM_COMPRESSED_TEXTURE_FORMATS:
+			*data = 0;
+			break;
+		case GL_VERTEX_ARRAY_BINDING:
+			*data = (GLint)s_vertexArray;
+			break;
+		default:
+			*data = 32;
+			break;
+		}
+	}
+	void GLAD_API_PTR stubGetFloatv(GLenum, GLfloat* data) { *data = 16.0f; }
+	const GLubyte* GLAD_API_PTR stubGetString(GLenum) { return (const GLubyte*)"Stub"; }
+	const GLubyte* GLAD_API_PTR stubGetStringi(GLenum, GLuint index) { return (const GLubyte*)STUB_EXTENSIONS[index % STUB_NUM_EXTENSIONS]; }
+	GLenum GLAD_API_PTR stubGetError() { return GL_NO_ERROR; }
+	void GLAD_API_PTR stubGetTexParameteriv(GLenum, GLenum name, GLint* params) { *params = name == GL_TEXTURE_MAX_LEVEL ? 1000 : 0; }
+	void GLAD_API_PTR stubGetTexLevelParameteriv(GLenum, GLint level, GLenum name, GLint* params) {
+		int size = level < 31 ? STUB_TEXTURE_SIZE >> level : 0;
+		switch (name) {
+		case GL_TEXTURE_WIDTH:
+		case GL_TEXTURE_HEIGHT:
+			*params = size;
+			break;
+		case GL_TEXTURE_INTERNAL_FORMAT:
+			*params = GL_RGBA8;
+			break;
+		case GL_TEXTURE_RED_SIZE:
+		case GL_TEXTURE_GREEN_SIZE:
+		case GL_TEXTURE_BLUE_SIZE:
+		case GL_TEXTURE_ALPHA_SIZE:
+			*params = size > 0 ? 8 : 0;
+			break;
+		default:
+			*params = 0;
+			break;
+		}
+	}
+
+	//ARB_bindless_texture. Handles are just the texture and sampler names packed together.
+	GLuint64 GLAD_API_PTR stubGetTextureHandle(GLuint texture) { return (GLuint64)texture; }
+	GLuint64 GLAD_API_PTR stubGetTextureSamplerHandle(GLuint texture, GLuint sampler) { return ((GLuint64)sampler << 32) | texture; }
+	void GLAD_API_PTR stubMakeTextureHandleResident(GLuint64) { s_stats->makeResident++; }
+	void GLAD_API_PTR stubMakeTextureHandleNonResident(GLuint64) {}
+}
+
+namespace ew {
+	void installGLStub(GLStubStats* stats)
+	{
+		s_stats = stats;
+		glad_glGenTextures = stubGenTextures;
+		glad_glDeleteTextures = stubDeleteTextures;
+		glad_glGenBuffers = stubGenNames;
+		glad_glDeleteBuffers = stubDeleteBuffers;
+		glad_glGenVertexArrays = stubGenNames;
+		glad_glDeleteVertexArrays = stubDeleteNames;
+		glad_glActiveTexture = stubActiveTexture;
+		glad_glBindTexture = stubBindTexture;
+		glad_glBindTextures = stubBindTextures;
+		glad_glBindSamplers = stubBindSamplers;
+		glad_glBindBuffer = stubBindBuffer;
+		glad_glBindBufferBase = stubBindBufferBase;
+		glad_glBindBufferRange = stubBindBufferRange;
+		glad_glBindVertexArray = stubBindVertexArray;
+		glad_glVertexAttribPointer = stubVertexAttribPointer;
+		glad_glEnableVertexAttribArray = stubEnableVertexAttribArray;
+		glad_glBufferData = stubBufferData;
+		glad_glBufferSubData = stubBufferSubData;
+		glad_glGetBufferSubData = stubGetBufferSubData;
+		glad_glCopyBufferSubData = stubCopyBufferSubData;
+		glad_glBufferStorage = stubBufferStorage;
+		glad_glMapBufferRange = stubMapBufferRange;
+		glad_glUnmapBuffer = stubUnmapBuffer;
+		glad_glFenceSync = stubFenceSync;
+		glad_glClientWaitSync = stubClientWaitSync;
+		glad_glDeleteSync = stubDeleteSync;
+		glad_glUseProgram = stubUseProgram;
+		glad_glGetUniformLocation = stubGetUniformLocation;
+		glad_glUniform1i = stubUniform1i;
+		glad_glUniform1f = stubUniform1f;
+		glad_glUniform2f = stubUniform2f;
+		glad_glUniform3f = stubUniform3f;
+		glad_glUniform4f = stubUniform4f;
+		glad_glUniformMatrix4fv = stubUniformMatrix4fv;
+		glad_glDrawElements = stubDrawElements;
+		glad_glDrawElementsBaseVertex = stubDrawElementsBaseVertex;
+		glad_glDrawArrays = stubDrawArrays;
+
+		glad_glCreateShader = stubCreateShader;
+		glad_glShaderSource = stubShaderSource;
+		glad_glCompileShader = stubCompileShader;
+		glad_glGetShaderiv = stubGetShaderiv;
+		glad_glGetShaderInfoLog = stubGetInfoLog;
+		glad_glDeleteShader = stubDeleteName;
+		glad_glCreateProgram = stubCreateName;
+		glad_glAttachShader = stubAttachShader;
+		glad_glLinkProgram = stubLinkProgram;
+		glad_glGetProgramiv = stubGetProgramiv;
+		glad_glGetProgramInfoLog = stubGetInfoLog;
+		glad_glDeleteProgram = stubDeleteProgram;
+		glad_glProgramParameteri = stubProgramParameteri;
+		glad_glGetProgramBinary = stubGetProgramBinary;
+		glad_glProgramBinary = stubProgramBinary;
+
+		glad_glTexImage2D = stubTexImage2D;
+		glad_glCompressedTexImage2D = stubCompressedTexImage2D;
+		glad_glTexStorage3D = stubTexStorage3D;
+		glad_glTexParameteri = stubTexParameteri;
+		glad_glTexParameterfv = stubTexParameterfv;
+		glad_glGenerateMipmap = stubGenerateMipmap;
+		glad_glPixelStorei = stubPixelStorei;
+		glad_glCopyImageSubData = stubCopyImageSubData;
+		glad_glGenSamplers = stubGenSamplers;
+		glad_glDeleteSamplers = stubDeleteSamplers;
+		glad_glBindSampler = stubBindSampler;
+		glad_glSamplerParameteri = stubSamplerParameteri;
+		glad_glSamplerParameterf = stubSamplerParameterf;
+		glad_glSamplerParameterfv = stubSamplerParameterfv;
+		glad_glGetSamplerParameteriv = stubGetSamplerParameteriv;
+		glad_glGetSamplerParameterfv = stubGetSamplerParameterfv;
+
+		glad_glGetIntegerv = stubGetIntegerv;
+		glad_glGetFloatv = stubGetFloatv;
+		glad_glGetString = stubGetString;
+		glad_glGetStringi = stubGetStringi;
+		glad_glGetError = stubGetError;
+		glad_glGetTexParameteriv = stubGetTexParameteriv;
+		glad_glGetTexLevelParameteriv = stubGetTexLevelParameteriv;
+	}
+
+	void signalGLStubFences()
+	{
+		for (auto& fence : s_fences) {
+			if (!fence.second) {
+				fence.second = true;
+				s_stats->fencesSignaled++;
+			}
+		}
+	}
+
+	GLProc getGLStubProc(const char* name)
+	{
+		if (strcmp(name, "glGetTextureHandleARB") == 0)
+			return (GLProc)stubGetTextureHandle;
+		if (strcmp(name, "glGetTextureSamplerHandleARB") == 0)
+			return (GLProc)stubGetTextureSamplerHandle;
+		if (strcmp(name, "glMakeTextureHandleResidentARB") == 0)
+			return (GLProc)stubMakeTextureHandleResident;
+		if (strcmp(name, "glMakeTextureHandleNonResidentARB") == 0)
+			return (GLProc)stubMakeTextureHandleNonResident;
+		if (strcmp(name, "glMaxShaderCompilerThreadsKHR") == 0)
+			return (GLProc)stubMaxShaderCompilerThreads;
+		return nullptr;
+	}
+}
\ No newline at end of file
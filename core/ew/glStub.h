@@ -0,0 +1,66 @@
+#pragma once
+#include <stddef.h>
+#include "texture.h"
+#include "hash.h"
+
+namespace ew {
+	//Calls made through the stub GL backend
+	struct GLStubStats {
+		int activeTexture = 0;
+		int bindTexture = 0;
+		int bindTextures = 0; //Multi-bind calls, however many units each covers
+		int bindSampler = 0;
+		int bindSamplers = 0;
+		int bindBuffer = 0; //Including glBindBufferBase
+		int bindVertexArray = 0;
+		int bufferUploads = 0; //glBufferData with data, and glBufferSubData
+		size_t bufferBytes = 0;
+		int bufferAllocations = 0; //glBufferData, with data or without
+		size_t bufferCopyBytes = 0; //glCopyBufferSubData
+		int fences = 0;
+		int fencesSignaled = 0; //By a blocking wait or signalGLStubFences()
+		int useProgram = 0;
+		int uniforms = 0;
+		int uniformLookups = 0; //glGetUniformLocation
+		int draws = 0;
+		int makeResident = 0; //Bindless handles made resident
+		int texturesCreated = 0;
+		int texturesDeleted = 0;
+		int textureUploads = 0; //glTexImage2D and glCompressedTexImage2D, per level
+		int samplersCreated = 0;
+		int samplersDeleted = 0;
+		int compiles = 0; //Shader stages compiled
+		int sizedSources = 0; //Shader source strings passed with their length rather than null terminated
+		size_t sourceBytes = 0; //Shader source handed to glShaderSource
+		int links = 0;
+		int programBinaries = 0; //Programs created with glProgramBinary, accepted or not
+		//Every uniform value and every indexed draw's program, vertex array and index count, hashed in call order,
+		//so two ways of issuing the same frame can be checked for identical results
+		uint64_t callHash = HASH_SEED;
+
+		//Every call that changes what a draw reads
+		inline int getStateChanges()const {
+			return activeTexture + bindTexture + bindTextures + bindSampler + bindSamplers + bindBuffer + bindVertexArray + useProgram + uniforms;
+		}
+		inline int getLiveTextures()const { return texturesCreated - texturesDeleted; }
+		inline int getLiveSamplers()const { return samplersCreated - samplersDeleted; }
+	};
+
+	/// <summary>
+	/// Points glad at functions that only count calls and hand out names, so GL code can run and be measured
+	/// without a context. Queries answer as GL 4.5 with a 256x256 RGBA8 mipmapped texture and every limit generous,
+	/// and the extensions listed are GL_ARB_texture_filter_anisotropic, GL_ARB_bindless_texture and
+	/// GL_KHR_parallel_shader_compile. Sampler parameters are stored, so they can be read back with glGetSamplerParameteriv/fv.
+	/// Calls go to stats until the next install. Shaders always compile and link, and are complete as soon as they are linked.
+	/// Program binaries are a fixed tag, and glProgramBinary only accepts that tag.
+	/// Buffers are backed by real memory, so uploads, copies and maps can be read back with glGetBufferSubData.
+	/// Fences stay unsignaled, as if the GPU were far behind,
+	/// until waited on with a timeout or signaled with signalGLStubFences().
+	/// Covers texture, sampler, buffer, vertex array, shader, uniform, draw and sync calls; anything else is left null. Not thread safe.
+	/// </summary>
+	void installGLStub(GLStubStats* stats);
+	//As if the GPU had caught up with every call so far
+	void signalGLStubFences();
+	//Stand-in for glfwGetProcAddress, giving the stub's extension functions. Null for anything else.
+	GLProc getGLStubProc(const char* name);
+}
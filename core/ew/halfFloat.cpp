@@ -0,0 +1,152 @@
+#include "halfFloat.h"
+#include "ewMath/simd.h"
+#include <string.h>
+#include <algorithm>
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+namespace {
+	inline uint32_t floatBits(float f) { uint32_t u; memcpy(&u, &f, 4); return u; }
+	inline float bitsFloat(uint32_t u) { float f; memcpy(&f, &u, 4); return f; }
+
+#if EW_SIMD_SSE2
+	//Branchless FloatToHalf on 4 lanes. Results are in the low 16 bits of each lane, sign extended.
+	inline __m128i floatToHalf4(__m128 f) {
+		const __m128i F16_MAX = _mm_set1_epi32((127 + 16) << 23); //First float that overflows
+		const __m128i MIN_NORMAL = _mm_set1_epi32((127 - 14) << 23);
+		const __m128i SUBNORMAL_MAGIC = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+		const __m128i NORMAL_BIAS = _mm_set1_epi32(0xfff - ((127 - 15) << 23));
+
+		__m128 sign = _mm_and_ps(f, _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000u)));
+		__m128 absF = _mm_xor_ps(f, sign);
+		__m128i absBits = _mm_castps_si128(absF);
+		__m128i isRegular = _mm_cmpgt_epi32(F16_MAX, absBits);
+		__m128i isSubnormal = _mm_cmpgt_epi32(MIN_NORMAL, absBits);
+		__m128i nanBit = _mm_and_si128(_mm_castps_si128(_mm_cmpunord_ps(absF, absF)), _mm_set1_epi32(0x200));
+		__m128i infOrNan = _mm_or_si128(nanBit, _mm_set1_epi32(0x7c00));
+
+		//Adding the magic number lines the subnormal mantissa up and rounds it in the FPU
+		__m128i subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absF, _mm_castsi128_ps(SUBNORMAL_MAGIC))), SUBNORMAL_MAGIC);
+		//Rebias the exponent and round the mantissa to nearest even
+		__m128i mantissaOdd = _mm_srai_epi32(_mm_slli_epi32(absBits, 31 - 13), 31);
+		__m128i normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(absBits, NORMAL_BIAS), mantissaOdd), 13);
+
+		__m128i finite = _mm_or_si128(_mm_and_si128(isSubnormal, subnormal), _mm_andnot_si128(isSubnormal, normal));
+		__m128i joined = _mm_or_si128(_mm_and_si128(isRegular, finite), _mm_andnot_si128(isRegular, infOrNan));
+		return _mm_or_si128(joined, _mm_srai_epi32(_mm_castps_si128(sign), 16));
+	}
+#endif
+}
+
+namespace ew {
+	uint16_t FloatToHalf(float f) {
+		uint32_t bits = floatBits(f);
+		uint32_t sign = bits & 0x80000000u;
+		bits ^= sign;
+		uint32_t h;
+		if (bits >= 0x47800000u) {
+			//Too big for a half, infinity or NaN
+			h = bits > 0x7f800000u ? 0x7e00 : 0x7c00;
+		}
+		else if (bits < 0x38800000u) {
+			//Subnormal or zero. Adding 0.5 shifts the mantissa into place and rounds it.
+			h = floatBits(bitsFloat(bits) + 0.5f) - 0x3f000000u;
+		}
+		else {
+			uint32_t mantissaOdd = (bits >> 13) & 1;
+			bits += ((uint32_t)(15 - 127) << 23) + 0xfff + mantissaOdd;
+			h = bits >> 13;
+		}
+		return (uint16_t)(h | (sign >> 16));
+	}
+
+	float HalfToFloat(uint16_t h) {
+		const uint32_t SHIFTED_EXP = 0x7c00u << 13;
+		uint32_t bits = ((uint32_t)h & 0x7fffu) << 13;
+		uint32_t exponent = bits & SHIFTED_EXP;
+		bits += (uint32_t)(127 - 15) << 23;
+		if (exponent == SHIFTED_EXP) {
+			bits += (uint32_t)(128 - 16) << 23;
+		}
+		else if (exponent == 0) {
+			//Subnormal, renormalize through the FPU
+			bits = floatBits(bitsFloat(bits + (1u << 23)) - bitsFloat(113u << 23));
+		}
+		return bitsFloat(bits | (((uint32_t)h & 0x8000u) << 16));
+	}
+
+	void FloatToHalfArray(const float* src, uint16_t* dst, size_t count, bool simd) {
+		size_t i = 0;
+		if (simd) {
+#if defined(__F16C__)
+			for (; i + 8 <= count; i += 8) {
+				__m128i halves = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+				_mm_storeu_si128((__m128i*)(dst + i), halves);
+			}
+#endif
+#if EW_SIMD_SSE2
+			for (; i + 8 <= count; i += 8) {
+				__m128i low = floatToHalf4(_mm_loadu_ps(src + i));
+				__m128i high = floatToHalf4(_mm_loadu_ps(src + i + 4));
+				//Every lane fits in 16 bits once sign extended, so saturation never kicks in
+				_mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(low, high));
+			}
+#endif
+		}
+		for (; i < count; i++) {
+			dst[i] = FloatToHalf(src[i]);
+		}
+	}
+
+	//Largest finite values with 6 and 5 bit mantissas
+	static const float MAX_FLOAT11 = 65024.0f;
+	static const float MAX_FLOAT10 = 64512.0f;
+
+	static uint32_t packSmallFloat(float f, float maxValue, int droppedBits) {
+		//!(f > 0) also catches NaN
+		if (!(f > 0.0f)) {
+			return 0;
+		}
+		uint32_t h = FloatToHalf(std::min(f, maxValue));
+		uint32_t odd = (h >> droppedBits) & 1;
+		return (h + (1u << (droppedBits - 1)) - 1 + odd) >> droppedBits;
+	}
+
+	uint32_t PackR11G11B10F(float r, float g, float b) {
+		return packSmallFloat(r, MAX_FLOAT11, 4) | (packSmallFloat(g, MAX_FLOAT11, 4) << 11) | (packSmallFloat(b, MAX_FLOAT10, 5) << 22);
+	}
+
+	ew::Vec3 UnpackR11G11B10F(uint32_t packed) {
+		return ew::Vec3(
+			HalfToFloat((uint16_t)((packed & 0x7ff) << 4)),
+			HalfToFloat((uint16_t)(((packed >> 11) & 0x7ff) << 4)),
+			HalfToFloat((uint16_t)(((packed >> 22) & 0x3ff) << 5)));
+	}
+
+	void PackR11G11B10FArray(const float* src, int numComponents, uint32_t* dst, size_t numPixels) {
+		//Clamp and convert to halves in blocks with the SIMD path, then only the mantissa rounding is per channel
+		const size_t BLOCK = 256;
+		float rgb[BLOCK * 3];
+		uint16_t halves[BLOCK * 3];
+		for (size_t start = 0; start < numPixels; start += BLOCK) {
+			size_t count = std::min(BLOCK, numPixels - start);
+			for (size_t i = 0; i < count; i++) {
+				const float* pixel = src + (start + i) * numComponents;
+				for (int c = 0; c < 3; c++) {
+					float v = c < numComponents ? pixel[c] : 0.0f;
+					//!(v > 0) also catches NaN
+					rgb[i * 3 + c] = !(v > 0.0f) ? 0.0f : std::min(v, c == 2 ? MAX_FLOAT10 : MAX_FLOAT11);
+				}
+			}
+			FloatToHalfArray(rgb, halves, count * 3);
+			for (size_t i = 0; i < count; i++) {
+				uint32_t r = halves[i * 3], g = halves[i * 3 + 1], b = halves[i * 3 + 2];
+				r = (r + 0x7 + ((r >> 4) & 1)) >> 4;
+				g = (g + 0x7 + ((g >> 4) & 1)) >> 4;
+				b = (b + 0xf + ((b >> 5) & 1)) >> 5;
+				dst[start + i] = r | (g << 11) | (b << 22);
+			}
+		}
+	}
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "ewMath/vec3.h"
+
+namespace ew {
+	//IEEE half precision, rounding to nearest even. Overflow becomes infinity, NaN stays NaN.
+	uint16_t FloatToHalf(float f);
+	float HalfToFloat(uint16_t h);
+	//Converts count floats. With simd, 8 at a time with F16C when compiled for it, otherwise 4 at a time with SSE2.
+	//Gives the same bits as FloatToHalf either way, apart from NaN payloads.
+	void FloatToHalfArray(const float* src, uint16_t* dst, size_t count, bool simd = true);
+
+	//GL_R11F_G11F_B10F packing: unsigned floats with 6, 6 and 5 bit mantissas and no sign.
+	//Negatives and NaN become 0, anything past the largest finite value is clamped to it.
+	uint32_t PackR11G11B10F(float r, float g, float b);
+	ew::Vec3 UnpackR11G11B10F(uint32_t packed);
+	//Packs numPixels pixels of numComponents floats each. Missing channels are 0, extra ones dropped.
+	void PackR11G11B10FArray(const float* src, int numComponents, uint32_t* dst, size_t numPixels);
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+namespace ew {
+	const uint64_t HASH_SEED = 14695981039346656037ull;
+
+	//64 bit FNV-1a. Pass a previous result as the seed to hash several buffers as one.
+	inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = HASH_SEED) {
+		const unsigned char* bytes = (const unsigned char*)data;
+		uint64_t hash = seed;
+		for (size_t i = 0; i < size; i++) {
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+}
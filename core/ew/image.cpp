@@ -0,0 +1,122 @@
+#include "image.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "assetFile.h"
+#include "external/stb_image.h"
+
+namespace ew {
+	Image loadImage(const char* filePath, bool flipVertically) {
+		Image image;
+		//Decoded straight from the mapped file rather than through stdio
+		AssetFile file;
+		if (!file.open(filePath)) {
+			return Image();
+		}
+		const stbi_uc* bytes = file.getData();
+		int size = (int)file.getSize();
+		stbi_set_flip_vertically_on_load_thread(flipVertically);
+		unsigned char* data = stbi_load_from_memory(bytes, size, &image.width, &image.height, &image.numComponents, 0);
+		if (data == NULL) {
+			printf("Failed to load image %s", filePath);
+			return Image();
+		}
+		image.pixels.assign(data, data + (size_t)image.width * image.height * image.numComponents);
+		stbi_image_free(data);
+		return image;
+	}
+
+	FloatImage loadImageFloat(const char* filePath, bool flipVertically) {
+		FloatImage image;
+		AssetFile file;
+		if (!file.open(filePath)) {
+			return FloatImage();
+		}
+		const stbi_uc* bytes = file.getData();
+		int size = (int)file.getSize();
+		stbi_set_flip_vertically_on_load_thread(flipVertically);
+		if (stbi_is_hdr_from_memory(bytes, size)) {
+			float* data = stbi_loadf_from_memory(bytes, size, &image.width, &image.height, &image.numComponents, 0);
+			if (data == NULL) {
+				printf("Failed to load image %s", filePath);
+				return FloatImage();
+			}
+			image.bitsPerChannel = 32;
+			image.pixels.assign(data, data + (size_t)image.width * image.height * image.numComponents);
+			stbi_image_free(data);
+			return image;
+		}
+		//stbi_loadf would undo an assumed 2.2 gamma on these, so convert them here instead
+		bool is16Bit = stbi_is_16_bit_from_memory(bytes, size);
+		void* data = is16Bit ? (void*)stbi_load_16_from_memory(bytes, size, &image.width, &image.height, &image.numComponents, 0)
+			: (void*)stbi_load_from_memory(bytes, size, &image.width, &image.height, &image.numComponents, 0);
+		if (data == NULL) {
+			printf("Failed to load image %s", filePath);
+			return FloatImage();
+		}
+		size_t count = (size_t)image.width * image.height * image.numComponents;
+		image.pixels.resize(count);
+		if (is16Bit) {
+			const unsigned short* values = (const unsigned short*)data;
+			for (size_t i = 0; i < count; i++) {
+				image.pixels[i] = values[i] / 65535.0f;
+			}
+		}
+		else {
+			const unsigned char* values = (const unsigned char*)data;
+			for (size_t i = 0; i < count; i++) {
+				image.pixels[i] = values[i] / 255.0f;
+			}
+		}
+		image.bitsPerChannel = is16Bit ? 16 : 8;
+		stbi_image_free(data);
+		return image;
+	}
+
+	static int wrap(int i, int size) {
+		i %= size;
+		return i < 0 ? i + size : i;
+	}
+
+	ew::Vec4 SampleImage(const Image& image, const ew::Vec2& uv) {
+		if (!image.isValid()) {
+			return ew::Vec4(1.0f);
+		}
+		//Texel centers are at half pixel offsets, like GL_LINEAR
+		float x = uv.x * image.width - 0.5f;
+		float y = uv.y * image.height - 0.5f;
+		float fx = floorf(x), fy = floorf(y);
+		float tx = x - fx, ty = y - fy;
+		int x0 = wrap((int)fx, image.width), x1 = wrap((int)fx + 1, image.width);
+		int y0 = wrap((int)fy, image.height), y1 = wrap((int)fy + 1, image.height);
+		const unsigned char* p00 = &image.pixels[((size_t)y0 * image.width + x0) * image.numComponents];
+		const unsigned char* p10 = &image.pixels[((size_t)y0 * image.width + x1) * image.numComponents];
+		const unsigned char* p01 = &image.pixels[((size_t)y1 * image.width + x0) * image.numComponents];
+		const unsigned char* p11 = &image.pixels[((size_t)y1 * image.width + x1) * image.numComponents];
+		float c[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+		for (int i = 0; i < image.numComponents && i < 4; i++) {
+			float top = p00[i] * (1.0f - tx) + p10[i] * tx;
+			float bottom = p01[i] * (1.0f - tx) + p11[i] * tx;
+			c[i] = (top * (1.0f - ty) + bottom * ty) / 255.0f;
+		}
+		return ew::Vec4(c[0], c[1], c[2], c[3]);
+	}
+
+	bool saveImagePPM(const char* filePath, int width, int height, const unsigned char* rgba) {
+		FILE* file = fopen(filePath, "wb");
+		if (file == NULL) {
+			printf("Failed to write image %s", filePath);
+			return false;
+		}
+		fprintf(file, "P6\n%d %d\n255\n", width, height);
+		std::vector<unsigned char> row(width * 3);
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				memcpy(&row[x * 3], &rgba[((size_t)y * width + x) * 4], 3);
+			}
+			fwrite(row.data(), 1, row.size(), file);
+		}
+		fclose(file);
+		return true;
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <vector>
+#include "ewMath/ewMath.h"
+
+namespace ew {
+	//Decoded 8 bit image in CPU memory. Rows start at the top of the file, like glTexImage2D expects.
+	struct Image {
+		int width = 0;
+		int height = 0;
+		int numComponents = 0;
+		std::vector<unsigned char> pixels;
+
+		inline bool isValid()const { return width > 0 && height > 0 && !pixels.empty(); }
+	};
+
+	//Decoded image with float channels, for HDR and 16 bit sources
+	struct FloatImage {
+		int width = 0;
+		int height = 0;
+		int numComponents = 0;
+		int bitsPerChannel = 0; //Of the file: 32 for HDR, 16 or 8 otherwise
+		std::vector<float> pixels;
+
+		inline bool isValid()const { return width > 0 && height > 0 && !pixels.empty(); }
+	};
+
+	//Decodes an image with stb_image. Returns an invalid image on failure.
+	//Safe to call from worker threads, the flip setting only applies to the calling thread.
+	Image loadImage(const char* filePath, bool flipVertically = false);
+	//Radiance .hdr files keep their linear values (stbi_loadf). 16 and 8 bit files are read at full precision
+	//(stbi_load_16 or stbi_load) and scaled to 0-1 as stored, without any gamma conversion.
+	FloatImage loadImageFloat(const char* filePath, bool flipVertically = false);
+
+	//Bilinear sample with repeat wrapping, in 0-1 range. Missing channels read as 0, alpha as 1.
+	ew::Vec4 SampleImage(const Image& image, const ew::Vec2& uv);
+
+	//Writes 8 bit RGBA pixels as a binary PPM (alpha is dropped)
+	bool saveImagePPM(const char* filePath, int width, int height, const unsigned char* rgba);
+}
@@ -0,0 +1,119 @@
+#include "jobSystem.h"
+#include <atomic>
+#include <memory>
+
+namespace ew {
+	JobSystem::JobSystem(int numWorkers)
+	{
+		if (numWorkers <= 0) {
+			int hardwareThreads = (int)std::thread::hardware_concurrency();
+			numWorkers = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+		}
+		for (int i = 0; i < numWorkers; i++) {
+			m_workers.emplace_back(&JobSystem::workerLoop, this);
+		}
+	}
+
+	JobSystem::~JobSystem()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_quit = true;
+		}
+		m_wake.notify_all();
+		for (std::thread& worker : m_workers) {
+			worker.join();
+		}
+	}
+
+	void JobSystem::submit(std::function<void()> job)
+	{
+		//Without workers, run inline so callers behave the same
+		if (m_workers.empty()) {
+			job();
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_queue.push_back(std::move(job));
+			m_pending++;
+		}
+		m_wake.notify_one();
+	}
+
+	void JobSystem::wait()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_idle.wait(lock, [this] { return m_pending == 0; });
+	}
+
+	void JobSystem::workerLoop()
+	{
+		while (true) {
+			std::function<void()> job;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_wake.wait(lock, [this] { return m_quit || !m_queue.empty(); });
+				if (m_quit && m_queue.empty()) {
+					return;
+				}
+				job = std::move(m_queue.front());
+				m_queue.pop_front();
+			}
+			job();
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_pending--;
+				if (m_pending == 0) {
+					m_idle.notify_all();
+				}
+			}
+		}
+	}
+
+	//Shared between the caller and helpers of one parallelFor. Helpers may start after the caller returns,
+	//so this lives on the heap instead of the caller's stack.
+	struct ParallelForState {
+		std::atomic<int> next{ 0 };
+		std::atomic<int> done{ 0 };
+		int count = 0;
+		std::function<void(int)> job;
+		std::mutex mutex;
+		std::condition_variable finished;
+	};
+
+	static void runParallelFor(ParallelForState& state) {
+		int i;
+		while ((i = state.next.fetch_add(1)) < state.count) {
+			state.job(i);
+			if (state.done.fetch_add(1) + 1 == state.count) {
+				std::lock_guard<std::mutex> lock(state.mutex);
+				state.finished.notify_all();
+			}
+		}
+	}
+
+	void JobSystem::parallelFor(int count, const std::function<void(int)>& job)
+	{
+		if (count <= 0) {
+			return;
+		}
+		if (m_workers.empty() || count == 1) {
+			for (int i = 0; i < count; i++) {
+				job(i);
+			}
+			return;
+		}
+		std::shared_ptr<ParallelForState> state = std::make_shared<ParallelForState>();
+		state->count = count;
+		state->job = job;
+		int helpers = (int)m_workers.size() < count - 1 ? (int)m_workers.size() : count - 1;
+		for (int i = 0; i < helpers; i++) {
+			submit([state] { runParallelFor(*state); });
+		}
+		//The calling thread works too, so nested calls from inside a job cannot deadlock
+		runParallelFor(*state);
+		std::unique_lock<std::mutex> lock(state->mutex);
+		state->finished.wait(lock, [&] { return state->done.load() == count; });
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace ew {
+	/// <summary>
+	/// Fixed pool of worker threads for CPU side work (rasterizing, decoding, etc.)
+	/// Never touches OpenGL, so results must be handed back to the main thread for upload.
+	/// </summary>
+	class JobSystem {
+	public:
+		//0 workers uses one per hardware thread, minus the calling thread
+		JobSystem(int numWorkers = 0);
+		~JobSystem();
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		//Queues a job to run on a worker
+		void submit(std::function<void()> job);
+		//Blocks until every submitted job has finished
+		void wait();
+		//Runs job(i) for i in [0, count) on the workers and the calling thread. Returns once all are done.
+		void parallelFor(int count, const std::function<void(int)>& job);
+
+		//Workers plus the calling thread
+		inline int getNumThreads()const { return (int)m_workers.size() + 1; }
+	private:
+		void workerLoop();
+
+		std::vector<std::thread> m_workers;
+		std::deque<std::function<void()>> m_queue;
+		std::mutex m_mutex;
+		std::condition_variable m_wake;
+		std::condition_variable m_idle;
+		int m_pending = 0; //Queued plus running jobs
+		bool m_quit = false;
+	};
+}
@@ -0,0 +1,141 @@
+#include "mappedFile.h"
+#include <stdio.h>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace ew {
+	MappedFile::~MappedFile()
+	{
+		close();
+	}
+
+	MappedFile::MappedFile(MappedFile&& other) noexcept
+	{
+		moveFrom(other);
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+	{
+		if (this != &other) {
+			close();
+			moveFrom(other);
+		}
+		return *this;
+	}
+
+	void MappedFile::moveFrom(MappedFile& other)
+	{
+		m_data = other.m_data;
+		m_size = other.m_size;
+		m_open = other.m_open;
+		other.m_data = nullptr;
+		other.m_size = 0;
+		other.m_open = false;
+#ifdef _WIN32
+		m_file = other.m_file;
+		m_mapping = other.m_mapping;
+		other.m_file = nullptr;
+		other.m_mapping = nullptr;
+#endif
+	}
+
+#ifdef _WIN32
+	bool MappedFile::open(const char* filePath)
+	{
+		close();
+		HANDLE file = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(file, &size)) {
+			CloseHandle(file);
+			return false;
+		}
+		m_file = file;
+		m_size = (size_t)size.QuadPart;
+		m_open = true;
+		//Mapping an empty file fails, but there is nothing to read anyway
+		if (m_size == 0) {
+			return true;
+		}
+		m_mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (m_mapping != NULL) {
+			m_data = (const unsigned char*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+		}
+		if (m_data == nullptr) {
+			printf("Failed to map %s\n", filePath);
+			close();
+			return false;
+		}
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+		if (m_data) {
+			UnmapViewOfFile(m_data);
+		}
+		if (m_mapping) {
+			CloseHandle(m_mapping);
+		}
+		if (m_file) {
+			CloseHandle(m_file);
+		}
+		m_data = nullptr;
+		m_mapping = nullptr;
+		m_file = nullptr;
+		m_size = 0;
+		m_open = false;
+	}
+#else
+	bool MappedFile::open(const char* filePath)
+	{
+		close();
+		int file = ::open(filePath, O_RDONLY);
+		if (file < 0) {
+			return false;
+		}
+		struct stat info;
+		if (fstat(file, &info) != 0) {
+			::close(file);
+			return false;
+		}
+		m_size = (size_t)info.st_size;
+		m_open = true;
+		//Mapping an empty file fails, but there is nothing to read anyway
+		if (m_size > 0) {
+			void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+			if (data == MAP_FAILED) {
+				printf("Failed to map %s\n", filePath);
+				m_size = 0;
+				m_open = false;
+			}
+			else {
+				m_data = (const unsigned char*)data;
+			}
+		}
+		//The mapping keeps the file alive on its own
+		::close(file);
+		return m_open;
+	}
+
+	void MappedFile::close()
+	{
+		if (m_data) {
+			munmap((void*)m_data, m_size);
+		}
+		m_data = nullptr;
+		m_size = 0;
+		m_open = false;
+	}
+#endif
+}
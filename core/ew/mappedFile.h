@@ -0,0 +1,36 @@
+#pragma once
+#include <stddef.h>
+
+namespace ew {
+	/// <summary>
+	/// Read only view of a whole file, mapped into memory instead of copied.
+	/// Pages are read by the OS on first touch, so opening a large file is cheap.
+	/// </summary>
+	class MappedFile {
+	public:
+		MappedFile() = default;
+		~MappedFile();
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		//Closes any previous mapping first. An empty file opens with no data.
+		bool open(const char* filePath);
+		void close();
+
+		inline bool isOpen()const { return m_open; }
+		inline const unsigned char* getData()const { return m_data; }
+		inline size_t getSize()const { return m_size; }
+	private:
+		void moveFrom(MappedFile& other);
+
+		const unsigned char* m_data = nullptr;
+		size_t m_size = 0;
+		bool m_open = false;
+#ifdef _WIN32
+		void* m_file = nullptr;
+		void* m_mapping = nullptr;
+#endif
+	};
+}
@@ -5,10 +5,67 @@
 #include "mesh.h"
 #include "ewMath/ewMath.h"
 #include "external/glad.h"
+#include <stdio.h>
 
 namespace ew {
-	Mesh::Mesh(const MeshData& meshData)
+	static MeshUploadStats s_uploadStats;
+
+	const MeshUploadStats& getMeshUploadStats()
+	{
+		return s_uploadStats;
+	}
+
+	void resetMeshUploadStats()
 	{
+		s_uploadStats = MeshUploadStats();
+	}
+
+	static GLenum getUsageHint(MeshUsage usage)
+	{
+		switch (usage) {
+		case MeshUsage::DYNAMIC:
+			return GL_DYNAMIC_DRAW;
+		case MeshUsage::STREAM:
+			return GL_STREAM_DRAW;
+		default:
+			return GL_STATIC_DRAW;
+		}
+	}
+
+	/// <summary>
+	/// Replaces the contents of the buffer bound to target. Storage that's big enough is kept: dynamic meshes orphan it first,
+	/// so the driver can hand out fresh memory rather than wait for draws still reading the old contents.
+	/// Storage that's too small grows to double its size for dynamic meshes, so a mesh edited larger and larger reallocates rarely.
+	/// </summary>
+	static void uploadBuffer(GLenum target, const void* data, size_t size, size_t* capacity, MeshUsage usage)
+	{
+		GLenum hint = getUsageHint(usage);
+		if (size > *capacity) {
+			size_t grown = usage == MeshUsage::STATIC ? size : *capacity * 2;
+			*capacity = grown > size ? grown : size;
+			s_uploadStats.reallocations++;
+			if (*capacity == size) {
+				glBufferData(target, size, data, hint);
+			}
+			else {
+				glBufferData(target, *capacity, NULL, hint);
+				glBufferSubData(target, 0, size, data);
+			}
+		}
+		else {
+			if (usage != MeshUsage::STATIC) {
+				glBufferData(target, *capacity, NULL, hint);
+				s_uploadStats.orphans++;
+			}
+			glBufferSubData(target, 0, size, data);
+		}
+		s_uploadStats.uploads++;
+		s_uploadStats.bytes += size;
+	}
+
+	Mesh::Mesh(const MeshData& meshData, MeshUsage usage)
+	{
+		m_usage = usage;
 		load(meshData);
 	}
 	void Mesh::load(const MeshData& meshData)
@@ -42,10 +99,10 @@ namespace ew {
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
 
 		if (meshData.vertices.size() > 0) {
-			glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * meshData.vertices.size(), meshData.vertices.data(), GL_STATIC_DRAW);
+			uploadBuffer(GL_ARRAY_BUFFER, meshData.vertices.data(), sizeof(Vertex) * meshData.vertices.size(), &m_vertexCapacity, m_usage);
 		}
 		if (meshData.indices.size() > 0) {
-			glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * meshData.indices.size(), meshData.indices.data(), GL_STATIC_DRAW);
+			uploadBuffer(GL_ELEMENT_ARRAY_BUFFER, meshData.indices.data(), sizeof(unsigned int) * meshData.indices.size(), &m_indexCapacity, m_usage);
 		}
 		m_numVertices = meshData.vertices.size();
 		m_numIndices = meshData.indices.size();
@@ -54,6 +111,35 @@ namespace ew {
 		glBindBuffer(GL_ARRAY_BUFFER, 0);
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 	}
+	bool Mesh::updateVertices(const Vertex* vertices, int first, int count)
+	{
+		if (first < 0 || count < 0 || first + count > m_numVertices) {
+			printf("Vertices %d to %d are outside the mesh's %d\n", first, first + count, m_numVertices);
+			return false;
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+		glBufferSubData(GL_ARRAY_BUFFER, sizeof(Vertex) * first, sizeof(Vertex) * count, vertices);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		s_uploadStats.uploads++;
+		s_uploadStats.bytes += sizeof(Vertex) * count;
+		return true;
+	}
+
+	bool Mesh::updateIndices(const unsigned int* indices, int first, int count)
+	{
+		if (first < 0 || count < 0 || first + count > m_numIndices) {
+			printf("Indices %d to %d are outside the mesh's %d\n", first, first + count, m_numIndices);
+			return false;
+		}
+		//The element buffer is part of the vertex array's state, so it's bound through it
+		glBindVertexArray(m_vao);
+		glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * first, sizeof(unsigned int) * count, indices);
+		glBindVertexArray(0);
+		s_uploadStats.uploads++;
+		s_uploadStats.bytes += sizeof(unsigned int) * count;
+		return true;
+	}
+
 	void Mesh::draw(ew::DrawMode drawMode) const
 	{
 		glBindVertexArray(m_vao);
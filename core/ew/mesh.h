@@ -22,14 +22,42 @@ namespace ew {
 		POINTS = 1
 	};
 
+	//How often a mesh's buffers are rewritten, given to GL as the usage hint
+	enum class MeshUsage {
+		STATIC = 0, //Loaded once
+		DYNAMIC = 1, //Edited now and then, e.g. by a UI
+		STREAM = 2 //Rewritten every frame
+	};
+
+	//Buffer traffic from every Mesh since the last resetMeshUploadStats(), e.g. per frame
+	struct MeshUploadStats {
+		size_t bytes = 0;
+		int uploads = 0; //Full or partial
+		int reallocations = 0; //Storage that had to grow
+		int orphans = 0; //Storage handed back to the driver before a full rewrite
+	};
+	const MeshUploadStats& getMeshUploadStats();
+	void resetMeshUploadStats();
+
 	class Mesh {
 	public:
 		Mesh() {};
-		Mesh(const MeshData& meshData);
+		Mesh(const MeshData& meshData, MeshUsage usage = MeshUsage::STATIC);
+		//Replaces the whole mesh. Existing storage is kept when the new data fits.
 		void load(const MeshData& meshData);
+		//Rewrites count vertices or indices starting at first, which must already be in the mesh. False if they aren't.
+		bool updateVertices(const Vertex* vertices, int first, int count);
+		bool updateIndices(const unsigned int* indices, int first, int count);
 		void draw(DrawMode drawMode = DrawMode::TRIANGLES)const;
+		//Takes effect the next time storage is allocated or orphaned
+		inline void setUsage(MeshUsage usage) { m_usage = usage; }
+		inline MeshUsage getUsage()const { return m_usage; }
 		inline int getNumVertices()const { return m_numVertices; }
 		inline int getNumIndices()const { return m_numIndices; }
+		//Bytes of storage allocated for each buffer, at least what's in use
+		inline size_t getVertexCapacity()const { return m_vertexCapacity; }
+		inline size_t getIndexCapacity()const { return m_indexCapacity; }
+		inline unsigned int getVAO()const { return m_vao; }
 	private:
 		bool m_initialized = false;
 		unsigned int m_vao = 0;
@@ -37,5 +65,8 @@ namespace ew {
 		unsigned int m_ebo = 0;
 		int m_numVertices = 0;
 		int m_numIndices = 0;
+		MeshUsage m_usage = MeshUsage::STATIC;
+		size_t m_vertexCapacity = 0;
+		size_t m_indexCapacity = 0;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,265 @@
+#include "mipmap.h"
+#include "textureContainer.h"
+#include "ewMath/simd.h"
+#include <math.h>
+#include <algorithm>
+
+namespace ew {
+	static const int LINEAR_TO_SRGB_SIZE = 4096;
+
+	//Lookup tables for sRGB <-> linear, built once
+	struct GammaTables {
+		float toLinear[256];
+		unsigned char toSrgb[LINEAR_TO_SRGB_SIZE + 1];
+
+		GammaTables() {
+			for (int i = 0; i < 256; i++) {
+				float c = i / 255.0f;
+				toLinear[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+			}
+			for (int i = 0; i <= LINEAR_TO_SRGB_SIZE; i++) {
+				float l = (float)i / LINEAR_TO_SRGB_SIZE;
+				float c = l <= 0.0031308f ? l * 12.92f : 1.055f * powf(l, 1.0f / 2.4f) - 0.055f;
+				toSrgb[i] = (unsigned char)(ew::Clamp(c, 0.0f, 1.0f) * 255.0f + 0.5f);
+			}
+		}
+	};
+	static const GammaTables& getGammaTables() {
+		static GammaTables tables;
+		return tables;
+	}
+
+	//Source pixels and weights that make up one destination pixel along an axis
+	struct FilterTaps {
+		std::vector<int> first; //Index into taps per destination pixel, with one extra at the end
+		std::vector<int> index;
+		std::vector<float> weight;
+	};
+
+	//Zeroth order modified Bessel function of the first kind, for the Kaiser window
+	static float besselI0(float x) {
+		float sum = 1.0f, term = 1.0f;
+		for (int k = 1; k < 20; k++) {
+			term *= (x * 0.5f / k) * (x * 0.5f / k);
+			sum += term;
+		}
+		return sum;
+	}
+
+	static float kaiserWeight(float x, float halfWidth) {
+		const float ALPHA = 4.0f;
+		if (fabsf(x) >= halfWidth) {
+			return 0.0f;
+		}
+		float t = x / halfWidth;
+		float window = besselI0(ALPHA * sqrtf(1.0f - t * t)) / besselI0(ALPHA);
+		float sinc = x == 0.0f ? 1.0f : sinf(ew::PI * x) / (ew::PI * x);
+		return sinc * window;
+	}
+
+	/// <summary>
+	/// Computes normalized taps for resampling srcSize pixels down to dstSize along one axis. Edges are clamped.
+	/// </summary>
+	static void buildTaps(int srcSize, int dstSize, MipFilter filter, FilterTaps* taps) {
+		const float KAISER_HALF_WIDTH = 1.5f; //In destination pixels
+		float scale = (float)srcSize / dstSize;
+		taps->first.clear();
+		taps->index.clear();
+		taps->weight.clear();
+		for (int x = 0; x < dstSize; x++) {
+			taps->first.push_back((int)taps->index.size());
+			float center = (x + 0.5f) * scale;
+			size_t start = taps->index.size();
+			float total = 0.0f;
+			if (filter == MipFilter::BOX) {
+				//Weight each source pixel by how much of it the destination pixel covers
+				float lo = x * scale, hi = (x + 1) * scale;
+				for (int s = (int)floorf(lo); s < (int)ceilf(hi); s++) {
+					float w = std::min(hi, s + 1.0f) - std::max(lo, (float)s);
+					if (w <= 0.0f) {
+						continue;
+					}
+					taps->index.push_back(std::min(s, srcSize - 1));
+					taps->weight.push_back(w);
+					total += w;
+				}
+			}
+			else {
+				float radius = KAISER_HALF_WIDTH * scale;
+				for (int s = (int)floorf(center - radius); s <= (int)ceilf(center + radius); s++) {
+					float w = kaiserWeight((s + 0.5f - center) / scale, KAISER_HALF_WIDTH);
+					if (w == 0.0f) {
+						continue;
+					}
+					taps->index.push_back(std::min(std::max(s, 0), srcSize - 1));
+					taps->weight.push_back(w);
+					total += w;
+				}
+			}
+			for (size_t i = start; i < taps->weight.size(); i++) {
+				taps->weight[i] /= total;
+			}
+		}
+		taps->first.push_back((int)taps->index.size());
+	}
+
+	static void runRows(JobSystem* jobSystem, int numRows, const std::function<void(int, int)>& rows) {
+		//Bands of rows keep jobs large enough to be worth scheduling
+		const int ROWS_PER_JOB = 16;
+		int numJobs = (numRows + ROWS_PER_JOB - 1) / ROWS_PER_JOB;
+		auto job = [&](int i) { rows(i * ROWS_PER_JOB, std::min((i + 1) * ROWS_PER_JOB, numRows)); };
+		if (jobSystem) {
+			jobSystem->parallelFor(numJobs, job);
+		}
+		else {
+			for (int i = 0; i < numJobs; i++) {
+				job(i);
+			}
+		}
+	}
+
+	static int numColorChannels(int numComponents) {
+		//Grey + alpha, or RGB + alpha
+		return numComponents <= 2 ? 1 : 3;
+	}
+
+	/// <summary>
+	/// Converts a linear RGBA float level back to 8 bits with the source's channel count
+	/// </summary>
+	static Image toImage(const std::vector<Float4>& pixels, int width, int height, int numComponents, bool gammaCorrect, JobSystem* jobSystem) {
+		const GammaTables& tables = getGammaTables();
+		Image image;
+		image.width = width;
+		image.height = height;
+		image.numComponents = numComponents;
+		image.pixels.resize((size_t)width * height * numComponents);
+		int colorChannels = numColorChannels(numComponents);
+		runRows(jobSystem, height, [&](int rowStart, int rowEnd) {
+			for (size_t i = (size_t)rowStart * width; i < (size_t)rowEnd * width; i++) {
+				float rgba[4];
+				Float4Store(rgba, pixels[i]);
+				unsigned char* out = &image.pixels[i * numComponents];
+				for (int c = 0; c < numComponents; c++) {
+					//Alpha is stored in the last lane
+					float v = ew::Clamp(c < colorChannels ? rgba[c] : rgba[3], 0.0f, 1.0f);
+					if (gammaCorrect && c < colorChannels) {
+						out[c] = tables.toSrgb[(int)(v * LINEAR_TO_SRGB_SIZE + 0.5f)];
+					}
+					else {
+						out[c] = (unsigned char)(v * 255.0f + 0.5f);
+					}
+				}
+			}
+		});
+		return image;
+	}
+
+	MipChain BuildMipChain(const Image& image, MipFilter filter, bool gammaCorrect, JobSystem* jobSystem)
+	{
+		MipChain chain;
+		if (!image.isValid()) {
+			return chain;
+		}
+		chain.levels.push_back(image);
+		const GammaTables& tables = getGammaTables();
+		int numComponents = image.numComponents;
+		int colorChannels = numColorChannels(numComponents);
+
+		//Widen to one linear RGBA Float4 per pixel, with alpha always in the last lane
+		int width = image.width;
+		int height = image.height;
+		std::vector<Float4> src((size_t)width * height);
+		runRows(jobSystem, height, [&](int rowStart, int rowEnd) {
+			for (size_t i = (size_t)rowStart * width; i < (size_t)rowEnd * width; i++) {
+				const unsigned char* in = &image.pixels[i * numComponents];
+				float rgba[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+				for (int c = 0; c < numComponents; c++) {
+					float v = gammaCorrect && c < colorChannels ? tables.toLinear[in[c]] : in[c] / 255.0f;
+					rgba[c < colorChannels ? c : 3] = v;
+				}
+				src[i] = Float4Load(rgba);
+			}
+		});
+
+		std::vector<Float4> temp, dst;
+		FilterTaps tapsX, tapsY;
+		while (width > 1 || height > 1) {
+			int dstWidth = std::max(width / 2, 1);
+			int dstHeight = std::max(height / 2, 1);
+			buildTaps(width, dstWidth, filter, &tapsX);
+			buildTaps(height, dstHeight, filter, &tapsY);
+
+			//Separable: filter rows into temp, then columns into dst
+			temp.resize((size_t)dstWidth * height);
+			runRows(jobSystem, height, [&](int rowStart, int rowEnd) {
+				for (int y = rowStart; y < rowEnd; y++) {
+					const Float4* row = &src[(size_t)y * width];
+					for (int x = 0; x < dstWidth; x++) {
+						Float4 sum = Float4Set1(0.0f);
+						for (int t = tapsX.first[x]; t < tapsX.first[x + 1]; t++) {
+							sum = sum + row[tapsX.index[t]] * Float4Set1(tapsX.weight[t]);
+						}
+						temp[(size_t)y * dstWidth + x] = sum;
+					}
+				}
+			});
+			dst.resize((size_t)dstWidth * dstHeight);
+			runRows(jobSystem, dstHeight, [&](int rowStart, int rowEnd) {
+				for (int y = rowStart; y < rowEnd; y++) {
+					Float4* out = &dst[(size_t)y * dstWidth];
+					for (int x = 0; x < dstWidth; x++) {
+						out[x] = Float4Set1(0.0f);
+					}
+					for (int t = tapsY.first[y]; t < tapsY.first[y + 1]; t++) {
+						const Float4* row = &temp[(size_t)tapsY.index[t] * dstWidth];
+						Float4 weight = Float4Set1(tapsY.weight[t]);
+						for (int x = 0; x < dstWidth; x++) {
+							out[x] = out[x] + row[x] * weight;
+						}
+					}
+				}
+			});
+
+			chain.levels.push_back(toImage(dst, dstWidth, dstHeight, numComponents, gammaCorrect, jobSystem));
+			std::swap(src, dst);
+			width = dstWidth;
+			height = dstHeight;
+		}
+		return chain;
+	}
+
+	MipChain loadMipChainCached(const char* imagePath, MipFilter filter, bool gammaCorrect, bool flipVertically, JobSystem* jobSystem, MipStats* stats)
+	{
+		MipStats localStats;
+		stats = stats ? stats : &localStats;
+		*stats = MipStats();
+		TextureCacheSettings settings;
+		settings.flipVertically = flipVertically;
+		settings.mipFilter = filter;
+		settings.gammaCorrect = gammaCorrect;
+		TextureContainer container;
+		TextureCacheStats cacheStats;
+		MipChain chain;
+		if (!openTextureCached(imagePath, settings, &container, jobSystem, &cacheStats)) {
+			return chain;
+		}
+		int numComponents = (int)container.getHeader().numComponents;
+		for (int i = 0; i < container.getNumLevels(); i++) {
+			const TextureContainerLevel& level = container.getLevel(i);
+			Image image;
+			image.width = (int)level.width;
+			image.height = (int)level.height;
+			image.numComponents = numComponents;
+			image.pixels.assign(container.getLevelData(i), container.getLevelData(i) + level.size);
+			chain.levels.push_back(std::move(image));
+		}
+		stats->fromCache = cacheStats.fromCache;
+		stats->buildMs = cacheStats.buildMs;
+		stats->loadMs = cacheStats.loadMs;
+		if (!stats->fromCache) {
+			float megapixels = chain.levels[0].width * chain.levels[0].height / 1000000.0f;
+			stats->megapixelsPerSecond = megapixels / std::max(stats->buildMs / 1000.0f, 1e-6f);
+		}
+		return chain;
+	}
+}
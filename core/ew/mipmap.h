@@ -0,0 +1,34 @@
+#pragma once
+#include <vector>
+#include "image.h"
+#include "jobSystem.h"
+
+namespace ew {
+	enum class MipFilter {
+		BOX = 0, //Area average, same as most glGenerateMipmap implementations
+		KAISER = 1 //Windowed sinc, sharper but slower
+	};
+
+	//Every level of a texture, level 0 being the full size image
+	struct MipChain {
+		std::vector<Image> levels;
+
+		inline bool isValid()const { return !levels.empty() && levels[0].isValid(); }
+	};
+
+	struct MipStats {
+		float loadMs = 0; //Everything, including decoding or reading the cache
+		float buildMs = 0; //Decoding and filtering, 0 when cached
+		float megapixelsPerSecond = 0; //Level 0 pixels over build time
+		bool fromCache = false;
+	};
+
+	//Downsamples each level from the one before it until 1x1, using GL's floor(size / 2) rule.
+	//With gammaCorrect, color channels are treated as sRGB and filtered in linear space. Alpha is always linear.
+	//Each level is split into row bands across the job system, if one is given.
+	MipChain BuildMipChain(const Image& image, MipFilter filter, bool gammaCorrect, JobSystem* jobSystem = nullptr);
+
+	//Copies a mip chain out of the image's texture container, which openTextureCached builds if it's missing or stale
+	MipChain loadMipChainCached(const char* imagePath, MipFilter filter, bool gammaCorrect, bool flipVertically,
+		JobSystem* jobSystem = nullptr, MipStats* stats = nullptr);
+}
@@ -0,0 +1,347 @@
+#include "occlusion.h"
+#include "ewMath/simd.h"
+#include <math.h>
+#include <chrono>
+#include <algorithm>
+
+namespace ew {
+	static double nowMs() {
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+	}
+
+	OcclusionBuffer::OcclusionBuffer(int width, int height, JobSystem* jobSystem)
+		:m_jobSystem(jobSystem)
+	{
+		resize(width, height);
+	}
+
+	void OcclusionBuffer::resize(int width, int height)
+	{
+		m_width = (std::max(width, 4) + 3) & ~3;
+		m_height = std::max(height, 1);
+		m_levels.clear();
+		m_levelWidths.clear();
+		m_levelHeights.clear();
+		int levelWidth = m_width;
+		int levelHeight = m_height;
+		while (true) {
+			m_levels.push_back(std::vector<float>((size_t)levelWidth * levelHeight, 1.0f));
+			m_levelWidths.push_back(levelWidth);
+			m_levelHeights.push_back(levelHeight);
+			if (levelWidth == 1 && levelHeight == 1) {
+				break;
+			}
+			levelWidth = (levelWidth + 1) / 2;
+			levelHeight = (levelHeight + 1) / 2;
+		}
+	}
+
+	void OcclusionBuffer::begin(const ew::Mat4& viewProjection)
+	{
+		m_viewProjection = viewProjection;
+		m_numOccluders = 0;
+		m_stats = OcclusionStats();
+	}
+
+	void OcclusionBuffer::addOccluder(const MeshData& meshData, const ew::Mat4& model)
+	{
+		if (m_numOccluders == m_occluders.size()) {
+			m_occluders.emplace_back();
+		}
+		Occluder& occluder = m_occluders[m_numOccluders++];
+		occluder.meshData = &meshData;
+		occluder.model = model;
+		m_stats.occluderTriangles += (int)(meshData.indices.size() / 3);
+	}
+
+	void OcclusionBuffer::end()
+	{
+		//Occluders are independent, so set them up in parallel
+		double start = nowMs();
+		int numOccluders = (int)m_numOccluders;
+		auto setup = [this](int i) { setupOccluder(m_occluders[i]); };
+		if (m_jobSystem) {
+			m_jobSystem->parallelFor(numOccluders, setup);
+		}
+		else {
+			for (int i = 0; i < numOccluders; i++) {
+				setup(i);
+			}
+		}
+		for (int i = 0; i < numOccluders; i++) {
+			m_stats.trianglesRasterized += (int)m_occluders[i].triangles.size();
+		}
+		m_stats.setupMs = (float)(nowMs() - start);
+
+		start = nowMs();
+		std::fill(m_levels[0].begin(), m_levels[0].end(), 1.0f);
+		int tilesX = (m_width + TILE_WIDTH - 1) / TILE_WIDTH;
+		int tilesY = (m_height + TILE_HEIGHT - 1) / TILE_HEIGHT;
+		auto rasterize = [this](int tile) { rasterizeTile(tile); };
+		if (m_jobSystem) {
+			m_jobSystem->parallelFor(tilesX * tilesY, rasterize);
+		}
+		else {
+			for (int i = 0; i < tilesX * tilesY; i++) {
+				rasterize(i);
+			}
+		}
+		buildHierarchy();
+		m_stats.rasterMs = (float)(nowMs() - start);
+	}
+
+	/// <summary>
+	/// Transforms an occluder 4 vertices at a time and sets up edge and depth equations for its front facing triangles
+	/// </summary>
+	void OcclusionBuffer::setupOccluder(Occluder& occluder)
+	{
+		const std::vector<Vertex>& vertices = occluder.meshData->vertices;
+		const std::vector<unsigned int>& indices = occluder.meshData->indices;
+		ew::Mat4 m = m_viewProjection * occluder.model;
+		size_t numVertices = vertices.size();
+		occluder.vertices.resize(((numVertices + 3) & ~(size_t)3) * 4);
+		float* out = occluder.vertices.data();
+		const Float4 halfWidth = Float4Set1(m_width * 0.5f);
+		const Float4 halfHeight = Float4Set1(m_height * 0.5f);
+		const Float4 half = Float4Set1(0.5f);
+		const Float4 one = Float4Set1(1.0f);
+		for (size_t i = 0; i < numVertices; i += 4) {
+			//Gather positions into structure of arrays, repeating the last vertex to fill the group
+			float px[4], py[4], pz[4];
+			for (int lane = 0; lane < 4; lane++) {
+				const ew::Vec3& p = vertices[std::min(i + lane, numVertices - 1)].pos;
+				px[lane] = p.x;
+				py[lane] = p.y;
+				pz[lane] = p.z;
+			}
+			Float4 x = Float4Load(px), y = Float4Load(py), z = Float4Load(pz);
+			Float4 clipX = Float4Set1(m[0][0]) * x + Float4Set1(m[1][0]) * y + Float4Set1(m[2][0]) * z + Float4Set1(m[3][0]);
+			Float4 clipY = Float4Set1(m[0][1]) * x + Float4Set1(m[1][1]) * y + Float4Set1(m[2][1]) * z + Float4Set1(m[3][1]);
+			Float4 clipZ = Float4Set1(m[0][2]) * x + Float4Set1(m[1][2]) * y + Float4Set1(m[2][2]) * z + Float4Set1(m[3][2]);
+			Float4 clipW = Float4Set1(m[0][3]) * x + Float4Set1(m[1][3]) * y + Float4Set1(m[2][3]) * z + Float4Set1(m[3][3]);
+			//Vertices behind the near plane are flagged by their w and never divided
+			Float4 inFront = CmpGe(clipZ + clipW, Float4Set1(0.0f)) & CmpGt(clipW, Float4Set1(0.0f));
+			Float4 invW = one / Select(inFront, clipW, one);
+			Float4 screenX = (clipX * invW + one) * halfWidth;
+			Float4 screenY = (one - clipY * invW) * halfHeight;
+			Float4 depth = clipZ * invW * half + half;
+			Float4 w = Select(inFront, clipW, Float4Set1(-1.0f));
+			float sx[4], sy[4], sz[4], sw[4];
+			Float4Store(sx, screenX);
+			Float4Store(sy, screenY);
+			Float4Store(sz, depth);
+			Float4Store(sw, w);
+			for (int lane = 0; lane < 4; lane++) {
+				float* v = &out[(i + lane) * 4];
+				v[0] = sx[lane]; v[1] = sy[lane]; v[2] = sz[lane]; v[3] = sw[lane];
+			}
+		}
+
+		occluder.triangles.clear();
+		occluder.minX = m_width;
+		occluder.minY = m_height;
+		occluder.maxX = -1;
+		occluder.maxY = -1;
+		size_t numTriangles = indices.size() / 3;
+		for (size_t t = 0; t < numTriangles; t++) {
+			const float* v[3] = {
+				&out[indices[t * 3 + 0] * 4],
+				&out[indices[t * 3 + 1] * 4],
+				&out[indices[t * 3 + 2] * 4]
+			};
+			//Occluders are optional, so skip triangles crossing the near plane instead of clipping
+			if (v[0][3] <= 0.0f || v[1][3] <= 0.0f || v[2][3] <= 0.0f) {
+				continue;
+			}
+			//Front faces are counter clockwise in NDC, which is a negative area with Y down
+			float area = (v[1][0] - v[0][0]) * (v[2][1] - v[0][1]) - (v[1][1] - v[0][1]) * (v[2][0] - v[0][0]);
+			if (area >= 0.0f) {
+				continue;
+			}
+			std::swap(v[1], v[2]);
+			area = -area;
+
+			float minX = std::min(v[0][0], std::min(v[1][0], v[2][0]));
+			float maxX = std::max(v[0][0], std::max(v[1][0], v[2][0]));
+			float minY = std::min(v[0][1], std::min(v[1][1], v[2][1]));
+			float maxY = std::max(v[0][1], std::max(v[1][1], v[2][1]));
+			if (maxX < 0.0f || maxY < 0.0f || minX > (float)m_width || minY > (float)m_height) {
+				continue;
+			}
+			Triangle tri;
+			tri.minX = (int)ceilf(std::max(minX, 0.0f) - 0.5f);
+			tri.maxX = std::min((int)floorf(std::min(maxX, (float)m_width) - 0.5f), m_width - 1);
+			tri.minY = (int)ceilf(std::max(minY, 0.0f) - 0.5f);
+			tri.maxY = std::min((int)floorf(std::min(maxY, (float)m_height) - 0.5f), m_height - 1);
+			if (tri.minX > tri.maxX || tri.minY > tri.maxY) {
+				continue;
+			}
+
+			//Edge i is opposite vertex i. Depth is affine in screen space, so it is the barycentric blend of the 3 depths.
+			float invArea = 1.0f / area;
+			tri.z0 = tri.dzdx = tri.dzdy = 0.0f;
+			for (int i = 0; i < 3; i++) {
+				const float* a = v[(i + 1) % 3];
+				const float* b = v[(i + 2) % 3];
+				//Evaluate shared edges in the same vertex order from both sides, so neighbors get exactly negated
+				//values and the top-left rule leaves no cracks between them
+				bool flip = a[1] > b[1] || (a[1] == b[1] && a[0] > b[0]);
+				if (flip) {
+					std::swap(a, b);
+				}
+				float dx = b[0] - a[0];
+				float dy = b[1] - a[1];
+				float sign = flip ? -1.0f : 1.0f;
+				tri.edgeA[i] = -dy * sign;
+				tri.edgeB[i] = dx * sign;
+				tri.edgeC[i] = (dy * a[0] - dx * a[1]) * sign;
+				//With Y down and positive winding, top edges run +X and left edges run -Y
+				tri.topLeft[i] = (tri.edgeA[i] == 0.0f && tri.edgeB[i] > 0.0f) || tri.edgeA[i] > 0.0f;
+				tri.z0 += tri.edgeC[i] * invArea * v[i][2];
+				tri.dzdx += tri.edgeA[i] * invArea * v[i][2];
+				tri.dzdy += tri.edgeB[i] * invArea * v[i][2];
+			}
+			occluder.triangles.push_back(tri);
+			occluder.minX = std::min(occluder.minX, tri.minX);
+			occluder.minY = std::min(occluder.minY, tri.minY);
+			occluder.maxX = std::max(occluder.maxX, tri.maxX);
+			occluder.maxY = std::max(occluder.maxY, tri.maxY);
+		}
+	}
+
+	/// <summary>
+	/// Rasterizes every occluder triangle overlapping a tile, keeping the nearest depth per pixel.
+	/// Tile widths are a multiple of 4, so groups of 4 pixels never cross into another tile.
+	/// </summary>
+	void OcclusionBuffer::rasterizeTile(int tile)
+	{
+		int tilesX = (m_width + TILE_WIDTH - 1) / TILE_WIDTH;
+		int tileMinX = (tile % tilesX) * TILE_WIDTH;
+		int tileMinY = (tile / tilesX) * TILE_HEIGHT;
+		int tileMaxX = std::min(tileMinX + TILE_WIDTH, m_width) - 1;
+		int tileMaxY = std::min(tileMinY + TILE_HEIGHT, m_height) - 1;
+		float* depth = m_levels[0].data();
+		const Float4 zero = Float4Set1(0.0f);
+		const Float4 laneOffsets = Float4Set(0.5f, 1.5f, 2.5f, 3.5f);
+
+		for (size_t o = 0; o < m_numOccluders; o++) {
+			const Occluder& occluder = m_occluders[o];
+			if (occluder.maxX < tileMinX || occluder.minX > tileMaxX || occluder.maxY < tileMinY || occluder.minY > tileMaxY) {
+				continue;
+			}
+			for (const Triangle& tri : occluder.triangles) {
+				int minX = std::max(tri.minX, tileMinX) & ~3;
+				int maxX = std::min(tri.maxX, tileMaxX);
+				int minY = std::max(tri.minY, tileMinY);
+				int maxY = std::min(tri.maxY, tileMaxY);
+				if (minX > maxX || minY > maxY) {
+					continue;
+				}
+				Float4 edgeA[3], edgeB[3], edgeC[3], topLeft[3];
+				for (int i = 0; i < 3; i++) {
+					edgeA[i] = Float4Set1(tri.edgeA[i]);
+					edgeB[i] = Float4Set1(tri.edgeB[i]);
+					edgeC[i] = Float4Set1(tri.edgeC[i]);
+					//All bits set for top-left edges, which also own pixels exactly on the edge
+					topLeft[i] = tri.topLeft[i] ? CmpGe(zero, zero) : zero;
+				}
+				Float4 dzdx = Float4Set1(tri.dzdx);
+				for (int y = minY; y <= maxY; y++) {
+					Float4 py = Float4Set1(y + 0.5f);
+					//Row constant parts of the edge and depth equations
+					Float4 rowEdge[3];
+					for (int i = 0; i < 3; i++) {
+						rowEdge[i] = edgeB[i] * py + edgeC[i];
+					}
+					Float4 rowDepth = Float4Set1(tri.dzdy * (y + 0.5f) + tri.z0);
+					float* row = &depth[(size_t)y * m_width];
+					for (int x = minX; x <= maxX; x += 4) {
+						Float4 px = Float4Set1((float)x) + laneOffsets;
+						Float4 inside = CmpGe(zero, zero);
+						for (int i = 0; i < 3; i++) {
+							Float4 e = edgeA[i] * px + rowEdge[i];
+							inside = inside & Select(topLeft[i], CmpGe(e, zero), CmpGt(e, zero));
+						}
+						if (MoveMask(inside) == 0) {
+							continue;
+						}
+						Float4 z = dzdx * px + rowDepth;
+						Float4 current = Float4Load(row + x);
+						Float4Store(row + x, Select(inside, Min(current, z), current));
+					}
+				}
+			}
+		}
+	}
+
+	void OcclusionBuffer::buildHierarchy()
+	{
+		for (size_t level = 1; level < m_levels.size(); level++) {
+			const std::vector<float>& src = m_levels[level - 1];
+			std::vector<float>& dst = m_levels[level];
+			int srcWidth = m_levelWidths[level - 1];
+			int srcHeight = m_levelHeights[level - 1];
+			for (int y = 0; y < m_levelHeights[level]; y++) {
+				int y0 = y * 2;
+				int y1 = std::min(y0 + 1, srcHeight - 1);
+				for (int x = 0; x < m_levelWidths[level]; x++) {
+					int x0 = x * 2;
+					int x1 = std::min(x0 + 1, srcWidth - 1);
+					float farthest = std::max(std::max(src[y0 * srcWidth + x0], src[y0 * srcWidth + x1]),
+						std::max(src[y1 * srcWidth + x0], src[y1 * srcWidth + x1]));
+					dst[y * m_levelWidths[level] + x] = farthest;
+				}
+			}
+		}
+	}
+
+	bool OcclusionBuffer::isVisible(const AABB& worldBounds)
+	{
+		m_stats.objectsTested++;
+		float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX, minZ = FLT_MAX;
+		for (int i = 0; i < 8; i++) {
+			ew::Vec3 corner = ew::Vec3(
+				(i & 1) ? worldBounds.max.x : worldBounds.min.x,
+				(i & 2) ? worldBounds.max.y : worldBounds.min.y,
+				(i & 4) ? worldBounds.max.z : worldBounds.min.z);
+			ew::Vec4 clip = m_viewProjection * ew::Vec4(corner, 1.0f);
+			//Crossing the near plane, the camera may be inside the box
+			if (clip.w <= 0.0f || clip.z < -clip.w) {
+				return true;
+			}
+			float invW = 1.0f / clip.w;
+			float x = (clip.x * invW * 0.5f + 0.5f) * m_width;
+			float y = (0.5f - clip.y * invW * 0.5f) * m_height;
+			minX = std::min(minX, x);
+			maxX = std::max(maxX, x);
+			minY = std::min(minY, y);
+			maxY = std::max(maxY, y);
+			minZ = std::min(minZ, clip.z * invW * 0.5f + 0.5f);
+		}
+		//Off screen bounds are left to frustum culling
+		if (maxX < 0.0f || maxY < 0.0f || minX > (float)m_width || minY > (float)m_height) {
+			return true;
+		}
+		int x0 = (int)floorf(std::max(minX, 0.0f));
+		int x1 = std::min((int)floorf(std::min(maxX, (float)m_width)), m_width - 1);
+		int y0 = (int)floorf(std::max(minY, 0.0f));
+		int y1 = std::min((int)floorf(std::min(maxY, (float)m_height)), m_height - 1);
+
+		//Pick the finest level where the rectangle covers at most 4x4 texels
+		size_t level = 0;
+		while (level + 1 < m_levels.size() && ((x1 >> level) - (x0 >> level) > 3 || (y1 >> level) - (y0 >> level) > 3)) {
+			level++;
+		}
+		const std::vector<float>& depth = m_levels[level];
+		int levelWidth = m_levelWidths[level];
+		for (int y = y0 >> level; y <= (y1 >> level); y++) {
+			for (int x = x0 >> level; x <= (x1 >> level); x++) {
+				if (minZ <= depth[y * levelWidth + x]) {
+					return true;
+				}
+			}
+		}
+		m_stats.objectsOccluded++;
+		return false;
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <vector>
+#include "ewMath/ewMath.h"
+#include "mesh.h"
+#include "bounds.h"
+#include "jobSystem.h"
+
+namespace ew {
+	struct OcclusionStats {
+		int occluderTriangles = 0;
+		int trianglesRasterized = 0; //After back face, near plane and off screen rejection
+		int objectsTested = 0;
+		int objectsOccluded = 0;
+		float setupMs = 0; //Vertex transform and triangle setup
+		float rasterMs = 0; //Depth rasterization and hierarchy build
+	};
+
+	/// <summary>
+	/// Low resolution depth-only software rasterizer for occlusion culling.
+	/// Occluders are rasterized 4 pixels at a time in screen tiles on a JobSystem, then reduced into a
+	/// hierarchical depth buffer (each level keeps the farthest depth of 4 texels) that bounds are tested against.
+	/// Tests are conservative: anything partially visible or crossing the near plane is reported visible.
+	/// </summary>
+	class OcclusionBuffer {
+	public:
+		static const int TILE_WIDTH = 32;
+		static const int TILE_HEIGHT = 16;
+
+		//Width is rounded up to a multiple of 4
+		OcclusionBuffer(int width = 256, int height = 128, JobSystem* jobSystem = nullptr);
+		void resize(int width, int height);
+		void setJobSystem(JobSystem* jobSystem) { m_jobSystem = jobSystem; }
+
+		void begin(const ew::Mat4& viewProjection);
+		//meshData must stay alive until end()
+		void addOccluder(const MeshData& meshData, const ew::Mat4& model);
+		//Rasterizes all occluders and builds the depth hierarchy
+		void end();
+
+		//Tests world space bounds against the depth from the last end()
+		bool isVisible(const AABB& worldBounds);
+
+		inline int getWidth()const { return m_width; }
+		inline int getHeight()const { return m_height; }
+		//Full resolution depth, 0 = near plane, 1 = far plane or empty. Rows start at the top.
+		inline const std::vector<float>& getDepth()const { return m_levels[0]; }
+		inline const OcclusionStats& getStats()const { return m_stats; }
+	private:
+		struct Triangle {
+			float edgeA[3], edgeB[3], edgeC[3]; //Edge functions, positive inside
+			bool topLeft[3];
+			float z0, dzdx, dzdy; //Depth plane
+			int minX, minY, maxX, maxY;
+		};
+		struct Occluder {
+			const MeshData* meshData;
+			ew::Mat4 model;
+			std::vector<float> vertices; //Screen x, y, depth and clip w per vertex
+			std::vector<Triangle> triangles;
+			int minX, minY, maxX, maxY; //Screen bounds of every triangle
+		};
+		void setupOccluder(Occluder& occluder);
+		void rasterizeTile(int tile);
+		void buildHierarchy();
+
+		JobSystem* m_jobSystem;
+		int m_width = 0;
+		int m_height = 0;
+		ew::Mat4 m_viewProjection;
+		std::vector<Occluder> m_occluders;
+		size_t m_numOccluders = 0; //m_occluders is never shrunk, to keep triangle allocations
+		std::vector<std::vector<float>> m_levels; //Depth hierarchy, level 0 is full resolution
+		std::vector<int> m_levelWidths;
+		std::vector<int> m_levelHeights;
+		OcclusionStats m_stats;
+	};
+}
@@ -0,0 +1,174 @@
+#include "programCache.h"
+#include "shader.h"
+#include "hash.h"
+#include "external/glad.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <chrono>
+#include <filesystem>
+
+namespace ew {
+	static const char PROGRAM_BINARY_MAGIC[4] = { 'E', 'W', 'P', 'B' };
+	static const uint32_t PROGRAM_BINARY_VERSION = 1;
+
+	//File layout: this header, then binarySize bytes from glGetProgramBinary
+	struct ProgramBinaryHeader {
+		char magic[4];
+		uint32_t version;
+		uint64_t key;
+		uint32_t binaryFormat;
+		uint32_t binarySize;
+	};
+
+	ProgramCache::ProgramCache(const std::string& directory)
+		: m_directory(directory)
+	{
+	}
+
+	bool ProgramCache::isSupported()
+	{
+		if (m_supported < 0) {
+			int numFormats = 0;
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+			m_supported = numFormats > 0;
+		}
+		return m_supported == 1;
+	}
+
+	uint64_t ProgramCache::getDriverHash()
+	{
+		if (m_driverHash == 0) {
+			uint64_t hash = HASH_SEED;
+			const GLenum NAMES[3] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+			for (GLenum name : NAMES) {
+				const char* value = (const char*)glGetString(name);
+				//Include the terminator, so "ab" + "c" and "a" + "bc" differ
+				hash = value ? HashBytes(value, strlen(value) + 1, hash) : HashBytes("", 1, hash);
+			}
+			m_driverHash = hash;
+		}
+		return m_driverHash;
+	}
+
+	uint64_t ProgramCache::getKey(const char* vertexSource, const char* fragmentSource)
+	{
+		uint64_t driverHash = getDriverHash();
+		uint64_t hash = HashBytes(&driverHash, sizeof(driverHash));
+		hash = HashBytes(vertexSource, strlen(vertexSource) + 1, hash);
+		return HashBytes(fragmentSource, strlen(fragmentSource) + 1, hash);
+	}
+
+	std::string ProgramCache::getProgramPath(const char* vertexSource, const char* fragmentSource)
+	{
+		char name[32];
+		snprintf(name, sizeof(name), "%016llx.glprog", (unsigned long long)getKey(vertexSource, fragmentSource));
+		return m_directory + "/" + name;
+	}
+
+	unsigned int ProgramCache::getProgram(const char* vertexSource, const char* fragmentSource)
+	{
+		if (!isSupported()) {
+			return createShaderProgram(vertexSource, fragmentSource);
+		}
+		unsigned int program = findProgram(vertexSource, fragmentSource);
+		if (program) {
+			return program;
+		}
+		auto start = std::chrono::high_resolution_clock::now();
+		program = createShaderProgram(vertexSource, fragmentSource, true);
+		storeProgram(vertexSource, fragmentSource, program);
+		m_stats.compileMs += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		return program;
+	}
+
+	unsigned int ProgramCache::findProgram(const char* vertexSource, const char* fragmentSource)
+	{
+		if (!isSupported()) {
+			return 0;
+		}
+		auto start = std::chrono::high_resolution_clock::now();
+		unsigned int program = loadProgram(getProgramPath(vertexSource, fragmentSource), getKey(vertexSource, fragmentSource));
+		m_stats.loadMs += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		if (program) {
+			m_stats.hits++;
+		}
+		return program;
+	}
+
+	void ProgramCache::storeProgram(const char* vertexSource, const char* fragmentSource, unsigned int program)
+	{
+		int linked = 0;
+		glGetProgramiv(program, GL_LINK_STATUS, &linked);
+		if (!isSupported() || !linked) {
+			return;
+		}
+		saveProgram(getProgramPath(vertexSource, fragmentSource), getKey(vertexSource, fragmentSource), program);
+	}
+
+	/// <summary>
+	/// Creates a program from a saved binary. Counts a miss if there is no usable file, or a rejection if the driver refuses it.
+	/// </summary>
+	/// <returns>0 on failure</returns>
+	unsigned int ProgramCache::loadProgram(const std::string& path, uint64_t key)
+	{
+		FILE* file = fopen(path.c_str(), "rb");
+		if (file == NULL) {
+			m_stats.misses++;
+			return 0;
+		}
+		ProgramBinaryHeader header;
+		std::vector<unsigned char> binary;
+		bool valid = fread(&header, sizeof(header), 1, file) == 1 && memcmp(header.magic, PROGRAM_BINARY_MAGIC, 4) == 0
+			&& header.version == PROGRAM_BINARY_VERSION && header.key == key;
+		if (valid) {
+			binary.resize(header.binarySize);
+			valid = fread(binary.data(), 1, binary.size(), file) == binary.size();
+		}
+		fclose(file);
+		if (!valid) {
+			m_stats.misses++;
+			return 0;
+		}
+
+		unsigned int program = glCreateProgram();
+		glProgramBinary(program, header.binaryFormat, binary.data(), (int)binary.size());
+		int linked = 0;
+		glGetProgramiv(program, GL_LINK_STATUS, &linked);
+		if (!linked) {
+			glDeleteProgram(program);
+			m_stats.rejected++;
+			return 0;
+		}
+		return program;
+	}
+
+	void ProgramCache::saveProgram(const std::string& path, uint64_t key, unsigned int program)
+	{
+		int size = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+		if (size <= 0) {
+			return;
+		}
+		std::vector<unsigned char> binary(size);
+		GLenum format = 0;
+		glGetProgramBinary(program, size, &size, &format, binary.data());
+
+		std::error_code error;
+		std::filesystem::create_directories(m_directory, error);
+		FILE* file = fopen(path.c_str(), "wb");
+		if (file == NULL) {
+			printf("Failed to write program binary %s\n", path.c_str());
+			return;
+		}
+		ProgramBinaryHeader header;
+		memcpy(header.magic, PROGRAM_BINARY_MAGIC, 4);
+		header.version = PROGRAM_BINARY_VERSION;
+		header.key = key;
+		header.binaryFormat = format;
+		header.binarySize = (uint32_t)size;
+		fwrite(&header, sizeof(header), 1, file);
+		fwrite(binary.data(), 1, size, file);
+		fclose(file);
+	}
+}
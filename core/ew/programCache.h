@@ -0,0 +1,48 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+
+namespace ew {
+	struct ProgramCacheStats {
+		int hits = 0; //Programs loaded from a binary
+		int misses = 0; //No binary for the sources and driver yet
+		int rejected = 0; //Binaries the driver refused, e.g. after an update it doesn't report in its version string
+		float loadMs = 0; //Reading and loading binaries
+		float compileMs = 0; //Compiling, linking and saving programs that missed
+	};
+
+	/// <summary>
+	/// Saves linked programs with glGetProgramBinary and loads them with glProgramBinary on later runs, skipping compilation.
+	/// Files are named by a hash of every stage's source and the driver's vendor, renderer and version,
+	/// so editing a shader or updating the driver compiles again. Binaries the driver rejects are recompiled and replaced.
+	/// All calls must be on the thread with the GL context.
+	/// </summary>
+	class ProgramCache {
+	public:
+		ProgramCache(const std::string& directory = "shadercache");
+
+		//createShaderProgram through the cache. Programs that fail to link are returned but never saved.
+		unsigned int getProgram(const char* vertexSource, const char* fragmentSource);
+		//The saved program for these sources, or 0 if there is none or the driver rejects it. For callers that compile misses themselves.
+		unsigned int findProgram(const char* vertexSource, const char* fragmentSource);
+		//Saves a linked program built from these sources with the retrievable hint
+		void storeProgram(const char* vertexSource, const char* fragmentSource, unsigned int program);
+		//False if the driver has no binary formats, in which case every program is compiled
+		bool isSupported();
+		//Hash of GL_VENDOR, GL_RENDERER and GL_VERSION
+		uint64_t getDriverHash();
+		std::string getProgramPath(const char* vertexSource, const char* fragmentSource);
+
+		inline const std::string& getDirectory()const { return m_directory; }
+		inline const ProgramCacheStats& getStats()const { return m_stats; }
+	private:
+		uint64_t getKey(const char* vertexSource, const char* fragmentSource);
+		unsigned int loadProgram(const std::string& path, uint64_t key);
+		void saveProgram(const std::string& path, uint64_t key, unsigned int program);
+
+		std::string m_directory;
+		uint64_t m_driverHash = 0; //0 until queried
+		int m_supported = -1; //-1 until queried
+		ProgramCacheStats m_stats;
+	};
+}
@@ -0,0 +1,358 @@
+#include "rasterizer.h"
+#include <math.h>
+#include <chrono>
+#include <algorithm>
+
+namespace ew {
+	static double nowMs() {
+		return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+	}
+
+	Framebuffer::Framebuffer(int width, int height)
+	{
+		resize(width, height);
+	}
+
+	void Framebuffer::resize(int width, int height)
+	{
+		this->width = width;
+		this->height = height;
+		color.resize((size_t)width * height * 4);
+		depth.resize((size_t)width * height);
+	}
+
+	void Framebuffer::clear(const ew::Vec3& clearColor, float clearDepth)
+	{
+		unsigned char rgba[4] = {
+			(unsigned char)(ew::Clamp(clearColor.x, 0.0f, 1.0f) * 255.0f + 0.5f),
+			(unsigned char)(ew::Clamp(clearColor.y, 0.0f, 1.0f) * 255.0f + 0.5f),
+			(unsigned char)(ew::Clamp(clearColor.z, 0.0f, 1.0f) * 255.0f + 0.5f),
+			255
+		};
+		for (size_t i = 0; i < depth.size(); i++) {
+			color[i * 4 + 0] = rgba[0];
+			color[i * 4 + 1] = rgba[1];
+			color[i * 4 + 2] = rgba[2];
+			color[i * 4 + 3] = rgba[3];
+			depth[i] = clearDepth;
+		}
+	}
+
+	bool Framebuffer::save(const char* filePath) const
+	{
+		return saveImagePPM(filePath, width, height, color.data());
+	}
+
+	Rasterizer::Rasterizer(JobSystem* jobSystem)
+		:m_jobSystem(jobSystem)
+	{
+	}
+
+	void Rasterizer::begin(Framebuffer* framebuffer, const ew::Mat4& viewProjection)
+	{
+		m_framebuffer = framebuffer;
+		m_viewProjection = viewProjection;
+		m_tilesX = (framebuffer->width + TILE_SIZE - 1) / TILE_SIZE;
+		m_tilesY = (framebuffer->height + TILE_SIZE - 1) / TILE_SIZE;
+		//Keep bin allocations between frames
+		m_bins.resize(m_tilesX * m_tilesY);
+		for (std::vector<unsigned int>& bin : m_bins) {
+			bin.clear();
+		}
+		m_triangles.clear();
+		m_shaders.clear();
+		m_stats = RasterStats();
+	}
+
+	void Rasterizer::draw(const MeshData& meshData, const ew::Mat4& model, const FragmentShader& shader)
+	{
+		double start = nowMs();
+		unsigned int shaderIndex = (unsigned int)m_shaders.size();
+		m_shaders.push_back(shader);
+
+		//Vertex shader, same as defaultLit.vert
+		ew::Mat4 mvp = m_viewProjection * model;
+		m_vertices.resize(meshData.vertices.size());
+		const int BATCH_SIZE = 1024;
+		int numBatches = (int)((meshData.vertices.size() + BATCH_SIZE - 1) / BATCH_SIZE);
+		auto transformBatch = [&](int batch) {
+			size_t end = std::min((size_t)(batch + 1) * BATCH_SIZE, meshData.vertices.size());
+			for (size_t i = (size_t)batch * BATCH_SIZE; i < end; i++) {
+				const Vertex& v = meshData.vertices[i];
+				ew::Vec4 clip = mvp * ew::Vec4(v.pos, 1.0f);
+				ClipVertex& out = m_vertices[i];
+				out.position[0] = clip.x;
+				out.position[1] = clip.y;
+				out.position[2] = clip.z;
+				out.position[3] = clip.w;
+				out.worldPosition = (model * ew::Vec4(v.pos, 1.0f)).toVec3();
+				out.worldNormal = (model * ew::Vec4(v.normal, 0.0f)).toVec3();
+				out.uv = v.uv;
+			}
+		};
+		if (m_jobSystem) {
+			m_jobSystem->parallelFor(numBatches, transformBatch);
+		}
+		else {
+			for (int i = 0; i < numBatches; i++) {
+				transformBatch(i);
+			}
+		}
+
+		//Clip against the near plane (z >= -w), which can turn a triangle into a quad
+		size_t numTriangles = meshData.indices.size() / 3;
+		m_stats.trianglesSubmitted += (int)numTriangles;
+		for (size_t t = 0; t < numTriangles; t++) {
+			const ClipVertex* in[3] = {
+				&m_vertices[meshData.indices[t * 3 + 0]],
+				&m_vertices[meshData.indices[t * 3 + 1]],
+				&m_vertices[meshData.indices[t * 3 + 2]]
+			};
+			float d[3];
+			int numInside = 0;
+			for (int i = 0; i < 3; i++) {
+				d[i] = in[i]->position[2] + in[i]->position[3];
+				numInside += d[i] >= 0.0f;
+			}
+			if (numInside == 3) {
+				setupTriangle(*in[0], *in[1], *in[2], shaderIndex);
+				continue;
+			}
+			if (numInside == 0) {
+				m_stats.trianglesCulled++;
+				continue;
+			}
+			ClipVertex clipped[4];
+			int numClipped = 0;
+			for (int i = 0; i < 3; i++) {
+				int j = (i + 1) % 3;
+				if (d[i] >= 0.0f) {
+					clipped[numClipped++] = *in[i];
+				}
+				if ((d[i] >= 0.0f) != (d[j] >= 0.0f)) {
+					float s = d[i] / (d[i] - d[j]);
+					ClipVertex& v = clipped[numClipped++];
+					for (int k = 0; k < 4; k++) {
+						v.position[k] = in[i]->position[k] + (in[j]->position[k] - in[i]->position[k]) * s;
+					}
+					v.worldPosition = in[i]->worldPosition + (in[j]->worldPosition - in[i]->worldPosition) * s;
+					v.worldNormal = in[i]->worldNormal + (in[j]->worldNormal - in[i]->worldNormal) * s;
+					v.uv = in[i]->uv + (in[j]->uv - in[i]->uv) * s;
+				}
+			}
+			for (int i = 1; i + 1 < numClipped; i++) {
+				setupTriangle(clipped[0], clipped[i], clipped[i + 1], shaderIndex);
+			}
+		}
+		m_stats.setupMs += (float)(nowMs() - start);
+	}
+
+	void Rasterizer::setupTriangle(const ClipVertex& a, const ClipVertex& b, const ClipVertex& c, unsigned int shader)
+	{
+		const ClipVertex* v[3] = { &a, &b, &c };
+		Triangle tri;
+		float width = (float)m_framebuffer->width;
+		float height = (float)m_framebuffer->height;
+		for (int i = 0; i < 3; i++) {
+			float invW = 1.0f / v[i]->position[3];
+			//Viewport transform, Y flipped so row 0 is the top of the image
+			tri.x[i] = (v[i]->position[0] * invW * 0.5f + 0.5f) * width;
+			tri.y[i] = (0.5f - v[i]->position[1] * invW * 0.5f) * height;
+			tri.z[i] = v[i]->position[2] * invW * 0.5f + 0.5f;
+			tri.invW[i] = invW;
+			tri.worldPosition[i] = v[i]->worldPosition * invW;
+			tri.worldNormal[i] = v[i]->worldNormal * invW;
+			tri.uv[i] = v[i]->uv * invW;
+		}
+
+		//Counter clockwise in NDC is clockwise once Y is flipped, which gives a negative area here
+		float area = (tri.x[1] - tri.x[0]) * (tri.y[2] - tri.y[0]) - (tri.y[1] - tri.y[0]) * (tri.x[2] - tri.x[0]);
+		if (area >= 0.0f) {
+			m_stats.trianglesCulled++;
+			return;
+		}
+		//Swap to positive winding so edge functions are positive inside
+		std::swap(tri.x[1], tri.x[2]);
+		std::swap(tri.y[1], tri.y[2]);
+		std::swap(tri.z[1], tri.z[2]);
+		std::swap(tri.invW[1], tri.invW[2]);
+		std::swap(tri.worldPosition[1], tri.worldPosition[2]);
+		std::swap(tri.worldNormal[1], tri.worldNormal[2]);
+		std::swap(tri.uv[1], tri.uv[2]);
+
+		//Pixel centers are at +0.5. Clamp before converting, since vertices close to the near plane can be far off screen.
+		float minX = ew::Clamp(std::min(tri.x[0], std::min(tri.x[1], tri.x[2])), 0.0f, width);
+		float maxX = ew::Clamp(std::max(tri.x[0], std::max(tri.x[1], tri.x[2])), 0.0f, width);
+		float minY = ew::Clamp(std::min(tri.y[0], std::min(tri.y[1], tri.y[2])), 0.0f, height);
+		float maxY = ew::Clamp(std::max(tri.y[0], std::max(tri.y[1], tri.y[2])), 0.0f, height);
+		tri.minX = (int)ceilf(minX - 0.5f);
+		tri.maxX = std::min((int)floorf(maxX - 0.5f), m_framebuffer->width - 1);
+		tri.minY = (int)ceilf(minY - 0.5f);
+		tri.maxY = std::min((int)floorf(maxY - 0.5f), m_framebuffer->height - 1);
+		if (tri.minX > tri.maxX || tri.minY > tri.maxY) {
+			m_stats.trianglesCulled++;
+			return;
+		}
+		tri.shader = shader;
+
+		unsigned int index = (unsigned int)m_triangles.size();
+		m_triangles.push_back(tri);
+		m_stats.trianglesRasterized++;
+		for (int ty = tri.minY / TILE_SIZE; ty <= tri.maxY / TILE_SIZE; ty++) {
+			for (int tx = tri.minX / TILE_SIZE; tx <= tri.maxX / TILE_SIZE; tx++) {
+				m_bins[ty * m_tilesX + tx].push_back(index);
+			}
+		}
+	}
+
+	void Rasterizer::end()
+	{
+		double start = nowMs();
+		int numTiles = m_tilesX * m_tilesY;
+		std::vector<int> tileFragments(numTiles, 0);
+		auto rasterize = [&](int tile) {
+			tileFragments[tile] = rasterizeTile(tile);
+		};
+		if (m_jobSystem) {
+			m_jobSystem->parallelFor(numTiles, rasterize);
+		}
+		else {
+			for (int i = 0; i < numTiles; i++) {
+				rasterize(i);
+			}
+		}
+		for (int i = 0; i < numTiles; i++) {
+			m_stats.fragmentsShaded += tileFragments[i];
+			m_stats.tilesTouched += !m_bins[i].empty();
+		}
+		m_stats.rasterMs = (float)(nowMs() - start);
+		m_framebuffer = nullptr;
+	}
+
+	/// <summary>
+	/// Rasterizes every triangle binned to a tile, in submission order. Tiles never overlap, so no locking is needed.
+	/// </summary>
+	/// <returns>Number of fragments that passed the depth test</returns>
+	int Rasterizer::rasterizeTile(int tile)
+	{
+		const std::vector<unsigned int>& bin = m_bins[tile];
+		if (bin.empty()) {
+			return 0;
+		}
+		int tileMinX = (tile % m_tilesX) * TILE_SIZE;
+		int tileMinY = (tile / m_tilesX) * TILE_SIZE;
+		int tileMaxX = std::min(tileMinX + TILE_SIZE, m_framebuffer->width) - 1;
+		int tileMaxY = std::min(tileMinY + TILE_SIZE, m_framebuffer->height) - 1;
+		int width = m_framebuffer->width;
+		float* depthBuffer = m_framebuffer->depth.data();
+		unsigned char* colorBuffer = m_framebuffer->color.data();
+		int numFragments = 0;
+
+		for (unsigned int index : bin) {
+			const Triangle& tri = m_triangles[index];
+			int minX = std::max(tri.minX, tileMinX);
+			int maxX = std::min(tri.maxX, tileMaxX);
+			int minY = std::max(tri.minY, tileMinY);
+			int maxY = std::min(tri.maxY, tileMaxY);
+			if (minX > maxX || minY > maxY) {
+				continue;
+			}
+
+			//Edge i is opposite vertex i: e(p) = (b - a) x (p - a)
+			float edgeA[3], edgeB[3], edgeC[3];
+			bool topLeft[3];
+			for (int i = 0; i < 3; i++) {
+				int a = (i + 1) % 3;
+				int b = (i + 2) % 3;
+				float dx = tri.x[b] - tri.x[a];
+				float dy = tri.y[b] - tri.y[a];
+				edgeA[i] = -dy;
+				edgeB[i] = dx;
+				edgeC[i] = dy * tri.x[a] - dx * tri.y[a];
+				//With Y down and positive winding, top edges run +X and left edges run -Y
+				topLeft[i] = (dy == 0.0f && dx > 0.0f) || dy < 0.0f;
+			}
+			float invArea = 1.0f / (edgeC[0] + edgeA[0] * tri.x[0] + edgeB[0] * tri.y[0]);
+			const FragmentShader& shader = m_shaders[tri.shader];
+
+			for (int y = minY; y <= maxY; y++) {
+				float py = y + 0.5f;
+				float px = minX + 0.5f;
+				float e[3];
+				for (int i = 0; i < 3; i++) {
+					e[i] = edgeA[i] * px + edgeB[i] * py + edgeC[i];
+				}
+				for (int x = minX; x <= maxX; x++, e[0] += edgeA[0], e[1] += edgeA[1], e[2] += edgeA[2]) {
+					bool inside = true;
+					for (int i = 0; i < 3; i++) {
+						inside &= e[i] > 0.0f || (e[i] == 0.0f && topLeft[i]);
+					}
+					if (!inside) {
+						continue;
+					}
+					float b0 = e[0] * invArea;
+					float b1 = e[1] * invArea;
+					float b2 = e[2] * invArea;
+					//Depth is affine in screen space
+					float z = b0 * tri.z[0] + b1 * tri.z[1] + b2 * tri.z[2];
+					size_t pixel = (size_t)y * width + x;
+					if (z > 1.0f || z >= depthBuffer[pixel]) {
+						continue;
+					}
+
+					float w = 1.0f / (b0 * tri.invW[0] + b1 * tri.invW[1] + b2 * tri.invW[2]);
+					Fragment fragment;
+					fragment.worldPosition = (tri.worldPosition[0] * b0 + tri.worldPosition[1] * b1 + tri.worldPosition[2] * b2) * w;
+					fragment.worldNormal = (tri.worldNormal[0] * b0 + tri.worldNormal[1] * b1 + tri.worldNormal[2] * b2) * w;
+					fragment.uv = (tri.uv[0] * b0 + tri.uv[1] * b1 + tri.uv[2] * b2) * w;
+					fragment.x = x;
+					fragment.y = y;
+					ew::Vec4 color = shader(fragment);
+
+					depthBuffer[pixel] = z;
+					unsigned char* out = &colorBuffer[pixel * 4];
+					out[0] = (unsigned char)(ew::Clamp(color.x, 0.0f, 1.0f) * 255.0f + 0.5f);
+					out[1] = (unsigned char)(ew::Clamp(color.y, 0.0f, 1.0f) * 255.0f + 0.5f);
+					out[2] = (unsigned char)(ew::Clamp(color.z, 0.0f, 1.0f) * 255.0f + 0.5f);
+					out[3] = (unsigned char)(ew::Clamp(color.w, 0.0f, 1.0f) * 255.0f + 0.5f);
+					numFragments++;
+				}
+			}
+		}
+		return numFragments;
+	}
+
+	ew::Vec4 ShadeLit(const Fragment& fragment, const LitSettings& settings)
+	{
+		ew::Vec3 normal = ew::Normalize(fragment.worldNormal);
+		ew::Vec3 cameraDir = ew::Normalize(settings.cameraPosition - fragment.worldPosition);
+		ew::Vec3 lightColor = ew::Vec3(0);
+
+		for (int i = 0; i < settings.numLights; i++) {
+			const PointLight& light = settings.lights[i];
+			ew::Vec3 lightDir = ew::Normalize(light.position - fragment.worldPosition);
+
+			float diffAngle = std::max(ew::Dot(normal, lightDir), 0.0f);
+			ew::Vec3 diffuse = light.color * settings.diffuseK * diffAngle;
+
+			float specAngle;
+			if (!settings.phong) {
+				//Blinn-Phong
+				ew::Vec3 halfVec = ew::Normalize(lightDir + cameraDir);
+				specAngle = std::max(ew::Dot(halfVec, normal), 0.0f);
+			}
+			else {
+				//Phong, reflect(-lightDir, normal)
+				ew::Vec3 r = -lightDir + normal * (2.0f * ew::Dot(normal, lightDir));
+				specAngle = std::max(ew::Dot(r, cameraDir), 0.0f);
+			}
+			ew::Vec3 specular = light.color * settings.specularK * powf(specAngle, settings.shininess);
+
+			lightColor += (diffuse + specular) * 0.5f;
+		}
+		lightColor += ew::Vec3(settings.ambientK);
+
+		ew::Vec4 texColor = settings.texture ? SampleImage(*settings.texture, fragment.uv) : ew::Vec4(1.0f);
+		return ew::Vec4(texColor.x * lightColor.x, texColor.y * lightColor.y, texColor.z * lightColor.z, texColor.w);
+	}
+}
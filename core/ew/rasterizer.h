@@ -0,0 +1,117 @@
+#pragma once
+#include <vector>
+#include <functional>
+#include "ewMath/ewMath.h"
+#include "mesh.h"
+#include "image.h"
+#include "jobSystem.h"
+
+namespace ew {
+	//CPU render target. Rows start at the top of the image.
+	struct Framebuffer {
+		int width = 0;
+		int height = 0;
+		std::vector<unsigned char> color; //RGBA8
+		std::vector<float> depth; //0 = near plane, 1 = far plane
+
+		Framebuffer() {}
+		Framebuffer(int width, int height);
+		void resize(int width, int height);
+		void clear(const ew::Vec3& clearColor, float clearDepth = 1.0f);
+		//Writes the color buffer as a PPM
+		bool save(const char* filePath)const;
+	};
+
+	//Interpolated inputs to a fragment shader, matching the Surface block in defaultLit.vert
+	struct Fragment {
+		ew::Vec3 worldPosition;
+		ew::Vec3 worldNormal; //Not normalized
+		ew::Vec2 uv;
+		int x, y; //Pixel
+	};
+
+	//Returns RGBA in 0-1 range. Called from worker threads, so it must not write shared state.
+	typedef std::function<ew::Vec4(const Fragment& fragment)> FragmentShader;
+
+	struct RasterStats {
+		int trianglesSubmitted = 0;
+		int trianglesCulled = 0; //Back facing, clipped away or too small to cover a pixel
+		int trianglesRasterized = 0;
+		int fragmentsShaded = 0;
+		int tilesTouched = 0;
+		float setupMs = 0; //Vertex transform, clipping and binning
+		float rasterMs = 0;
+	};
+
+	/// <summary>
+	/// Tiled software rasterizer. Draws are transformed and binned into screen tiles as they are submitted,
+	/// then tiles are rasterized in parallel in end(). Follows GL conventions: counter clockwise front faces,
+	/// back face culling, near plane clipping, depth test LESS, and top-left fill rule.
+	/// </summary>
+	class Rasterizer {
+	public:
+		static const int TILE_SIZE = 64;
+
+		//Without a job system, everything runs on the calling thread
+		Rasterizer(JobSystem* jobSystem = nullptr);
+		void setJobSystem(JobSystem* jobSystem) { m_jobSystem = jobSystem; }
+
+		void begin(Framebuffer* framebuffer, const ew::Mat4& viewProjection);
+		void draw(const MeshData& meshData, const ew::Mat4& model, const FragmentShader& shader);
+		//Rasterizes everything drawn since begin()
+		void end();
+
+		inline const RasterStats& getStats()const { return m_stats; }
+	private:
+		struct Triangle {
+			float x[3], y[3], z[3]; //Screen space
+			float invW[3];
+			//Attributes divided by w, for perspective correct interpolation
+			ew::Vec3 worldPosition[3];
+			ew::Vec3 worldNormal[3];
+			ew::Vec2 uv[3];
+			int minX, minY, maxX, maxY; //Pixels covered by the bounding box
+			unsigned int shader;
+		};
+		struct ClipVertex {
+			float position[4];
+			ew::Vec3 worldPosition;
+			ew::Vec3 worldNormal;
+			ew::Vec2 uv;
+		};
+		void setupTriangle(const ClipVertex& a, const ClipVertex& b, const ClipVertex& c, unsigned int shader);
+		int rasterizeTile(int tile);
+
+		JobSystem* m_jobSystem;
+		Framebuffer* m_framebuffer = nullptr;
+		ew::Mat4 m_viewProjection;
+		int m_tilesX = 0;
+		int m_tilesY = 0;
+		std::vector<FragmentShader> m_shaders;
+		std::vector<Triangle> m_triangles;
+		std::vector<std::vector<unsigned int>> m_bins; //Triangle indices per tile, in draw order
+		std::vector<ClipVertex> m_vertices;
+		RasterStats m_stats;
+	};
+
+	struct PointLight {
+		ew::Vec3 position;
+		ew::Vec3 color;
+	};
+
+	//Uniforms of defaultLit.frag
+	struct LitSettings {
+		ew::Vec3 cameraPosition;
+		const PointLight* lights = nullptr;
+		int numLights = 0;
+		float ambientK = 0.1f;
+		float diffuseK = 0.5f;
+		float specularK = 1.0f;
+		float shininess = 50.0f;
+		bool phong = false; //Phong instead of Blinn-Phong specular
+		const Image* texture = nullptr; //White if null
+	};
+
+	//CPU version of defaultLit.frag
+	ew::Vec4 ShadeLit(const Fragment& fragment, const LitSettings& settings);
+}
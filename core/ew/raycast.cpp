@@ -0,0 +1,194 @@
+#include "raycast.h"
+#include "ewMath/simd.h"
+
+namespace ew {
+	MeshBVH::MeshBVH(const MeshData& meshData)
+	{
+		build(meshData);
+	}
+
+	void MeshBVH::build(const MeshData& meshData)
+	{
+		m_numTriangles = meshData.indices.size() / 3;
+		std::vector<AABB> triangleBounds(m_numTriangles);
+		m_bounds = AABB();
+		for (size_t i = 0; i < m_numTriangles; i++) {
+			for (int j = 0; j < 3; j++) {
+				triangleBounds[i].expand(meshData.vertices[meshData.indices[i * 3 + j]].pos);
+			}
+			m_bounds.expand(triangleBounds[i]);
+		}
+		m_bvh.build(triangleBounds);
+
+		//Pack each leaf's triangles into groups of 4
+		const std::vector<BVH::Node>& nodes = m_bvh.getNodes();
+		const std::vector<unsigned int>& order = m_bvh.getObjectIndices();
+		m_packs.clear();
+		m_leafPacks.assign(nodes.size(), 0);
+		for (size_t n = 0; n < nodes.size(); n++) {
+			if (nodes[n].count == 0) {
+				continue;
+			}
+			m_leafPacks[n] = (unsigned int)m_packs.size();
+			for (unsigned int i = 0; i < nodes[n].count; i += 4) {
+				//Unused lanes are left as zero size triangles, which never hit
+				Triangle4 pack = {};
+				for (unsigned int lane = 0; lane < 4 && i + lane < nodes[n].count; lane++) {
+					unsigned int triangle = order[nodes[n].first + i + lane];
+					ew::Vec3 a = meshData.vertices[meshData.indices[triangle * 3 + 0]].pos;
+					ew::Vec3 b = meshData.vertices[meshData.indices[triangle * 3 + 1]].pos;
+					ew::Vec3 c = meshData.vertices[meshData.indices[triangle * 3 + 2]].pos;
+					ew::Vec3 e1 = b - a;
+					ew::Vec3 e2 = c - a;
+					pack.v0x[lane] = a.x; pack.v0y[lane] = a.y; pack.v0z[lane] = a.z;
+					pack.e1x[lane] = e1.x; pack.e1y[lane] = e1.y; pack.e1z[lane] = e1.z;
+					pack.e2x[lane] = e2.x; pack.e2y[lane] = e2.y; pack.e2z[lane] = e2.z;
+					pack.triangle[lane] = triangle;
+				}
+				m_packs.push_back(pack);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Moller-Trumbore against 4 triangles at once. Updates closest and hit when a nearer triangle is found.
+	/// </summary>
+	static bool intersectPack(const Float4 origin[3], const Float4 dir[3], const float* v0x, const float* v0y, const float* v0z,
+		const float* e1x, const float* e1y, const float* e1z, const float* e2x, const float* e2y, const float* e2z,
+		float* closest, int* lane, float* outU, float* outV) {
+		const Float4 zero = Float4Set1(0.0f);
+		const Float4 one = Float4Set1(1.0f);
+		const Float4 epsilon = Float4Set1(1e-8f);
+		Float4 edge1[3] = { Float4Load(e1x), Float4Load(e1y), Float4Load(e1z) };
+		Float4 edge2[3] = { Float4Load(e2x), Float4Load(e2y), Float4Load(e2z) };
+
+		//p = dir x edge2
+		Float4 px = dir[1] * edge2[2] - dir[2] * edge2[1];
+		Float4 py = dir[2] * edge2[0] - dir[0] * edge2[2];
+		Float4 pz = dir[0] * edge2[1] - dir[1] * edge2[0];
+		Float4 det = edge1[0] * px + edge1[1] * py + edge1[2] * pz;
+		Float4 valid = CmpGt(Abs(det), epsilon);
+		//Avoid dividing by zero in lanes that are already rejected
+		Float4 invDet = one / Select(valid, det, one);
+
+		Float4 tx = origin[0] - Float4Load(v0x);
+		Float4 ty = origin[1] - Float4Load(v0y);
+		Float4 tz = origin[2] - Float4Load(v0z);
+		Float4 u = (tx * px + ty * py + tz * pz) * invDet;
+		valid = valid & CmpGe(u, zero) & CmpLe(u, one);
+
+		//q = t x edge1
+		Float4 qx = ty * edge1[2] - tz * edge1[1];
+		Float4 qy = tz * edge1[0] - tx * edge1[2];
+		Float4 qz = tx * edge1[1] - ty * edge1[0];
+		Float4 v = (dir[0] * qx + dir[1] * qy + dir[2] * qz) * invDet;
+		valid = valid & CmpGe(v, zero) & CmpLe(u + v, one);
+
+		Float4 t = (edge2[0] * qx + edge2[1] * qy + edge2[2] * qz) * invDet;
+		valid = valid & CmpGt(t, zero) & CmpLt(t, Float4Set1(*closest));
+
+		int mask = MoveMask(valid);
+		if (mask == 0) {
+			return false;
+		}
+		float tLanes[4], uLanes[4], vLanes[4];
+		Float4Store(tLanes, t);
+		Float4Store(uLanes, u);
+		Float4Store(vLanes, v);
+		for (int i = 0; i < 4; i++) {
+			if ((mask & (1 << i)) && tLanes[i] < *closest) {
+				*closest = tLanes[i];
+				*lane = i;
+				*outU = uLanes[i];
+				*outV = vLanes[i];
+			}
+		}
+		return true;
+	}
+
+	bool MeshBVH::raycast(const Ray& ray, float maxDistance, MeshHit* hit)const
+	{
+		const std::vector<BVH::Node>& nodes = m_bvh.getNodes();
+		if (nodes.empty()) {
+			return false;
+		}
+		ew::Vec3 invDir = InverseDirection(ray.direction);
+		Float4 origin[3] = { Float4Set1(ray.origin.x), Float4Set1(ray.origin.y), Float4Set1(ray.origin.z) };
+		Float4 dir[3] = { Float4Set1(ray.direction.x), Float4Set1(ray.direction.y), Float4Set1(ray.direction.z) };
+		float closest = maxDistance;
+		bool found = false;
+		float tEnter;
+		if (!IntersectRayAABB(ray.origin, invDir, nodes[0].bounds, closest, &tEnter)) {
+			return false;
+		}
+
+		unsigned int stack[BVH::MAX_DEPTH];
+		int stackSize = 0;
+		stack[stackSize++] = 0;
+		while (stackSize > 0) {
+			unsigned int nodeIndex = stack[--stackSize];
+			const BVH::Node& node = nodes[nodeIndex];
+			if (node.count > 0) {
+				unsigned int numPacks = (node.count + 3) / 4;
+				for (unsigned int p = 0; p < numPacks; p++) {
+					const Triangle4& pack = m_packs[m_leafPacks[nodeIndex] + p];
+					int lane = 0;
+					float u = 0, v = 0;
+					if (intersectPack(origin, dir, pack.v0x, pack.v0y, pack.v0z, pack.e1x, pack.e1y, pack.e1z,
+						pack.e2x, pack.e2y, pack.e2z, &closest, &lane, &u, &v)) {
+						hit->triangle = pack.triangle[lane];
+						hit->distance = closest;
+						hit->u = u;
+						hit->v = v;
+						found = true;
+					}
+				}
+				continue;
+			}
+			float tLeft, tRight;
+			bool hitLeft = IntersectRayAABB(ray.origin, invDir, nodes[node.first].bounds, closest, &tLeft);
+			bool hitRight = IntersectRayAABB(ray.origin, invDir, nodes[node.first + 1].bounds, closest, &tRight);
+			if (hitLeft && hitRight) {
+				bool leftFirst = tLeft <= tRight;
+				stack[stackSize++] = leftFirst ? node.first + 1 : node.first;
+				stack[stackSize++] = leftFirst ? node.first : node.first + 1;
+			}
+			else if (hitLeft) {
+				stack[stackSize++] = node.first;
+			}
+			else if (hitRight) {
+				stack[stackSize++] = node.first + 1;
+			}
+		}
+		return found;
+	}
+
+	Ray ScreenPointToRay(const ew::Camera& camera, float screenX, float screenY, float screenWidth, float screenHeight)
+	{
+		//Screen space to normalized device coordinates, Y flipped since window coordinates start at the top
+		float ndcX = (2.0f * screenX) / screenWidth - 1.0f;
+		float ndcY = 1.0f - (2.0f * screenY) / screenHeight;
+		ew::Mat4 invViewProj = ew::Inverse(camera.ProjectionMatrix() * camera.ViewMatrix());
+		ew::Vec4 nearPoint = invViewProj * ew::Vec4(ndcX, ndcY, -1.0f, 1.0f);
+		ew::Vec4 farPoint = invViewProj * ew::Vec4(ndcX, ndcY, 1.0f, 1.0f);
+		ew::Vec3 nearWorld = nearPoint.toVec3() / nearPoint.w;
+		ew::Vec3 farWorld = farPoint.toVec3() / farPoint.w;
+		Ray ray;
+		ray.origin = nearWorld;
+		ray.direction = ew::Normalize(farWorld - nearWorld);
+		return ray;
+	}
+
+	Ray TransformRay(const Ray& ray, const ew::Mat4& m)
+	{
+		Ray out;
+		out.origin = (m * ew::Vec4(ray.origin, 1.0f)).toVec3();
+		out.direction = (m * ew::Vec4(ray.direction, 0.0f)).toVec3();
+		return out;
+	}
+
+	bool RaycastMesh(const MeshBVH& mesh, const ew::Mat4& model, const Ray& ray, float maxDistance, MeshHit* hit)
+	{
+		return mesh.raycast(TransformRay(ray, ew::Inverse(model)), maxDistance, hit);
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <vector>
+#include "mesh.h"
+#include "camera.h"
+#include "bvh.h"
+
+namespace ew {
+	struct MeshHit {
+		unsigned int triangle = 0; //Index of the triangle (first index is triangle * 3)
+		float distance = 0; //Ray parameter at the hit
+		float u = 0, v = 0; //Barycentric coordinates of the hit
+	};
+
+	/// <summary>
+	/// Triangle level ray queries against MeshData.
+	/// Triangles are grouped 4 at a time in BVH leaves and intersected together with SIMD.
+	/// </summary>
+	class MeshBVH {
+	public:
+		MeshBVH() {}
+		MeshBVH(const MeshData& meshData);
+		void build(const MeshData& meshData);
+		//Ray in the mesh's local space. Both sides of triangles can be hit.
+		bool raycast(const Ray& ray, float maxDistance, MeshHit* hit)const;
+		inline size_t getNumTriangles()const { return m_numTriangles; }
+		inline const AABB& getBounds()const { return m_bounds; }
+	private:
+		//4 triangles as v0 + two edges, structure of arrays
+		struct Triangle4 {
+			float v0x[4], v0y[4], v0z[4];
+			float e1x[4], e1y[4], e1z[4];
+			float e2x[4], e2y[4], e2z[4];
+			unsigned int triangle[4];
+		};
+		BVH m_bvh;
+		std::vector<Triangle4> m_packs;
+		std::vector<unsigned int> m_leafPacks; //Per node, first pack of a leaf
+		size_t m_numTriangles = 0;
+		AABB m_bounds;
+	};
+
+	/// <summary>
+	/// Ray from the camera through a point on screen
+	/// </summary>
+	/// <param name="camera">Camera being rendered with</param>
+	/// <param name="screenX">Pixels from the left of the window</param>
+	/// <param name="screenY">Pixels from the top of the window</param>
+	/// <param name="screenWidth">Window width in pixels</param>
+	/// <param name="screenHeight">Window height in pixels</param>
+	Ray ScreenPointToRay(const ew::Camera& camera, float screenX, float screenY, float screenWidth, float screenHeight);
+
+	//Moves a world space ray into a model's local space. Direction is not renormalized, so distances match world space.
+	Ray TransformRay(const Ray& ray, const ew::Mat4& m);
+
+	//Casts a world space ray against a mesh placed with a model matrix
+	bool RaycastMesh(const MeshBVH& mesh, const ew::Mat4& model, const Ray& ray, float maxDistance, MeshHit* hit);
+}
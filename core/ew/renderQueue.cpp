@@ -0,0 +1,191 @@
+#include "renderQueue.h"
+#include "bindTracker.h"
+#include "external/glad.h"
+#include <string.h>
+#include <chrono>
+
+namespace ew {
+	//Key layout, most significant first
+	static const int PROGRAM_BITS = 12;
+	static const int MATERIAL_BITS = 16; //Texture and sampler pair
+	static const int MESH_BITS = 12;
+	static const int DEPTH_BITS = 24;
+
+	void RadixSortKeys(std::vector<RenderKey>& keys, std::vector<RenderKey>& scratch)
+	{
+		size_t count = keys.size();
+		if (count < 2) {
+			return;
+		}
+		//Every byte's histogram in one pass over the keys
+		uint32_t histograms[8][256] = {};
+		for (const RenderKey& key : keys) {
+			for (int byte = 0; byte < 8; byte++) {
+				histograms[byte][(key.key >> (byte * 8)) & 0xFF]++;
+			}
+		}
+		scratch.resize(count);
+		RenderKey* source = keys.data();
+		RenderKey* destination = scratch.data();
+		for (int byte = 0; byte < 8; byte++) {
+			uint32_t* histogram = histograms[byte];
+			//Every key has the same value here, so this pass wouldn't move anything
+			if (histogram[(source[0].key >> (byte * 8)) & 0xFF] == count) {
+				continue;
+			}
+			uint32_t offsets[256];
+			uint32_t offset = 0;
+			for (int i = 0; i < 256; i++) {
+				offsets[i] = offset;
+				offset += histogram[i];
+			}
+			for (size_t i = 0; i < count; i++) {
+				destination[offsets[(source[i].key >> (byte * 8)) & 0xFF]++] = source[i];
+			}
+			std::swap(source, destination);
+		}
+		if (source != keys.data()) {
+			memcpy(keys.data(), source, count * sizeof(RenderKey));
+		}
+	}
+
+	void RenderQueue::clear()
+	{
+		m_items.clear();
+		m_keys.clear();
+		m_programIndices.clear();
+		m_materialIndices.clear();
+		m_meshIndices.clear();
+	}
+
+	void RenderQueue::invalidatePrograms()
+	{
+		m_locations.clear();
+	}
+
+	uint64_t RenderQueue::getIndex(std::unordered_map<uint64_t, uint32_t>& indices, uint64_t name, int bits)
+	{
+		auto it = indices.find(name);
+		if (it == indices.end()) {
+			it = indices.emplace(name, (uint32_t)indices.size()).first;
+		}
+		return it->second & ((1u << bits) - 1);
+	}
+
+	void RenderQueue::submit(const Shader& shader, unsigned int texture, unsigned int sampler, unsigned int vertexArray, int numIndices,
+		size_t firstIndex, int baseVertex, const ew::Mat4& model, float depth)
+	{
+		uint64_t program = getIndex(m_programIndices, shader.getID(), PROGRAM_BITS);
+		uint64_t material = getIndex(m_materialIndices, ((uint64_t)texture << 32) | sampler, MATERIAL_BITS);
+		uint64_t meshIndex = getIndex(m_meshIndices, vertexArray, MESH_BITS);
+		//Positive floats sort the same as their bits, so the top bits make a coarse depth
+		float positiveDepth = depth > 0 ? depth : 0;
+		uint32_t depthBits;
+		memcpy(&depthBits, &positiveDepth, sizeof(depthBits));
+		RenderKey key;
+		key.key = (program << (MATERIAL_BITS + MESH_BITS + DEPTH_BITS)) | (material << (MESH_BITS + DEPTH_BITS))
+			| (meshIndex << DEPTH_BITS) | (depthBits >> (32 - DEPTH_BITS));
+		key.item = (uint32_t)m_items.size();
+		m_keys.push_back(key);
+		m_items.push_back({ shader.getID(), texture, sampler, vertexArray, numIndices, firstIndex, baseVertex, model, ew::Vec3(0), false });
+	}
+
+	void RenderQueue::submit(const Shader& shader, unsigned int texture, unsigned int sampler, const Mesh& mesh, const ew::Mat4& model, float depth)
+	{
+		submit(shader, texture, sampler, mesh.getVAO(), mesh.getNumIndices(), 0, 0, model, depth);
+	}
+
+	void RenderQueue::submit(const Shader& shader, unsigned int texture, unsigned int sampler, const Mesh& mesh, const ew::Mat4& model, float depth, const ew::Vec3& color)
+	{
+		submit(shader, texture, sampler, mesh, model, depth);
+		m_items.back().color = color;
+		m_items.back().hasColor = true;
+	}
+
+	void RenderQueue::submit(const Shader& shader, unsigned int texture, unsigned int sampler, const GeometryHeap& heap, GeometryHandle geometry,
+		const ew::Mat4& model, float depth)
+	{
+		const GeometryRange& range = heap.getRange(geometry);
+		submit(shader, texture, sampler, heap.getVAO(), range.numIndices, range.firstIndex, (int)range.baseVertex, model, depth);
+	}
+
+	void RenderQueue::submit(const Shader& shader, unsigned int texture, unsigned int sampler, const GeometryHeap& heap, GeometryHandle geometry,
+		const ew::Mat4& model, float depth, const ew::Vec3& color)
+	{
+		submit(shader, texture, sampler, heap, geometry, model, depth);
+		m_items.back().color = color;
+		m_items.back().hasColor = true;
+	}
+
+	const RenderQueue::UniformLocations& RenderQueue::getLocations(unsigned int program)
+	{
+		auto it = m_locations.find(program);
+		if (it == m_locations.end()) {
+			UniformLocations locations;
+			locations.model = glGetUniformLocation(program, "_Model");
+			locations.color = glGetUniformLocation(program, "_Color");
+			it = m_locations.emplace(program, locations).first;
+		}
+		return it->second;
+	}
+
+	void RenderQueue::execute(const std::function<void(const Shader& shader)>& bindProgram)
+	{
+		m_stats = RenderQueueStats();
+		m_stats.draws = (int)m_items.size();
+		if (m_items.empty()) {
+			m_keys.clear();
+			return;
+		}
+
+		//Count what submission order would have cost, tracking state the same way as below
+		BindTracker unsorted;
+		for (const Item& item : m_items) {
+			m_stats.unsortedStateChanges += unsorted.changeProgram(item.program) + unsorted.changeVertexArray(item.vertexArray);
+			if (item.texture) {
+				m_stats.unsortedStateChanges += unsorted.changeTexture(item.texture) + unsorted.changeSampler(item.sampler);
+			}
+		}
+
+		auto start = std::chrono::high_resolution_clock::now();
+		RadixSortKeys(m_keys, m_scratch);
+		m_stats.sortMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		BindTracker bound;
+		const UniformLocations* locations = nullptr;
+		glActiveTexture(GL_TEXTURE0);
+		for (const RenderKey& key : m_keys) {
+			const Item& item = m_items[key.item];
+			if (bound.changeProgram(item.program)) {
+				glUseProgram(item.program);
+				locations = &getLocations(item.program);
+				bindProgram(Shader(item.program));
+				m_stats.programChanges++;
+			}
+			if (item.texture && bound.changeTexture(item.texture)) {
+				glBindTexture(GL_TEXTURE_2D, item.texture);
+				m_stats.textureChanges++;
+			}
+			if (item.texture && bound.changeSampler(item.sampler)) {
+				glBindSampler(0, item.sampler);
+				m_stats.samplerChanges++;
+			}
+			if (bound.changeVertexArray(item.vertexArray)) {
+				glBindVertexArray(item.vertexArray);
+				m_stats.meshChanges++;
+			}
+			glUniformMatrix4fv(locations->model, 1, GL_FALSE, &item.model[0][0]);
+			if (item.hasColor) {
+				glUniform3f(locations->color, item.color.x, item.color.y, item.color.z);
+			}
+			if (item.baseVertex == 0 && item.firstIndex == 0) {
+				glDrawElements(GL_TRIANGLES, item.numIndices, GL_UNSIGNED_INT, NULL);
+			}
+			else {
+				glDrawElementsBaseVertex(GL_TRIANGLES, item.numIndices, GL_UNSIGNED_INT, (const void*)(sizeof(unsigned int) * item.firstIndex),
+					item.baseVertex);
+			}
+		}
+		m_keys.clear();
+	}
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include "ewMath/ewMath.h"
+#include "shader.h"
+#include "mesh.h"
+#include "geometryHeap.h"
+
+namespace ew {
+	//A draw's state packed so sorting groups it: program, then texture and sampler, then mesh, then front to back depth
+	struct RenderKey {
+		uint64_t key;
+		uint32_t item; //Index of the draw in submission order
+	};
+
+	//Sorts by key, least significant byte first, skipping bytes that every key shares. Stable. scratch is resized as needed.
+	void RadixSortKeys(std::vector<RenderKey>& keys, std::vector<RenderKey>& scratch);
+
+	struct RenderQueueStats {
+		int draws = 0;
+		int programChanges = 0;
+		int textureChanges = 0;
+		int samplerChanges = 0;
+		int meshChanges = 0;
+		int unsortedStateChanges = 0; //What drawing in submission order would have taken
+		float sortMs = 0;
+
+		inline int getStateChanges()const { return programChanges + textureChanges + samplerChanges + meshChanges; }
+	};
+
+	/// <summary>
+	/// Collects a frame's draws, sorts them by packed 64 bit keys and issues them with redundant binds skipped.
+	/// Each draw sets _Model, and _Color when it has one. Uniforms shared by every draw with a program are set
+	/// once per frame in the callback given to execute(). Texture 0 means the draw doesn't sample one, so whatever
+	/// is bound stays bound. Textures are bound to unit 0. All calls must be on the thread with the GL context.
+	/// </summary>
+	class RenderQueue {
+	public:
+		//Forgets the last frame's draws. Keeps allocations and uniform locations.
+		void clear();
+		//Forgets uniform locations, which are kept across frames. Call when programs are deleted or relinked,
+		//e.g. when ShaderVariantCache::update() swaps any in, since a new program can reuse an old one's name.
+		void invalidatePrograms();
+		//depth is the distance from the camera, for front to back order within the same state
+		void submit(const Shader& shader, unsigned int texture, unsigned int sampler, const Mesh& mesh, const ew::Mat4& model, float depth);
+		void submit(const Shader& shader, unsigned int texture, unsigned int sampler, const Mesh& mesh, const ew::Mat4& model, float depth, const ew::Vec3& color);
+		//A mesh in a GeometryHeap, drawn with its base vertex. Everything in one heap shares a vertex array, so sorts as one mesh.
+		void submit(const Shader& shader, unsigned int texture, unsigned int sampler, const GeometryHeap& heap, GeometryHandle geometry,
+			const ew::Mat4& model, float depth);
+		void submit(const Shader& shader, unsigned int texture, unsigned int sampler, const GeometryHeap& heap, GeometryHandle geometry,
+			const ew::Mat4& model, float depth, const ew::Vec3& color);
+		//Sorts and draws everything submitted. bindProgram is called the first time each program is used.
+		void execute(const std::function<void(const Shader& shader)>& bindProgram);
+
+		inline int getNumDraws()const { return (int)m_items.size(); }
+		inline const RenderQueueStats& getStats()const { return m_stats; }
+	private:
+		struct Item {
+			unsigned int program;
+			unsigned int texture;
+			unsigned int sampler;
+			unsigned int vertexArray;
+			int numIndices;
+			size_t firstIndex;
+			int baseVertex;
+			ew::Mat4 model;
+			ew::Vec3 color;
+			bool hasColor;
+		};
+		struct UniformLocations {
+			int model;
+			int color;
+		};
+		//Small indices for the key, handed out in the order states are first seen. Wraps if there are too many,
+		//which only makes the order less ideal, since binds compare the real names.
+		uint64_t getIndex(std::unordered_map<uint64_t, uint32_t>& indices, uint64_t name, int bits);
+		const UniformLocations& getLocations(unsigned int program);
+		void submit(const Shader& shader, unsigned int texture, unsigned int sampler, unsigned int vertexArray, int numIndices,
+			size_t firstIndex, int baseVertex, const ew::Mat4& model, float depth);
+
+		std::vector<Item> m_items;
+		std::vector<RenderKey> m_keys;
+		std::vector<RenderKey> m_scratch;
+		std::unordered_map<uint64_t, uint32_t> m_programIndices;
+		std::unordered_map<uint64_t, uint32_t> m_materialIndices;
+		std::unordered_map<uint64_t, uint32_t> m_meshIndices;
+		std::unordered_map<unsigned int, UniformLocations> m_locations;
+		RenderQueueStats m_stats;
+	};
+}
@@ -0,0 +1,152 @@
+#include "ringBuffer.h"
+#include "external/glad.h"
+#include <stdio.h>
+#include <chrono>
+
+namespace ew {
+	RingBuffer::~RingBuffer()
+	{
+		destroy();
+	}
+
+	/// <summary>
+	/// Allocates and maps the whole buffer once. Coherent mapping means writes are seen by the GPU without flushing.
+	/// </summary>
+	bool RingBuffer::create(size_t frameSize, int numFrames)
+	{
+		destroy();
+		if (glBufferStorage == NULL || glMapBufferRange == NULL || glFenceSync == NULL) {
+			printf("Ring buffer needs GL 4.4 buffer storage\n");
+			return false;
+		}
+		m_numFrames = numFrames > 1 ? numFrames : 1;
+		m_size = frameSize * m_numFrames;
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glGenBuffers(1, &m_buffer);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+		glBufferStorage(GL_COPY_WRITE_BUFFER, m_size, NULL, flags);
+		m_data = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, m_size, flags);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		if (m_data == NULL) {
+			printf("Failed to map ring buffer of %zu bytes\n", m_size);
+			destroy();
+			return false;
+		}
+		return true;
+	}
+
+	void RingBuffer::destroy()
+	{
+		for (const Frame& frame : m_frames) {
+			glDeleteSync((GLsync)frame.fence);
+		}
+		m_frames.clear();
+		if (m_buffer) {
+			if (m_data) {
+				glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+				glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+				glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+			}
+			glDeleteBuffers(1, &m_buffer);
+		}
+		m_buffer = 0;
+		m_data = nullptr;
+		m_size = 0;
+		m_head = m_frameBegin = 0;
+	}
+
+	bool RingBuffer::retireOldest(bool wait)
+	{
+		if (m_frames.empty()) {
+			return false;
+		}
+		GLsync fence = (GLsync)m_frames.front().fence;
+		GLenum result = glClientWaitSync(fence, 0, 0);
+		if (result == GL_TIMEOUT_EXPIRED) {
+			if (!wait) {
+				return false;
+			}
+			m_stats.stalls++;
+			auto start = std::chrono::high_resolution_clock::now();
+			//A millisecond at a time, flushing so the fence is sure to reach the GPU
+			while (result == GL_TIMEOUT_EXPIRED) {
+				result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+			}
+			m_stats.stallMs += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		}
+		//GL_WAIT_FAILED means the fence is unusable, so it can't protect anything either
+		glDeleteSync(fence);
+		m_frames.pop_front();
+		return true;
+	}
+
+	void RingBuffer::beginFrame()
+	{
+		m_stats.frameBytes = 0;
+		m_stats.frameAllocations = 0;
+		while (retireOldest(false)) {}
+		while ((int)m_frames.size() >= m_numFrames) {
+			retireOldest(true);
+		}
+	}
+
+	/// <summary>
+	/// Live data runs from the oldest in flight frame's start to the head, possibly across the end of the buffer.
+	/// Space is taken after the head, or from the start of the buffer when that runs out, retiring frames until it's free.
+	/// The head never catches up to the tail exactly, so an empty buffer and a full one can't be confused.
+	/// </summary>
+	void* RingBuffer::allocate(size_t size, size_t alignment, size_t* offset)
+	{
+		if (m_data == nullptr || size == 0 || size + alignment > m_size) {
+			printf("Ring buffer can't fit %zu bytes\n", size);
+			return nullptr;
+		}
+		while (true) {
+			if (m_frames.empty() && m_head == m_frameBegin) {
+				//Nothing written is still needed
+				m_head = m_frameBegin = 0;
+			}
+			size_t tail = m_frames.empty() ? m_frameBegin : m_frames.front().begin;
+			size_t start = (m_head + alignment - 1) & ~(alignment - 1);
+			bool wrap = false;
+			bool fits;
+			if (m_head >= tail) {
+				fits = start + size <= m_size;
+				if (!fits) {
+					wrap = true;
+					start = 0;
+					fits = size < tail;
+				}
+			}
+			else {
+				fits = start + size < tail;
+			}
+			if (fits) {
+				m_stats.wraps += wrap ? 1 : 0;
+				m_stats.frameBytes += size;
+				m_stats.frameAllocations++;
+				m_head = start + size;
+				*offset = start;
+				return m_data + start;
+			}
+			if (!retireOldest(true)) {
+				printf("Ring buffer of %zu bytes is too small for one frame\n", m_size);
+				return nullptr;
+			}
+		}
+	}
+
+	void RingBuffer::endFrame()
+	{
+		if (m_data == nullptr) {
+			return;
+		}
+		m_frames.push_back({ glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), m_frameBegin });
+		m_frameBegin = m_head;
+	}
+
+	void RingBuffer::bindRange(unsigned int target, unsigned int index, size_t offset, size_t size)const
+	{
+		glBindBufferRange(target, index, m_buffer, offset, size);
+	}
+}
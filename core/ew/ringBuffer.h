@@ -0,0 +1,61 @@
+#pragma once
+#include <stddef.h>
+#include <deque>
+
+namespace ew {
+	struct RingBufferStats {
+		size_t frameBytes = 0; //Allocated since beginFrame(), not counting alignment padding
+		int frameAllocations = 0;
+		int wraps = 0; //Allocations that went back to the start of the buffer
+		int stalls = 0; //Waits on a fence the GPU hadn't passed yet
+		float stallMs = 0;
+	};
+
+	/// <summary>
+	/// One buffer mapped for writing for its whole life with glBufferStorage, handing out space for per frame uniforms,
+	/// instance data and dynamic vertices without reallocating or remapping. Allocations run around the buffer in order.
+	/// Each frame's allocations are fenced in endFrame(), and space is only reused once the GPU has passed the fence,
+	/// so up to numFrames frames are written and read at once. Needs GL 4.4. All calls must be on the thread with the GL context.
+	/// </summary>
+	class RingBuffer {
+	public:
+		RingBuffer() {};
+		~RingBuffer();
+		RingBuffer(const RingBuffer&) = delete;
+		RingBuffer& operator=(const RingBuffer&) = delete;
+
+		//Room for numFrames frames of frameSize bytes. False if persistent mapping isn't supported.
+		bool create(size_t frameSize, int numFrames = 3);
+		void destroy();
+		//Retires frames the GPU has finished, waiting for the oldest if numFrames are still in flight
+		void beginFrame();
+		//Where to write size bytes, at an offset into the buffer that is a multiple of alignment (a power of two).
+		//Waits for the GPU when the buffer is full. Null if size can never fit.
+		void* allocate(size_t size, size_t alignment, size_t* offset);
+		//Fences everything allocated since beginFrame()
+		void endFrame();
+		//glBindBufferRange on an allocation, e.g. GL_UNIFORM_BUFFER
+		void bindRange(unsigned int target, unsigned int index, size_t offset, size_t size)const;
+
+		inline unsigned int getBuffer()const { return m_buffer; }
+		inline size_t getSize()const { return m_size; }
+		inline int getFramesInFlight()const { return (int)m_frames.size(); }
+		inline const RingBufferStats& getStats()const { return m_stats; }
+	private:
+		struct Frame {
+			void* fence; //GLsync
+			size_t begin; //Where its allocations start
+		};
+		//Pops the oldest frame if the GPU is done with it. With wait, blocks until it is.
+		bool retireOldest(bool wait);
+
+		unsigned int m_buffer = 0;
+		unsigned char* m_data = nullptr;
+		size_t m_size = 0;
+		int m_numFrames = 3;
+		size_t m_head = 0; //End of the newest allocation
+		size_t m_frameBegin = 0; //Start of the current frame
+		std::deque<Frame> m_frames; //In flight, oldest first
+		RingBufferStats m_stats;
+	};
+}
@@ -0,0 +1,84 @@
+#include "sampler.h"
+#include "hash.h"
+#include "texture.h"
+#include "external/glad.h"
+#include <algorithm>
+
+namespace ew {
+	size_t SamplerStateHash::operator()(const SamplerState& state)const
+	{
+		int modes[4] = { state.minFilter, state.magFilter, state.wrapS, state.wrapT };
+		float values[6] = { state.maxAnisotropy, state.lodBias, state.borderColor.x, state.borderColor.y, state.borderColor.z, state.borderColor.w };
+		return (size_t)HashBytes(values, sizeof(values), HashBytes(modes, sizeof(modes)));
+	}
+
+	SamplerState MakeSamplerState(int wrapMode, int filterMode, bool mipmapped)
+	{
+		SamplerState state;
+		state.wrapS = state.wrapT = wrapMode;
+		state.magFilter = filterMode;
+		if (filterMode == GL_NEAREST) {
+			state.minFilter = mipmapped ? GL_NEAREST_MIPMAP_NEAREST : GL_NEAREST;
+		}
+		else {
+			state.minFilter = mipmapped ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR;
+		}
+		return state;
+	}
+
+	SamplerCache::~SamplerCache()
+	{
+		clear();
+	}
+
+	unsigned int SamplerCache::get(const SamplerState& state)
+	{
+		m_lookups++;
+		auto it = m_samplers.find(state);
+		if (it != m_samplers.end()) {
+			return it->second;
+		}
+		if (m_maxAnisotropy == 0) {
+			//Core since 4.6, and the same enums in both extensions before that
+			int major = 0, minor = 0;
+			glGetIntegerv(GL_MAJOR_VERSION, &major);
+			glGetIntegerv(GL_MINOR_VERSION, &minor);
+			m_anisotropic = major > 4 || (major == 4 && minor >= 6)
+				|| hasGLExtension("GL_ARB_texture_filter_anisotropic") || hasGLExtension("GL_EXT_texture_filter_anisotropic");
+			if (m_anisotropic) {
+				glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &m_maxAnisotropy);
+			}
+			m_maxAnisotropy = std::max(m_maxAnisotropy, 1.0f);
+		}
+
+		unsigned int sampler = 0;
+		glGenSamplers(1, &sampler);
+		glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, state.minFilter);
+		glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, state.magFilter);
+		glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, state.wrapS);
+		glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, state.wrapT);
+		if (m_anisotropic) {
+			glSamplerParameterf(sampler, GL_TEXTURE_MAX_ANISOTROPY, std::min(std::max(state.maxAnisotropy, 1.0f), m_maxAnisotropy));
+		}
+		glSamplerParameterf(sampler, GL_TEXTURE_LOD_BIAS, state.lodBias);
+		glSamplerParameterfv(sampler, GL_TEXTURE_BORDER_COLOR, &state.borderColor.x);
+		m_samplers[state] = sampler;
+		m_created++;
+		return sampler;
+	}
+
+	void SamplerCache::bind(int unit, unsigned int texture, unsigned int sampler)
+	{
+		glActiveTexture(GL_TEXTURE0 + unit);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glBindSampler(unit, sampler);
+	}
+
+	void SamplerCache::clear()
+	{
+		for (auto& it : m_samplers) {
+			glDeleteSamplers(1, &it.second);
+		}
+		m_samplers.clear();
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <unordered_map>
+#include "ewMath/vec4.h"
+
+namespace ew {
+	//Everything a GL sampler object holds. Enum fields take GL values, e.g. GL_LINEAR_MIPMAP_LINEAR.
+	struct SamplerState {
+		int minFilter = 0x2703; //GL_LINEAR_MIPMAP_LINEAR
+		int magFilter = 0x2601; //GL_LINEAR
+		int wrapS = 0x2901; //GL_REPEAT
+		int wrapT = 0x2901;
+		float maxAnisotropy = 1.0f; //1 turns anisotropic filtering off. Clamped to the driver's limit, and ignored without GL 4.6 or the extension.
+		float lodBias = 0.0f;
+		ew::Vec4 borderColor = ew::Vec4(0, 0, 0, 0); //Only used by GL_CLAMP_TO_BORDER
+
+		inline bool operator==(const SamplerState& other)const {
+			return minFilter == other.minFilter && magFilter == other.magFilter && wrapS == other.wrapS && wrapT == other.wrapT
+				&& maxAnisotropy == other.maxAnisotropy && lodBias == other.lodBias && borderColor.x == other.borderColor.x
+				&& borderColor.y == other.borderColor.y && borderColor.z == other.borderColor.z && borderColor.w == other.borderColor.w;
+		}
+	};
+
+	struct SamplerStateHash {
+		size_t operator()(const SamplerState& state)const;
+	};
+
+	//Same wrap mode on both axes, trilinear when minifying if mipmapped
+	SamplerState MakeSamplerState(int wrapMode, int filterMode, bool mipmapped = true);
+
+	/// <summary>
+	/// Owns one GL sampler object per unique SamplerState, so textures sharing settings share a sampler
+	/// and filtering can change without touching texture objects. Samplers bound to a unit override the
+	/// parameters stored in the texture. All calls must be on the thread with the GL context.
+	/// </summary>
+	class SamplerCache {
+	public:
+		SamplerCache() = default;
+		//Deletes every sampler
+		~SamplerCache();
+		SamplerCache(const SamplerCache&) = delete;
+		SamplerCache& operator=(const SamplerCache&) = delete;
+
+		//Creates the sampler the first time a state is seen
+		unsigned int get(const SamplerState& state);
+		//Binds a texture and sampler to a unit together
+		void bind(int unit, unsigned int texture, unsigned int sampler);
+		//Deletes every sampler. Names handed out before are invalid after this.
+		void clear();
+
+		inline int getNumSamplers()const { return (int)m_samplers.size(); }
+		inline int getLookups()const { return m_lookups; }
+		inline int getCreated()const { return m_created; }
+	private:
+		std::unordered_map<SamplerState, unsigned int, SamplerStateHash> m_samplers;
+		float m_maxAnisotropy = 0; //0 until queried
+		bool m_anisotropic = false;
+		int m_lookups = 0;
+		int m_created = 0;
+	};
+}
@@ -1,6 +1,8 @@
 #include "shader.h"
-#include <fstream>
-#include <sstream>
+#include "programCache.h"
+#include "shaderPreprocessor.h"
+#include "assetFile.h"
+#include <string_view>
 #include "external/glad.h"
 
 namespace ew {
@@ -10,14 +12,25 @@ namespace ew {
 	/// <param name="filePath"></param>
 	/// <returns></returns>
 	std::string loadShaderSourceFromFile(const std::string& filePath) {
-		std::ifstream fstream(filePath);
-		if (!fstream.is_open()) {
-			printf("Failed to load file %s", filePath.c_str());
-			return {};
+		std::string source;
+		loadShaderSourceFromFile(filePath, source);
+		return source;
+	}
+
+	/// <summary>
+	/// Loads shader source code from a file, copying it once from the mapped file into the string
+	/// </summary>
+	/// <param name="filePath"></param>
+	/// <param name="source">Replaced with the file's contents</param>
+	/// <returns>False if the file couldn't be opened or read</returns>
+	bool loadShaderSourceFromFile(const std::string& filePath, std::string& source) {
+		AssetFile file;
+		if (!file.open(filePath.c_str())) {
+			source.clear();
+			return false;
 		}
-		std::stringstream buffer;
-		buffer << fstream.rdbuf();
-		return buffer.str();
+		source.assign(file.getText(), file.getSize());
+		return true;
 	}
 
 	/// <summary>
@@ -25,12 +38,13 @@ namespace ew {
 	/// </summary>
 	/// <param name="shaderType">Expects GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, etc.</param>
 	/// <param name="sourceCode">GLSL source code for the shader stage</param>
+	/// <param name="sourceLength">Length of sourceCode, or -1 if it is null terminated</param>
 	/// <returns></returns>
-	static unsigned int createShader(GLenum shaderType, const char* sourceCode) {
+	static unsigned int createShader(GLenum shaderType, const char* sourceCode, int sourceLength) {
 		//Create a new vertex shader object
 		unsigned int shader = glCreateShader(shaderType);
 		//Supply the shader object with source code
-		glShaderSource(shader, 1, &sourceCode, NULL);
+		glShaderSource(shader, 1, &sourceCode, &sourceLength);
 		//Compile the shader object
 		glCompileShader(shader);
 		int success;
@@ -49,15 +63,33 @@ namespace ew {
 	/// </summary>
 	/// <param name="vertexShaderSource">GLSL source code for the vertex shader</param>
 	/// <param name="fragmentShaderSource">GLSL source code for the fragment shader</param>
+	/// <param name="retrievable">Whether the linked binary will be read back with glGetProgramBinary</param>
+	/// <returns></returns>
+	unsigned int createShaderProgram(const char* vertexShaderSource, const char* fragmentShaderSource, bool retrievable) {
+		return createShaderProgram(vertexShaderSource, -1, fragmentShaderSource, -1, retrievable);
+	}
+
+	/// <summary>
+	/// Creates a shader program from sources with known lengths, which don't need to be null terminated,
+	/// so views into a mapped file can be passed straight to the driver
+	/// </summary>
+	/// <param name="vertexShaderSource">GLSL source code for the vertex shader</param>
+	/// <param name="vertexShaderLength">Length in bytes, or -1 if null terminated</param>
+	/// <param name="fragmentShaderSource">GLSL source code for the fragment shader</param>
+	/// <param name="fragmentShaderLength">Length in bytes, or -1 if null terminated</param>
+	/// <param name="retrievable">Whether the linked binary will be read back with glGetProgramBinary</param>
 	/// <returns></returns>
-	unsigned int createShaderProgram(const char* vertexShaderSource, const char* fragmentShaderSource) {
-		unsigned int vertexShader = createShader(GL_VERTEX_SHADER, vertexShaderSource);
-		unsigned int fragmentShader = createShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
+	unsigned int createShaderProgram(const char* vertexShaderSource, int vertexShaderLength, const char* fragmentShaderSource, int fragmentShaderLength, bool retrievable) {
+		unsigned int vertexShader = createShader(GL_VERTEX_SHADER, vertexShaderSource, vertexShaderLength);
+		unsigned int fragmentShader = createShader(GL_FRAGMENT_SHADER, fragmentShaderSource, fragmentShaderLength);
 
 		unsigned int shaderProgram = glCreateProgram();
 		//Attach each stage
 		glAttachShader(shaderProgram, vertexShader);
 		glAttachShader(shaderProgram, fragmentShader);
+		if (retrievable) {
+			glProgramParameteri(shaderProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
 		//Link all the stages together
 		glLinkProgram(shaderProgram);
 		int success;
@@ -77,11 +109,33 @@ namespace ew {
 	/// </summary>
 	/// <param name="vertexShader">File path to vertex shader</param>
 	/// <param name="fragmentShader">File path to fragment shader</param>
-	Shader::Shader(const std::string& vertexShader, const std::string& fragmentShader)
+	/// <param name="programCache">Optional cache of linked program binaries</param>
+	Shader::Shader(const std::string& vertexShader, const std::string& fragmentShader, ProgramCache* programCache)
+	{
+		AssetFile vertexFile(vertexShader.c_str());
+		AssetFile fragmentFile(fragmentShader.c_str());
+		std::string_view vertexText(vertexFile.getText(), vertexFile.getSize());
+		std::string_view fragmentText(fragmentFile.getText(), fragmentFile.getSize());
+		//Files with nothing to expand are handed to the driver straight from the mapped files
+		if (!programCache && vertexFile.isOpen() && fragmentFile.isOpen()
+			&& vertexText.find("#include") == std::string_view::npos && fragmentText.find("#include") == std::string_view::npos) {
+			m_id = ew::createShaderProgram(vertexFile.getText(), (int)vertexFile.getSize(), fragmentFile.getText(), (int)fragmentFile.getSize());
+			return;
+		}
+		//Includes are expanded first, so cached binaries are keyed by everything that went into them
+		std::string vertexShaderSource, fragmentShaderSource;
+		ew::PreprocessShader(vertexShader, {}, vertexShaderSource);
+		ew::PreprocessShader(fragmentShader, {}, fragmentShaderSource);
+		if (programCache) {
+			m_id = programCache->getProgram(vertexShaderSource.c_str(), fragmentShaderSource.c_str());
+		}
+		else {
+			m_id = ew::createShaderProgram(vertexShaderSource.c_str(), fragmentShaderSource.c_str());
+		}
+	}
+	Shader::Shader(unsigned int program)
+		: m_id(program)
 	{
-		std::string vertexShaderSource = ew::loadShaderSourceFromFile(vertexShader.c_str());
-		std::string fragmentShaderSource = ew::loadShaderSourceFromFile(fragmentShader.c_str());
-		m_id = ew::createShaderProgram(vertexShaderSource.c_str(), fragmentShaderSource.c_str());
 	}
 	void Shader::use()const
 	{
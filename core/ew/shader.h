@@ -3,11 +3,22 @@
 #include "ewMath/ewMath.h"
 
 namespace ew {
+	class ProgramCache;
+
 	std::string loadShaderSourceFromFile(const std::string& filePath);
-	unsigned int createShaderProgram(const char* vertexShaderSource, const char* fragmentShaderSource);
+	//False if the file couldn't be read, rather than an empty string
+	bool loadShaderSourceFromFile(const std::string& filePath, std::string& source);
+	//retrievable asks the driver to keep the linked binary around for glGetProgramBinary
+	unsigned int createShaderProgram(const char* vertexShaderSource, const char* fragmentShaderSource, bool retrievable = false);
+	//Same with source lengths, so the sources needn't be null terminated. -1 means null terminated.
+	unsigned int createShaderProgram(const char* vertexShaderSource, int vertexShaderLength, const char* fragmentShaderSource, int fragmentShaderLength, bool retrievable = false);
 	class Shader {
 	public:
-		Shader(const std::string& vertexShader, const std::string& fragmentShader);
+		//Loads both files with their #includes expanded, or hands them to the driver straight from the mapped files when
+		//they have none. Loads the linked program from programCache when one is given and it has a binary for these sources.
+		Shader(const std::string& vertexShader, const std::string& fragmentShader, ProgramCache* programCache = nullptr);
+		//Wraps a program that was already linked, e.g. by ShaderCompiler
+		explicit Shader(unsigned int program);
 		void use()const;
 		void setInt(const std::string& name, int v) const;
 		void setFloat(const std::string& name, float v) const;
@@ -18,6 +29,7 @@ namespace ew {
 		void setVec4(const std::string& name, float x, float y, float z, float w) const;
 		void setVec4(const std::string& name, const ew::Vec4& v) const;
 		void setMat4(const std::string& name, const ew::Mat4& m) const;
+		inline unsigned int getID()const { return m_id; }
 	private:
 		unsigned int m_id; //Shader program handle
 	};
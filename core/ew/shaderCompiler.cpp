@@ -0,0 +1,171 @@
+#include "shaderCompiler.h"
+#include "shaderPreprocessor.h"
+#include "external/glad.h"
+#include <stdio.h>
+#include <chrono>
+
+//KHR_parallel_shader_compile, which glad was generated without. The ARB version uses the same values.
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+namespace {
+	typedef void (GLAD_API_PTR* MaxShaderCompilerThreadsProc)(GLuint count);
+
+	//Errors in a stage, if it failed. Only called once the program is known to be done, so it never blocks for long.
+	bool checkShader(unsigned int shader, const char* stageName) {
+		int success = 0;
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+		if (!success) {
+			char infoLog[512];
+			glGetShaderInfoLog(shader, 512, NULL, infoLog);
+			printf("Failed to compile %s shader: %s", stageName, infoLog);
+		}
+		return success != 0;
+	}
+}
+
+namespace ew {
+	ShaderCompiler::ShaderCompiler(GLProcLoader loader, ProgramCache* programCache)
+		: m_programCache(programCache)
+	{
+		if (!loader) {
+			return;
+		}
+		const char* FUNCTIONS[2] = { "glMaxShaderCompilerThreadsKHR", "glMaxShaderCompilerThreadsARB" };
+		const char* EXTENSIONS[2] = { "GL_KHR_parallel_shader_compile", "GL_ARB_parallel_shader_compile" };
+		for (int i = 0; i < 2 && !m_stats.parallel; i++) {
+			if (!hasGLExtension(EXTENSIONS[i])) {
+				continue;
+			}
+			MaxShaderCompilerThreadsProc maxThreads = (MaxShaderCompilerThreadsProc)loader(FUNCTIONS[i]);
+			if (maxThreads) {
+				//0xFFFFFFFF lets the driver pick as many threads as it likes
+				maxThreads(0xFFFFFFFFu);
+				m_stats.parallel = true;
+			}
+		}
+	}
+
+	ShaderCompiler::~ShaderCompiler()
+	{
+		for (Build& build : m_builds) {
+			if (!build.taken) {
+				glDeleteShader(build.vertexShader);
+				glDeleteShader(build.fragmentShader);
+				glDeleteProgram(build.program);
+			}
+		}
+	}
+
+	int ShaderCompiler::submit(const char* vertexSource, const char* fragmentSource)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		Build build;
+		if (m_programCache) {
+			build.program = m_programCache->findProgram(vertexSource, fragmentSource);
+		}
+		if (build.program) {
+			m_builds.push_back(build);
+			m_stats.submitted++;
+			m_stats.cached++;
+			m_stats.submitMs += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			return (int)m_builds.size() - 1;
+		}
+		build.vertexShader = glCreateShader(GL_VERTEX_SHADER);
+		glShaderSource(build.vertexShader, 1, &vertexSource, NULL);
+		glCompileShader(build.vertexShader);
+		build.fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+		glShaderSource(build.fragmentShader, 1, &fragmentSource, NULL);
+		glCompileShader(build.fragmentShader);
+		//Linking straight away is fine, the driver queues it behind the compiles and fails the link if they fail
+		build.program = glCreateProgram();
+		glAttachShader(build.program, build.vertexShader);
+		glAttachShader(build.program, build.fragmentShader);
+		if (m_programCache) {
+			glProgramParameteri(build.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+			build.vertexSource = vertexSource;
+			build.fragmentSource = fragmentSource;
+		}
+		glLinkProgram(build.program);
+		m_builds.push_back(build);
+		m_stats.submitted++;
+		m_stats.submitMs += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		return (int)m_builds.size() - 1;
+	}
+
+	int ShaderCompiler::submitFiles(const std::string& vertexShader, const std::string& fragmentShader)
+	{
+		std::string vertexSource, fragmentSource;
+		PreprocessShader(vertexShader, {}, vertexSource);
+		PreprocessShader(fragmentShader, {}, fragmentSource);
+		return submit(vertexSource.c_str(), fragmentSource.c_str());
+	}
+
+	bool ShaderCompiler::isReady(int id)
+	{
+		if (m_builds[id].taken || !m_stats.parallel) {
+			return true;
+		}
+		int complete = 0;
+		glGetProgramiv(m_builds[id].program, GL_COMPLETION_STATUS_KHR, &complete);
+		return complete != 0;
+	}
+
+	int ShaderCompiler::getNumPending()
+	{
+		int pending = 0;
+		for (int i = 0; i < (int)m_builds.size(); i++) {
+			if (!m_builds[i].taken && !isReady(i)) {
+				pending++;
+			}
+		}
+		return pending;
+	}
+
+	unsigned int ShaderCompiler::get(int id)
+	{
+		Build& build = m_builds[id];
+		if (build.taken) {
+			return build.program;
+		}
+		if (build.vertexShader == 0) {
+			//Loaded from the cache, already checked
+			build.taken = true;
+			m_stats.finished++;
+			return build.program;
+		}
+		//Querying the link status is what blocks, so time it
+		auto start = std::chrono::high_resolution_clock::now();
+		int linked = 0;
+		glGetProgramiv(build.program, GL_LINK_STATUS, &linked);
+		m_stats.waitMs += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		if (!linked) {
+			bool compiled = checkShader(build.vertexShader, "vertex");
+			compiled = checkShader(build.fragmentShader, "fragment") && compiled;
+			if (compiled) {
+				char infoLog[512];
+				glGetProgramInfoLog(build.program, 512, NULL, infoLog);
+				printf("Failed to link shader program: %s", infoLog);
+			}
+			glDeleteProgram(build.program);
+			build.program = 0;
+			m_stats.failed++;
+		}
+		else if (m_programCache) {
+			m_programCache->storeProgram(build.vertexSource.c_str(), build.fragmentSource.c_str(), build.program);
+		}
+		build.vertexSource.clear();
+		build.fragmentSource.clear();
+		glDeleteShader(build.vertexShader);
+		glDeleteShader(build.fragmentShader);
+		build.taken = true;
+		m_stats.finished++;
+		return build.program;
+	}
+
+	Shader ShaderCompiler::getShader(int id)
+	{
+		return Shader(get(id));
+	}
+}
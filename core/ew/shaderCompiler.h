@@ -0,0 +1,62 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "shader.h"
+#include "texture.h"
+#include "programCache.h"
+
+namespace ew {
+	struct ShaderCompilerStats {
+		int submitted = 0;
+		int cached = 0; //Loaded from the program cache instead of compiled
+		int finished = 0; //Checked and handed out
+		int failed = 0;
+		float submitMs = 0; //Time spent in submit calls
+		float waitMs = 0; //Time get() blocked on programs that weren't done yet
+		bool parallel = false; //Whether the driver compiles on its own threads
+	};
+
+	/// <summary>
+	/// Compiles and links programs without waiting on each one. submit() only issues the compile and link calls,
+	/// which drivers can run in the background, and errors are checked the first time a program is needed with get().
+	/// With KHR_parallel_shader_compile (or the ARB version) the driver is asked to use every thread it can,
+	/// and isReady() checks without blocking. Given a ProgramCache, saved binaries are used straight away
+	/// and only misses are compiled, then saved once they are checked. All calls must be on the thread with the GL context.
+	/// </summary>
+	class ShaderCompiler {
+	public:
+		//loader loads the extension's thread count function, which glad was generated without
+		ShaderCompiler(GLProcLoader loader = nullptr, ProgramCache* programCache = nullptr);
+		//Deletes programs that were never taken with get()
+		~ShaderCompiler();
+		ShaderCompiler(const ShaderCompiler&) = delete;
+		ShaderCompiler& operator=(const ShaderCompiler&) = delete;
+
+		//Starts building a program from sources, returning its id
+		int submit(const char* vertexSource, const char* fragmentSource);
+		//Same, loading both stages from files first with their #includes expanded
+		int submitFiles(const std::string& vertexShader, const std::string& fragmentShader);
+		//Never blocks with the parallel extension. Without it, always true, since asking would wait.
+		bool isReady(int id);
+		//Programs submitted but not taken with get() yet that are still compiling
+		int getNumPending();
+		//Waits for the program if needed, prints any errors and deletes its stage objects.
+		//The program belongs to the caller from then on. 0 if it failed.
+		unsigned int get(int id);
+		//get() wrapped in a Shader
+		Shader getShader(int id);
+
+		inline const ShaderCompilerStats& getStats()const { return m_stats; }
+	private:
+		struct Build {
+			unsigned int program = 0;
+			unsigned int vertexShader = 0;
+			unsigned int fragmentShader = 0; //Both 0 when the program came from the cache
+			bool taken = false;
+			std::string vertexSource, fragmentSource; //Kept until the program is saved to the cache
+		};
+		ProgramCache* m_programCache;
+		std::vector<Build> m_builds;
+		ShaderCompilerStats m_stats;
+	};
+}
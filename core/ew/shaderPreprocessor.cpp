@@ -0,0 +1,279 @@
+#include "shaderPreprocessor.h"
+#include "shaderCompiler.h"
+#include "hash.h"
+#include "assetFile.h"
+#include "external/glad.h"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <string_view>
+
+namespace {
+	const int MAX_INCLUDE_DEPTH = 32;
+
+	struct IncludeState {
+		std::vector<std::string> files; //Index is the #line source number
+		int depth = 0;
+	};
+
+	void appendLineDirective(std::string& source, int line, int fileIndex) {
+		source += "#line " + std::to_string(line) + " " + std::to_string(fileIndex) + "\n";
+	}
+
+	//Whether line starts with a directive, ignoring whitespace. Sets rest to just after it.
+	bool isDirective(std::string_view text, size_t lineStart, size_t lineEnd, const char* directive, size_t& rest) {
+		size_t i = text.find_first_not_of(" \t", lineStart);
+		size_t length = strlen(directive);
+		if (i == std::string_view::npos || i + length > lineEnd || text.compare(i, length, directive) != 0) {
+			return false;
+		}
+		rest = i + length;
+		return true;
+	}
+
+	bool expandFile(const std::string& path, const ew::ShaderDefines* defines, IncludeState& state, std::string& source) {
+		//Listed even if it can't be read, so whoever watches the files sees it appear
+		int fileIndex = (int)state.files.size();
+		state.files.push_back(path);
+		ew::AssetFile file;
+		if (!file.open(path.c_str())) {
+			return false;
+		}
+		//Lines are copied straight from the mapped file into the output
+		std::string_view text(file.getText(), file.getSize());
+		std::filesystem::path directory = std::filesystem::path(path).parent_path();
+
+		//Defines go after #version, which has to come before anything but comments. Without one they go first.
+		size_t rest = 0;
+		bool hasVersion = false;
+		if (defines) {
+			for (size_t lineStart = 0; lineStart < text.size() && !hasVersion; ) {
+				size_t lineEnd = std::min(text.find('\n', lineStart), text.size());
+				hasVersion = isDirective(text, lineStart, lineEnd, "#version", rest);
+				lineStart = lineEnd + 1;
+			}
+		}
+		auto appendDefines = [&](int nextLine) {
+			for (const ew::ShaderDefine& define : *defines) {
+				source += "#define " + define.name + " " + define.value + "\n";
+			}
+			appendLineDirective(source, nextLine, fileIndex);
+		};
+		if (defines && !hasVersion) {
+			appendDefines(1);
+		}
+		else if (!defines) {
+			appendLineDirective(source, 1, fileIndex);
+		}
+
+		int lineNumber = 1;
+		for (size_t lineStart = 0; lineStart < text.size(); lineNumber++) {
+			size_t lineEnd = std::min(text.find('\n', lineStart), text.size());
+			if (isDirective(text, lineStart, lineEnd, "#include", rest)) {
+				size_t open = text.find_first_of("\"<", rest);
+				size_t close = open < lineEnd ? text.find_first_of("\">", open + 1) : std::string_view::npos;
+				if (close >= lineEnd) {
+					printf("%s(%d): malformed #include\n", path.c_str(), lineNumber);
+					return false;
+				}
+				std::string includePath = (directory / std::string(text.substr(open + 1, close - open - 1))).lexically_normal().generic_string();
+				if (std::find(state.files.begin(), state.files.end(), includePath) == state.files.end()) {
+					if (state.depth >= MAX_INCLUDE_DEPTH) {
+						printf("%s(%d): includes nested too deeply\n", path.c_str(), lineNumber);
+						return false;
+					}
+					state.depth++;
+					if (!expandFile(includePath, nullptr, state, source)) {
+						printf("%s(%d): failed to include %s\n", path.c_str(), lineNumber, includePath.c_str());
+						return false;
+					}
+					state.depth--;
+				}
+				appendLineDirective(source, lineNumber + 1, fileIndex);
+			}
+			else {
+				source.append(text, lineStart, lineEnd - lineStart);
+				source += '\n';
+				if (defines && hasVersion && isDirective(text, lineStart, lineEnd, "#version", rest)) {
+					appendDefines(lineNumber + 1);
+				}
+			}
+			lineStart = lineEnd + 1;
+		}
+		return true;
+	}
+}
+
+namespace ew {
+	bool PreprocessShader(const std::string& filePath, const ShaderDefines& defines, std::string& source, std::vector<std::string>* files)
+	{
+		IncludeState state;
+		source.clear();
+		bool success = expandFile(std::filesystem::path(filePath).lexically_normal().generic_string(), &defines, state, source);
+		if (files) {
+			*files = state.files;
+		}
+		return success;
+	}
+
+	uint64_t HashShaderDefines(const ShaderDefines& defines)
+	{
+		std::vector<const ShaderDefine*> sorted(defines.size());
+		for (size_t i = 0; i < defines.size(); i++) {
+			sorted[i] = &defines[i];
+		}
+		std::sort(sorted.begin(), sorted.end(), [](const ShaderDefine* a, const ShaderDefine* b) { return a->name < b->name; });
+		uint64_t hash = HASH_SEED;
+		for (const ShaderDefine* define : sorted) {
+			//Include the terminators, so "AB" = "C" and "A" = "BC" differ
+			hash = HashBytes(define->name.c_str(), define->name.size() + 1, hash);
+			hash = HashBytes(define->value.c_str(), define->value.size() + 1, hash);
+		}
+		return hash;
+	}
+
+	std::vector<ShaderDefines> MakeShaderPermutations(const std::vector<std::string>& toggles, const ShaderDefines& base)
+	{
+		std::vector<ShaderDefines> permutations(size_t(1) << toggles.size(), base);
+		for (size_t i = 0; i < permutations.size(); i++) {
+			for (size_t j = 0; j < toggles.size(); j++) {
+				if (i & (size_t(1) << j)) {
+					permutations[i].push_back({ toggles[j] });
+				}
+			}
+		}
+		return permutations;
+	}
+
+	ShaderVariantCache::ShaderVariantCache(const std::string& vertexShader, const std::string& fragmentShader, ShaderCompiler* compiler)
+		: m_vertexShader(vertexShader), m_fragmentShader(fragmentShader), m_compiler(compiler)
+	{
+	}
+
+	ShaderVariantCache::Variant& ShaderVariantCache::findVariant(const ShaderDefines& defines)
+	{
+		uint64_t key = HashShaderDefines(defines);
+		auto it = m_variants.find(key);
+		if (it != m_variants.end()) {
+			return it->second;
+		}
+		Variant& variant = m_variants[key];
+		variant.defines = defines;
+		if (submitVariant(variant, variant.build, variant.program)) {
+			m_stats.variants++;
+		}
+		else {
+			m_stats.failed++;
+		}
+		return variant;
+	}
+
+	bool ShaderVariantCache::submitVariant(Variant& variant, int& build, unsigned int& program)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		std::string vertexSource, fragmentSource;
+		std::vector<std::string> vertexFiles, fragmentFiles;
+		bool loaded = PreprocessShader(m_vertexShader, variant.defines, vertexSource, &vertexFiles);
+		loaded = loaded && PreprocessShader(m_fragmentShader, variant.defines, fragmentSource, &fragmentFiles);
+		m_stats.preprocessMs += std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		//Keep whatever was read even on failure, so fixing the file triggers a reload
+		variant.files = vertexFiles;
+		variant.files.insert(variant.files.end(), fragmentFiles.begin(), fragmentFiles.end());
+		if (!loaded) {
+			return false;
+		}
+		if (m_compiler) {
+			build = m_compiler->submit(vertexSource.c_str(), fragmentSource.c_str());
+		}
+		else {
+			program = createShaderProgram(vertexSource.c_str(), fragmentSource.c_str());
+		}
+		return true;
+	}
+
+	void ShaderVariantCache::prepare(const ShaderDefines& defines)
+	{
+		findVariant(defines);
+	}
+
+	Shader ShaderVariantCache::get(const ShaderDefines& defines)
+	{
+		m_stats.lookups++;
+		Variant& variant = findVariant(defines);
+		if (variant.build >= 0) {
+			variant.program = m_compiler->get(variant.build);
+			variant.build = -1;
+		}
+		return Shader(variant.program);
+	}
+
+	int ShaderVariantCache::update(const std::vector<std::string>& changedFiles)
+	{
+		int swapped = 0;
+		for (auto& entry : m_variants) {
+			Variant& variant = entry.second;
+			bool changed = false;
+			for (const std::string& file : changedFiles) {
+				changed = changed || std::find(variant.files.begin(), variant.files.end(), file) != variant.files.end();
+			}
+			if (changed) {
+				//A newer edit replaces a rebuild that hasn't finished
+				if (variant.rebuild >= 0) {
+					glDeleteProgram(m_compiler->get(variant.rebuild));
+					variant.rebuild = -1;
+				}
+				unsigned int program = 0;
+				if (!submitVariant(variant, variant.rebuild, program)) {
+					m_stats.reloadFailures++;
+					continue;
+				}
+				if (!m_compiler) {
+					int linked = 0;
+					glGetProgramiv(program, GL_LINK_STATUS, &linked);
+					if (!linked) {
+						glDeleteProgram(program);
+						m_stats.reloadFailures++;
+						continue;
+					}
+					glDeleteProgram(variant.program);
+					variant.program = program;
+					m_stats.reloads++;
+					swapped++;
+				}
+			}
+			if (variant.rebuild >= 0 && m_compiler->isReady(variant.rebuild)) {
+				unsigned int program = m_compiler->get(variant.rebuild);
+				variant.rebuild = -1;
+				if (!program) {
+					m_stats.reloadFailures++;
+					continue;
+				}
+				//Take the first build first, so it isn't left behind in the compiler
+				if (variant.build >= 0) {
+					variant.program = m_compiler->get(variant.build);
+					variant.build = -1;
+				}
+				glDeleteProgram(variant.program);
+				variant.program = program;
+				m_stats.reloads++;
+				swapped++;
+			}
+		}
+		return swapped;
+	}
+
+	std::vector<std::string> ShaderVariantCache::getFiles()const
+	{
+		std::vector<std::string> files;
+		for (const auto& entry : m_variants) {
+			for (const std::string& file : entry.second.files) {
+				if (std::find(files.begin(), files.end(), file) == files.end()) {
+					files.push_back(file);
+				}
+			}
+		}
+		return files;
+	}
+}
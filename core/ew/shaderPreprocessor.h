@@ -0,0 +1,82 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "shader.h"
+
+namespace ew {
+	class ShaderCompiler;
+
+	struct ShaderDefine {
+		std::string name;
+		std::string value = "1";
+	};
+	typedef std::vector<ShaderDefine> ShaderDefines;
+
+	/// <summary>
+	/// Loads a shader and expands its #include "file" lines, resolved relative to the including file.
+	/// Each file is only included once per shader, like #pragma once, and includes are expanded whether or not
+	/// they sit inside an #if. defines are inserted as #define lines straight after #version, and #line directives
+	/// keep compiler errors pointing at the right line. Error source numbers index into files when it is given.
+	/// </summary>
+	/// <returns>False if a file couldn't be read</returns>
+	bool PreprocessShader(const std::string& filePath, const ShaderDefines& defines, std::string& source, std::vector<std::string>* files = nullptr);
+
+	//Same for any order of the same defines
+	uint64_t HashShaderDefines(const ShaderDefines& defines);
+
+	//Every combination of the toggles being defined or not, 2^n sets. Each set starts with base.
+	std::vector<ShaderDefines> MakeShaderPermutations(const std::vector<std::string>& toggles, const ShaderDefines& base = {});
+
+	struct ShaderVariantStats {
+		int variants = 0; //Programs built
+		int failed = 0; //Variants whose files couldn't be read
+		int lookups = 0;
+		float preprocessMs = 0;
+		int reloads = 0; //Rebuilt programs swapped in
+		int reloadFailures = 0; //Rebuilds that failed, leaving the old program in place
+	};
+
+	/// <summary>
+	/// Programs built from one pair of shader files with different defines, so features can be compiled in or out
+	/// instead of branched on per fragment. Each define set is preprocessed and built once, keyed by HashShaderDefines.
+	/// With a ShaderCompiler, variants are built through it (and its ProgramCache), and prepare() lets them build
+	/// in the background before they're first used. update() hot reloads variants whose files changed, e.g. as
+	/// reported by a FileWatcher. All calls must be on the thread with the GL context.
+	/// </summary>
+	class ShaderVariantCache {
+	public:
+		ShaderVariantCache(const std::string& vertexShader, const std::string& fragmentShader, ShaderCompiler* compiler = nullptr);
+
+		//Starts building a variant if it hasn't been already. Without a compiler this builds it straight away.
+		void prepare(const ShaderDefines& defines);
+		//The variant's program, waiting for it to be built if needed. The program is 0 if it failed.
+		Shader get(const ShaderDefines& defines);
+		//Starts rebuilding every variant that read one of changedFiles, and swaps in rebuilds that have finished,
+		//returning how many were swapped. Call once a frame before drawing, so a frame never mixes old and new programs.
+		//A rebuild that fails keeps the old program. With a parallel ShaderCompiler this never waits on the driver.
+		int update(const std::vector<std::string>& changedFiles = {});
+		//Every file read while preprocessing any variant, to watch for changes
+		std::vector<std::string> getFiles()const;
+
+		inline int getNumVariants()const { return (int)m_variants.size(); }
+		inline const ShaderVariantStats& getStats()const { return m_stats; }
+	private:
+		struct Variant {
+			ShaderDefines defines;
+			std::vector<std::string> files; //Read while preprocessing
+			int build = -1; //ShaderCompiler id while it's being built
+			int rebuild = -1; //ShaderCompiler id of a hot reload, swapped in once it's done
+			unsigned int program = 0;
+		};
+		Variant& findVariant(const ShaderDefines& defines);
+		//Preprocesses the variant's files again and starts building them. Sets build with a compiler, or program without one.
+		bool submitVariant(Variant& variant, int& build, unsigned int& program);
+
+		std::string m_vertexShader, m_fragmentShader;
+		ShaderCompiler* m_compiler;
+		std::unordered_map<uint64_t, Variant> m_variants;
+		ShaderVariantStats m_stats;
+	};
+}
@@ -1,6 +1,18 @@
 #include "texture.h"
 #include "external/glad.h"
-#include "external/stb_image.h"
+#include "halfFloat.h"
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <string.h>
+
+//S3TC is an extension, so glad was generated without it
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
 
 static int getTextureFormat(int numComponents) {
 	switch (numComponents) {
@@ -12,20 +24,34 @@ static int getTextureFormat(int numComponents) {
 		return GL_RG;
 	}
 }
+
+static int getCompressedFormat(ew::BCFormat format) {
+	switch (format) {
+	default:
+		return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	case ew::BCFormat::BC3:
+		return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	case ew::BCFormat::BC5:
+		return GL_COMPRESSED_RG_RGTC2;
+	case ew::BCFormat::BC7:
+		return GL_COMPRESSED_RGBA_BPTC_UNORM;
+	}
+}
 namespace ew {
 	unsigned int loadTexture(const char* filePath, int wrapMode, int filterMode) {
-		int width, height, numComponents;
-		unsigned char* data = stbi_load(filePath, &width, &height, &numComponents, 0);
-		if (data == NULL) {
-			printf("Failed to load image %s", filePath);
-			stbi_image_free(data);
+		Image image = loadImage(filePath);
+		if (!image.isValid()) {
 			return 0;
 		}
+		return uploadTexture(image, wrapMode, filterMode);
+	}
+
+	unsigned int uploadTexture(const Image& image, int wrapMode, int filterMode) {
 		unsigned int texture;
 		glGenTextures(1, &texture);
 		glBindTexture(GL_TEXTURE_2D, texture);
-		int format = getTextureFormat(numComponents);
-		glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+		int format = getTextureFormat(image.numComponents);
+		glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, image.pixels.data());
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapMode);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapMode);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
@@ -37,8 +63,255 @@ namespace ew {
 		glGenerateMipmap(GL_TEXTURE_2D);
 
 		glBindTexture(GL_TEXTURE_2D, NULL);
-		stbi_image_free(data);
 		return texture;
 	}
-}
 
+	unsigned int uploadTextureHDR(const FloatImage& image, HDRFormat format, int wrapMode, int filterMode, JobSystem* jobSystem,
+		HDRTextureStats* stats) {
+		if (!image.isValid()) {
+			return 0;
+		}
+		static const int PIXEL_FORMATS[4] = { GL_RED, GL_RG, GL_RGB, GL_RGBA };
+		static const int HALF_FORMATS[4] = { GL_R16F, GL_RG16F, GL_RGB16F, GL_RGBA16F };
+		static const int FLOAT_FORMATS[4] = { GL_R32F, GL_RG32F, GL_RGB32F, GL_RGBA32F };
+		int numComponents = std::min(std::max(image.numComponents, 1), 4);
+		size_t numPixels = (size_t)image.width * image.height;
+
+		//Rows are converted in bands, so each job has enough work to be worth handing out
+		auto start = std::chrono::high_resolution_clock::now();
+		const int BAND_ROWS = 16;
+		int numBands = (image.height + BAND_ROWS - 1) / BAND_ROWS;
+		size_t bandPixels = (size_t)BAND_ROWS * image.width;
+		std::vector<uint16_t> halves;
+		std::vector<uint32_t> packed;
+		std::function<void(int)> convertBand;
+		if (format == HDRFormat::HALF) {
+			halves.resize(numPixels * numComponents);
+			convertBand = [&](int band) {
+				size_t first = band * bandPixels;
+				size_t count = std::min(bandPixels, numPixels - first);
+				FloatToHalfArray(&image.pixels[first * numComponents], &halves[first * numComponents], count * numComponents);
+			};
+		}
+		else if (format == HDRFormat::R11G11B10F) {
+			packed.resize(numPixels);
+			convertBand = [&](int band) {
+				size_t first = band * bandPixels;
+				size_t count = std::min(bandPixels, numPixels - first);
+				PackR11G11B10FArray(&image.pixels[first * image.numComponents], image.numComponents, &packed[first], count);
+			};
+		}
+		if (convertBand) {
+			if (jobSystem) {
+				jobSystem->parallelFor(numBands, convertBand);
+			}
+			else {
+				for (int band = 0; band < numBands; band++) {
+					convertBand(band);
+				}
+			}
+		}
+		float convertMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+		unsigned int texture;
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		size_t gpuBytes = 0;
+		switch (format) {
+		case HDRFormat::HALF:
+			glTexImage2D(GL_TEXTURE_2D, 0, HALF_FORMATS[numComponents - 1], image.width, image.height, 0, PIXEL_FORMATS[numComponents - 1],
+				GL_HALF_FLOAT, halves.data());
+			gpuBytes = halves.size() * sizeof(uint16_t);
+			break;
+		case HDRFormat::R11G11B10F:
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_R11F_G11F_B10F, image.width, image.height, 0, GL_RGB, GL_UNSIGNED_INT_10F_11F_11F_REV, packed.data());
+			gpuBytes = packed.size() * sizeof(uint32_t);
+			break;
+		case HDRFormat::FLOAT:
+			glTexImage2D(GL_TEXTURE_2D, 0, FLOAT_FORMATS[numComponents - 1], image.width, image.height, 0, PIXEL_FORMATS[numComponents - 1],
+				GL_FLOAT, image.pixels.data());
+			gpuBytes = image.pixels.size() * sizeof(float);
+			break;
+		}
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapMode);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapMode);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filterMode);
+		glGenerateMipmap(GL_TEXTURE_2D);
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		if (stats) {
+			stats->convertMs = convertMs;
+			stats->sourceBytes = image.pixels.size() * sizeof(float);
+			stats->gpuBytes = gpuBytes;
+		}
+		return texture;
+	}
+
+	unsigned int loadTextureHDR(const char* filePath, HDRFormat format, int wrapMode, int filterMode, JobSystem* jobSystem,
+		HDRTextureStats* stats) {
+		auto start = std::chrono::high_resolution_clock::now();
+		FloatImage image = loadImageFloat(filePath);
+		if (stats) {
+			stats->loadMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		}
+		return uploadTextureHDR(image, format, wrapMode, filterMode, jobSystem, stats);
+	}
+
+	unsigned int uploadMipChain(const MipChain& chain, int wrapMode, int filterMode) {
+		if (!chain.isValid()) {
+			return 0;
+		}
+		unsigned int texture;
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		int format = getTextureFormat(chain.levels[0].numComponents);
+		//Small levels have rows that are not 4 byte aligned
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		for (size_t i = 0; i < chain.levels.size(); i++) {
+			const Image& level = chain.levels[i];
+			glTexImage2D(GL_TEXTURE_2D, (int)i, format, level.width, level.height, 0, format, GL_UNSIGNED_BYTE, level.pixels.data());
+		}
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (int)chain.levels.size() - 1);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapMode);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapMode);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filterMode);
+
+		glBindTexture(GL_TEXTURE_2D, 0);
+		return texture;
+	}
+
+	unsigned int uploadCompressedTexture(const CompressedTexture& texture, int wrapMode, int filterMode) {
+		if (!texture.isValid() || !isCompressedFormatSupported(texture.format)) {
+			return 0;
+		}
+		unsigned int handle;
+		glGenTextures(1, &handle);
+		glBindTexture(GL_TEXTURE_2D, handle);
+		int format = getCompressedFormat(texture.format);
+		for (size_t i = 0; i < texture.levels.size(); i++) {
+			const CompressedImage& level = texture.levels[i];
+			glCompressedTexImage2D(GL_TEXTURE_2D, (int)i, format, level.width, level.height, 0, (int)level.blocks.size(), level.blocks.data());
+		}
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (int)texture.levels.size() - 1);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrapMode);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapMode);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texture.levels.size() > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filterMode);
+
+		glBindTexture(GL_TEXTURE_2D, 0);
+		return handle;
+	}
+
+	bool isCompressedFormatSupported(BCFormat format) {
+		int numFormats = 0;
+		glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &numFormats);
+		std::vector<int> formats(numFormats);
+		if (numFormats > 0) {
+			glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
+		}
+		return std::find(formats.begin(), formats.end(), getCompressedFormat(format)) != formats.end();
+	}
+
+	bool hasGLExtension(const char* name) {
+		int numExtensions = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+		for (int i = 0; i < numExtensions; i++) {
+			const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+			if (extension && strcmp(extension, name) == 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	unsigned int uploadTextureContainer(const TextureContainer& container) {
+		if (!container.isOpen() || (container.isCompressed() && !isCompressedFormatSupported(container.getBCFormat()))) {
+			return 0;
+		}
+		const TextureContainerHeader& header = container.getHeader();
+		unsigned int texture;
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		int format = container.isCompressed() ? getCompressedFormat(container.getBCFormat()) : getTextureFormat(header.numComponents);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		for (int i = 0; i < container.getNumLevels(); i++) {
+			const TextureContainerLevel& level = container.getLevel(i);
+			if (container.isCompressed()) {
+				glCompressedTexImage2D(GL_TEXTURE_2D, i, format, level.width, level.height, 0, (int)level.size, container.getLevelData(i));
+			}
+			else {
+				glTexImage2D(GL_TEXTURE_2D, i, format, level.width, level.height, 0, format, GL_UNSIGNED_BYTE, container.getLevelData(i));
+			}
+		}
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		int minFilter = header.minFilter != 0 ? header.minFilter : GL_LINEAR_MIPMAP_LINEAR;
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, container.getNumLevels() - 1);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, header.wrapMode);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, header.wrapMode);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, header.magFilter);
+
+		glBindTexture(GL_TEXTURE_2D, 0);
+		return texture;
+	}
+
+	unsigned int loadTextureCached(const char* filePath, int wrapMode, int filterMode, TextureCacheSettings settings,
+		JobSystem* jobSystem, TextureCacheStats* stats) {
+		TextureCacheStats localStats;
+		stats = stats ? stats : &localStats;
+		settings.wrapMode = wrapMode;
+		settings.magFilter = filterMode;
+		if (settings.compress) {
+			//The format depends on the channel count, so check all the ones an image could need
+			settings.compress = isCompressedFormatSupported(BCFormat::BC1) && isCompressedFormatSupported(BCFormat::BC3)
+				&& isCompressedFormatSupported(BCFormat::BC5);
+		}
+		TextureContainer container;
+		if (!openTextureCached(filePath, settings, &container, jobSystem, stats)) {
+			return 0;
+		}
+		auto start = std::chrono::high_resolution_clock::now();
+		unsigned int texture = uploadTextureContainer(container);
+		stats->uploadMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		return texture;
+	}
+
+	size_t getTextureMemory(unsigned int texture) {
+		glBindTexture(GL_TEXTURE_2D, texture);
+		int maxLevel = 0;
+		glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, &maxLevel);
+		size_t bytes = 0;
+		for (int level = 0; level <= maxLevel; level++) {
+			int width = 0, height = 0;
+			glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_WIDTH, &width);
+			glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_HEIGHT, &height);
+			if (width == 0 || height == 0) {
+				break;
+			}
+			int compressed = 0;
+			glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_COMPRESSED, &compressed);
+			if (compressed) {
+				int size = 0;
+				glGetTexLevelParameteriv(GL_TEXTURE_2D, level, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &size);
+				bytes += size;
+				continue;
+			}
+			//Bits per channel of the format the driver actually picked
+			static const int SIZE_QUERIES[] = { GL_TEXTURE_RED_SIZE, GL_TEXTURE_GREEN_SIZE, GL_TEXTURE_BLUE_SIZE, GL_TEXTURE_ALPHA_SIZE, GL_TEXTURE_DEPTH_SIZE, GL_TEXTURE_STENCIL_SIZE };
+			int bits = 0;
+			for (int query : SIZE_QUERIES) {
+				int channelBits = 0;
+				glGetTexLevelParameteriv(GL_TEXTURE_2D, level, query, &channelBits);
+				bits += channelBits;
+			}
+			bytes += (size_t)width * height * ((bits + 7) / 8);
+		}
+		glBindTexture(GL_TEXTURE_2D, 0);
+		return bytes;
+	}
+}
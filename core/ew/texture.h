@@ -1,5 +1,52 @@
 #pragma once
+#include "image.h"
+#include "mipmap.h"
+#include "textureCompression.h"
+#include "textureContainer.h"
 
 namespace ew {
+	//How float images are stored on the GPU
+	enum class HDRFormat {
+		HALF = 0, //R16F to RGBA16F by channel count
+		R11G11B10F = 1, //RGB in 4 bytes per pixel, without sign or alpha. Mantissas are 6, 6 and 5 bits.
+		FLOAT = 2 //32 bit floats, as loaded
+	};
+
+	struct HDRTextureStats {
+		float loadMs = 0; //Decoding the file
+		float convertMs = 0; //Packing into the GPU format
+		size_t sourceBytes = 0; //Level 0 as floats
+		size_t gpuBytes = 0; //Level 0 in the GPU format
+	};
+
+	//Same signature as glfwGetProcAddress, for loading extension functions glad was generated without
+	typedef void (*GLProc)(void);
+	typedef GLProc(*GLProcLoader)(const char* name);
+
 	unsigned int loadTexture(const char* filePath, int wrapMode, int filterMode);
+	//Creates a mipmapped GL texture from pixels already in memory. Must be called on the thread with the GL context.
+	unsigned int uploadTexture(const Image& image, int wrapMode, int filterMode);
+	//Converts to the GPU format (in parallel rows if a job system is given) and uploads with generated mipmaps.
+	//R11G11B10F drops alpha and clamps negatives to 0.
+	unsigned int uploadTextureHDR(const FloatImage& image, HDRFormat format, int wrapMode, int filterMode, JobSystem* jobSystem = nullptr,
+		HDRTextureStats* stats = nullptr);
+	//loadTexture for .hdr and 16 bit images
+	unsigned int loadTextureHDR(const char* filePath, HDRFormat format, int wrapMode, int filterMode, JobSystem* jobSystem = nullptr,
+		HDRTextureStats* stats = nullptr);
+	//Uploads precomputed levels one by one instead of calling glGenerateMipmap
+	unsigned int uploadMipChain(const MipChain& chain, int wrapMode, int filterMode);
+	//Uploads block compressed levels as is. Returns 0 if the driver does not support the format.
+	unsigned int uploadCompressedTexture(const CompressedTexture& texture, int wrapMode, int filterMode);
+	//Checks the driver's compressed format list. BC5 and BC7 are core in GL 4.2, BC1 and BC3 need S3TC.
+	bool isCompressedFormatSupported(BCFormat format);
+	//Whether the driver lists an extension, e.g. "GL_ARB_texture_filter_anisotropic"
+	bool hasGLExtension(const char* name);
+	//Uploads every level straight from the container's mapping, with the wrap and filter modes stored in it
+	unsigned int uploadTextureContainer(const TextureContainer& container);
+	//Bytes of GPU memory used by every level of a texture, as reported by the driver
+	size_t getTextureMemory(unsigned int texture);
+	//loadTexture through a container cached in texturecache/, so later runs skip decoding and mip generation.
+	//Compression is turned off if the driver doesn't support the format.
+	unsigned int loadTextureCached(const char* filePath, int wrapMode, int filterMode, TextureCacheSettings settings = TextureCacheSettings(),
+		JobSystem* jobSystem = nullptr, TextureCacheStats* stats = nullptr);
 }
@@ -0,0 +1,775 @@
+#include "textureCompression.h"
+#include "textureContainer.h"
+#include "ewMath/ewMath.h"
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+#include <algorithm>
+
+namespace ew {
+	int BCBlockSize(BCFormat format)
+	{
+		return format == BCFormat::BC1 ? 8 : 16;
+	}
+
+	int BCNumComponents(BCFormat format)
+	{
+		switch (format) {
+		case BCFormat::BC1:
+			return 3;
+		case BCFormat::BC5:
+			return 2;
+		default:
+			return 4;
+		}
+	}
+
+	BCFormat ChooseBCFormat(int numComponents)
+	{
+		if (numComponents <= 2) {
+			return BCFormat::BC5;
+		}
+		return numComponents == 3 ? BCFormat::BC1 : BCFormat::BC3;
+	}
+
+	//4x4 pixels, always RGBA
+	struct Block {
+		unsigned char rgba[16][4];
+	};
+
+	static void loadBlock(const Image& image, int blockX, int blockY, Block* block) {
+		for (int i = 0; i < 16; i++) {
+			int x = std::min(blockX * 4 + (i & 3), image.width - 1);
+			int y = std::min(blockY * 4 + (i >> 2), image.height - 1);
+			const unsigned char* src = &image.pixels[((size_t)y * image.width + x) * image.numComponents];
+			unsigned char* dst = block->rgba[i];
+			dst[0] = dst[1] = dst[2] = 0;
+			dst[3] = 255;
+			for (int c = 0; c < image.numComponents && c < 4; c++) {
+				dst[c] = src[c];
+			}
+		}
+	}
+
+	//LSB first bit packing, as every BC format stores its fields
+	struct BitWriter {
+		unsigned char* out;
+		int position = 0;
+
+		void write(unsigned int value, int numBits) {
+			for (int i = 0; i < numBits; i++, position++) {
+				if ((value >> i) & 1) {
+					out[position >> 3] |= (unsigned char)(1 << (position & 7));
+				}
+			}
+		}
+	};
+
+	struct BitReader {
+		const unsigned char* in;
+		int position = 0;
+
+		unsigned int read(int numBits) {
+			unsigned int value = 0;
+			for (int i = 0; i < numBits; i++, position++) {
+				value |= ((in[position >> 3] >> (position & 7)) & 1u) << i;
+			}
+			return value;
+		}
+	};
+
+	/// <summary>
+	/// Mean and direction of greatest variance of a block's pixels, over the first numChannels channels.
+	/// Uses power iteration on the covariance matrix.
+	/// </summary>
+	static void principalAxis(const float points[16][4], int numChannels, float mean[4], float axis[4]) {
+		for (int c = 0; c < 4; c++) {
+			mean[c] = 0.0f;
+			for (int i = 0; i < 16; i++) {
+				mean[c] += points[i][c];
+			}
+			mean[c] /= 16.0f;
+		}
+		float covariance[4][4] = {};
+		for (int i = 0; i < 16; i++) {
+			for (int a = 0; a < numChannels; a++) {
+				for (int b = 0; b < numChannels; b++) {
+					covariance[a][b] += (points[i][a] - mean[a]) * (points[i][b] - mean[b]);
+				}
+			}
+		}
+		float v[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+		for (int iteration = 0; iteration < 8; iteration++) {
+			float next[4] = {};
+			float length = 0.0f;
+			for (int a = 0; a < numChannels; a++) {
+				for (int b = 0; b < numChannels; b++) {
+					next[a] += covariance[a][b] * v[b];
+				}
+				length = std::max(length, fabsf(next[a]));
+			}
+			if (length < 1e-6f) {
+				break;
+			}
+			for (int a = 0; a < numChannels; a++) {
+				v[a] = next[a] / length;
+			}
+		}
+		float length = 0.0f;
+		for (int c = 0; c < numChannels; c++) {
+			length += v[c] * v[c];
+		}
+		length = sqrtf(length);
+		for (int c = 0; c < 4; c++) {
+			axis[c] = c < numChannels && length > 0.0f ? v[c] / length : 0.0f;
+		}
+	}
+
+	/// <summary>
+	/// Endpoints at the extremes of the block along its principal axis, or the corners of its bounding box for FAST.
+	/// Returns them in end0 (high end) and end1 (low end).
+	/// </summary>
+	static void initialEndpoints(const float points[16][4], int numChannels, BCQuality quality, float end0[4], float end1[4]) {
+		float mean[4], axis[4];
+		principalAxis(points, numChannels, mean, axis);
+		if (quality == BCQuality::FAST) {
+			//Bounding box, with the diagonal flipped per channel to follow the axis
+			for (int c = 0; c < 4; c++) {
+				float lo = 255.0f, hi = 0.0f;
+				for (int i = 0; i < 16; i++) {
+					lo = std::min(lo, points[i][c]);
+					hi = std::max(hi, points[i][c]);
+				}
+				//Inset slightly, since the extremes are rarely worth matching exactly
+				float inset = (hi - lo) / 16.0f;
+				lo += inset;
+				hi -= inset;
+				end0[c] = axis[c] >= 0.0f ? hi : lo;
+				end1[c] = axis[c] >= 0.0f ? lo : hi;
+			}
+			return;
+		}
+		float tMin = 0.0f, tMax = 0.0f;
+		for (int i = 0; i < 16; i++) {
+			float t = 0.0f;
+			for (int c = 0; c < numChannels; c++) {
+				t += (points[i][c] - mean[c]) * axis[c];
+			}
+			tMin = std::min(tMin, t);
+			tMax = std::max(tMax, t);
+		}
+		for (int c = 0; c < 4; c++) {
+			end0[c] = ew::Clamp(mean[c] + axis[c] * tMax, 0.0f, 255.0f);
+			end1[c] = ew::Clamp(mean[c] + axis[c] * tMin, 0.0f, 255.0f);
+		}
+	}
+
+	/// <summary>
+	/// Least squares endpoints for fixed indices, where pixel i is end0 * weight[i] + end1 * (1 - weight[i]).
+	/// </summary>
+	/// <returns>False if every pixel uses the same weight</returns>
+	static bool leastSquaresEndpoints(const float points[16][4], const float weights[16], float end0[4], float end1[4]) {
+		float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+		float ax[4] = {}, bx[4] = {};
+		for (int i = 0; i < 16; i++) {
+			float a = weights[i];
+			float b = 1.0f - a;
+			aa += a * a;
+			ab += a * b;
+			bb += b * b;
+			for (int c = 0; c < 4; c++) {
+				ax[c] += a * points[i][c];
+				bx[c] += b * points[i][c];
+			}
+		}
+		float det = aa * bb - ab * ab;
+		if (fabsf(det) < 1e-6f) {
+			return false;
+		}
+		for (int c = 0; c < 4; c++) {
+			end0[c] = ew::Clamp((ax[c] * bb - bx[c] * ab) / det, 0.0f, 255.0f);
+			end1[c] = ew::Clamp((bx[c] * aa - ax[c] * ab) / det, 0.0f, 255.0f);
+		}
+		return true;
+	}
+
+	static int refinementCount(BCQuality quality) {
+		switch (quality) {
+		case BCQuality::FAST:
+			return 0;
+		case BCQuality::NORMAL:
+			return 1;
+		default:
+			return 4;
+		}
+	}
+
+	//---BC1---
+
+	static unsigned short packRGB565(const float color[4]) {
+		int r = (int)(ew::Clamp(color[0], 0.0f, 255.0f) * 31.0f / 255.0f + 0.5f);
+		int g = (int)(ew::Clamp(color[1], 0.0f, 255.0f) * 63.0f / 255.0f + 0.5f);
+		int b = (int)(ew::Clamp(color[2], 0.0f, 255.0f) * 31.0f / 255.0f + 0.5f);
+		return (unsigned short)((r << 11) | (g << 5) | b);
+	}
+
+	static void unpackRGB565(unsigned short color, int out[3]) {
+		int r = (color >> 11) & 31;
+		int g = (color >> 5) & 63;
+		int b = color & 31;
+		out[0] = (r << 3) | (r >> 2);
+		out[1] = (g << 2) | (g >> 4);
+		out[2] = (b << 3) | (b >> 2);
+	}
+
+	//Colors in index order. The 3 color mode has black (transparent in BC1) as index 3.
+	static void bc1Palette(unsigned short c0, unsigned short c1, bool fourColor, int palette[4][3]) {
+		unpackRGB565(c0, palette[0]);
+		unpackRGB565(c1, palette[1]);
+		for (int c = 0; c < 3; c++) {
+			if (fourColor) {
+				palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+			}
+			else {
+				palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+				palette[3][c] = 0;
+			}
+		}
+	}
+
+	//Picks the closest of the 4 colors for each pixel. Returns the total squared error.
+	static int bc1Indices(const Block& block, const int palette[4][3], unsigned int* indices) {
+		int error = 0;
+		*indices = 0;
+		for (int i = 0; i < 16; i++) {
+			int best = 0, bestError = INT32_MAX;
+			for (int p = 0; p < 4; p++) {
+				int dr = block.rgba[i][0] - palette[p][0];
+				int dg = block.rgba[i][1] - palette[p][1];
+				int db = block.rgba[i][2] - palette[p][2];
+				int e = dr * dr + dg * dg + db * db;
+				if (e < bestError) {
+					bestError = e;
+					best = p;
+				}
+			}
+			*indices |= (unsigned int)best << (i * 2);
+			error += bestError;
+		}
+		return error;
+	}
+
+	/// <summary>
+	/// Encodes a block's RGB as an 8 byte BC1 color block, always in 4 color mode so it is also valid inside BC3
+	/// </summary>
+	static void encodeBC1Color(const Block& block, BCQuality quality, unsigned char* out) {
+		float points[16][4];
+		for (int i = 0; i < 16; i++) {
+			for (int c = 0; c < 4; c++) {
+				points[i][c] = c < 3 ? block.rgba[i][c] : 0.0f;
+			}
+		}
+		float end0[4], end1[4];
+		initialEndpoints(points, 3, quality, end0, end1);
+
+		unsigned short bestC0 = packRGB565(end0), bestC1 = packRGB565(end1);
+		int palette[4][3];
+		bc1Palette(bestC0, bestC1, true, palette);
+		unsigned int bestIndices;
+		int bestError = bc1Indices(block, palette, &bestIndices);
+
+		//Index 0 is all end0, 1 is all end1, 2 and 3 are thirds in between
+		static const float INDEX_WEIGHTS[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+		unsigned int indices = bestIndices;
+		for (int iteration = 0; iteration < refinementCount(quality) && bestError > 0; iteration++) {
+			float weights[16];
+			for (int i = 0; i < 16; i++) {
+				weights[i] = INDEX_WEIGHTS[(indices >> (i * 2)) & 3];
+			}
+			if (!leastSquaresEndpoints(points, weights, end0, end1)) {
+				break;
+			}
+			unsigned short c0 = packRGB565(end0), c1 = packRGB565(end1);
+			bc1Palette(c0, c1, true, palette);
+			int error = bc1Indices(block, palette, &indices);
+			if (error < bestError) {
+				bestError = error;
+				bestIndices = indices;
+				bestC0 = c0;
+				bestC1 = c1;
+			}
+		}
+
+		//4 color mode requires c0 > c1. Swapping the endpoints swaps indices 0/1 and 2/3.
+		if (bestC0 < bestC1) {
+			std::swap(bestC0, bestC1);
+			bestIndices ^= 0x55555555;
+		}
+		else if (bestC0 == bestC1) {
+			bestIndices = 0;
+		}
+		memset(out, 0, 8);
+		BitWriter writer = { out };
+		writer.write(bestC0, 16);
+		writer.write(bestC1, 16);
+		writer.write(bestIndices, 32);
+	}
+
+	static void decodeBC1Color(const unsigned char* in, bool alwaysFourColor, unsigned char rgba[16][4]) {
+		BitReader reader = { in };
+		unsigned short c0 = (unsigned short)reader.read(16);
+		unsigned short c1 = (unsigned short)reader.read(16);
+		unsigned int indices = reader.read(32);
+		bool fourColor = alwaysFourColor || c0 > c1;
+		int palette[4][3];
+		bc1Palette(c0, c1, fourColor, palette);
+		for (int i = 0; i < 16; i++) {
+			int index = (indices >> (i * 2)) & 3;
+			for (int c = 0; c < 3; c++) {
+				rgba[i][c] = (unsigned char)palette[index][c];
+			}
+			rgba[i][3] = !fourColor && index == 3 ? 0 : 255;
+		}
+	}
+
+	//---BC4, used for BC3 alpha and both BC5 channels---
+
+	static void bc4Palette(int a0, int a1, int palette[8]) {
+		palette[0] = a0;
+		palette[1] = a1;
+		if (a0 > a1) {
+			for (int i = 1; i <= 6; i++) {
+				palette[i + 1] = ((7 - i) * a0 + i * a1 + 3) / 7;
+			}
+		}
+		else {
+			for (int i = 1; i <= 4; i++) {
+				palette[i + 1] = ((5 - i) * a0 + i * a1 + 2) / 5;
+			}
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+	}
+
+	static int bc4Indices(const unsigned char values[16], int a0, int a1, uint64_t* indices) {
+		int palette[8];
+		bc4Palette(a0, a1, palette);
+		int error = 0;
+		*indices = 0;
+		for (int i = 0; i < 16; i++) {
+			int best = 0, bestError = INT32_MAX;
+			for (int p = 0; p < 8; p++) {
+				int d = values[i] - palette[p];
+				if (d * d < bestError) {
+					bestError = d * d;
+					best = p;
+				}
+			}
+			*indices |= (uint64_t)best << (i * 3);
+			error += bestError;
+		}
+		return error;
+	}
+
+	/// <summary>
+	/// Encodes 16 single channel values as an 8 byte BC4 block.
+	/// NORMAL also tries the 6 value mode, which has exact 0 and 255. HIGH also searches around the min and max.
+	/// </summary>
+	static void encodeBC4(const unsigned char values[16], BCQuality quality, unsigned char* out) {
+		int lo = 255, hi = 0;
+		int innerLo = 255, innerHi = 0; //Ignoring 0 and 255, which the 6 value mode stores exactly
+		for (int i = 0; i < 16; i++) {
+			lo = std::min(lo, (int)values[i]);
+			hi = std::max(hi, (int)values[i]);
+			if (values[i] != 0 && values[i] != 255) {
+				innerLo = std::min(innerLo, (int)values[i]);
+				innerHi = std::max(innerHi, (int)values[i]);
+			}
+		}
+		int bestA0 = hi, bestA1 = lo;
+		uint64_t bestIndices;
+		int bestError = bc4Indices(values, bestA0, bestA1, &bestIndices);
+		auto tryEndpoints = [&](int a0, int a1) {
+			uint64_t indices;
+			int error = bc4Indices(values, a0, a1, &indices);
+			if (error < bestError) {
+				bestError = error;
+				bestIndices = indices;
+				bestA0 = a0;
+				bestA1 = a1;
+			}
+		};
+		if (quality != BCQuality::FAST && bestError > 0) {
+			if (innerLo <= innerHi) {
+				tryEndpoints(innerLo, innerHi);
+			}
+		}
+		if (quality == BCQuality::HIGH && bestError > 0) {
+			for (int d0 = 0; d0 <= 4; d0++) {
+				for (int d1 = 0; d1 <= 4; d1++) {
+					if (hi - d0 > lo + d1) {
+						tryEndpoints(hi - d0, lo + d1);
+					}
+				}
+			}
+		}
+		memset(out, 0, 8);
+		BitWriter writer = { out };
+		writer.write(bestA0, 8);
+		writer.write(bestA1, 8);
+		writer.write((unsigned int)(bestIndices & 0xFFFFFF), 24);
+		writer.write((unsigned int)(bestIndices >> 24), 24);
+	}
+
+	static void decodeBC4(const unsigned char* in, unsigned char values[16]) {
+		BitReader reader = { in };
+		int a0 = reader.read(8);
+		int a1 = reader.read(8);
+		int palette[8];
+		bc4Palette(a0, a1, palette);
+		for (int i = 0; i < 16; i++) {
+			values[i] = (unsigned char)palette[reader.read(3)];
+		}
+	}
+
+	//---BC7 mode 6: one subset, RGBA endpoints of 7 bits plus a p-bit, 4 bit indices---
+
+	static const int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	static void bc7Palette(const int e0[4], const int e1[4], int palette[16][4]) {
+		for (int i = 0; i < 16; i++) {
+			for (int c = 0; c < 4; c++) {
+				palette[i][c] = ((64 - BC7_WEIGHTS[i]) * e0[c] + BC7_WEIGHTS[i] * e1[c] + 32) >> 6;
+			}
+		}
+	}
+
+	static int bc7Indices(const Block& block, const int e0[4], const int e1[4], unsigned char indices[16]) {
+		int palette[16][4];
+		bc7Palette(e0, e1, palette);
+		int error = 0;
+		for (int i = 0; i < 16; i++) {
+			int best = 0, bestError = INT32_MAX;
+			for (int p = 0; p < 16; p++) {
+				int e = 0;
+				for (int c = 0; c < 4; c++) {
+					int d = block.rgba[i][c] - palette[p][c];
+					e += d * d;
+				}
+				if (e < bestError) {
+					bestError = e;
+					best = p;
+				}
+			}
+			indices[i] = (unsigned char)best;
+			error += bestError;
+		}
+		return error;
+	}
+
+	//Rounds an endpoint to 7 bits with the given p-bit as the lowest bit
+	static void bc7Quantize(const float endpoint[4], int pBit, int quantized[4], int expanded[4]) {
+		for (int c = 0; c < 4; c++) {
+			quantized[c] = std::min(std::max((int)((endpoint[c] - pBit) * 0.5f + 0.5f), 0), 127);
+			expanded[c] = (quantized[c] << 1) | pBit;
+		}
+	}
+
+	struct BC7Mode6 {
+		int q0[4], q1[4]; //7 bit endpoints
+		int p0, p1;
+		unsigned char indices[16];
+		int error = INT32_MAX;
+	};
+
+	//Tries every p-bit combination for a pair of endpoints, keeping the best in best
+	static void bc7TryEndpoints(const Block& block, const float end0[4], const float end1[4], BC7Mode6* best) {
+		for (int p0 = 0; p0 < 2; p0++) {
+			for (int p1 = 0; p1 < 2; p1++) {
+				BC7Mode6 candidate;
+				int e0[4], e1[4];
+				bc7Quantize(end0, p0, candidate.q0, e0);
+				bc7Quantize(end1, p1, candidate.q1, e1);
+				candidate.error = bc7Indices(block, e0, e1, candidate.indices);
+				if (candidate.error < best->error) {
+					candidate.p0 = p0;
+					candidate.p1 = p1;
+					*best = candidate;
+				}
+			}
+		}
+	}
+
+	static void encodeBC7(const Block& block, BCQuality quality, unsigned char* out) {
+		float points[16][4];
+		for (int i = 0; i < 16; i++) {
+			for (int c = 0; c < 4; c++) {
+				points[i][c] = block.rgba[i][c];
+			}
+		}
+		float end0[4], end1[4];
+		initialEndpoints(points, 4, quality, end0, end1);
+		BC7Mode6 best;
+		bc7TryEndpoints(block, end0, end1, &best);
+		for (int iteration = 0; iteration < refinementCount(quality) && best.error > 0; iteration++) {
+			//Index i blends from end0 at 0 to end1 at 15
+			float weights[16];
+			for (int i = 0; i < 16; i++) {
+				weights[i] = 1.0f - BC7_WEIGHTS[best.indices[i]] / 64.0f;
+			}
+			if (!leastSquaresEndpoints(points, weights, end0, end1)) {
+				break;
+			}
+			bc7TryEndpoints(block, end0, end1, &best);
+		}
+
+		//The first pixel's index is stored with 3 bits, so its top bit must be 0
+		if (best.indices[0] & 8) {
+			std::swap(best.q0, best.q1);
+			std::swap(best.p0, best.p1);
+			for (int i = 0; i < 16; i++) {
+				best.indices[i] = 15 - best.indices[i];
+			}
+		}
+		memset(out, 0, 16);
+		BitWriter writer = { out };
+		writer.write(1 << 6, 7);
+		for (int c = 0; c < 4; c++) {
+			writer.write(best.q0[c], 7);
+			writer.write(best.q1[c], 7);
+		}
+		writer.write(best.p0, 1);
+		writer.write(best.p1, 1);
+		writer.write(best.indices[0], 3);
+		for (int i = 1; i < 16; i++) {
+			writer.write(best.indices[i], 4);
+		}
+	}
+
+	//Only decodes mode 6, which is all the encoder writes. Other modes decode as transparent black.
+	static void decodeBC7(const unsigned char* in, unsigned char rgba[16][4]) {
+		memset(rgba, 0, 16 * 4);
+		if ((in[0] & 0x7F) != (1 << 6)) {
+			return;
+		}
+		BitReader reader = { in, 7 };
+		int e0[4], e1[4];
+		for (int c = 0; c < 4; c++) {
+			e0[c] = reader.read(7) << 1;
+			e1[c] = reader.read(7) << 1;
+		}
+		int p0 = reader.read(1);
+		int p1 = reader.read(1);
+		for (int c = 0; c < 4; c++) {
+			e0[c] |= p0;
+			e1[c] |= p1;
+		}
+		int palette[16][4];
+		bc7Palette(e0, e1, palette);
+		for (int i = 0; i < 16; i++) {
+			int index = reader.read(i == 0 ? 3 : 4);
+			for (int c = 0; c < 4; c++) {
+				rgba[i][c] = (unsigned char)palette[index][c];
+			}
+		}
+	}
+
+	//---Images---
+
+	static void encodeBlock(const Block& block, BCFormat format, BCQuality quality, unsigned char* out) {
+		unsigned char channel[16];
+		switch (format) {
+		case BCFormat::BC1:
+			encodeBC1Color(block, quality, out);
+			break;
+		case BCFormat::BC3:
+			for (int i = 0; i < 16; i++) {
+				channel[i] = block.rgba[i][3];
+			}
+			encodeBC4(channel, quality, out);
+			encodeBC1Color(block, quality, out + 8);
+			break;
+		case BCFormat::BC5:
+			for (int c = 0; c < 2; c++) {
+				for (int i = 0; i < 16; i++) {
+					channel[i] = block.rgba[i][c];
+				}
+				encodeBC4(channel, quality, out + c * 8);
+			}
+			break;
+		case BCFormat::BC7:
+			encodeBC7(block, quality, out);
+			break;
+		}
+	}
+
+	static void decodeBlock(const unsigned char* in, BCFormat format, unsigned char rgba[16][4]) {
+		unsigned char channel[16];
+		switch (format) {
+		case BCFormat::BC1:
+			decodeBC1Color(in, false, rgba);
+			break;
+		case BCFormat::BC3:
+			decodeBC1Color(in + 8, true, rgba);
+			decodeBC4(in, channel);
+			for (int i = 0; i < 16; i++) {
+				rgba[i][3] = channel[i];
+			}
+			break;
+		case BCFormat::BC5:
+			for (int c = 0; c < 2; c++) {
+				decodeBC4(in + c * 8, channel);
+				for (int i = 0; i < 16; i++) {
+					rgba[i][c] = channel[i];
+				}
+			}
+			for (int i = 0; i < 16; i++) {
+				rgba[i][2] = 0;
+				rgba[i][3] = 255;
+			}
+			break;
+		case BCFormat::BC7:
+			decodeBC7(in, rgba);
+			break;
+		}
+	}
+
+	CompressedImage CompressImage(const Image& image, BCFormat format, BCQuality quality, JobSystem* jobSystem)
+	{
+		CompressedImage compressed;
+		if (!image.isValid()) {
+			return compressed;
+		}
+		compressed.width = image.width;
+		compressed.height = image.height;
+		int blocksX = (image.width + 3) / 4;
+		int blocksY = (image.height + 3) / 4;
+		int blockSize = BCBlockSize(format);
+		compressed.blocks.resize((size_t)blocksX * blocksY * blockSize);
+		auto compressRow = [&](int blockY) {
+			Block block;
+			for (int blockX = 0; blockX < blocksX; blockX++) {
+				loadBlock(image, blockX, blockY, &block);
+				encodeBlock(block, format, quality, &compressed.blocks[((size_t)blockY * blocksX + blockX) * blockSize]);
+			}
+		};
+		if (jobSystem) {
+			jobSystem->parallelFor(blocksY, compressRow);
+		}
+		else {
+			for (int y = 0; y < blocksY; y++) {
+				compressRow(y);
+			}
+		}
+		return compressed;
+	}
+
+	Image DecompressImage(const CompressedImage& compressed, BCFormat format)
+	{
+		Image image;
+		image.width = compressed.width;
+		image.height = compressed.height;
+		image.numComponents = BCNumComponents(format);
+		image.pixels.resize((size_t)image.width * image.height * image.numComponents);
+		int blocksX = (image.width + 3) / 4;
+		int blocksY = (image.height + 3) / 4;
+		int blockSize = BCBlockSize(format);
+		if (compressed.blocks.size() < (size_t)blocksX * blocksY * blockSize) {
+			return Image();
+		}
+		for (int blockY = 0; blockY < blocksY; blockY++) {
+			for (int blockX = 0; blockX < blocksX; blockX++) {
+				unsigned char rgba[16][4];
+				decodeBlock(&compressed.blocks[((size_t)blockY * blocksX + blockX) * blockSize], format, rgba);
+				for (int i = 0; i < 16; i++) {
+					int x = blockX * 4 + (i & 3);
+					int y = blockY * 4 + (i >> 2);
+					if (x < image.width && y < image.height) {
+						memcpy(&image.pixels[((size_t)y * image.width + x) * image.numComponents], rgba[i], image.numComponents);
+					}
+				}
+			}
+		}
+		return image;
+	}
+
+	float ComputePSNR(const Image& a, const Image& b)
+	{
+		if (a.width != b.width || a.height != b.height || !a.isValid() || !b.isValid()) {
+			return 0.0f;
+		}
+		int numChannels = std::min(a.numComponents, b.numComponents);
+		double squaredError = 0.0;
+		size_t numPixels = (size_t)a.width * a.height;
+		for (size_t i = 0; i < numPixels; i++) {
+			for (int c = 0; c < numChannels; c++) {
+				double d = (double)a.pixels[i * a.numComponents + c] - b.pixels[i * b.numComponents + c];
+				squaredError += d * d;
+			}
+		}
+		double mse = squaredError / (numPixels * numChannels);
+		if (mse <= 0.0) {
+			return 99.0f; //Identical
+		}
+		return (float)(10.0 * log10(255.0 * 255.0 / mse));
+	}
+
+	CompressedTexture CompressMipChain(const MipChain& chain, BCFormat format, BCQuality quality, JobSystem* jobSystem)
+	{
+		CompressedTexture texture;
+		texture.format = format;
+		for (const Image& level : chain.levels) {
+			texture.levels.push_back(CompressImage(level, format, quality, jobSystem));
+		}
+		return texture;
+	}
+
+	CompressedTexture loadCompressedTextureCached(const char* imagePath, BCFormat format, BCQuality quality, bool flipVertically,
+		JobSystem* jobSystem, CompressionStats* stats)
+	{
+		CompressionStats localStats;
+		stats = stats ? stats : &localStats;
+		*stats = CompressionStats();
+		TextureCacheSettings settings;
+		settings.flipVertically = flipVertically;
+		settings.mipFilter = MipFilter::BOX;
+		settings.gammaCorrect = format != BCFormat::BC5;
+		settings.compress = true;
+		settings.bcFormat = (int)format;
+		settings.quality = quality;
+		TextureContainer container;
+		TextureCacheStats cacheStats;
+		CompressedTexture texture;
+		if (!openTextureCached(imagePath, settings, &container, jobSystem, &cacheStats)) {
+			return texture;
+		}
+		texture.format = format;
+		for (int i = 0; i < container.getNumLevels(); i++) {
+			const TextureContainerLevel& level = container.getLevel(i);
+			CompressedImage image;
+			image.width = (int)level.width;
+			image.height = (int)level.height;
+			image.blocks.assign(container.getLevelData(i), container.getLevelData(i) + level.size);
+			texture.levels.push_back(std::move(image));
+		}
+		stats->fromCache = cacheStats.fromCache;
+		stats->encodeMs = cacheStats.buildMs;
+		int sourceComponents = BCNumComponents(format);
+		if (!stats->fromCache) {
+			//The container only keeps the compressed result, so the source is decoded again to measure it
+			Image image = loadImage(imagePath, flipVertically);
+			if (image.isValid()) {
+				sourceComponents = image.numComponents;
+				stats->psnr = ComputePSNR(image, DecompressImage(texture.levels[0], format));
+			}
+		}
+		for (const CompressedImage& level : texture.levels) {
+			stats->uncompressedBytes += (size_t)level.width * level.height * sourceComponents;
+			stats->compressedBytes += level.blocks.size();
+		}
+		stats->loadMs = cacheStats.loadMs;
+		return texture;
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <vector>
+#include "image.h"
+#include "mipmap.h"
+#include "jobSystem.h"
+
+namespace ew {
+	//Block compressed formats. Every format stores 4x4 pixel blocks.
+	enum class BCFormat {
+		BC1 = 0, //RGB, 8 bytes per block
+		BC3 = 1, //RGBA, BC1 color plus a BC4 alpha block, 16 bytes per block
+		BC5 = 2, //RG, two BC4 blocks, 16 bytes per block. For normal maps.
+		BC7 = 3 //RGBA, 16 bytes per block. Only mode 6 is encoded.
+	};
+
+	//Trades encoding speed for quality
+	enum class BCQuality {
+		FAST = 0, //Bounding box endpoints
+		NORMAL = 1, //Principal axis endpoints with one least squares refinement
+		HIGH = 2 //Several refinements, keeping the best result
+	};
+
+	struct CompressedImage {
+		int width = 0;
+		int height = 0;
+		std::vector<unsigned char> blocks;
+	};
+
+	struct CompressedTexture {
+		BCFormat format = BCFormat::BC1;
+		std::vector<CompressedImage> levels; //Level 0 is the full size image
+
+		inline bool isValid()const { return !levels.empty() && !levels[0].blocks.empty(); }
+	};
+
+	struct CompressionStats {
+		float loadMs = 0; //Everything, including decoding or reading the cache
+		float encodeMs = 0; //Decoding, filtering and encoding, 0 when cached
+		float psnr = 0; //Level 0 against the source in dB, 0 when cached
+		size_t uncompressedBytes = 0; //All levels at the source's channel count
+		size_t compressedBytes = 0;
+		bool fromCache = false;
+	};
+
+	int BCBlockSize(BCFormat format);
+	//Channels the decoder produces. Image channels map to R, G, B, A in order, like the uncompressed upload.
+	int BCNumComponents(BCFormat format);
+	//BC5 for 1-2 channels, BC1 for RGB and BC3 for RGBA
+	BCFormat ChooseBCFormat(int numComponents);
+
+	//Compresses rows of blocks in parallel if a job system is given. Partial blocks at the edges repeat the last pixel.
+	CompressedImage CompressImage(const Image& image, BCFormat format, BCQuality quality, JobSystem* jobSystem = nullptr);
+	Image DecompressImage(const CompressedImage& compressed, BCFormat format);
+	//Peak signal to noise ratio over the channels both images have, in dB. Higher is better.
+	float ComputePSNR(const Image& a, const Image& b);
+
+	CompressedTexture CompressMipChain(const MipChain& chain, BCFormat format, BCQuality quality, JobSystem* jobSystem = nullptr);
+	//Copies compressed mips out of the image's texture container, which openTextureCached encodes if it's missing or stale.
+	//Mips are box filtered, in linear space for every format except BC5.
+	CompressedTexture loadCompressedTextureCached(const char* imagePath, BCFormat format, BCQuality quality, bool flipVertically,
+		JobSystem* jobSystem = nullptr, CompressionStats* stats = nullptr);
+}
@@ -0,0 +1,278 @@
+#include "textureContainer.h"
+#include "hash.h"
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
+namespace ew {
+	static const char TEXTURE_CONTAINER_MAGIC[4] = { 'E', 'W', 'T', 'X' };
+	static const uint32_t TEXTURE_CONTAINER_VERSION = 1;
+	static const uint64_t LEVEL_ALIGNMENT = 16;
+
+	//Bytes a level must hold: every pixel, or every 4x4 block
+	static uint64_t expectedLevelSize(const TextureContainerHeader& header, const TextureContainerLevel& level) {
+		if (header.bcFormat < 0) {
+			return (uint64_t)level.width * level.height * header.numComponents;
+		}
+		uint64_t numBlocks = (uint64_t)((level.width + 3) / 4) * ((level.height + 3) / 4);
+		return numBlocks * BCBlockSize((BCFormat)header.bcFormat);
+	}
+
+	bool TextureContainer::open(const char* filePath)
+	{
+		close();
+		if (!m_file.open(filePath)) {
+			return false;
+		}
+		const unsigned char* data = m_file.getData();
+		size_t size = m_file.getSize();
+		const TextureContainerHeader* header = (const TextureContainerHeader*)data;
+		bool valid = size >= sizeof(TextureContainerHeader)
+			&& memcmp(header->magic, TEXTURE_CONTAINER_MAGIC, 4) == 0
+			&& header->version == TEXTURE_CONTAINER_VERSION
+			&& header->numLevels >= 1 && header->numLevels <= 32
+			&& size >= sizeof(TextureContainerHeader) + header->numLevels * sizeof(TextureContainerLevel);
+		valid = valid && header->bcFormat >= -1 && header->bcFormat <= (int32_t)BCFormat::BC7
+			&& header->numComponents >= 1 && header->numComponents <= 4;
+		const TextureContainerLevel* levels = (const TextureContainerLevel*)(data + sizeof(TextureContainerHeader));
+		for (uint32_t i = 0; valid && i < header->numLevels; i++) {
+			valid = levels[i].width == std::max(header->width >> i, 1u) && levels[i].height == std::max(header->height >> i, 1u)
+				&& levels[i].size == expectedLevelSize(*header, levels[i])
+				&& levels[i].offset <= size && levels[i].size <= size - levels[i].offset;
+		}
+		if (!valid) {
+			printf("Invalid texture container %s\n", filePath);
+			m_file.close();
+			return false;
+		}
+		m_header = header;
+		m_levels = levels;
+		return true;
+	}
+
+	void TextureContainer::close()
+	{
+		m_file.close();
+		m_header = nullptr;
+		m_levels = nullptr;
+	}
+
+	bool getTextureSource(const char* filePath, bool hashContents, TextureSource* source)
+	{
+		std::error_code error;
+		std::filesystem::file_time_type time = std::filesystem::last_write_time(filePath, error);
+		if (error) {
+			return false;
+		}
+		source->time = (int64_t)time.time_since_epoch().count();
+		source->size = (uint64_t)std::filesystem::file_size(filePath, error);
+		if (error) {
+			return false;
+		}
+		source->hash = 0;
+		if (hashContents) {
+			MappedFile file;
+			if (!file.open(filePath)) {
+				return false;
+			}
+			source->hash = HashBytes(file.getData(), file.getSize());
+		}
+		return true;
+	}
+
+	uint64_t HashTextureCacheSettings(const TextureCacheSettings& settings)
+	{
+		//Field by field, so padding bytes don't end up in the hash
+		int fields[] = { settings.flipVertically, (int)settings.mipFilter, settings.gammaCorrect, settings.compress,
+			settings.compress ? settings.bcFormat : -1, (int)settings.quality, settings.wrapMode, settings.minFilter, settings.magFilter };
+		return HashBytes(fields, sizeof(fields));
+	}
+
+	std::string TextureCacheFilePath(const char* imagePath, uint64_t key, const char* extension)
+	{
+		//The path goes in the hash so images with the same name in different folders don't collide
+		char name[32];
+		snprintf(name, sizeof(name), ".%016llx", (unsigned long long)HashBytes(imagePath, strlen(imagePath), key));
+		return std::string(TEXTURE_CACHE_DIRECTORY) + "/" + std::filesystem::path(imagePath).filename().string() + name + extension;
+	}
+
+	std::string TextureCachePath(const char* imagePath, const TextureCacheSettings& settings)
+	{
+		return TextureCacheFilePath(imagePath, HashTextureCacheSettings(settings), ".ewtx");
+	}
+
+	TextureSourceMatch MatchTextureSource(const char* imagePath, const TextureSource& recorded, TextureSource* current)
+	{
+		if (!getTextureSource(imagePath, false, current)) {
+			return TextureSourceMatch::MISSING;
+		}
+		if (current->time == recorded.time && current->size == recorded.size) {
+			return TextureSourceMatch::SAME;
+		}
+		if (current->size != recorded.size || !getTextureSource(imagePath, true, current)) {
+			return TextureSourceMatch::CHANGED;
+		}
+		return current->hash == recorded.hash ? TextureSourceMatch::TOUCHED : TextureSourceMatch::CHANGED;
+	}
+
+	void updateCachedSourceTime(const char* cachePath, size_t offset, int64_t time)
+	{
+		FILE* file = fopen(cachePath, "r+b");
+		if (file == NULL) {
+			return;
+		}
+		fseek(file, (long)offset, SEEK_SET);
+		fwrite(&time, sizeof(time), 1, file);
+		fclose(file);
+	}
+
+	struct ContainerLevelData {
+		int width;
+		int height;
+		const unsigned char* data;
+		size_t size;
+	};
+
+	static bool writeContainer(const char* filePath, TextureContainerHeader header, const std::vector<ContainerLevelData>& levels) {
+		if (levels.empty()) {
+			return false;
+		}
+		std::error_code error;
+		std::filesystem::create_directories(std::filesystem::path(filePath).parent_path(), error);
+		FILE* file = fopen(filePath, "wb");
+		if (file == NULL) {
+			printf("Failed to write texture container %s\n", filePath);
+			return false;
+		}
+		memcpy(header.magic, TEXTURE_CONTAINER_MAGIC, 4);
+		header.version = TEXTURE_CONTAINER_VERSION;
+		header.width = levels[0].width;
+		header.height = levels[0].height;
+		header.numLevels = (uint32_t)levels.size();
+
+		std::vector<TextureContainerLevel> table(levels.size());
+		uint64_t offset = sizeof(TextureContainerHeader) + levels.size() * sizeof(TextureContainerLevel);
+		for (size_t i = 0; i < levels.size(); i++) {
+			offset = (offset + LEVEL_ALIGNMENT - 1) & ~(LEVEL_ALIGNMENT - 1);
+			table[i].width = levels[i].width;
+			table[i].height = levels[i].height;
+			table[i].offset = offset;
+			table[i].size = levels[i].size;
+			offset += levels[i].size;
+		}
+		fwrite(&header, sizeof(header), 1, file);
+		fwrite(table.data(), sizeof(TextureContainerLevel), table.size(), file);
+		uint64_t position = sizeof(TextureContainerHeader) + levels.size() * sizeof(TextureContainerLevel);
+		static const unsigned char padding[LEVEL_ALIGNMENT] = {};
+		for (size_t i = 0; i < levels.size(); i++) {
+			fwrite(padding, 1, (size_t)(table[i].offset - position), file);
+			fwrite(levels[i].data, 1, levels[i].size, file);
+			position = table[i].offset + table[i].size;
+		}
+		bool written = ferror(file) == 0;
+		fclose(file);
+		return written;
+	}
+
+	static TextureContainerHeader makeHeader(const TextureCacheSettings& settings, const TextureSource& source) {
+		TextureContainerHeader header = {};
+		header.wrapMode = settings.wrapMode;
+		header.minFilter = settings.minFilter;
+		header.magFilter = settings.magFilter;
+		header.settingsKey = HashTextureCacheSettings(settings);
+		header.sourceHash = source.hash;
+		header.sourceTime = source.time;
+		header.sourceSize = source.size;
+		return header;
+	}
+
+	bool saveTextureContainer(const char* filePath, const MipChain& chain, const TextureCacheSettings& settings, const TextureSource& source)
+	{
+		if (!chain.isValid()) {
+			return false;
+		}
+		TextureContainerHeader header = makeHeader(settings, source);
+		header.bcFormat = -1;
+		header.numComponents = chain.levels[0].numComponents;
+		std::vector<ContainerLevelData> levels;
+		for (const Image& level : chain.levels) {
+			levels.push_back({ level.width, level.height, level.pixels.data(), level.pixels.size() });
+		}
+		return writeContainer(filePath, header, levels);
+	}
+
+	bool saveTextureContainer(const char* filePath, const CompressedTexture& texture, const TextureCacheSettings& settings, const TextureSource& source)
+	{
+		if (!texture.isValid()) {
+			return false;
+		}
+		TextureContainerHeader header = makeHeader(settings, source);
+		header.bcFormat = (int32_t)texture.format;
+		header.numComponents = BCNumComponents(texture.format);
+		std::vector<ContainerLevelData> levels;
+		for (const CompressedImage& level : texture.levels) {
+			levels.push_back({ level.width, level.height, level.blocks.data(), level.blocks.size() });
+		}
+		return writeContainer(filePath, header, levels);
+	}
+
+	bool openTextureCached(const char* imagePath, const TextureCacheSettings& settings, TextureContainer* container,
+		JobSystem* jobSystem, TextureCacheStats* stats)
+	{
+		std::string cachePath = TextureCachePath(imagePath, settings);
+		TextureCacheStats localStats;
+		stats = stats ? stats : &localStats;
+		*stats = TextureCacheStats();
+		auto start = std::chrono::high_resolution_clock::now();
+
+		TextureSource source;
+		if (container->open(cachePath.c_str()) && container->getHeader().settingsKey == HashTextureCacheSettings(settings)) {
+			const TextureContainerHeader& header = container->getHeader();
+			TextureSource recorded;
+			recorded.hash = header.sourceHash;
+			recorded.time = header.sourceTime;
+			recorded.size = header.sourceSize;
+			TextureSourceMatch match = MatchTextureSource(imagePath, recorded, &source);
+			stats->hashed = match == TextureSourceMatch::TOUCHED;
+			stats->fromCache = match != TextureSourceMatch::CHANGED;
+			if (match == TextureSourceMatch::TOUCHED) {
+				//Can't write through the read only mapping
+				container->close();
+				updateCachedSourceTime(cachePath.c_str(), offsetof(TextureContainerHeader, sourceTime), source.time);
+				stats->fromCache = container->open(cachePath.c_str());
+			}
+		}
+		if (!stats->fromCache) {
+			container->close();
+			auto buildStart = std::chrono::high_resolution_clock::now();
+			Image image = loadImage(imagePath, settings.flipVertically);
+			//Stored so a later touch of the file can be told apart from an edit
+			stats->hashed = true;
+			if (!image.isValid() || !getTextureSource(imagePath, true, &source)) {
+				printf("Failed to load texture %s\n", imagePath);
+				return false;
+			}
+			bool gammaCorrect = settings.gammaCorrect;
+			BCFormat format = settings.bcFormat >= 0 ? (BCFormat)settings.bcFormat : ChooseBCFormat(image.numComponents);
+			if (settings.compress && format == BCFormat::BC5) {
+				//Two channel images are data, not color
+				gammaCorrect = false;
+			}
+			MipChain chain = BuildMipChain(image, settings.mipFilter, gammaCorrect, jobSystem);
+			bool saved = settings.compress
+				? saveTextureContainer(cachePath.c_str(), CompressMipChain(chain, format, settings.quality, jobSystem), settings, source)
+				: saveTextureContainer(cachePath.c_str(), chain, settings, source);
+			stats->buildMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - buildStart).count();
+			if (!saved || !container->open(cachePath.c_str())) {
+				return false;
+			}
+		}
+		stats->loadMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		return true;
+	}
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include "image.h"
+#include "mipmap.h"
+#include "textureCompression.h"
+#include "mappedFile.h"
+#include "jobSystem.h"
+
+namespace ew {
+	//File layout: header, one TextureContainerLevel per level, then each level's pixels 16 byte aligned
+	struct TextureContainerHeader {
+		char magic[4];
+		uint32_t version;
+		int32_t bcFormat; //BCFormat, or -1 for uncompressed 8 bit pixels
+		uint32_t numComponents; //Of the uncompressed pixels, or what the BC format decodes to
+		uint32_t width;
+		uint32_t height;
+		uint32_t numLevels;
+		//Defaults to upload with, as GL enums. 0 min filter picks trilinear if there are mips.
+		int32_t wrapMode;
+		int32_t minFilter;
+		int32_t magFilter;
+		uint64_t settingsKey; //Hash of the TextureCacheSettings the container was built with
+		//The source image the container was built from
+		uint64_t sourceHash;
+		int64_t sourceTime;
+		uint64_t sourceSize;
+	};
+
+	struct TextureContainerLevel {
+		uint32_t width;
+		uint32_t height;
+		uint64_t offset; //From the start of the file
+		uint64_t size;
+	};
+
+	/// <summary>
+	/// A mapped texture container. Level pixels point straight into the mapping and stay valid until it closes.
+	/// </summary>
+	class TextureContainer {
+	public:
+		//Checks the header and level table against the file size. Pixels are not read until they are used.
+		bool open(const char* filePath);
+		void close();
+
+		inline bool isOpen()const { return m_header != nullptr; }
+		inline const TextureContainerHeader& getHeader()const { return *m_header; }
+		inline bool isCompressed()const { return m_header->bcFormat >= 0; }
+		inline BCFormat getBCFormat()const { return (BCFormat)m_header->bcFormat; }
+		inline int getNumLevels()const { return (int)m_header->numLevels; }
+		inline const TextureContainerLevel& getLevel(int level)const { return m_levels[level]; }
+		inline const unsigned char* getLevelData(int level)const { return m_file.getData() + m_levels[level].offset; }
+	private:
+		MappedFile m_file;
+		const TextureContainerHeader* m_header = nullptr;
+		const TextureContainerLevel* m_levels = nullptr;
+	};
+
+	//Identifies the contents of a file
+	struct TextureSource {
+		uint64_t hash = 0;
+		int64_t time = 0;
+		uint64_t size = 0;
+	};
+	//Reads the file's time and size, and hashes its contents if hashContents is set
+	bool getTextureSource(const char* filePath, bool hashContents, TextureSource* source);
+
+	struct TextureCacheSettings {
+		bool flipVertically = false;
+		MipFilter mipFilter = MipFilter::BOX;
+		bool gammaCorrect = true;
+		bool compress = false;
+		int bcFormat = -1; //BCFormat to compress to, or -1 for ChooseBCFormat of the image's channel count
+		BCQuality quality = BCQuality::NORMAL;
+		//GL enums. 0 min filter picks trilinear.
+		int wrapMode = 0;
+		int minFilter = 0;
+		int magFilter = 0;
+	};
+
+	struct TextureCacheStats {
+		float loadMs = 0; //Everything, including building the container
+		float buildMs = 0; //Decoding, filtering and compressing, 0 when cached
+		float uploadMs = 0; //Set by loadTextureCached
+		bool fromCache = false;
+		bool hashed = false; //The source's time or size changed, so its contents were hashed
+	};
+
+	uint64_t HashTextureCacheSettings(const TextureCacheSettings& settings);
+
+	//Every file built from an image is cached here, relative to the working directory
+	const char* const TEXTURE_CACHE_DIRECTORY = "texturecache";
+	//A cache file for an image, named after the image and a hash of its path and key
+	std::string TextureCacheFilePath(const char* imagePath, uint64_t key, const char* extension);
+	//Where openTextureCached keeps the container for an image
+	std::string TextureCachePath(const char* imagePath, const TextureCacheSettings& settings);
+
+	enum class TextureSourceMatch {
+		SAME, //Time and size are as recorded
+		TOUCHED, //Only the time changed, and the contents hash the same. Record the new time with updateCachedSourceTime.
+		CHANGED,
+		MISSING //Can't be read, so whatever was cached is all there is
+	};
+	//Compares an image with the source recorded in a cache file built from it, hashing only if the time changed and the size didn't
+	TextureSourceMatch MatchTextureSource(const char* imagePath, const TextureSource& recorded, TextureSource* current);
+	//Overwrites the source time recorded at offset bytes into a cache file
+	void updateCachedSourceTime(const char* cachePath, size_t offset, int64_t time);
+
+	bool saveTextureContainer(const char* filePath, const MipChain& chain, const TextureCacheSettings& settings, const TextureSource& source);
+	bool saveTextureContainer(const char* filePath, const CompressedTexture& texture, const TextureCacheSettings& settings, const TextureSource& source);
+
+	//Maps the container cached for the image, rebuilding it if the settings or source changed.
+	//A source whose time or size changed is hashed, so touching a file without editing it doesn't rebuild.
+	//A container without its source image is used as is.
+	bool openTextureCached(const char* imagePath, const TextureCacheSettings& settings, TextureContainer* container,
+		JobSystem* jobSystem = nullptr, TextureCacheStats* stats = nullptr);
+}
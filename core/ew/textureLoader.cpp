@@ -0,0 +1,83 @@
+#include "textureLoader.h"
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+#include <ctype.h>
+
+namespace ew {
+	TextureLoader::TextureLoader(JobSystem* jobSystem)
+		:m_jobSystem(jobSystem)
+	{
+	}
+
+	TextureLoader::~TextureLoader()
+	{
+		//Jobs reference this loader, so they must finish first
+		waitAll();
+	}
+
+	void TextureLoader::request(const std::string& filePath, bool flipVertically)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_decoding++;
+		}
+		m_jobSystem->submit([this, filePath, flipVertically] {
+			auto start = std::chrono::high_resolution_clock::now();
+			DecodedImage decoded;
+			decoded.filePath = filePath;
+			decoded.image = loadImage(filePath.c_str(), flipVertically);
+			decoded.decodeMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			//Notify under the lock, since the loader may be destroyed as soon as waitAll() sees the count hit zero
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_finished.push_back(std::move(decoded));
+			m_decoding--;
+			m_decoded.notify_all();
+		});
+	}
+
+	bool TextureLoader::poll(DecodedImage* out)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_finished.empty()) {
+			return false;
+		}
+		*out = std::move(m_finished.front());
+		m_finished.pop_front();
+		return true;
+	}
+
+	void TextureLoader::waitAll()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_decoded.wait(lock, [this] { return m_decoding == 0; });
+	}
+
+	int TextureLoader::getNumPending()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_decoding + (int)m_finished.size();
+	}
+
+	std::vector<std::string> listImageFiles(const std::string& directory)
+	{
+		static const char* EXTENSIONS[] = { ".png", ".jpg", ".jpeg", ".bmp", ".tga", ".psd", ".gif", ".hdr", ".pic", ".ppm", ".pgm" };
+		std::vector<std::string> files;
+		std::error_code error;
+		for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(directory, error)) {
+			if (!entry.is_regular_file()) {
+				continue;
+			}
+			std::string extension = entry.path().extension().string();
+			std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)tolower(c); });
+			for (const char* supported : EXTENSIONS) {
+				if (extension == supported) {
+					files.push_back(entry.path().string());
+					break;
+				}
+			}
+		}
+		std::sort(files.begin(), files.end());
+		return files;
+	}
+}
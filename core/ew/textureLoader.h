@@ -0,0 +1,47 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include "image.h"
+#include "jobSystem.h"
+
+namespace ew {
+	//An image decoded off the main thread, waiting to be uploaded
+	struct DecodedImage {
+		std::string filePath;
+		Image image; //Invalid if decoding failed
+		float decodeMs = 0;
+	};
+
+	/// <summary>
+	/// Decodes many images at once on a JobSystem. GL calls have to stay on the thread that owns the context,
+	/// so finished pixels are queued and handed back through poll() for upload.
+	/// </summary>
+	class TextureLoader {
+	public:
+		TextureLoader(JobSystem* jobSystem);
+		//Waits for any decodes still running
+		~TextureLoader();
+		TextureLoader(const TextureLoader&) = delete;
+		TextureLoader& operator=(const TextureLoader&) = delete;
+
+		void request(const std::string& filePath, bool flipVertically = false);
+		//Moves out the next finished image, in completion order. Returns false if none are ready.
+		bool poll(DecodedImage* out);
+		//Blocks until every request has finished decoding
+		void waitAll();
+		//Requests that have not been polled yet
+		int getNumPending();
+	private:
+		JobSystem* m_jobSystem;
+		std::mutex m_mutex;
+		std::condition_variable m_decoded;
+		std::deque<DecodedImage> m_finished;
+		int m_decoding = 0;
+	};
+
+	//Paths of every file in a directory that stb_image can decode, sorted by name
+	std::vector<std::string> listImageFiles(const std::string& directory);
+}
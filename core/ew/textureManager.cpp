@@ -0,0 +1,176 @@
+#include "textureManager.h"
+#include "texture.h"
+#include "hash.h"
+#include "external/glad.h"
+#include <algorithm>
+
+namespace ew {
+	size_t TextureKeyHash::operator()(const TextureKey& key)const
+	{
+		uint64_t hash = HashBytes(key.filePath.data(), key.filePath.size());
+		int modes[2] = { key.wrapMode, key.filterMode };
+		hash = HashBytes(modes, sizeof(modes), hash);
+		return (size_t)HashBytes(key.variant.data(), key.variant.size(), hash);
+	}
+
+	TextureHandle::TextureHandle(TextureManager* manager, int slot)
+		: m_manager(manager), m_slot(slot)
+	{
+		m_manager->addRef(m_slot);
+	}
+
+	TextureHandle::~TextureHandle()
+	{
+		reset();
+	}
+
+	TextureHandle::TextureHandle(const TextureHandle& other)
+		: m_manager(other.m_manager), m_slot(other.m_slot)
+	{
+		if (m_manager) {
+			m_manager->addRef(m_slot);
+		}
+	}
+
+	TextureHandle& TextureHandle::operator=(const TextureHandle& other)
+	{
+		if (this != &other) {
+			//Add first, in case both refer to the same last reference
+			if (other.m_manager) {
+				other.m_manager->addRef(other.m_slot);
+			}
+			reset();
+			m_manager = other.m_manager;
+			m_slot = other.m_slot;
+		}
+		return *this;
+	}
+
+	TextureHandle::TextureHandle(TextureHandle&& other) noexcept
+		: m_manager(other.m_manager), m_slot(other.m_slot)
+	{
+		other.m_manager = nullptr;
+		other.m_slot = -1;
+	}
+
+	TextureHandle& TextureHandle::operator=(TextureHandle&& other) noexcept
+	{
+		if (this != &other) {
+			reset();
+			m_manager = other.m_manager;
+			m_slot = other.m_slot;
+			other.m_manager = nullptr;
+			other.m_slot = -1;
+		}
+		return *this;
+	}
+
+	unsigned int TextureHandle::get()const
+	{
+		return m_manager ? m_manager->m_entries[m_slot].texture : 0;
+	}
+
+	void TextureHandle::reset()
+	{
+		if (m_manager) {
+			m_manager->release(m_slot);
+		}
+		m_manager = nullptr;
+		m_slot = -1;
+	}
+
+	TextureManager::~TextureManager()
+	{
+		for (const Entry& entry : m_entries) {
+			if (entry.texture != 0) {
+				glDeleteTextures(1, &entry.texture);
+			}
+		}
+	}
+
+	TextureHandle TextureManager::load(const char* filePath, int wrapMode, int filterMode)
+	{
+		TextureKey key;
+		key.filePath = filePath;
+		key.wrapMode = wrapMode;
+		key.filterMode = filterMode;
+		TextureHandle existing = find(key);
+		if (existing.isValid()) {
+			return existing;
+		}
+		unsigned int texture = loadTexture(filePath, wrapMode, filterMode);
+		if (texture == 0) {
+			return TextureHandle();
+		}
+		return insert(key, texture);
+	}
+
+	TextureHandle TextureManager::insert(const TextureKey& key, unsigned int texture)
+	{
+		if (texture == 0) {
+			return TextureHandle();
+		}
+		auto found = m_lookup.find(key);
+		if (found != m_lookup.end()) {
+			if (m_entries[found->second].texture != texture) {
+				glDeleteTextures(1, &texture);
+			}
+			return TextureHandle(this, found->second);
+		}
+		int slot;
+		if (!m_freeSlots.empty()) {
+			slot = m_freeSlots.back();
+			m_freeSlots.pop_back();
+		}
+		else {
+			slot = (int)m_entries.size();
+			m_entries.emplace_back();
+		}
+		Entry& entry = m_entries[slot];
+		entry.key = key;
+		entry.texture = texture;
+		entry.bytes = getTextureMemory(texture);
+		entry.refCount = 0;
+		m_totalBytes += entry.bytes;
+		m_lookup[key] = slot;
+		return TextureHandle(this, slot);
+	}
+
+	TextureHandle TextureManager::find(const TextureKey& key)
+	{
+		auto found = m_lookup.find(key);
+		if (found == m_lookup.end()) {
+			return TextureHandle();
+		}
+		return TextureHandle(this, found->second);
+	}
+
+	std::vector<TextureInfo> TextureManager::getTextures()const
+	{
+		std::vector<TextureInfo> textures;
+		for (const auto& item : m_lookup) {
+			const Entry& entry = m_entries[item.second];
+			textures.push_back({ entry.key, entry.texture, entry.bytes, entry.refCount });
+		}
+		std::sort(textures.begin(), textures.end(), [](const TextureInfo& a, const TextureInfo& b) { return a.bytes > b.bytes; });
+		return textures;
+	}
+
+	void TextureManager::addRef(int slot)
+	{
+		m_entries[slot].refCount++;
+	}
+
+	void TextureManager::release(int slot)
+	{
+		Entry& entry = m_entries[slot];
+		if (--entry.refCount > 0) {
+			return;
+		}
+		glDeleteTextures(1, &entry.texture);
+		m_totalBytes -= entry.bytes;
+		m_lookup.erase(entry.key);
+		entry = Entry();
+		m_freeSlots.push_back(slot);
+	}
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace ew {
+	//What a texture was created with. Textures are only shared if every field matches.
+	struct TextureKey {
+		std::string filePath;
+		int wrapMode = 0;
+		int filterMode = 0;
+		std::string variant; //Tells apart textures made from the same file in other ways, e.g. "bc1"
+
+		inline bool operator==(const TextureKey& other)const {
+			return filePath == other.filePath && wrapMode == other.wrapMode && filterMode == other.filterMode && variant == other.variant;
+		}
+	};
+
+	struct TextureKeyHash {
+		size_t operator()(const TextureKey& key)const;
+	};
+
+	class TextureManager;
+
+	/// <summary>
+	/// Counted reference to a texture owned by a TextureManager. Copies share the texture,
+	/// and the last one to go away frees it. Must not outlive its manager.
+	/// </summary>
+	class TextureHandle {
+	public:
+		TextureHandle() = default;
+		~TextureHandle();
+		TextureHandle(const TextureHandle& other);
+		TextureHandle& operator=(const TextureHandle& other);
+		TextureHandle(TextureHandle&& other) noexcept;
+		TextureHandle& operator=(TextureHandle&& other) noexcept;
+
+		//GL texture name, 0 if the handle is empty
+		unsigned int get()const;
+		inline bool isValid()const { return m_manager != nullptr; }
+		void reset();
+	private:
+		friend class TextureManager;
+		TextureHandle(TextureManager* manager, int slot);
+
+		TextureManager* m_manager = nullptr;
+		int m_slot = -1;
+	};
+
+	struct TextureInfo {
+		TextureKey key;
+		unsigned int texture = 0;
+		size_t bytes = 0;
+		int refCount = 0;
+	};
+
+	/// <summary>
+	/// Registry of GL textures keyed by file and sampler settings, so repeated loads share one texture.
+	/// Tracks the GPU memory of each texture. All calls must be on the thread with the GL context.
+	/// </summary>
+	class TextureManager {
+	public:
+		TextureManager() = default;
+		//Frees every texture, including ones still referenced
+		~TextureManager();
+		TextureManager(const TextureManager&) = delete;
+		TextureManager& operator=(const TextureManager&) = delete;
+
+		//Returns the shared texture, calling loadTexture the first time. Empty handle if loading fails.
+		TextureHandle load(const char* filePath, int wrapMode, int filterMode);
+		//Takes ownership of a texture created some other way. If the key is already in use, texture is deleted and the existing one returned.
+		TextureHandle insert(const TextureKey& key, unsigned int texture);
+		//Empty handle if nothing has the key
+		TextureHandle find(const TextureKey& key);
+
+		inline size_t getTotalBytes()const { return m_totalBytes; }
+		inline int getNumTextures()const { return (int)m_lookup.size(); }
+		//Every live texture, largest first
+		std::vector<TextureInfo> getTextures()const;
+	private:
+		friend class TextureHandle;
+		void addRef(int slot);
+		void release(int slot);
+
+		struct Entry {
+			TextureKey key;
+			unsigned int texture = 0;
+			size_t bytes = 0;
+			int refCount = 0;
+		};
+		std::vector<Entry> m_entries;
+		std::vector<int> m_freeSlots;
+		std::unordered_map<TextureKey, int, TextureKeyHash> m_lookup;
+		size_t m_totalBytes = 0;
+	};
+}
@@ -0,0 +1,285 @@
+#include "textureTable.h"
+#include "external/glad.h"
+#include <stdio.h>
+#include <algorithm>
+
+namespace {
+	typedef GLuint64(GLAD_API_PTR* GetTextureHandleProc)(GLuint texture);
+	typedef GLuint64(GLAD_API_PTR* GetTextureSamplerHandleProc)(GLuint texture, GLuint sampler);
+	typedef void (GLAD_API_PTR* TextureHandleResidencyProc)(GLuint64 handle);
+}
+
+namespace ew {
+	TextureTable::~TextureTable()
+	{
+		destroy();
+	}
+
+	bool TextureTable::create(TextureTableBackend backend, int capacity, int firstUnit, GLProcLoader loader)
+	{
+		destroy();
+		if (capacity <= 0) {
+			return false;
+		}
+		switch (backend) {
+		case TextureTableBackend::MULTI_BIND: {
+			int maxUnits = 0;
+			glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &maxUnits);
+			if (firstUnit + capacity > maxUnits) {
+				printf("Texture table needs units %d-%d, driver has %d\n", firstUnit, firstUnit + capacity - 1, maxUnits);
+				return false;
+			}
+			break;
+		}
+		case TextureTableBackend::TEXTURE_ARRAY: {
+			int maxLayers = 0;
+			glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+			if (capacity > maxLayers) {
+				printf("Texture table needs %d layers, driver has %d\n", capacity, maxLayers);
+				return false;
+			}
+			break;
+		}
+		case TextureTableBackend::BINDLESS:
+			if (!loader || !hasGLExtension("GL_ARB_bindless_texture")) {
+				printf("Bindless textures are not supported\n");
+				return false;
+			}
+			m_getTextureHandle = loader("glGetTextureHandleARB");
+			m_getTextureSamplerHandle = loader("glGetTextureSamplerHandleARB");
+			m_makeResident = loader("glMakeTextureHandleResidentARB");
+			m_makeNonResident = loader("glMakeTextureHandleNonResidentARB");
+			if (!m_getTextureHandle || !m_getTextureSamplerHandle || !m_makeResident || !m_makeNonResident) {
+				printf("Failed to load ARB_bindless_texture functions\n");
+				return false;
+			}
+			m_handles.assign(capacity, 0);
+			glGenBuffers(1, &m_handleBuffer);
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_handleBuffer);
+			glBufferData(GL_SHADER_STORAGE_BUFFER, capacity * sizeof(uint64_t), m_handles.data(), GL_DYNAMIC_DRAW);
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+			break;
+		}
+		m_backend = backend;
+		m_capacity = capacity;
+		m_firstUnit = firstUnit;
+		m_textures.assign(capacity, 0);
+		m_samplers.assign(capacity, 0);
+		//Reversed, so slots are handed out from 0
+		for (int i = capacity - 1; i >= 0; i--) {
+			m_freeSlots.push_back(i);
+		}
+		m_dirty = true;
+		m_stats = TextureTableStats();
+		return true;
+	}
+
+	void TextureTable::destroy()
+	{
+		if (m_makeNonResident) {
+			for (uint64_t handle : m_handles) {
+				if (handle) {
+					((TextureHandleResidencyProc)m_makeNonResident)(handle);
+				}
+			}
+		}
+		if (m_handleBuffer) {
+			glDeleteBuffers(1, &m_handleBuffer);
+		}
+		if (m_array) {
+			glDeleteTextures(1, &m_array);
+		}
+		m_handleBuffer = m_array = 0;
+		m_arrayWidth = m_arrayHeight = m_arrayFormat = m_arrayLevels = 0;
+		m_getTextureHandle = m_getTextureSamplerHandle = m_makeResident = m_makeNonResident = nullptr;
+		m_handles.clear();
+		m_textures.clear();
+		m_samplers.clear();
+		m_freeSlots.clear();
+		m_capacity = 0;
+	}
+
+	int TextureTable::add(unsigned int texture, unsigned int sampler)
+	{
+		if (m_freeSlots.empty()) {
+			printf("Texture table is full (%d slots)\n", m_capacity);
+			return -1;
+		}
+		int index = m_freeSlots.back();
+		m_freeSlots.pop_back();
+		if (!assign(index, texture, sampler)) {
+			m_freeSlots.push_back(index);
+			return -1;
+		}
+		m_stats.slotsUsed++;
+		return index;
+	}
+
+	bool TextureTable::set(int index, unsigned int texture, unsigned int sampler)
+	{
+		if (index < 0 || index >= m_capacity || m_textures[index] == 0) {
+			return false;
+		}
+		return assign(index, texture, sampler);
+	}
+
+	bool TextureTable::assign(int index, unsigned int texture, unsigned int sampler)
+	{
+		if (m_backend == TextureTableBackend::TEXTURE_ARRAY && !copyToArray(index, texture)) {
+			return false;
+		}
+		if (m_backend == TextureTableBackend::BINDLESS) {
+			if (m_handles[index]) {
+				((TextureHandleResidencyProc)m_makeNonResident)(m_handles[index]);
+			}
+			m_handles[index] = sampler ? ((GetTextureSamplerHandleProc)m_getTextureSamplerHandle)(texture, sampler)
+				: ((GetTextureHandleProc)m_getTextureHandle)(texture);
+			((TextureHandleResidencyProc)m_makeResident)(m_handles[index]);
+		}
+		m_textures[index] = texture;
+		m_samplers[index] = sampler;
+		m_dirty = true;
+		return true;
+	}
+
+	void TextureTable::remove(int index)
+	{
+		if (index < 0 || index >= m_capacity || m_textures[index] == 0) {
+			return;
+		}
+		if (m_backend == TextureTableBackend::BINDLESS && m_handles[index]) {
+			((TextureHandleResidencyProc)m_makeNonResident)(m_handles[index]);
+			m_handles[index] = 0;
+		}
+		m_textures[index] = 0;
+		m_samplers[index] = 0;
+		m_freeSlots.push_back(index);
+		m_stats.slotsUsed--;
+		m_dirty = true;
+	}
+
+	void TextureTable::commit(bool force)
+	{
+		if ((!m_dirty && !force) || m_capacity == 0) {
+			return;
+		}
+		int calls = 0;
+		switch (m_backend) {
+		case TextureTableBackend::MULTI_BIND:
+			glBindTextures(m_firstUnit, m_capacity, m_textures.data());
+			glBindSamplers(m_firstUnit, m_capacity, m_samplers.data());
+			calls = 2;
+			break;
+		case TextureTableBackend::TEXTURE_ARRAY: {
+			auto sampler = std::find_if(m_samplers.begin(), m_samplers.end(), [](unsigned int s) { return s != 0; });
+			unsigned int arraySampler = sampler != m_samplers.end() ? *sampler : 0;
+			glBindTextures(m_firstUnit, 1, &m_array);
+			glBindSamplers(m_firstUnit, 1, &arraySampler);
+			calls = 2;
+			break;
+		}
+		case TextureTableBackend::BINDLESS:
+			//Handles only need uploading when they change. Otherwise just restore the binding.
+			if (m_dirty) {
+				glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_handleBuffer);
+				glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, m_capacity * sizeof(uint64_t), m_handles.data());
+				glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+				calls += 3;
+			}
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, m_firstUnit, m_handleBuffer);
+			calls++;
+			break;
+		}
+		m_dirty = false;
+		m_stats.commits++;
+		m_stats.glCalls += calls;
+	}
+
+	std::string TextureTable::getShaderSource()const
+	{
+		std::string binding = std::to_string(m_firstUnit);
+		switch (m_backend) {
+		case TextureTableBackend::TEXTURE_ARRAY:
+			return "layout(binding = " + binding + ") uniform sampler2DArray _TextureTable;\n"
+				"vec4 sampleTextureTable(int index, vec2 uv) { return texture(_TextureTable, vec3(uv, index)); }\n";
+		case TextureTableBackend::BINDLESS:
+			return "#extension GL_ARB_bindless_texture : require\n"
+				"layout(std430, binding = " + binding + ") readonly buffer _TextureTableHandles { uvec2 _TextureTable[]; };\n"
+				"vec4 sampleTextureTable(int index, vec2 uv) { return texture(sampler2D(_TextureTable[index]), uv); }\n";
+		default:
+			//Indexing a sampler array is fine as long as every invocation of a draw uses the same index
+			return "layout(binding = " + binding + ") uniform sampler2D _TextureTable[" + std::to_string(m_capacity) + "];\n"
+				"vec4 sampleTextureTable(int index, vec2 uv) { return texture(_TextureTable[index], uv); }\n";
+		}
+	}
+
+	//glTexStorage3D only takes sized formats, but textures made with glTexImage2D can report the unsized one they were given.
+	//Those are stored as 8 bits per channel, which is what these map to.
+	static int getSizedFormat(int format) {
+		switch (format) {
+		case GL_RED:
+			return GL_R8;
+		case GL_RG:
+			return GL_RG8;
+		case GL_RGB:
+			return GL_RGB8;
+		case GL_RGBA:
+			return GL_RGBA8;
+		default:
+			return format;
+		}
+	}
+
+	/// <summary>
+	/// Copies every level of a 2D texture into one layer of the array, creating the array to match the first texture.
+	/// </summary>
+	bool TextureTable::copyToArray(int index, unsigned int texture)
+	{
+		glBindTexture(GL_TEXTURE_2D, texture);
+		int width = 0, height = 0, format = 0;
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &format);
+		format = getSizedFormat(format);
+		//Levels that exist, down to 1x1 or the first one never uploaded
+		int levels = 0;
+		for (; levels < 32; levels++) {
+			int levelWidth = 0, levelHeight = 0;
+			glGetTexLevelParameteriv(GL_TEXTURE_2D, levels, GL_TEXTURE_WIDTH, &levelWidth);
+			glGetTexLevelParameteriv(GL_TEXTURE_2D, levels, GL_TEXTURE_HEIGHT, &levelHeight);
+			if (levelWidth == 0 || levelHeight == 0) {
+				break;
+			}
+			if (levelWidth == 1 && levelHeight == 1) {
+				levels++;
+				break;
+			}
+		}
+		glBindTexture(GL_TEXTURE_2D, 0);
+		if (levels == 0) {
+			return false;
+		}
+
+		if (m_array == 0) {
+			m_arrayWidth = width;
+			m_arrayHeight = height;
+			m_arrayFormat = format;
+			m_arrayLevels = levels;
+			glGenTextures(1, &m_array);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, m_array);
+			glTexStorage3D(GL_TEXTURE_2D_ARRAY, m_arrayLevels, m_arrayFormat, m_arrayWidth, m_arrayHeight, m_capacity);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		}
+		else if (width != m_arrayWidth || height != m_arrayHeight || format != m_arrayFormat) {
+			printf("Texture %u is %dx%d, format 0x%X, but the table's array is %dx%d, format 0x%X\n", texture, width, height, format,
+				m_arrayWidth, m_arrayHeight, m_arrayFormat);
+			return false;
+		}
+		for (int level = 0; level < std::min(levels, m_arrayLevels); level++) {
+			int levelWidth = std::max(width >> level, 1);
+			int levelHeight = std::max(height >> level, 1);
+			glCopyImageSubData(texture, GL_TEXTURE_2D, level, 0, 0, 0, m_array, GL_TEXTURE_2D_ARRAY, level, 0, 0, index, levelWidth, levelHeight, 1);
+		}
+		return true;
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "texture.h"
+
+namespace ew {
+	enum class TextureTableBackend {
+		MULTI_BIND = 0, //Slot i is texture unit firstUnit + i. Everything is bound with one glBindTextures call.
+		TEXTURE_ARRAY = 1, //Slot i is layer i of one array texture. Textures are copied in, so they must share size and format.
+		BINDLESS = 2 //Slot i is a resident ARB_bindless_texture handle in a storage buffer. Textures can't be changed once added.
+	};
+
+	struct TextureTableStats {
+		int commits = 0; //Commits that made GL calls
+		int glCalls = 0; //Binds and uploads made by commits
+		int slotsUsed = 0;
+	};
+
+	/// <summary>
+	/// Gives textures stable indices, so shaders pick a texture by index and a draw never rebinds units or
+	/// resets sampler uniforms. commit() pushes every change at once, in a single bind or buffer update.
+	/// All calls must be on the thread with the GL context.
+	/// </summary>
+	class TextureTable {
+	public:
+		TextureTable() = default;
+		~TextureTable();
+		TextureTable(const TextureTable&) = delete;
+		TextureTable& operator=(const TextureTable&) = delete;
+
+		//Fails if the driver lacks what the backend needs. For BINDLESS, firstUnit is the storage buffer binding
+		//and loader loads the ARB functions.
+		bool create(TextureTableBackend backend, int capacity, int firstUnit = 0, GLProcLoader loader = nullptr);
+		void destroy();
+
+		//Index of a new slot, reusing removed ones. -1 if the table is full or, for TEXTURE_ARRAY, the texture's
+		//level 0 size or format differs from the first one added. TEXTURE_ARRAY samples every layer with the first sampler.
+		int add(unsigned int texture, unsigned int sampler = 0);
+		//Replaces the texture in a slot that is in use, keeping its index
+		bool set(int index, unsigned int texture, unsigned int sampler = 0);
+		void remove(int index);
+		//Makes every slot visible to shaders. Does nothing if nothing changed, unless forced,
+		//e.g. for MULTI_BIND after something else bound its own textures.
+		void commit(bool force = false);
+
+		//GLSL declaring the table and `vec4 sampleTextureTable(int index, vec2 uv)` for this backend, to go right after #version.
+		//Needs GLSL 4.20, or 4.30 for BINDLESS.
+		std::string getShaderSource()const;
+		//Unit a MULTI_BIND slot is bound to, for shaders that use plain sampler uniforms
+		inline int getUnit(int index)const { return m_firstUnit + index; }
+		inline TextureTableBackend getBackend()const { return m_backend; }
+		inline int getCapacity()const { return m_capacity; }
+		inline unsigned int getTexture(int index)const { return m_textures[index]; }
+		inline const TextureTableStats& getStats()const { return m_stats; }
+	private:
+		bool assign(int index, unsigned int texture, unsigned int sampler);
+		bool copyToArray(int index, unsigned int texture);
+
+		TextureTableBackend m_backend = TextureTableBackend::MULTI_BIND;
+		int m_capacity = 0;
+		int m_firstUnit = 0;
+		bool m_dirty = false;
+		std::vector<unsigned int> m_textures; //0 for free slots
+		std::vector<unsigned int> m_samplers;
+		std::vector<int> m_freeSlots;
+
+		//TEXTURE_ARRAY
+		unsigned int m_array = 0;
+		int m_arrayWidth = 0;
+		int m_arrayHeight = 0;
+		int m_arrayFormat = 0;
+		int m_arrayLevels = 0;
+
+		//BINDLESS
+		unsigned int m_handleBuffer = 0;
+		std::vector<uint64_t> m_handles; //Resident handle per slot, 0 for free slots
+		//Cast to their real types where they are called
+		GLProc m_getTextureHandle = nullptr;
+		GLProc m_getTextureSamplerHandle = nullptr;
+		GLProc m_makeResident = nullptr;
+		GLProc m_makeNonResident = nullptr;
+
+		TextureTableStats m_stats;
+	};
+}
@@ -0,0 +1,477 @@
+#include "virtualTexture.h"
+#include "mipmap.h"
+#include "hash.h"
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <filesystem>
+
+namespace ew {
+	static const char VIRTUAL_TEXTURE_MAGIC[4] = { 'E', 'W', 'V', 'T' };
+	static const uint32_t VIRTUAL_TEXTURE_VERSION = 2;
+
+	static PageId pageFromKey(uint32_t key) {
+		PageId page;
+		page.mip = (int)(key >> 24);
+		page.y = (int)((key >> 12) & 0xFFF);
+		page.x = (int)(key & 0xFFF);
+		return page;
+	}
+
+	//Copies one page of a level, including its border, clamping at the level's edges
+	static void copyPage(const Image& level, int pageX, int pageY, int pageSize, int border, unsigned char* out) {
+		int size = pageSize + border * 2;
+		for (int y = 0; y < size; y++) {
+			int sourceY = std::min(std::max(pageY * pageSize + y - border, 0), level.height - 1);
+			for (int x = 0; x < size; x++) {
+				int sourceX = std::min(std::max(pageX * pageSize + x - border, 0), level.width - 1);
+				memcpy(out, &level.pixels[((size_t)sourceY * level.width + sourceX) * 4], 4);
+				out += 4;
+			}
+		}
+	}
+
+	bool saveVirtualTexture(const char* filePath, const Image& image, int pageSize, int border, JobSystem* jobSystem,
+		const TextureSource& source)
+	{
+		if (!image.isValid() || pageSize <= 0 || border < 0) {
+			return false;
+		}
+		//Pages are always RGBA
+		Image rgba;
+		rgba.width = image.width;
+		rgba.height = image.height;
+		rgba.numComponents = 4;
+		rgba.pixels.resize((size_t)image.width * image.height * 4);
+		for (size_t i = 0; i < (size_t)image.width * image.height; i++) {
+			unsigned char* dst = &rgba.pixels[i * 4];
+			const unsigned char* src = &image.pixels[i * image.numComponents];
+			dst[0] = dst[1] = dst[2] = 0;
+			dst[3] = 255;
+			for (int c = 0; c < image.numComponents && c < 4; c++) {
+				dst[c] = src[c];
+			}
+		}
+		MipChain chain = BuildMipChain(rgba, MipFilter::BOX, true, jobSystem);
+		size_t numLevels = 0;
+		while (numLevels < chain.levels.size()) {
+			const Image& level = chain.levels[numLevels++];
+			if (level.width <= pageSize && level.height <= pageSize) {
+				break;
+			}
+		}
+
+		FILE* file = fopen(filePath, "wb");
+		if (file == NULL) {
+			printf("Failed to write virtual texture %s\n", filePath);
+			return false;
+		}
+		VirtualTextureHeader header = {};
+		memcpy(header.magic, VIRTUAL_TEXTURE_MAGIC, 4);
+		header.version = VIRTUAL_TEXTURE_VERSION;
+		header.width = image.width;
+		header.height = image.height;
+		header.pageSize = pageSize;
+		header.border = border;
+		header.numLevels = (uint32_t)numLevels;
+		header.sourceHash = source.hash;
+		header.sourceTime = source.time;
+		header.sourceSize = source.size;
+		std::vector<VirtualTextureLevel> levels(numLevels);
+		uint32_t firstPage = 0;
+		for (size_t i = 0; i < numLevels; i++) {
+			levels[i].width = chain.levels[i].width;
+			levels[i].height = chain.levels[i].height;
+			levels[i].pagesX = (levels[i].width + pageSize - 1) / pageSize;
+			levels[i].pagesY = (levels[i].height + pageSize - 1) / pageSize;
+			levels[i].firstPage = firstPage;
+			firstPage += levels[i].pagesX * levels[i].pagesY;
+		}
+		fwrite(&header, sizeof(header), 1, file);
+		fwrite(levels.data(), sizeof(VirtualTextureLevel), levels.size(), file);
+
+		size_t pageBytes = (size_t)(pageSize + border * 2) * (pageSize + border * 2) * 4;
+		std::vector<unsigned char> pages;
+		for (size_t i = 0; i < numLevels; i++) {
+			const VirtualTextureLevel& level = levels[i];
+			pages.resize(pageBytes * level.pagesX * level.pagesY);
+			auto copyRow = [&](int pageY) {
+				for (uint32_t pageX = 0; pageX < level.pagesX; pageX++) {
+					copyPage(chain.levels[i], pageX, pageY, pageSize, border, &pages[((size_t)pageY * level.pagesX + pageX) * pageBytes]);
+				}
+			};
+			if (jobSystem) {
+				jobSystem->parallelFor(level.pagesY, copyRow);
+			}
+			else {
+				for (uint32_t pageY = 0; pageY < level.pagesY; pageY++) {
+					copyRow(pageY);
+				}
+			}
+			fwrite(pages.data(), 1, pages.size(), file);
+		}
+		bool written = ferror(file) == 0;
+		fclose(file);
+		return written;
+	}
+
+	std::string buildVirtualTextureCached(const char* imagePath, int pageSize, int border, JobSystem* jobSystem)
+	{
+		int layout[2] = { pageSize, border };
+		std::string cachePath = TextureCacheFilePath(imagePath, HashBytes(layout, sizeof(layout)), ".vtex");
+		//Only the header is needed to tell if the pages are current
+		VirtualTextureHeader header;
+		FILE* file = fopen(cachePath.c_str(), "rb");
+		bool valid = file != NULL && fread(&header, sizeof(header), 1, file) == 1
+			&& memcmp(header.magic, VIRTUAL_TEXTURE_MAGIC, 4) == 0
+			&& header.version == VIRTUAL_TEXTURE_VERSION
+			&& header.pageSize == (uint32_t)pageSize && header.border == (uint32_t)border;
+		if (file != NULL) {
+			fclose(file);
+		}
+		TextureSource source;
+		if (valid) {
+			TextureSource recorded;
+			recorded.hash = header.sourceHash;
+			recorded.time = header.sourceTime;
+			recorded.size = header.sourceSize;
+			TextureSourceMatch match = MatchTextureSource(imagePath, recorded, &source);
+			if (match == TextureSourceMatch::TOUCHED) {
+				updateCachedSourceTime(cachePath.c_str(), offsetof(VirtualTextureHeader, sourceTime), source.time);
+			}
+			if (match != TextureSourceMatch::CHANGED) {
+				return cachePath;
+			}
+		}
+		Image image = loadImage(imagePath);
+		std::error_code error;
+		std::filesystem::create_directories(TEXTURE_CACHE_DIRECTORY, error);
+		if (!getTextureSource(imagePath, true, &source) || !saveVirtualTexture(cachePath.c_str(), image, pageSize, border, jobSystem, source)) {
+			return std::string();
+		}
+		return cachePath;
+	}
+
+	VirtualTexture::VirtualTexture(JobSystem* jobSystem)
+		:m_jobSystem(jobSystem)
+	{
+	}
+
+	VirtualTexture::~VirtualTexture()
+	{
+		//Jobs reference this texture and its mapping, so they must finish first
+		waitAll();
+	}
+
+	void VirtualTexture::waitAll()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_loaded.wait(lock, [this] { return m_loading == 0; });
+	}
+
+	bool VirtualTexture::open(const char* filePath, const VirtualTextureSettings& settings)
+	{
+		waitAll();
+		m_finished.clear();
+		m_pending.clear();
+		m_feedback.clear();
+		m_pageTable.clear();
+		m_lru.clear();
+		m_freeSlots.clear();
+		m_dirtySlots.clear();
+		m_levels.clear();
+		m_stats = VirtualTextureStats();
+		m_totalLoadMs = 0;
+		m_totalLoads = 0;
+		m_settings = settings;
+
+		if (!m_file.open(filePath)) {
+			printf("Failed to open virtual texture %s\n", filePath);
+			return false;
+		}
+		const VirtualTextureHeader* header = (const VirtualTextureHeader*)m_file.getData();
+		bool valid = m_file.getSize() >= sizeof(VirtualTextureHeader)
+			&& memcmp(header->magic, VIRTUAL_TEXTURE_MAGIC, 4) == 0
+			&& header->version == VIRTUAL_TEXTURE_VERSION
+			&& header->numLevels >= 1 && header->numLevels <= 32 && header->pageSize > 0
+			&& m_file.getSize() >= sizeof(VirtualTextureHeader) + header->numLevels * sizeof(VirtualTextureLevel);
+		if (valid) {
+			const VirtualTextureLevel* levels = (const VirtualTextureLevel*)(m_file.getData() + sizeof(VirtualTextureHeader));
+			m_levels.assign(levels, levels + header->numLevels);
+			m_pageSize = header->pageSize;
+			m_border = header->border;
+			m_pageBytes = (size_t)(m_pageSize + m_border * 2) * (m_pageSize + m_border * 2) * 4;
+			m_dataOffset = sizeof(VirtualTextureHeader) + m_levels.size() * sizeof(VirtualTextureLevel);
+			const VirtualTextureLevel& last = m_levels.back();
+			size_t numPages = last.firstPage + last.pagesX * last.pagesY;
+			valid = m_file.getSize() >= m_dataOffset + numPages * m_pageBytes && last.pagesX * last.pagesY == 1;
+		}
+		if (!valid) {
+			printf("Invalid virtual texture %s\n", filePath);
+			m_file.close();
+			m_levels.clear();
+			return false;
+		}
+
+		//The pinned page plus at least one more
+		int capacity = std::max((int)(settings.budgetBytes / m_pageBytes), 2);
+		int slotSize = m_pageSize + m_border * 2;
+		m_slotsPerRow = (int)ceilf(sqrtf((float)capacity));
+		m_physical.width = m_slotsPerRow * slotSize;
+		m_physical.height = (capacity + m_slotsPerRow - 1) / m_slotsPerRow * slotSize;
+		m_physical.numComponents = 4;
+		m_physical.pixels.assign((size_t)m_physical.width * m_physical.height * 4, 0);
+		m_slots.assign(capacity, Slot());
+		for (int i = capacity - 1; i >= 0; i--) {
+			m_freeSlots.push_back(i);
+		}
+		m_stats.capacityPages = capacity;
+
+		LoadedPage pinned;
+		pinned.page.mip = (int)m_levels.size() - 1;
+		pinned.pixels.assign(m_file.getData() + m_dataOffset + m_levels.back().firstPage * m_pageBytes,
+			m_file.getData() + m_dataOffset + (m_levels.back().firstPage + 1) * m_pageBytes);
+		place(pinned);
+		m_slots[m_pageTable[pinned.page.key()]].pinned = true;
+		m_lru.erase(m_slots[m_pageTable[pinned.page.key()]].lruPosition);
+		return true;
+	}
+
+	void VirtualTexture::addFeedback(PageId page)
+	{
+		if (page.mip < 0 || page.mip >= (int)m_levels.size()) {
+			return;
+		}
+		const VirtualTextureLevel& level = m_levels[page.mip];
+		if (page.x < 0 || page.y < 0 || page.x >= (int)level.pagesX || page.y >= (int)level.pagesY) {
+			return;
+		}
+		m_feedback.insert(page.key());
+	}
+
+	static PageId pageAt(const std::vector<VirtualTextureLevel>& levels, int pageSize, const ew::Vec2& uv, int mip) {
+		const VirtualTextureLevel& level = levels[mip];
+		float u = uv.x - floorf(uv.x);
+		float v = uv.y - floorf(uv.y);
+		PageId page;
+		page.mip = mip;
+		page.x = std::min((int)(u * level.width) / pageSize, (int)level.pagesX - 1);
+		page.y = std::min((int)(v * level.height) / pageSize, (int)level.pagesY - 1);
+		return page;
+	}
+
+	//The page one level coarser covering the same texels. Levels round their size down, so the last page of an odd sized
+	//level can map past the end of the parent's pages.
+	static PageId parentPage(const std::vector<VirtualTextureLevel>& levels, PageId page) {
+		page.mip++;
+		if (page.mip < (int)levels.size()) {
+			page.x = std::min(page.x / 2, (int)levels[page.mip].pagesX - 1);
+			page.y = std::min(page.y / 2, (int)levels[page.mip].pagesY - 1);
+		}
+		return page;
+	}
+
+	void VirtualTexture::addFeedback(const ew::Vec2& uv, float mip)
+	{
+		if (m_levels.empty()) {
+			return;
+		}
+		int level = std::min(std::max((int)floorf(mip), 0), (int)m_levels.size() - 1);
+		addFeedback(pageAt(m_levels, m_pageSize, uv, level));
+	}
+
+	void VirtualTexture::touch(int slot)
+	{
+		Slot& s = m_slots[slot];
+		s.lastUsedFrame = m_stats.frame;
+		if (!s.pinned) {
+			m_lru.splice(m_lru.begin(), m_lru, s.lruPosition);
+		}
+	}
+
+	int VirtualTexture::allocateSlot()
+	{
+		if (!m_freeSlots.empty()) {
+			int slot = m_freeSlots.back();
+			m_freeSlots.pop_back();
+			return slot;
+		}
+		//Least recently used, unless even that one is needed this frame
+		if (m_lru.empty() || m_slots[m_lru.back()].lastUsedFrame >= m_stats.frame) {
+			return -1;
+		}
+		int slot = m_lru.back();
+		m_lru.pop_back();
+		m_pageTable.erase(m_slots[slot].page.key());
+		m_slots[slot].occupied = false;
+		m_stats.evictions++;
+		return slot;
+	}
+
+	void VirtualTexture::place(LoadedPage& loaded)
+	{
+		int slot = allocateSlot();
+		if (slot < 0) {
+			m_stats.dropped++;
+			return;
+		}
+		Slot& s = m_slots[slot];
+		s.page = loaded.page;
+		s.occupied = true;
+		s.pinned = false;
+		s.lastUsedFrame = m_stats.frame;
+		m_lru.push_front(slot);
+		s.lruPosition = m_lru.begin();
+		m_pageTable[loaded.page.key()] = slot;
+
+		int slotSize = m_pageSize + m_border * 2;
+		int originX = slot % m_slotsPerRow * slotSize;
+		int originY = slot / m_slotsPerRow * slotSize;
+		for (int y = 0; y < slotSize; y++) {
+			memcpy(&m_physical.pixels[((size_t)(originY + y) * m_physical.width + originX) * 4],
+				&loaded.pixels[(size_t)y * slotSize * 4], (size_t)slotSize * 4);
+		}
+		m_dirtySlots.push_back(slot);
+	}
+
+	void VirtualTexture::requestLoad(PageId page)
+	{
+		if (page.mip < 0 || page.mip >= (int)m_levels.size()) {
+			return;
+		}
+		const VirtualTextureLevel& level = m_levels[page.mip];
+		if (page.x < 0 || page.y < 0 || page.x >= (int)level.pagesX || page.y >= (int)level.pagesY) {
+			printf("Virtual texture page %d,%d of level %d is out of range\n", page.x, page.y, page.mip);
+			return;
+		}
+		const unsigned char* source = m_file.getData() + m_dataOffset
+			+ (level.firstPage + (size_t)page.y * level.pagesX + page.x) * m_pageBytes;
+		size_t pageBytes = m_pageBytes;
+		float latencyMs = m_settings.simulatedLatencyMs;
+		m_pending.insert(page.key());
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_loading++;
+		}
+		m_stats.loadsIssued++;
+		m_jobSystem->submit([this, page, source, pageBytes, latencyMs] {
+			auto start = std::chrono::high_resolution_clock::now();
+			if (latencyMs > 0) {
+				std::this_thread::sleep_for(std::chrono::duration<float, std::milli>(latencyMs));
+			}
+			LoadedPage loaded;
+			loaded.page = page;
+			//Reading the mapping is what pulls the page off disk
+			loaded.pixels.assign(source, source + pageBytes);
+			loaded.loadMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			//Notify under the lock, since the texture may be destroyed as soon as waitAll() sees the count hit zero
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_finished.push_back(std::move(loaded));
+			m_loading--;
+			m_loaded.notify_all();
+		});
+	}
+
+	void VirtualTexture::update()
+	{
+		if (m_levels.empty()) {
+			return;
+		}
+		m_stats.frame++;
+		m_stats.requested = (int)m_feedback.size();
+		m_stats.hits = 0;
+		m_stats.misses = 0;
+		m_stats.loadsIssued = 0;
+		m_stats.loadsCompleted = 0;
+		m_stats.evictions = 0;
+		m_stats.dropped = 0;
+
+		//Touch everything sampled, and whatever is missing along with its missing parents
+		std::vector<PageId> missing;
+		std::unordered_set<uint32_t> missingKeys;
+		for (uint32_t key : m_feedback) {
+			auto found = m_pageTable.find(key);
+			if (found != m_pageTable.end()) {
+				m_stats.hits++;
+				touch(found->second);
+				continue;
+			}
+			m_stats.misses++;
+			for (PageId page = pageFromKey(key); page.mip < (int)m_levels.size(); page = parentPage(m_levels, page)) {
+				auto parent = m_pageTable.find(page.key());
+				if (parent != m_pageTable.end()) {
+					//Keep the fallback alive while the finer page streams in
+					touch(parent->second);
+					break;
+				}
+				if (missingKeys.insert(page.key()).second) {
+					missing.push_back(page);
+				}
+			}
+		}
+		m_feedback.clear();
+
+		//Place finished loads, only evicting pages nothing sampled this frame
+		std::deque<LoadedPage> finished;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			finished.swap(m_finished);
+		}
+		for (LoadedPage& loaded : finished) {
+			m_pending.erase(loaded.page.key());
+			m_stats.loadsCompleted++;
+			m_stats.bytesLoaded += loaded.pixels.size();
+			m_totalLoadMs += loaded.loadMs;
+			m_totalLoads++;
+			//Already placed if it was requested twice
+			if (m_pageTable.find(loaded.page.key()) == m_pageTable.end()) {
+				place(loaded);
+			}
+		}
+
+		//Coarsest first, so there's something close to show soonest
+		std::stable_sort(missing.begin(), missing.end(), [](const PageId& a, const PageId& b) { return a.mip > b.mip; });
+		for (const PageId& page : missing) {
+			if ((int)m_pending.size() >= m_settings.maxLoadsInFlight) {
+				break;
+			}
+			if (m_pending.count(page.key()) == 0 && m_pageTable.find(page.key()) == m_pageTable.end()) {
+				requestLoad(page);
+			}
+		}
+
+		m_stats.inFlight = (int)m_pending.size();
+		m_stats.residentPages = (int)m_pageTable.size();
+		m_stats.averageLoadMs = m_totalLoads > 0 ? (float)(m_totalLoadMs / m_totalLoads) : 0.0f;
+	}
+
+	int VirtualTexture::getResidentMip(const ew::Vec2& uv, int mip)const
+	{
+		for (int level = std::max(mip, 0); level < (int)m_levels.size(); level++) {
+			if (m_pageTable.count(pageAt(m_levels, m_pageSize, uv, level).key())) {
+				return level;
+			}
+		}
+		return -1;
+	}
+
+	int VirtualTexture::getSlot(PageId page)const
+	{
+		auto found = m_pageTable.find(page.key());
+		return found == m_pageTable.end() ? -1 : found->second;
+	}
+
+	std::vector<int> VirtualTexture::takeDirtySlots()
+	{
+		std::vector<int> slots;
+		slots.swap(m_dirtySlots);
+		//A slot can be refilled more than once between uploads
+		std::sort(slots.begin(), slots.end());
+		slots.erase(std::unique(slots.begin(), slots.end()), slots.end());
+		return slots;
+	}
+}
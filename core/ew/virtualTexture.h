@@ -0,0 +1,165 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <list>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <condition_variable>
+#include "image.h"
+#include "mappedFile.h"
+#include "jobSystem.h"
+#include "textureContainer.h"
+
+namespace ew {
+	//One page of one mip level. Keys hold up to 4096 pages per side.
+	struct PageId {
+		int mip = 0;
+		int x = 0;
+		int y = 0;
+
+		inline uint32_t key()const { return ((uint32_t)mip << 24) | ((uint32_t)y << 12) | (uint32_t)x; }
+	};
+
+	//File layout: header, one VirtualTextureLevel per mip, then every page of every level in order.
+	//Pages are RGBA, (pageSize + 2 * border) pixels square, with the border copied from neighbouring pixels.
+	struct VirtualTextureHeader {
+		char magic[4];
+		uint32_t version;
+		uint32_t width;
+		uint32_t height;
+		uint32_t pageSize;
+		uint32_t border;
+		uint32_t numLevels;
+		uint32_t padding;
+		//The source image the pages were cut from, as in TextureContainerHeader
+		uint64_t sourceHash;
+		int64_t sourceTime;
+		uint64_t sourceSize;
+	};
+
+	struct VirtualTextureLevel {
+		uint32_t width;
+		uint32_t height;
+		uint32_t pagesX;
+		uint32_t pagesY;
+		uint32_t firstPage; //Index of the level's top left page in the file
+	};
+
+	//Splits an image and its box filtered mips into pages. The last level is the first one that fits in a single page.
+	bool saveVirtualTexture(const char* filePath, const Image& image, int pageSize, int border, JobSystem* jobSystem = nullptr,
+		const TextureSource& source = TextureSource());
+	//Path of the image's page file in the texture cache, rebuilt if missing or if the image changed, as in openTextureCached
+	std::string buildVirtualTextureCached(const char* imagePath, int pageSize, int border, JobSystem* jobSystem = nullptr);
+
+	struct VirtualTextureSettings {
+		size_t budgetBytes = 16 * 1024 * 1024; //Physical page cache, including pinned pages
+		int maxLoadsInFlight = 8;
+		float simulatedLatencyMs = 0; //Added to every page load, to mimic a slow disk
+	};
+
+	struct VirtualTextureStats {
+		int frame = 0;
+		int requested = 0; //Distinct pages in this frame's feedback
+		int hits = 0; //Of those, already resident
+		int misses = 0;
+		int loadsIssued = 0;
+		int loadsCompleted = 0;
+		int evictions = 0;
+		int dropped = 0; //Loads that finished with every slot needed this frame
+		int inFlight = 0;
+		int residentPages = 0;
+		int capacityPages = 0;
+		size_t bytesLoaded = 0; //Total since creation
+		float averageLoadMs = 0; //Per page, since creation
+	};
+
+	/// <summary>
+	/// Streams pages of a virtual texture into a fixed size physical cache.
+	/// Each frame, report the pages that were sampled with addFeedback, then call update() to touch them in the LRU,
+	/// queue loads for missing ones (and their parents, coarsest first), and place pages that finished loading.
+	/// The coarsest level is pinned, so every lookup can fall back to something.
+	/// Loads run on the JobSystem. Nothing here touches GL; upload the dirty slots of getPhysicalImage() yourself.
+	/// </summary>
+	class VirtualTexture {
+	public:
+		VirtualTexture(JobSystem* jobSystem);
+		//Waits for loads still running
+		~VirtualTexture();
+		VirtualTexture(const VirtualTexture&) = delete;
+		VirtualTexture& operator=(const VirtualTexture&) = delete;
+
+		//Maps a page file from saveVirtualTexture. Blocks until the pinned level is loaded.
+		bool open(const char* filePath, const VirtualTextureSettings& settings = VirtualTextureSettings());
+
+		void addFeedback(PageId page);
+		//The page a sample at uv (0-1, repeating) on a fractional mip would read
+		void addFeedback(const ew::Vec2& uv, float mip);
+		void update();
+
+		//Finest resident level at or above mip covering uv, or -1 if nothing is
+		int getResidentMip(const ew::Vec2& uv, int mip)const;
+		//Slot holding a page, or -1
+		int getSlot(PageId page)const;
+
+		inline int getNumLevels()const { return (int)m_levels.size(); }
+		inline const VirtualTextureLevel& getLevel(int mip)const { return m_levels[mip]; }
+		inline int getPageSize()const { return m_pageSize; }
+		inline int getBorder()const { return m_border; }
+		//Every slot side by side, each (pageSize + 2 * border) pixels square
+		inline const Image& getPhysicalImage()const { return m_physical; }
+		inline int getSlotsPerRow()const { return m_slotsPerRow; }
+		//Slots written since the last call
+		std::vector<int> takeDirtySlots();
+		inline const VirtualTextureStats& getStats()const { return m_stats; }
+	private:
+		struct LoadedPage {
+			PageId page;
+			std::vector<unsigned char> pixels;
+			float loadMs = 0;
+		};
+		struct Slot {
+			PageId page;
+			bool occupied = false;
+			bool pinned = false;
+			int lastUsedFrame = -1;
+			std::list<int>::iterator lruPosition;
+		};
+
+		void requestLoad(PageId page);
+		void place(LoadedPage& loaded);
+		int allocateSlot();
+		void touch(int slot);
+		void waitAll();
+
+		JobSystem* m_jobSystem;
+		MappedFile m_file;
+		VirtualTextureSettings m_settings;
+		std::vector<VirtualTextureLevel> m_levels;
+		int m_pageSize = 0;
+		int m_border = 0;
+		size_t m_pageBytes = 0;
+		size_t m_dataOffset = 0;
+
+		Image m_physical;
+		int m_slotsPerRow = 0;
+		std::vector<Slot> m_slots;
+		std::list<int> m_lru; //Unpinned occupied slots, most recently used first
+		std::vector<int> m_freeSlots;
+		std::unordered_map<uint32_t, int> m_pageTable; //Page key to slot
+		std::vector<int> m_dirtySlots;
+
+		std::unordered_set<uint32_t> m_feedback;
+		std::unordered_set<uint32_t> m_pending; //Loads issued and not placed yet
+		std::mutex m_mutex;
+		std::condition_variable m_loaded;
+		std::deque<LoadedPage> m_finished;
+		int m_loading = 0;
+
+		VirtualTextureStats m_stats;
+		double m_totalLoadMs = 0;
+		int m_totalLoads = 0;
+	};
+}